@@ -0,0 +1,105 @@
+/**
+ * @file BatchAnalyzerMain.cpp
+ * @author John Korreck
+ *
+ * Entry point for the tool that analyzes files of positions
+ */
+
+#include "pch.h"
+#include <BatchAnalyzer.h>
+
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+/**
+ * Search every position of a FEN or EPD file and write what was
+ * found as JSON, one object per line. With -resume, lines already
+ * in the output file are not searched again.
+ *
+ * Usage: Chess_Engine_BatchAnalyzer [-threads N] [-time ms] [-nodes N]
+ * [-depth N] [-hash MB] [-unordered] [-syzygy path] [-o out.jsonl]
+ * [-resume] positions.epd|-
+ * @param argc Number of arguments
+ * @param argv The arguments
+ * @return Exit code
+ */
+int main(int argc, char *argv[])
+{
+    BatchAnalyzerOptions options;
+    options.mThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    std::string inputPath;
+    std::string outputPath;
+    bool resume = false;
+    int depth = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-threads" && hasValue) options.mThreads = std::atoi(argv[++i]);
+        else if (arg == "-time" && hasValue) options.mMoveTime = std::atoll(argv[++i]);
+        else if (arg == "-nodes" && hasValue) options.mNodes = uint64_t(std::atoll(argv[++i]));
+        else if (arg == "-depth" && hasValue) depth = std::atoi(argv[++i]);
+        else if (arg == "-hash" && hasValue) options.mHash = size_t(std::atoll(argv[++i]));
+        else if (arg == "-unordered") options.mOrdered = false;
+        else if (arg == "-syzygy" && hasValue) options.mSyzygyPath = argv[++i];
+        else if (arg == "-o" && hasValue) outputPath = argv[++i];
+        else if (arg == "-resume") resume = true;
+        else inputPath = arg;
+    }
+    if (inputPath.empty() || (resume && outputPath.empty()))
+    {
+        std::cerr << "usage: " << argv[0] << " [-threads N] [-time ms] [-nodes N] [-depth N] [-hash MB]"
+                  << " [-unordered] [-syzygy path] [-o out.jsonl] [-resume] positions.epd|-" << std::endl;
+        return 1;
+    }
+    if (depth >= 0 || options.mMoveTime > 0 || options.mNodes > 0)
+    {
+        // A time or node limit replaces the default depth
+        options.mDepth = std::max(0, depth);
+    }
+
+    std::ifstream file;
+    if (inputPath != "-")
+    {
+        file.open(inputPath);
+        if (!file)
+        {
+            std::cerr << "could not read " << inputPath << std::endl;
+            return 1;
+        }
+    }
+    std::istream &input = inputPath == "-" ? std::cin : file;
+
+    std::unordered_set<uint64_t> done;
+    if (resume && !BatchAnalyzer::Resume(outputPath, done))
+    {
+        std::cerr << "could not resume from " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::ofstream out;
+    if (!outputPath.empty())
+    {
+        out.open(outputPath, resume ? std::ios::app : std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "could not write " << outputPath << std::endl;
+            return 1;
+        }
+    }
+
+    BatchAnalyzer analyzer(options);
+    analyzer.Run(input, outputPath.empty() ? std::cout : out, done);
+
+    auto const &stats = analyzer.GetStats();
+    std::cerr << "positions " << stats.mPositions << " bad lines " << stats.mBadLines << " skipped "
+              << stats.mSkipped << " nodes " << stats.mNodes << " time " << stats.mMilliseconds << " ms";
+    if (stats.mMilliseconds > 0)
+    {
+        std::cerr << " (" << stats.mPositions * 1000 / uint64_t(stats.mMilliseconds) << " positions/s)";
+    }
+    std::cerr << std::endl;
+    return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file BookBuilderMain.cpp
+ * @author John Korreck
+ *
+ * Entry point for the tool that builds opening books from PGN files
+ */
+
+#include "pch.h"
+#include <BookBuilder.h>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+/**
+ * Build a Polyglot book from the PGN files given as arguments.
+ *
+ * Usage: Chess_Engine_BookBuilder [-o book.bin] [-ply N] [-min N]
+ * [-memory MB] [-threads N] [-temp directory] games.pgn...
+ * @param argc Number of arguments
+ * @param argv The arguments
+ * @return Exit code
+ */
+int main(int argc, char *argv[])
+{
+    BookBuilderOptions options;
+    options.mThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    std::string output = "book.bin";
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue) output = argv[++i];
+        else if (arg == "-ply" && hasValue) options.mMaxPly = std::atoi(argv[++i]);
+        else if (arg == "-min" && hasValue) options.mMinGames = std::atoi(argv[++i]);
+        else if (arg == "-memory" && hasValue) options.mMemory = size_t(std::atoll(argv[++i]));
+        else if (arg == "-threads" && hasValue) options.mThreads = std::atoi(argv[++i]);
+        else if (arg == "-temp" && hasValue) options.mTempDirectory = argv[++i];
+        else files.push_back(arg);
+    }
+    if (files.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " [-o book.bin] [-ply N] [-min N] [-memory MB] [-threads N]"
+                  << " [-temp directory] games.pgn..." << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BookBuilder builder(options);
+    bool built = builder.Build(files, output);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    auto const &stats = builder.GetStats();
+    std::cout << "games " << stats.mGames << " unreadable " << stats.mBadGames << " positions " << stats.mRecords
+              << " runs " << stats.mRuns << " entries " << stats.mEntries << " time " << elapsed.count() << " ms"
+              << std::endl;
+    if (!built)
+    {
+        std::cerr << "could not build " << output << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file AccumulatorStack.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "AccumulatorStack.h"
+#include "Position.h"
+
+#include <algorithm>
+
+/**
+ * Set the network to compute accumulators for. Everything
+ * computed for the previous network is forgotten.
+ * @param network A loaded network or nullptr
+ */
+void AccumulatorStack::SetNetwork(const Network *network)
+{
+    mNetwork = network;
+    mEntries.clear();
+    mCache.clear();
+    if (network != nullptr)
+    {
+        // With no pieces recorded every cache entry is just the biases
+        mCache.resize(2 * SQUARE_NB);
+        for (CacheEntry &entry : mCache)
+        {
+            std::copy_n(network->FeatureBiases(), NnueHalfDims, entry.mValues);
+        }
+    }
+}
+
+/**
+ * Evaluate a position with the network
+ * @param position Position to evaluate
+ * @return Score in centipawns from the side to move's point of view
+ */
+int AccumulatorStack::Evaluate(const Position &position)
+{
+    int ply = position.GamePly();
+    if (int(mEntries.size()) <= ply)
+    {
+        mEntries.resize(ply + 1);
+    }
+
+    Update(position, WHITE);
+    Update(position, BLACK);
+    return mNetwork->Propagate(mEntries[ply].mAccumulator, position.SideToMove());
+}
+
+/**
+ * Get the entry of a ply, forgetting what it holds if that was
+ * computed for another position
+ * @param position Current position
+ * @param ply Game ply of the entry
+ * @return The entry
+ */
+AccumulatorStack::Entry &AccumulatorStack::EntryAt(const Position &position, int ply)
+{
+    Entry &entry = mEntries[ply];
+    if (entry.mKey != position.KeyAtPly(ply))
+    {
+        entry.mKey = position.KeyAtPly(ply);
+        entry.mComputed[0] = entry.mComputed[1] = false;
+    }
+    return entry;
+}
+
+/**
+ * Bring one half of the entry for the current ply up to date
+ * @param position Current position
+ * @param perspective WHITE or BLACK, which half
+ */
+void AccumulatorStack::Update(const Position &position, int perspective)
+{
+    int side = ColorIndex(perspective);
+    auto computed = [&](int ply) {
+        return mEntries[ply].mKey == position.KeyAtPly(ply) && mEntries[ply].mComputed[side];
+    };
+
+    int ply = position.GamePly();
+    if (computed(ply))
+    {
+        return;
+    }
+
+    // Walk back to a computed entry, unless our king moved on the way
+    int start = ply;
+    bool found = false;
+    while (start > 0 && !found)
+    {
+        const DirtyPiece &dirty = position.ChangesToPly(start);
+        bool kingMoved = false;
+        for (int i = 0; i < dirty.mCount; i++)
+        {
+            kingMoved = kingMoved || dirty.mPiece[i] == perspective + KING;
+        }
+        if (kingMoved)
+        {
+            break;
+        }
+        start--;
+        found = computed(start);
+    }
+
+    if (!found)
+    {
+        Entry &entry = EntryAt(position, ply);
+        Refresh(position, perspective, entry.mAccumulator.mValues[side]);
+        entry.mComputed[side] = true;
+        mRefreshes++;
+        return;
+    }
+
+    for (int p = start + 1; p <= ply; p++)
+    {
+        ApplyChanges(position, perspective, p);
+    }
+}
+
+/**
+ * Compute one half of an entry from the entry of the ply before
+ * @param position Current position, at or after the ply
+ * @param perspective WHITE or BLACK, which half
+ * @param ply Game ply of the entry, the king of perspective
+ * must not have moved since
+ */
+void AccumulatorStack::ApplyChanges(const Position &position, int perspective, int ply)
+{
+    int side = ColorIndex(perspective);
+    Entry &entry = EntryAt(position, ply);
+    int16_t *values = entry.mAccumulator.mValues[side];
+    std::copy_n(mEntries[ply - 1].mAccumulator.mValues[side], NnueHalfDims, values);
+
+    const NnueKernels &kernels = mNetwork->Kernels();
+    int king = position.KingSquare(perspective);
+    const DirtyPiece &dirty = position.ChangesToPly(ply);
+    for (int i = 0; i < dirty.mCount; i++)
+    {
+        // The enemy king is not an input
+        int piece = dirty.mPiece[i];
+        if (TypeOf(piece) == KING)
+        {
+            continue;
+        }
+        if (dirty.mFrom[i] != NO_SQUARE)
+        {
+            int feature = Network::FeatureIndex(perspective, king, piece, dirty.mFrom[i]);
+            kernels.mSubRow(values, mNetwork->FeatureRow(feature), NnueHalfDims);
+        }
+        if (dirty.mTo[i] != NO_SQUARE)
+        {
+            int feature = Network::FeatureIndex(perspective, king, piece, dirty.mTo[i]);
+            kernels.mAddRow(values, mNetwork->FeatureRow(feature), NnueHalfDims);
+        }
+    }
+
+    entry.mComputed[side] = true;
+    mUpdates++;
+}
+
+/**
+ * Rebuild one half of the first layer through the refresh cache
+ * @param position Position to compute the half for
+ * @param perspective WHITE or BLACK, which half
+ * @param values Receives the NnueHalfDims values
+ */
+void AccumulatorStack::Refresh(const Position &position, int perspective, int16_t *values)
+{
+    const NnueKernels &kernels = mNetwork->Kernels();
+    int king = position.KingSquare(perspective);
+    CacheEntry &cache = mCache[ColorIndex(perspective) * SQUARE_NB + king];
+
+    // Take off what left since the king was last here, then add what arrived
+    const int16_t *added[SQUARE_NB];
+    int addedCount = 0;
+    for (int color : {WHITE, BLACK})
+    {
+        for (int type = PAWN; type <= QUEEN; type++)
+        {
+            int piece = color + type;
+            Bitboard now = position.Pieces(piece);
+            Bitboard removed = cache.mPieces[piece] & ~now;
+            Bitboard arrived = now & ~cache.mPieces[piece];
+            while (removed)
+            {
+                int feature = Network::FeatureIndex(perspective, king, piece, PopLsb(removed));
+                kernels.mSubRow(cache.mValues, mNetwork->FeatureRow(feature), NnueHalfDims);
+            }
+            while (arrived)
+            {
+                int feature = Network::FeatureIndex(perspective, king, piece, PopLsb(arrived));
+                added[addedCount++] = mNetwork->FeatureRow(feature);
+            }
+            cache.mPieces[piece] = now;
+        }
+    }
+    kernels.mAddRows(cache.mValues, added, addedCount, NnueHalfDims);
+    std::copy_n(cache.mValues, NnueHalfDims, values);
+}
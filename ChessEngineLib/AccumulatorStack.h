@@ -0,0 +1,92 @@
+/**
+ * @file AccumulatorStack.h
+ * @author John Korreck
+ *
+ * First layer of the network kept up to date along the search.
+ */
+
+#ifndef ACCUMULATORSTACK_H
+#define ACCUMULATORSTACK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Bitboard.h"
+#include "Nnue.h"
+
+class Position;
+
+/**
+ * Network accumulators for each ply of the game, computed lazily.
+ *
+ * Entry n belongs to the position at game ply n and is trusted only
+ * while its key matches Position::KeyAtPly(n), so making and taking
+ * back moves needs no calls into the stack. When an evaluation is
+ * asked for, the stack walks back to the nearest computed entry and
+ * replays the DirtyPiece changes of the moves since then. A king move
+ * changes every feature of its own side, so that half is instead
+ * rebuilt from a per king square cache holding the accumulator and
+ * pieces seen the last time the king stood there, which only needs
+ * the pieces that differ since.
+ *
+ * Each Evaluation owns one stack, so nothing is shared between threads.
+ */
+class AccumulatorStack {
+private:
+    /**
+     * Accumulator of one game ply
+     */
+    struct Entry {
+        /// First layer output for both sides
+        NnueAccumulator mAccumulator;
+
+        /// Key of the position the entry was computed for
+        uint64_t mKey = 0;
+
+        /// Which halves are up to date, indexed by ColorIndex()
+        bool mComputed[2] = {};
+    };
+
+    /**
+     * Half accumulator last computed with the king on a square
+     */
+    struct CacheEntry {
+        /// The half accumulator
+        alignas(64) int16_t mValues[NnueHalfDims];
+
+        /// Squares of each piece code it was computed for
+        Bitboard mPieces[PIECE_CODE_NB] = {};
+    };
+
+    /// Network the accumulators are for
+    const Network *mNetwork = nullptr;
+
+    /// Entries indexed by game ply
+    std::vector<Entry> mEntries;
+
+    /// Refresh cache indexed by ColorIndex() of the perspective, then king square
+    std::vector<CacheEntry> mCache;
+
+    /// Halves brought up to date from the ply before
+    uint64_t mUpdates = 0;
+
+    /// Halves rebuilt from the refresh cache
+    uint64_t mRefreshes = 0;
+
+    Entry &EntryAt(const Position &position, int ply);
+    void Update(const Position &position, int perspective);
+    void Refresh(const Position &position, int perspective, int16_t *values);
+    void ApplyChanges(const Position &position, int perspective, int ply);
+
+public:
+    void SetNetwork(const Network *network);
+    int Evaluate(const Position &position);
+
+    /// Halves brought up to date from the ply before
+    uint64_t Updates() const { return mUpdates; }
+
+    /// Halves rebuilt from the refresh cache
+    uint64_t Refreshes() const { return mRefreshes; }
+};
+
+#endif //ACCUMULATORSTACK_H
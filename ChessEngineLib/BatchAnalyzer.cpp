@@ -0,0 +1,298 @@
+/**
+ * @file BatchAnalyzer.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "BatchAnalyzer.h"
+#include "Engine.h"
+#include "Epd.h"
+#include "Uci.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+/// Lines read ahead of the output per worker before the reader waits
+const size_t UnwrittenLinesPerThread = 16;
+
+/// Every result starts with this, followed by the line number
+const std::string LinePrefix = "{\"line\":";
+
+/**
+ * Analyze every position of a stream
+ * @param input Positions in FEN or EPD, one per line. Blank lines
+ * and lines starting with '#' are skipped.
+ * @param output Receives a JSON object per line
+ * @param done Line numbers to skip, already analyzed by an earlier run
+ */
+void BatchAnalyzer::Run(std::istream &input, std::ostream &output, const std::unordered_set<uint64_t> &done)
+{
+    auto start = std::chrono::steady_clock::now();
+    mStats = Stats();
+    mQueue.clear();
+    mUnwritten.clear();
+    mFinished.clear();
+    mDone = false;
+    mOutput = &output;
+
+    int threads = std::max(1, mOptions.mThreads);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&BatchAnalyzer::Worker, this);
+    }
+
+    std::string text;
+    for (uint64_t line = 1; std::getline(input, text); line++)
+    {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos || text[first] == '#')
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (done.count(line) > 0)
+        {
+            mStats.mSkipped++;
+            continue;
+        }
+        mCondition.wait(lock, [this, threads]() { return mUnwritten.size() < UnwrittenLinesPerThread * threads; });
+        mQueue.push_back({line, text});
+        mUnwritten.push_back(line);
+        lock.unlock();
+        mCondition.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mDone = true;
+    }
+    mCondition.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    mOutput = nullptr;
+
+    mStats.mMilliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Take lines off the queue and analyze them until there are none left
+ */
+void BatchAnalyzer::Worker()
+{
+    Engine engine;
+    engine.SetHashSize(mOptions.mHash);
+    if (!mOptions.mSyzygyPath.empty())
+    {
+        engine.SetSyzygyPath(mOptions.mSyzygyPath);
+    }
+
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mDone || !mQueue.empty(); });
+            if (mQueue.empty())
+            {
+                break;
+            }
+            job = std::move(mQueue.front());
+            mQueue.pop_front();
+        }
+
+        Stats stats;
+        std::string json = Analyze(engine, job, stats);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.mPositions += stats.mPositions;
+            mStats.mBadLines += stats.mBadLines;
+            mStats.mNodes += stats.mNodes;
+            Write(job.mLine, json);
+        }
+        mCondition.notify_all();
+    }
+    engine.GetSearch().SetInfoCallback(nullptr);
+    engine.GetSearch().SetBestMoveCallback(nullptr);
+}
+
+/**
+ * Search the position of a line
+ * @param engine Engine to search with
+ * @param job The line
+ * @param stats Receives the position, bad line and nodes counts
+ * @return The result as a JSON object
+ */
+std::string BatchAnalyzer::Analyze(Engine &engine, const Job &job, Stats &stats)
+{
+    std::string json = LinePrefix + std::to_string(job.mLine);
+    EpdPosition epd;
+    if (!epd.Parse(job.mText) || !engine.SetPosition(epd.mFen, {}))
+    {
+        stats.mBadLines++;
+        return json + ",\"error\":\"not a position\"}";
+    }
+
+    SearchInfo last;
+    Move best;
+    engine.GetSearch().SetInfoCallback([&last](const SearchInfo &info) {
+        if (info.mMultiPV == 1)
+        {
+            last = info;
+        }
+    });
+    engine.GetSearch().SetBestMoveCallback([&best](Move move, Move) { best = move; });
+
+    SearchLimits limits;
+    limits.mMoveTime = mOptions.mMoveTime;
+    limits.mNodes = mOptions.mNodes;
+    limits.mDepth = mOptions.mDepth;
+    auto start = std::chrono::steady_clock::now();
+    engine.Go(limits);
+    engine.Wait();
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    stats.mPositions++;
+    stats.mNodes += engine.GetSearch().Nodes();
+
+    // With no legal move there is no iteration, the game is over
+    int score = last.mScore;
+    if (!best.IsValid() && last.mPv.empty())
+    {
+        score = engine.GetPosition().InCheck() ? MatedIn(0) : VALUE_DRAW;
+    }
+
+    json += ",\"fen\":\"" + Escape(epd.mFen) + "\"";
+    if (!epd.mId.empty())
+    {
+        json += ",\"id\":\"" + Escape(epd.mId) + "\"";
+    }
+    json += ",\"bestmove\":";
+    json += best.IsValid() ? "\"" + best.ToUci() + "\"" : "null";
+
+    // The score as UCI gives it, its unit "cp" or "mate" becoming the key
+    std::string uciScore = Uci::FormatScore(score);
+    size_t space = uciScore.find(' ');
+    json += ",\"" + uciScore.substr(0, space) + "\":" + uciScore.substr(space + 1);
+    json += ",\"depth\":" + std::to_string(last.mDepth) + ",\"seldepth\":" + std::to_string(last.mSelDepth);
+    json += ",\"nodes\":" + std::to_string(engine.GetSearch().Nodes()) + ",\"time\":" + std::to_string(elapsed);
+    json += ",\"pv\":[";
+    for (size_t i = 0; i < last.mPv.size(); i++)
+    {
+        json += (i == 0 ? "\"" : ",\"");
+        json += last.mPv[i].UciText().View();
+        json += '"';
+    }
+    return json + "]}";
+}
+
+/**
+ * Write a result, or hold it back until the lines ahead of it are
+ * written when the output is ordered. Called with the lock held.
+ * @param line Line number of the result
+ * @param json The result
+ */
+void BatchAnalyzer::Write(uint64_t line, const std::string &json)
+{
+    if (!mOptions.mOrdered)
+    {
+        *mOutput << json << '\n' << std::flush;
+        mUnwritten.erase(std::find(mUnwritten.begin(), mUnwritten.end(), line));
+        return;
+    }
+
+    mFinished[line] = json;
+    while (!mUnwritten.empty() && mFinished.count(mUnwritten.front()) > 0)
+    {
+        auto next = mFinished.find(mUnwritten.front());
+        *mOutput << next->second << '\n';
+        mFinished.erase(next);
+        mUnwritten.pop_front();
+    }
+    *mOutput << std::flush;
+}
+
+/**
+ * Find the lines an interrupted run has already written. A result
+ * cut off part way through is removed from the file.
+ * @param path Output file of the interrupted run
+ * @param done Receives the line numbers of the results in the file
+ * @return False if the file could not be read or repaired, true
+ * if it was or if it does not exist
+ */
+bool BatchAnalyzer::Resume(const std::string &path, std::unordered_set<uint64_t> &done)
+{
+    std::error_code error;
+    if (!std::filesystem::exists(path, error))
+    {
+        return !error;
+    }
+
+    uint64_t complete = 0;
+    {
+        std::ifstream input(path, std::ios::binary);
+        if (!input)
+        {
+            return false;
+        }
+        std::string text;
+        while (std::getline(input, text))
+        {
+            if (input.eof())
+            {
+                // No newline, the run stopped while writing this
+                break;
+            }
+            complete += text.size() + 1;
+            if (text.compare(0, LinePrefix.size(), LinePrefix) == 0)
+            {
+                done.insert(std::strtoull(text.c_str() + LinePrefix.size(), nullptr, 10));
+            }
+        }
+    }
+
+    if (complete < std::filesystem::file_size(path, error) && !error)
+    {
+        std::filesystem::resize_file(path, complete, error);
+    }
+    return !error;
+}
+
+/**
+ * Escape text for a JSON string
+ * @param text The text
+ * @return The text with quotes, backslashes and control characters escaped
+ */
+std::string BatchAnalyzer::Escape(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file BatchAnalyzer.h
+ * @author John Korreck
+ *
+ * Scores streams of positions with several searches at once.
+ */
+
+#ifndef BATCHANALYZER_H
+#define BATCHANALYZER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+
+class Engine;
+
+/**
+ * Settings for analyzing positions
+ */
+struct BatchAnalyzerOptions {
+    /// Positions searched at once, each by its own engine
+    int mThreads = 1;
+
+    /// Time to search each position in milliseconds, 0 for no limit
+    int64_t mMoveTime = 0;
+
+    /// Nodes to search each position, 0 for no limit
+    uint64_t mNodes = 0;
+
+    /// Depth to search each position to, 0 for no limit
+    int mDepth = 12;
+
+    /// Transposition table of each engine in megabytes
+    size_t mHash = 16;
+
+    /// Write the results in input order, otherwise as they finish
+    bool mOrdered = true;
+
+    /// Syzygy tablebase directories, empty for none
+    std::string mSyzygyPath;
+};
+
+/**
+ * Reads positions in FEN or EPD, one per line, and writes a JSON
+ * object per line with what the search found for each.
+ *
+ * The calling thread reads the input and queues its lines for the
+ * worker threads, each of which owns an engine with its own table.
+ * The transposition table does not support several searches writing
+ * to it at once, so the tables are not shared. Every result carries
+ * the number of its input line, which is what lets an interrupted run
+ * resume: Resume() collects the lines already written, and Run() skips
+ * them. Output is flushed after each line, so at most the searches in
+ * progress are lost.
+ *
+ * A line that is not a position gets an object with an "error" member,
+ * so every line of input has its result.
+ */
+class BatchAnalyzer {
+public:
+    /**
+     * Statistics of a run
+     */
+    struct Stats {
+        /// Positions searched
+        uint64_t mPositions = 0;
+
+        /// Lines that were not positions
+        uint64_t mBadLines = 0;
+
+        /// Lines skipped because they were done in an earlier run
+        uint64_t mSkipped = 0;
+
+        /// Nodes searched over all positions
+        uint64_t mNodes = 0;
+
+        /// Time taken in milliseconds
+        int64_t mMilliseconds = 0;
+    };
+
+private:
+    /**
+     * A line of input waiting for a worker
+     */
+    struct Job {
+        /// Line number in the input, from 1
+        uint64_t mLine;
+
+        /// The line
+        std::string mText;
+    };
+
+    /// Settings for the run
+    BatchAnalyzerOptions mOptions;
+
+    /// Statistics of the last run
+    Stats mStats;
+
+    /// Lines waiting for a worker
+    std::deque<Job> mQueue;
+
+    /// Lines queued and not written yet, in input order
+    std::deque<uint64_t> mUnwritten;
+
+    /// Results finished before the lines ahead of them, when ordered
+    std::map<uint64_t, std::string> mFinished;
+
+    /// No more lines will be queued
+    bool mDone = false;
+
+    /// Where the results go
+    std::ostream *mOutput = nullptr;
+
+    /// Protects everything above
+    std::mutex mMutex;
+
+    /// Signals a change in the queue or the lines written
+    std::condition_variable mCondition;
+
+    void Worker();
+    std::string Analyze(Engine &engine, const Job &job, Stats &stats);
+    void Write(uint64_t line, const std::string &json);
+
+public:
+    /**
+     * Constructor
+     * @param options Settings for the run
+     */
+    BatchAnalyzer(const BatchAnalyzerOptions &options) : mOptions(options) {}
+
+    /// Copy constructor (disabled)
+    BatchAnalyzer(const BatchAnalyzer &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const BatchAnalyzer &) = delete;
+
+    void Run(std::istream &input, std::ostream &output, const std::unordered_set<uint64_t> &done = {});
+
+    static bool Resume(const std::string &path, std::unordered_set<uint64_t> &done);
+    static std::string Escape(const std::string &text);
+
+    /// Statistics of the last run
+    const Stats &GetStats() const { return mStats; }
+};
+
+#endif //BATCHANALYZER_H
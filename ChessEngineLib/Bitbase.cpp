@@ -0,0 +1,186 @@
+/**
+ * @file Bitbase.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Bitbase.h"
+#include "Bitboard.h"
+
+#include <mutex>
+#include <vector>
+
+/// One bit per position, set if the side with the pawn wins
+static uint64_t KpkWins[KPK_INDEX_NB / 64];
+
+/**
+ * Result of a position while the bitbase is generated. The values
+ * are bits, so the results of the moves can be or-ed together.
+ */
+enum KpkResult : uint8_t { KPK_INVALID = 0, KPK_UNKNOWN = 1, KPK_DRAW = 2, KPK_WIN = 4 };
+
+/**
+ * Index of a position with white holding the pawn
+ * @param whiteKing White king square
+ * @param pawn Pawn square, on files a to d and ranks 2 to 7
+ * @param blackKing Black king square
+ * @param whiteToMove Is it white's move?
+ * @return Index below KPK_INDEX_NB
+ */
+static int KpkIndex(int whiteKing, int pawn, int blackKing, bool whiteToMove)
+{
+    return blackKing | whiteKing << 6 | (whiteToMove ? 0 : 1) << 12 | FileOf(pawn) << 13 | (6 - RankOf(pawn)) << 15;
+}
+
+/**
+ * One position of the bitbase being generated
+ */
+struct KpkPosition {
+    /// White king square
+    int mWhiteKing;
+
+    /// Black king square
+    int mBlackKing;
+
+    /// Pawn square
+    int mPawn;
+
+    /// Is it white's move?
+    bool mWhiteToMove;
+
+    /// Result found so far
+    KpkResult mResult;
+
+    /**
+     * Decode an index and score what can be seen without moving:
+     * illegal positions, safe promotions, stalemates and the pawn
+     * falling to the black king
+     * @param index Index below KPK_INDEX_NB
+     */
+    explicit KpkPosition(int index)
+    {
+        mBlackKing = index & 63;
+        mWhiteKing = (index >> 6) & 63;
+        mWhiteToMove = ((index >> 12) & 1) == 0;
+        mPawn = MakeSquare((index >> 13) & 3, 6 - ((index >> 15) & 7));
+
+        int promotion = mPawn + 8;
+        if (Distance(mWhiteKing, mBlackKing) <= 1 || mWhiteKing == mPawn || mBlackKing == mPawn
+            || (mWhiteToMove && Contains(PawnAttacks[0][mPawn], mBlackKing)))
+        {
+            mResult = KPK_INVALID;
+        }
+        else if (mWhiteToMove && RankOf(mPawn) == 6 && mWhiteKing != promotion && mBlackKing != promotion
+                 && (Distance(mBlackKing, promotion) > 1 || Distance(mWhiteKing, promotion) == 1))
+        {
+            mResult = KPK_WIN;
+        }
+        else if (!mWhiteToMove
+                 && ((KingAttacks[mBlackKing] & ~(KingAttacks[mWhiteKing] | PawnAttacks[0][mPawn])) == 0
+                     || (Contains(KingAttacks[mBlackKing], mPawn) && !Contains(KingAttacks[mWhiteKing], mPawn))))
+        {
+            mResult = KPK_DRAW;
+        }
+        else
+        {
+            mResult = KPK_UNKNOWN;
+        }
+    }
+
+    /**
+     * Score the position by its moves: won for the side to move if a
+     * move wins, lost if every move loses
+     * @param positions Every position of the bitbase
+     * @return The result, still KPK_UNKNOWN if some move is not decided
+     */
+    KpkResult Classify(const std::vector<KpkPosition> &positions) const
+    {
+        int results = KPK_INVALID;
+        Bitboard moves = KingAttacks[mWhiteToMove ? mWhiteKing : mBlackKing];
+        while (moves != 0)
+        {
+            int to = PopLsb(moves);
+            results |= mWhiteToMove ? positions[KpkIndex(to, mPawn, mBlackKing, false)].mResult
+                                    : positions[KpkIndex(mWhiteKing, mPawn, to, true)].mResult;
+        }
+
+        // Promotions were scored up front, a promotion that loses the
+        // queen is never better than another move
+        if (mWhiteToMove && RankOf(mPawn) < 6)
+        {
+            int push = mPawn + 8;
+            if (push != mWhiteKing && push != mBlackKing)
+            {
+                results |= positions[KpkIndex(mWhiteKing, push, mBlackKing, false)].mResult;
+                if (RankOf(mPawn) == 1 && push + 8 != mWhiteKing && push + 8 != mBlackKing)
+                {
+                    results |= positions[KpkIndex(mWhiteKing, push + 8, mBlackKing, false)].mResult;
+                }
+            }
+        }
+
+        KpkResult good = mWhiteToMove ? KPK_WIN : KPK_DRAW;
+        KpkResult bad = mWhiteToMove ? KPK_DRAW : KPK_WIN;
+        return (results & good) != 0 ? good : (results & KPK_UNKNOWN) != 0 ? KPK_UNKNOWN : bad;
+    }
+};
+
+/**
+ * Generate the bitbase, once. Safe to call from several threads.
+ */
+void InitKpkBitbase()
+{
+    static std::once_flag generated;
+    std::call_once(generated, []() {
+        std::vector<KpkPosition> positions;
+        positions.reserve(KPK_INDEX_NB);
+        for (int index = 0; index < KPK_INDEX_NB; index++)
+        {
+            positions.emplace_back(index);
+        }
+
+        // Sweep until nothing changes, every sweep settles the
+        // positions one move further from a known result
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            for (KpkPosition &position : positions)
+            {
+                if (position.mResult == KPK_UNKNOWN)
+                {
+                    position.mResult = position.Classify(positions);
+                    changed |= position.mResult != KPK_UNKNOWN;
+                }
+            }
+        }
+
+        for (int index = 0; index < KPK_INDEX_NB; index++)
+        {
+            if (positions[index].mResult == KPK_WIN)
+            {
+                KpkWins[index / 64] |= uint64_t(1) << (index % 64);
+            }
+        }
+    });
+}
+
+/**
+ * Is a king and pawn against king position won? InitKpkBitbase()
+ * must have been called. The squares are seen from the side with
+ * the pawn, as if it were white with the pawn on files a to d.
+ * @param strongKing King square of the side with the pawn
+ * @param pawn Pawn square, on ranks 2 to 7
+ * @param weakKing King square of the lone king
+ * @param strongToMove Is it the move of the side with the pawn?
+ * @return True if the side with the pawn wins, false for a pawn on
+ * the first or last rank, which has no place in the bitbase
+ */
+bool ProbeKpk(int strongKing, int pawn, int weakKing, bool strongToMove)
+{
+    if (RankOf(pawn) == 0 || RankOf(pawn) == 7)
+    {
+        return false;
+    }
+    int index = KpkIndex(strongKing, pawn, weakKing, strongToMove);
+    return (KpkWins[index / 64] >> (index % 64)) & 1;
+}
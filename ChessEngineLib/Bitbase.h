@@ -0,0 +1,18 @@
+/**
+ * @file Bitbase.h
+ * @author John Korreck
+ *
+ * Exact win or draw of every king and pawn against king position.
+ */
+
+#ifndef BITBASE_H
+#define BITBASE_H
+
+/// Positions in the king and pawn against king bitbase: both kings,
+/// the side to move and the pawn on files a to d and ranks 2 to 7
+const int KPK_INDEX_NB = 64 * 64 * 2 * 4 * 6;
+
+void InitKpkBitbase();
+bool ProbeKpk(int strongKing, int pawn, int weakKing, bool strongToMove);
+
+#endif //BITBASE_H
@@ -0,0 +1,381 @@
+/**
+ * @file Bitboard.h
+ * @author John Korreck
+ *
+ * 64 bit square sets and the attack tables built from them.
+ * Bit n stands for square n, so a1 is the lowest bit.
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "ChessTypes.h"
+
+/// A set of squares
+using Bitboard = uint64_t;
+
+/**
+ * Get the set holding a single square
+ * @param square Square index
+ * @return Set with only that square
+ */
+constexpr Bitboard SquareBB(int square) { return Bitboard(1) << square; }
+
+/**
+ * Get the set of squares on a rank
+ * @param rank Rank 0 to 7
+ * @return Set of the eight squares
+ */
+constexpr Bitboard RankBB(int rank) { return Bitboard(0xFF) << (rank * 8); }
+
+/**
+ * Get the set of squares on a file
+ * @param file File 0 to 7
+ * @return Set of the eight squares
+ */
+constexpr Bitboard FileBB(int file) { return Bitboard(0x0101010101010101) << file; }
+
+/**
+ * Get the files either side of a file
+ * @param file File 0 to 7
+ * @return Set of the squares on the neighbouring files
+ */
+constexpr Bitboard AdjacentFilesBB(int file)
+{
+    return (file > 0 ? FileBB(file - 1) : 0) | (file < 7 ? FileBB(file + 1) : 0);
+}
+
+/**
+ * Get the ranks in front of a square from a side's point of view
+ * @param color WHITE or BLACK
+ * @param square Square index
+ * @return Set of the squares on the ranks ahead
+ */
+constexpr Bitboard ForwardRanksBB(int color, int square)
+{
+    return color == WHITE ? ~Bitboard(0) << 8 << (square & 56) : ~Bitboard(0) >> 8 >> (56 - (square & 56));
+}
+
+// Directions as square offsets, for Shift()
+const int NORTH = 8;
+const int SOUTH = -8;
+const int NORTH_EAST = 9;
+const int NORTH_WEST = 7;
+const int SOUTH_EAST = -7;
+const int SOUTH_WEST = -9;
+
+/**
+ * Move every square of a set one step in a direction. Squares
+ * that would wrap around to the other side of the board are lost.
+ * @param bitboard Set of squares
+ * @return Shifted set
+ */
+template<int Direction>
+constexpr Bitboard Shift(Bitboard bitboard)
+{
+    if constexpr (Direction == NORTH) return bitboard << 8;
+    if constexpr (Direction == SOUTH) return bitboard >> 8;
+    if constexpr (Direction == NORTH_EAST) return (bitboard & ~FileBB(7)) << 9;
+    if constexpr (Direction == NORTH_WEST) return (bitboard & ~FileBB(0)) << 7;
+    if constexpr (Direction == SOUTH_EAST) return (bitboard & ~FileBB(7)) >> 7;
+    if constexpr (Direction == SOUTH_WEST) return (bitboard & ~FileBB(0)) >> 9;
+    return 0;
+}
+
+/**
+ * Is a square in a set?
+ * @param bitboard Set of squares
+ * @param square Square index
+ * @return True if the square is in the set
+ */
+constexpr bool Contains(Bitboard bitboard, int square) { return (bitboard & SquareBB(square)) != 0; }
+
+/**
+ * Number of squares in a set
+ * @param bitboard Set of squares
+ * @return Count
+ */
+constexpr int PopCount(Bitboard bitboard) { return std::popcount(bitboard); }
+
+/**
+ * Lowest square in a set
+ * @param bitboard Non-empty set of squares
+ * @return Square index
+ */
+constexpr int Lsb(Bitboard bitboard) { return std::countr_zero(bitboard); }
+
+/**
+ * Highest square in a set
+ * @param bitboard Non-empty set of squares
+ * @return Square index
+ */
+constexpr int Msb(Bitboard bitboard) { return 63 - std::countl_zero(bitboard); }
+
+/**
+ * Remove the lowest square from a set
+ * @param bitboard Non-empty set of squares, updated
+ * @return The square that was removed
+ */
+constexpr int PopLsb(Bitboard &bitboard)
+{
+    int square = Lsb(bitboard);
+    bitboard &= bitboard - 1;
+    return square;
+}
+
+/**
+ * Squares reached by single steps from a square
+ * @param square Starting square
+ * @param steps File and rank steps
+ * @return Set of squares on the board
+ */
+template<size_t N>
+constexpr Bitboard StepAttacks(int square, const int (&steps)[N][2])
+{
+    Bitboard attacks = 0;
+    for (auto const &step : steps)
+    {
+        int file = FileOf(square) + step[0];
+        int rank = RankOf(square) + step[1];
+        if (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+        {
+            attacks |= SquareBB(MakeSquare(file, rank));
+        }
+    }
+    return attacks;
+}
+
+/**
+ * Squares reached by sliding from a square until the edge or a
+ * piece, including the square of the piece
+ * @param square Starting square
+ * @param occupied Occupied squares
+ * @param directions File and rank steps to slide in
+ * @return Set of squares
+ */
+constexpr Bitboard SlidingAttacks(int square, Bitboard occupied, const int (&directions)[4][2])
+{
+    Bitboard attacks = 0;
+    for (auto const &direction : directions)
+    {
+        int file = FileOf(square) + direction[0];
+        int rank = RankOf(square) + direction[1];
+        for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += direction[0], rank += direction[1])
+        {
+            attacks |= SquareBB(MakeSquare(file, rank));
+            if (Contains(occupied, MakeSquare(file, rank)))
+            {
+                break;
+            }
+        }
+    }
+    return attacks;
+}
+
+/// File and rank steps of a knight
+constexpr int KnightSteps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+
+/// File and rank steps of a king
+constexpr int KingSteps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+/// File and rank steps of pawn captures, indexed by ColorIndex()
+constexpr int PawnSteps[2][2][2] = {{{-1, 1}, {1, 1}}, {{-1, -1}, {1, -1}}};
+
+/// Directions a bishop slides in
+constexpr int BishopDirections[4][2] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+
+/// Directions a rook slides in
+constexpr int RookDirections[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+/**
+ * Build a table of step attacks for every square
+ * @param steps File and rank steps
+ * @return Attacks indexed by square
+ */
+template<size_t N>
+constexpr std::array<Bitboard, SQUARE_NB> MakeStepTable(const int (&steps)[N][2])
+{
+    std::array<Bitboard, SQUARE_NB> table{};
+    for (int square = 0; square < SQUARE_NB; square++)
+    {
+        table[square] = StepAttacks(square, steps);
+    }
+    return table;
+}
+
+/// Knight attacks from each square
+inline constexpr std::array<Bitboard, SQUARE_NB> KnightAttacks = MakeStepTable(KnightSteps);
+
+/// King attacks from each square
+inline constexpr std::array<Bitboard, SQUARE_NB> KingAttacks = MakeStepTable(KingSteps);
+
+/**
+ * Build a table of slider attacks on an empty board for every square
+ * @param directions File and rank steps to slide in
+ * @return Attacks indexed by square
+ */
+constexpr std::array<Bitboard, SQUARE_NB> MakeRayTable(const int (&directions)[4][2])
+{
+    std::array<Bitboard, SQUARE_NB> table{};
+    for (int square = 0; square < SQUARE_NB; square++)
+    {
+        table[square] = SlidingAttacks(square, 0, directions);
+    }
+    return table;
+}
+
+/// Bishop attacks from each square on an empty board
+inline constexpr std::array<Bitboard, SQUARE_NB> BishopRays = MakeRayTable(BishopDirections);
+
+/// Rook attacks from each square on an empty board
+inline constexpr std::array<Bitboard, SQUARE_NB> RookRays = MakeRayTable(RookDirections);
+
+/// Pawn captures from each square, indexed by ColorIndex() then square
+inline constexpr std::array<Bitboard, SQUARE_NB> PawnAttacks[2] = {
+    MakeStepTable(PawnSteps[0]), MakeStepTable(PawnSteps[1])};
+
+/// File and rank steps of the eight ray directions. The first four
+/// go up the square numbers, the last four down.
+constexpr int RayDirections[8][2] = {{0, 1}, {1, 1}, {1, 0}, {-1, 1}, {0, -1}, {-1, -1}, {-1, 0}, {1, -1}};
+
+/**
+ * Build a table of the squares along one ray from every square
+ * @param direction Index into RayDirections
+ * @return Rays indexed by square
+ */
+constexpr std::array<Bitboard, SQUARE_NB> MakeSingleRayTable(int direction)
+{
+    int fileStep = RayDirections[direction][0];
+    int rankStep = RayDirections[direction][1];
+    std::array<Bitboard, SQUARE_NB> table{};
+    for (int square = 0; square < SQUARE_NB; square++)
+    {
+        int file = FileOf(square) + fileStep;
+        int rank = RankOf(square) + rankStep;
+        for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += fileStep, rank += rankStep)
+        {
+            table[square] |= SquareBB(MakeSquare(file, rank));
+        }
+    }
+    return table;
+}
+
+/// Squares along each ray direction from each square on an empty board
+inline constexpr std::array<Bitboard, SQUARE_NB> Rays[8] = {
+    MakeSingleRayTable(0), MakeSingleRayTable(1), MakeSingleRayTable(2), MakeSingleRayTable(3),
+    MakeSingleRayTable(4), MakeSingleRayTable(5), MakeSingleRayTable(6), MakeSingleRayTable(7)};
+
+/**
+ * Squares along one ray up to and including the first piece
+ * @param square Starting square
+ * @param occupied Occupied squares
+ * @return Attacked squares
+ */
+template<int Direction>
+inline Bitboard RayAttacks(int square, Bitboard occupied)
+{
+    Bitboard attacks = Rays[Direction][square];
+    Bitboard blockers = attacks & occupied;
+    if (blockers)
+    {
+        // Everything beyond the nearest blocker is cut off
+        int blocker = Direction < 4 ? Lsb(blockers) : Msb(blockers);
+        attacks ^= Rays[Direction][blocker];
+    }
+    return attacks;
+}
+
+/**
+ * Bishop attacks given the occupied squares
+ * @param square Bishop square
+ * @param occupied Occupied squares
+ * @return Attacked squares
+ */
+inline Bitboard BishopAttacks(int square, Bitboard occupied)
+{
+    return RayAttacks<1>(square, occupied) | RayAttacks<3>(square, occupied)
+        | RayAttacks<5>(square, occupied) | RayAttacks<7>(square, occupied);
+}
+
+/**
+ * Rook attacks given the occupied squares
+ * @param square Rook square
+ * @param occupied Occupied squares
+ * @return Attacked squares
+ */
+inline Bitboard RookAttacks(int square, Bitboard occupied)
+{
+    return RayAttacks<0>(square, occupied) | RayAttacks<2>(square, occupied)
+        | RayAttacks<4>(square, occupied) | RayAttacks<6>(square, occupied);
+}
+
+/**
+ * Compute the squares strictly between two squares on a line
+ * @param from First square
+ * @param to Second square
+ * @return Squares between them, empty if they do not share a line
+ */
+constexpr Bitboard ComputeBetween(int from, int to)
+{
+    int fileStep = (FileOf(to) > FileOf(from)) - (FileOf(to) < FileOf(from));
+    int rankStep = (RankOf(to) > RankOf(from)) - (RankOf(to) < RankOf(from));
+    int files = FileOf(to) - FileOf(from);
+    int ranks = RankOf(to) - RankOf(from);
+    if (from == to || (files != 0 && ranks != 0 && files != ranks && files != -ranks))
+    {
+        return 0;
+    }
+
+    Bitboard between = 0;
+    for (int square = from + fileStep + rankStep * 8; square != to; square += fileStep + rankStep * 8)
+    {
+        between |= SquareBB(square);
+    }
+    return between;
+}
+
+/**
+ * Build the table of squares between every pair of squares
+ * @return Squares between, indexed by both squares
+ */
+constexpr std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> MakeBetweenTable()
+{
+    std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> table{};
+    for (int from = 0; from < SQUARE_NB; from++)
+    {
+        for (int to = 0; to < SQUARE_NB; to++)
+        {
+            table[from][to] = ComputeBetween(from, to);
+        }
+    }
+    return table;
+}
+
+/// Squares between every pair of squares
+inline constexpr std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> BetweenTable = MakeBetweenTable();
+
+/**
+ * Squares strictly between two squares on a line
+ * @param from First square
+ * @param to Second square
+ * @return Squares between them, empty if they do not share a line
+ */
+inline Bitboard BetweenBB(int from, int to) { return BetweenTable[from][to]; }
+
+/**
+ * Do three squares lie on one rank, file or diagonal?
+ * @param a First square
+ * @param b Second square
+ * @param c Third square
+ * @return True if one of them is between the other two
+ */
+inline bool Aligned(int a, int b, int c)
+{
+    return Contains(BetweenBB(a, c), b) || Contains(BetweenBB(a, b), c) || Contains(BetweenBB(b, c), a);
+}
+
+#endif //BITBOARD_H
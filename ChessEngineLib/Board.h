@@ -10,6 +10,7 @@
 
 #include "Square.h"
 #include "Item.h"
+#include "Position.h"
 
 class Board : public Item {
 private:
@@ -24,13 +25,13 @@ private:
  /// All pieces in the board
  std::vector<std::shared_ptr<Piece>> mPieces;
  /// All possible moves
- std::vector<std::wstring> mPossibleMoves;
+ MoveList mPossibleMoves;
  /// Whose turn is it?
  bool mWhiteTurn = true;
  /// King square for white
- std::wstring mWhiteKingSquare = L"e1";
+ int mWhiteKingSquare = MakeSquare(4, 0);
  /// King square for black
- std::wstring mBlackKingSquare = L"e8";
+ int mBlackKingSquare = MakeSquare(4, 7);
  /// Is black in check?
  bool mBlackInCheck = false;
  /// Is white in check?
@@ -39,8 +40,6 @@ private:
  bool mBlackCastlingRights = true;
  /// Does white have castling rights?
  bool mWhiteCastlingRights = true;
- /// The opposing color's responses
- std::vector <std::wstring> mResponses;
 
 public:
  /// Destructor
@@ -80,23 +79,18 @@ public:
   */
  std::vector<std::vector<int>> FenParser(std::wstring fenString);
  std::shared_ptr<Square> GetClosestSquare(wxPoint pos) override;
- void GeneratePossibleMoves(bool response);
- void GenerateSlidingMoves(int const &pieceNum, int const &file, int const &rank, std::wstring const &currentSquare, bool response);
- void GenerateDiagonalMoves(int const& pieceNum, int const& file, int const& rank, std::wstring const& currentSquare, bool response);
+ void GeneratePossibleMoves();
  void AddSquare(std::shared_ptr<Square> square) { mSquares.push_back(square); }
  std::vector<std::shared_ptr<Square>> GetSquares() { return mSquares; }
  void AddPiece(std::shared_ptr<Piece> piece) { mPieces.push_back(piece); }
  std::vector<std::shared_ptr<Piece>> GetPieces() { return mPieces; }
  std::shared_ptr<Piece> HitTest(wxPoint pos);
- void UpdateBoard(std::wstring const &move);
- bool CheckBounds(int file, int rank);
- void GenerateKingMoves(int const &pieceNum, int const &file, int const &rank, std::wstring const &currentSquare, bool response);
- void GeneratePawnMoves(int const& pieceNum, int const& file, int const& rank, std::wstring const& currentSquare, bool response);
- void GenerateKnightMoves(int const& pieceNum, int const& file, int const& rank, std::wstring const& currentSquare, bool response);
- void SetBlackKingSquare(std::wstring const &pos) { mBlackKingSquare = pos; }
- void SetWhiteKingSquare(std::wstring const &pos) { mWhiteKingSquare = pos; }
- std::vector<std::wstring> GetPossibleMoves() { return mPossibleMoves; }
+ void UpdateBoard(Move move);
+ const MoveList &GetPossibleMoves() const { return mPossibleMoves; }
+ Move FindMove(int from, int to) const;
  void displayWinner();
+ GameStatus GetGameStatus();
+ std::string GetFen();
 };
 
 
@@ -5,6 +5,7 @@
  
 #include "pch.h"
 #include "BoardFactory.h"
+#include "ChessTypes.h"
 
 #include "Board.h"
 #include "Item.h"
@@ -19,35 +20,6 @@ const int squareSize = 75;
 /// Directory within resources that contains the images.
 const std::wstring ImagesDirectory = L"/images";
 
-// Uncolored pieces
-const int EMPTY = 0;
-const int KING = 1;
-const int PAWN = 2;
-const int KNIGHT = 3;
-const int BISHOP = 4;
-const int ROOK = 5;
-const int QUEEN = 6;
-
-// Color values
-const int WHITE = 8;
-const int BLACK = 16;
-
-// White pieces (uppercase)
-const int WHITE_KING = WHITE + KING;
-const int WHITE_PAWN = WHITE + PAWN;
-const int WHITE_KNIGHT = WHITE + KNIGHT;
-const int WHITE_BISHOP = WHITE + BISHOP;
-const int WHITE_ROOK = WHITE + ROOK;
-const int WHITE_QUEEN = WHITE + QUEEN;
-
-// Black pieces (lowercase)
-const int BLACK_KING = BLACK + KING;
-const int BLACK_PAWN = BLACK + PAWN;
-const int BLACK_KNIGHT = BLACK + KNIGHT;
-const int BLACK_BISHOP = BLACK + BISHOP;
-const int BLACK_ROOK = BLACK + ROOK;
-const int BLACK_QUEEN = BLACK + QUEEN;
-
 std::shared_ptr<Board> BoardFactory::Create(std::wstring resourcesDir)
 {
     auto imagesDir = resourcesDir + ImagesDirectory;
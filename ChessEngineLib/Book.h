@@ -0,0 +1,92 @@
+/**
+ * @file Book.h
+ * @author John Korreck
+ *
+ * Polyglot opening book.
+ */
+
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Move.h"
+
+class Position;
+
+/// Size of a Polyglot book entry in bytes
+const int BookEntrySize = 16;
+
+/// Polyglot random keys: 768 for pieces on squares, 4 for castling
+/// rights, 8 for en passant files and 1 for white to move
+const int PolyglotRandomCount = 781;
+
+/**
+ * A book entry as stored in the file
+ */
+struct BookEntry {
+    /// Polyglot key of the position
+    uint64_t mKey = 0;
+
+    /// Move in Polyglot encoding
+    uint16_t mMove = 0;
+
+    /// How often the move should be chosen relative to the others
+    uint16_t mWeight = 0;
+
+    /// Learning data, unused
+    uint32_t mLearn = 0;
+};
+
+/**
+ * An opening book in the Polyglot .bin format.
+ *
+ * The file is a sequence of 16 byte big endian entries sorted by
+ * the Polyglot key of their position. It is mapped into memory and
+ * the entries of a position are found by binary search, so opening
+ * even a large book costs nothing and a probe touches a few pages.
+ *
+ * The keys hash positions with the fixed Random64 table of the
+ * Polyglot format, so books written by other tools can be read.
+ */
+class Book {
+private:
+    /// The mapped book file
+    MappedFile mFile;
+
+    /// Picks between the moves of a position
+    std::mt19937_64 mRandom;
+
+    BookEntry EntryAt(size_t index) const;
+
+public:
+    Book();
+
+    /// Copy constructor (disabled)
+    Book(const Book &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const Book &) = delete;
+
+    bool Open(const std::string &path);
+    void Close();
+
+    /// Is a book open?
+    bool IsOpen() const { return mFile.IsOpen(); }
+
+    /// Number of entries in the book
+    size_t Size() const { return mFile.Size() / BookEntrySize; }
+
+    std::vector<BookEntry> Find(uint64_t key) const;
+    Move Probe(const Position &position);
+
+    static uint64_t Key(const Position &position);
+    static Move DecodeMove(const Position &position, uint16_t move);
+    static uint16_t EncodeMove(Move move);
+};
+
+#endif //BOOK_H
@@ -0,0 +1,439 @@
+/**
+ * @file BookBuilder.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "BookBuilder.h"
+#include "Book.h"
+#include "Position.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <queue>
+
+/// Size of a record in a run file
+const size_t RecordSize = 18;
+
+/// Records converted at a time when writing a run
+const size_t RecordsPerWrite = 4096;
+
+/**
+ * Write a big endian value
+ * @param bytes The first byte
+ * @param value The value
+ * @param count Number of bytes
+ */
+static void StoreBig(unsigned char *bytes, uint64_t value, int count)
+{
+    for (int i = count - 1; i >= 0; i--)
+    {
+        bytes[i] = (unsigned char)value;
+        value >>= 8;
+    }
+}
+
+/**
+ * Read a big endian value
+ * @param bytes The first byte
+ * @param count Number of bytes
+ * @return The value
+ */
+static uint64_t LoadBig(const unsigned char *bytes, int count)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < count; i++)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+/**
+ * Write the record as it is stored in a run file, field by
+ * field so the padding of the structure is never written
+ * @param bytes RecordSize bytes to write to
+ */
+void BookBuilder::Record::Store(unsigned char *bytes) const
+{
+    StoreBig(bytes, mKey, 8);
+    StoreBig(bytes + 8, mPoints, 4);
+    StoreBig(bytes + 12, mGames, 4);
+    StoreBig(bytes + 16, mMove, 2);
+}
+
+/**
+ * Read the record from a run file
+ * @param bytes RecordSize bytes written by Store
+ */
+void BookBuilder::Record::Load(const unsigned char *bytes)
+{
+    mKey = LoadBig(bytes, 8);
+    mPoints = uint32_t(LoadBig(bytes + 8, 4));
+    mGames = uint32_t(LoadBig(bytes + 12, 4));
+    mMove = uint16_t(LoadBig(bytes + 16, 2));
+}
+
+/**
+ * Reads the records of one sorted run in order
+ */
+class BookBuilder::RunSource {
+private:
+    /// Run file, or not open for a run held in memory
+    std::ifstream mFile;
+
+    /// Bytes read from the file
+    std::vector<unsigned char> mBuffer;
+
+    /// The run held in memory, or nullptr for a run file
+    const std::vector<Record> *mRecords = nullptr;
+
+    /// Next byte in the buffer, or next record in memory
+    size_t mNext = 0;
+
+    /// End of the bytes in the buffer, or of the records in memory
+    size_t mEnd = 0;
+
+public:
+    /**
+     * Read a run from a file
+     * @param path The file
+     * @param chunk Records to read at a time
+     */
+    RunSource(const std::string &path, size_t chunk) : mFile(path, std::ios::binary), mBuffer(chunk * RecordSize)
+    {
+    }
+
+    /**
+     * Read a run held in memory
+     * @param records The records, sorted and combined
+     */
+    RunSource(const std::vector<Record> &records) : mRecords(&records), mEnd(records.size()) {}
+
+    /// Could the run not be read?
+    bool Failed() const { return mRecords == nullptr && (!mFile.is_open() || mFile.bad()); }
+
+    /**
+     * Get the next record
+     * @param record Receives the record
+     * @return False at the end of the run
+     */
+    bool Next(Record &record)
+    {
+        if (mRecords != nullptr)
+        {
+            if (mNext == mEnd)
+            {
+                return false;
+            }
+            record = (*mRecords)[mNext++];
+            return true;
+        }
+
+        if (mNext == mEnd)
+        {
+            mFile.read(reinterpret_cast<char *>(mBuffer.data()), std::streamsize(mBuffer.size()));
+            mNext = 0;
+            mEnd = size_t(mFile.gcount()) / RecordSize * RecordSize;
+            if (mEnd == 0)
+            {
+                return false;
+            }
+        }
+        record.Load(mBuffer.data() + mNext);
+        mNext += RecordSize;
+        return true;
+    }
+};
+
+/**
+ * Build a book
+ * @param pgnFiles Games to build it from
+ * @param output Book file to write
+ * @return False if a file could not be read or written
+ */
+bool BookBuilder::Build(const std::vector<std::string> &pgnFiles, const std::string &output)
+{
+    mStats = Stats();
+    mRuns.clear();
+    mFailed = false;
+
+    // The parser calls back on at most this many threads at once,
+    // so there is always a free buffer
+    int threads = std::max(1, mOptions.mThreads);
+    mCapacity = std::max<size_t>(1024, mOptions.mMemory * 1024 * 1024 / sizeof(Record) / threads);
+    mBuffers.assign(threads, {});
+    mFree.clear();
+    for (auto &buffer : mBuffers)
+    {
+        buffer.reserve(mCapacity);
+        mFree.push_back(&buffer);
+    }
+
+    bool readAll = true;
+    PgnParser parser(threads);
+    for (auto const &path : pgnFiles)
+    {
+        if (!parser.Parse(path, [this](ParsedGame &game) { AddGame(game); }))
+        {
+            readAll = false;
+        }
+        mStats.mGames += parser.GetStats().mGames;
+        mStats.mBadGames += parser.GetStats().mBadGames;
+    }
+
+    bool written = !mFailed && Merge(output);
+    for (auto const &run : mRuns)
+    {
+        std::filesystem::remove(run);
+    }
+    mRuns.clear();
+    mBuffers.clear();
+    mFree.clear();
+    return readAll && written;
+}
+
+/**
+ * Record the positions and moves of a game, in a buffer
+ * no other parser thread is using
+ * @param game The game, with its moves decoded
+ */
+void BookBuilder::AddGame(const ParsedGame &game)
+{
+    // Points for a win, indexed by ColorIndex() of the mover
+    uint32_t points[2];
+    if (game.mGame.mResult == "1-0")
+    {
+        points[0] = 2;
+        points[1] = 0;
+    }
+    else if (game.mGame.mResult == "0-1")
+    {
+        points[0] = 0;
+        points[1] = 2;
+    }
+    else if (game.mGame.mResult == "1/2-1/2")
+    {
+        points[0] = points[1] = 1;
+    }
+    else
+    {
+        return;
+    }
+
+    std::vector<Record> *records;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        records = mFree.back();
+        mFree.pop_back();
+    }
+
+    Position position;
+    position.SetFen(game.mStartFen);
+    size_t plies = std::min(game.mMoves.size(), size_t(std::max(0, mOptions.mMaxPly)));
+    for (size_t ply = 0; ply < plies; ply++)
+    {
+        Move move = game.mMoves[ply];
+        records->push_back({Book::Key(position), points[ColorIndex(position.SideToMove())], 1, Book::EncodeMove(move)});
+        position.DoMove(move);
+    }
+
+    if (records->size() + MAX_PLY > mCapacity)
+    {
+        // Opening positions repeat a lot, so combining
+        // often frees most of the room without any disk
+        Combine(*records);
+        if (records->size() > mCapacity / 4 * 3)
+        {
+            WriteRun(*records);
+            records->clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.mRecords += plies;
+    mFree.push_back(records);
+}
+
+/**
+ * Sort records and add up those of the same position and move
+ * @param records The records
+ */
+void BookBuilder::Combine(std::vector<Record> &records)
+{
+    std::sort(records.begin(), records.end());
+    size_t kept = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (kept > 0 && records[kept - 1].mKey == records[i].mKey && records[kept - 1].mMove == records[i].mMove)
+        {
+            records[kept - 1].mPoints += records[i].mPoints;
+            records[kept - 1].mGames += records[i].mGames;
+        }
+        else
+        {
+            records[kept++] = records[i];
+        }
+    }
+    records.resize(kept);
+}
+
+/**
+ * Write sorted records to a new run file. If the file cannot be
+ * written the build fails.
+ * @param records The records, sorted and combined
+ */
+void BookBuilder::WriteRun(const std::vector<Record> &records)
+{
+    std::filesystem::path directory = mOptions.mTempDirectory.empty()
+        ? std::filesystem::temp_directory_path() : std::filesystem::path(mOptions.mTempDirectory);
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        path = (directory / ("book-run-" + std::to_string(uintptr_t(this)) + "-"
+                             + std::to_string(mRuns.size()) + ".tmp")).string();
+        mRuns.push_back(path);
+        mStats.mRuns++;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    std::vector<unsigned char> bytes(RecordsPerWrite * RecordSize);
+    for (size_t first = 0; file && first < records.size(); first += RecordsPerWrite)
+    {
+        size_t count = std::min(RecordsPerWrite, records.size() - first);
+        for (size_t i = 0; i < count; i++)
+        {
+            records[first + i].Store(bytes.data() + i * RecordSize);
+        }
+        file.write(reinterpret_cast<const char *>(bytes.data()), std::streamsize(count * RecordSize));
+    }
+    file.close();
+    if (!file)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFailed = true;
+    }
+}
+
+/**
+ * Merge the buffers and runs and write the book. Each position
+ * keeps the moves played often enough that scored any points,
+ * weighted by the points and scaled to fit the 16 bit weights.
+ * @param output Book file to write
+ * @return False if a run could not be read or the book written
+ */
+bool BookBuilder::Merge(const std::string &output)
+{
+    for (auto &records : mBuffers)
+    {
+        Combine(records);
+    }
+    if (!mRuns.empty())
+    {
+        // Reading the runs takes the whole budget, so the
+        // records still in memory go to runs of their own
+        for (auto &records : mBuffers)
+        {
+            if (!records.empty())
+            {
+                WriteRun(records);
+            }
+            std::vector<Record>().swap(records);
+        }
+        if (mFailed)
+        {
+            return false;
+        }
+    }
+
+    std::ofstream file(output, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    // Share the memory budget between the runs being read
+    size_t runs = std::max<size_t>(1, mRuns.size());
+    size_t chunk = std::max<size_t>(1024, mOptions.mMemory * 1024 * 1024 / RecordSize / runs);
+    std::vector<RunSource> sources;
+    sources.reserve(mBuffers.size() + mRuns.size());
+    for (auto const &records : mBuffers)
+    {
+        sources.emplace_back(records);
+    }
+    for (auto const &run : mRuns)
+    {
+        sources.emplace_back(run, chunk);
+    }
+
+    // Smallest record on top, with the source it came from
+    auto greater = [](const std::pair<Record, size_t> &a, const std::pair<Record, size_t> &b) {
+        return b.first < a.first;
+    };
+    std::priority_queue<std::pair<Record, size_t>, std::vector<std::pair<Record, size_t>>, decltype(greater)>
+        heap(greater);
+    auto advance = [&](size_t source) {
+        Record record;
+        if (sources[source].Next(record))
+        {
+            heap.emplace(record, source);
+        }
+    };
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        advance(i);
+    }
+
+    auto put = [&file](uint64_t value, int bytes) {
+        for (int b = bytes - 1; b >= 0; b--)
+        {
+            file.put(char(value >> (8 * b)));
+        }
+    };
+    std::vector<Record> moves;
+    auto flush = [&]() {
+        std::erase_if(moves, [this](const Record &move) {
+            return move.mGames < uint32_t(mOptions.mMinGames) || move.mPoints == 0;
+        });
+        std::sort(moves.begin(), moves.end(), [](const Record &a, const Record &b) { return a.mPoints > b.mPoints; });
+        uint64_t most = moves.empty() ? 0 : moves.front().mPoints;
+        for (const Record &move : moves)
+        {
+            uint64_t weight = most > 0xFFFF ? std::max<uint64_t>(1, move.mPoints * 0xFFFF / most) : move.mPoints;
+            put(move.mKey, 8);
+            put(move.mMove, 2);
+            put(weight, 2);
+            put(0, 4);
+            mStats.mEntries++;
+        }
+        moves.clear();
+    };
+
+    while (!heap.empty())
+    {
+        auto [record, source] = heap.top();
+        heap.pop();
+        advance(source);
+
+        if (!moves.empty() && moves.back().mKey != record.mKey)
+        {
+            flush();
+        }
+        if (!moves.empty() && moves.back().mMove == record.mMove)
+        {
+            moves.back().mPoints += record.mPoints;
+            moves.back().mGames += record.mGames;
+        }
+        else
+        {
+            moves.push_back(record);
+        }
+    }
+    flush();
+    file.close();
+    return bool(file) && std::none_of(sources.begin(), sources.end(), [](const RunSource &source) {
+        return source.Failed();
+    });
+}
@@ -0,0 +1,149 @@
+/**
+ * @file BookBuilder.h
+ * @author John Korreck
+ *
+ * Builds Polyglot opening books from PGN games.
+ */
+
+#ifndef BOOKBUILDER_H
+#define BOOKBUILDER_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Pgn.h"
+
+/**
+ * Settings for building a book
+ */
+struct BookBuilderOptions {
+    /// Only moves played in the first this many plies are kept
+    int mMaxPly = 24;
+
+    /// A move must be played in at least this many games to be kept
+    int mMinGames = 3;
+
+    /// Memory for move statistics in megabytes, beyond this they are sorted to disk
+    size_t mMemory = 256;
+
+    /// Worker threads replaying games
+    int mThreads = 1;
+
+    /// Directory for the sorted runs, the system temporary directory if empty
+    std::string mTempDirectory;
+};
+
+/**
+ * Turns PGN files into a Polyglot book.
+ *
+ * The games are read and decoded by a PgnParser, whose worker threads
+ * record every position and move with the points the mover scored (2
+ * for a win, 1 for a draw). Records are collected in one buffer per
+ * thread, each a fixed share of the memory budget. When a buffer is
+ * full the records are sorted and combined, and if that does not free
+ * enough room they are written to a sorted run on disk. At the end the
+ * runs are merged, so the memory used does not depend on the number
+ * of games.
+ */
+class BookBuilder {
+public:
+    /**
+     * Statistics of a build
+     */
+    struct Stats {
+        /// Games read
+        uint64_t mGames = 0;
+
+        /// Games with a move that could not be read, kept up to that move
+        uint64_t mBadGames = 0;
+
+        /// Position and move pairs recorded
+        uint64_t mRecords = 0;
+
+        /// Sorted runs written to disk
+        uint64_t mRuns = 0;
+
+        /// Entries in the book
+        uint64_t mEntries = 0;
+    };
+
+private:
+    /**
+     * A position and move with the statistics gathered for it
+     */
+    struct Record {
+        /// Polyglot key of the position
+        uint64_t mKey;
+
+        /// Points scored by the side playing the move, 2 per win
+        uint32_t mPoints;
+
+        /// Games the move was played in
+        uint32_t mGames;
+
+        /// Polyglot move
+        uint16_t mMove;
+
+        void Store(unsigned char *bytes) const;
+        void Load(const unsigned char *bytes);
+
+        /// Order by position, then move
+        bool operator<(const Record &other) const
+        {
+            return mKey != other.mKey ? mKey < other.mKey : mMove < other.mMove;
+        }
+    };
+
+    class RunSource;
+
+    /// Settings for the build
+    BookBuilderOptions mOptions;
+
+    /// Statistics of the build
+    Stats mStats;
+
+    /// Record buffers, one for each parser thread
+    std::vector<std::vector<Record>> mBuffers;
+
+    /// Buffers not in use by a parser thread
+    std::vector<std::vector<Record> *> mFree;
+
+    /// Records a buffer holds before it is combined
+    size_t mCapacity = 0;
+
+    /// Could a run not be written?
+    bool mFailed = false;
+
+    /// Protects the free buffers, the runs and the statistics
+    std::mutex mMutex;
+
+    /// Files holding the sorted runs
+    std::vector<std::string> mRuns;
+
+    void AddGame(const ParsedGame &game);
+    static void Combine(std::vector<Record> &records);
+    void WriteRun(const std::vector<Record> &records);
+    bool Merge(const std::string &output);
+
+public:
+    /**
+     * Constructor
+     * @param options Settings for the build
+     */
+    BookBuilder(const BookBuilderOptions &options) : mOptions(options) {}
+
+    /// Copy constructor (disabled)
+    BookBuilder(const BookBuilder &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const BookBuilder &) = delete;
+
+    bool Build(const std::vector<std::string> &pgnFiles, const std::string &output);
+
+    /// Statistics of the last build
+    const Stats &GetStats() const { return mStats; }
+};
+
+#endif //BOOKBUILDER_H
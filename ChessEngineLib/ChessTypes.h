@@ -0,0 +1,147 @@
+/**
+ * @file ChessTypes.h
+ * @author John Korreck
+ *
+ * Piece codes, squares and score constants shared by the
+ * GUI board and the search engine.
+ */
+
+#ifndef CHESSTYPES_H
+#define CHESSTYPES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+// Binary representations for pieces
+
+// Uncolored pieces
+const int EMPTY = 0;
+const int KING = 1;
+const int PAWN = 2;
+const int KNIGHT = 3;
+const int BISHOP = 4;
+const int ROOK = 5;
+const int QUEEN = 6;
+
+// Color values
+const int WHITE = 8;
+const int BLACK = 16;
+
+// White pieces (uppercase)
+const int WHITE_KING = WHITE + KING;
+const int WHITE_PAWN = WHITE + PAWN;
+const int WHITE_KNIGHT = WHITE + KNIGHT;
+const int WHITE_BISHOP = WHITE + BISHOP;
+const int WHITE_ROOK = WHITE + ROOK;
+const int WHITE_QUEEN = WHITE + QUEEN;
+
+// Black pieces (lowercase)
+const int BLACK_KING = BLACK + KING;
+const int BLACK_PAWN = BLACK + PAWN;
+const int BLACK_KNIGHT = BLACK + KNIGHT;
+const int BLACK_BISHOP = BLACK + BISHOP;
+const int BLACK_ROOK = BLACK + ROOK;
+const int BLACK_QUEEN = BLACK + QUEEN;
+
+/// Size of arrays indexed by piece code (largest code is BLACK_QUEEN)
+const int PIECE_CODE_NB = BLACK_QUEEN + 1;
+
+/// Squares are numbered a1 = 0, b1 = 1, ... h8 = 63
+const int SQUARE_NB = 64;
+
+/// Marker for "no square", used for an absent en passant square
+const int NO_SQUARE = 64;
+
+// Castling right flags
+const int WHITE_OO = 1;
+const int WHITE_OOO = 2;
+const int BLACK_OO = 4;
+const int BLACK_OOO = 8;
+const int ALL_CASTLING = WHITE_OO | WHITE_OOO | BLACK_OO | BLACK_OOO;
+
+/// Deepest ply the search will ever reach
+const int MAX_PLY = 128;
+
+// Scores are in centipawns from the side to move's point of view
+const int VALUE_ZERO = 0;
+const int VALUE_DRAW = 0;
+const int VALUE_KNOWN_WIN = 10000;
+const int VALUE_MATE = 32000;
+const int VALUE_INFINITE = 32001;
+const int VALUE_NONE = 32002;
+const int VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_PLY;
+
+// Tablebase wins score just below the mates, less the further away they are found
+const int VALUE_TB_WIN = VALUE_MATE_IN_MAX_PLY - 1;
+const int VALUE_TB_WIN_IN_MAX_PLY = VALUE_TB_WIN - MAX_PLY;
+
+/**
+ * Get the uncolored type of a piece code
+ * @param piece Piece code such as WHITE_ROOK
+ * @return Piece type such as ROOK
+ */
+constexpr int TypeOf(int piece) { return piece & 7; }
+
+/**
+ * Get the color of a piece code
+ * @param piece Piece code such as WHITE_ROOK
+ * @return WHITE or BLACK
+ */
+constexpr int ColorOf(int piece) { return piece & (WHITE | BLACK); }
+
+/**
+ * Get the other color
+ * @param color WHITE or BLACK
+ * @return BLACK or WHITE
+ */
+constexpr int Opponent(int color) { return color ^ (WHITE | BLACK); }
+
+/**
+ * Get an array index for a color
+ * @param color WHITE or BLACK
+ * @return 0 for white, 1 for black
+ */
+constexpr int ColorIndex(int color) { return color >> 4; }
+
+constexpr int MakeSquare(int file, int rank) { return rank * 8 + file; }
+constexpr int FileOf(int square) { return square & 7; }
+constexpr int RankOf(int square) { return square >> 3; }
+
+/**
+ * King steps between two squares
+ * @param a First square
+ * @param b Second square
+ * @return Distance 0 to 7
+ */
+constexpr int Distance(int a, int b)
+{
+    return std::max(std::abs(FileOf(a) - FileOf(b)), std::abs(RankOf(a) - RankOf(b)));
+}
+
+/**
+ * Mate score for the side delivering mate in ply half moves
+ * @param ply Distance from the root
+ * @return Mate score
+ */
+constexpr int MateIn(int ply) { return VALUE_MATE - ply; }
+
+/**
+ * Mate score for the side getting mated in ply half moves
+ * @param ply Distance from the root
+ * @return Mated score
+ */
+constexpr int MatedIn(int ply) { return -VALUE_MATE + ply; }
+
+/**
+ * Get the algebraic name of a square
+ * @param square Square index
+ * @return Name such as "e4"
+ */
+inline std::string SquareName(int square)
+{
+    return {char('a' + FileOf(square)), char('1' + RankOf(square))};
+}
+
+#endif //CHESSTYPES_H
@@ -0,0 +1,115 @@
+/**
+ * @file Endgame.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Endgame.h"
+#include "Bitbase.h"
+#include "Evaluation.h"
+#include "Position.h"
+
+/**
+ * How far a square is from the four centre squares
+ * @param square Square index
+ * @return 0 in the centre to 6 in a corner
+ */
+static int CenterDistance(int square)
+{
+    return std::max(3 - FileOf(square), FileOf(square) - 4) + std::max(3 - RankOf(square), RankOf(square) - 4);
+}
+
+/**
+ * Material of one side in centipawns, king excluded
+ * @param position Position to count in
+ * @param color Color to count
+ * @return Material value
+ */
+static int Material(const Position &position, int color)
+{
+    int material = 0;
+    for (int type = PAWN; type <= QUEEN; type++)
+    {
+        material += position.PieceCount(color + type) * PieceValue[type];
+    }
+    return material;
+}
+
+/**
+ * King and mating material against a lone king. The lone king
+ * is driven to the edge and the strong king brought close.
+ * @param position Position to evaluate
+ * @param strong Color with the material
+ * @return Score from the strong side's point of view
+ */
+int EvaluateKXK(const Position &position, int strong)
+{
+    int strongKing = position.KingSquare(strong);
+    int weakKing = position.KingSquare(Opponent(strong));
+    return VALUE_KNOWN_WIN + Material(position, strong)
+        + 10 * CenterDistance(weakKing) + 10 * (7 - Distance(strongKing, weakKing));
+}
+
+/**
+ * King, bishop and knight against a lone king. Mate is only
+ * possible in a corner of the bishop's color, so the lone king
+ * is driven towards one.
+ * @param position Position to evaluate
+ * @param strong Color with the bishop and knight
+ * @return Score from the strong side's point of view
+ */
+int EvaluateKBNK(const Position &position, int strong)
+{
+    int strongKing = position.KingSquare(strong);
+    int weakKing = position.KingSquare(Opponent(strong));
+    int bishop = position.Squares(strong + BISHOP)[0];
+
+    // a1 is a dark square, so dark bishops mate on a1 or h8
+    bool dark = (FileOf(bishop) + RankOf(bishop)) % 2 == 0;
+    int corners[2] = {dark ? MakeSquare(0, 0) : MakeSquare(0, 7), dark ? MakeSquare(7, 7) : MakeSquare(7, 0)};
+    int cornerDistance = std::min(Distance(weakKing, corners[0]), Distance(weakKing, corners[1]));
+
+    return VALUE_KNOWN_WIN + Material(position, strong)
+        + 20 * (7 - cornerDistance) + 10 * (7 - Distance(strongKing, weakKing));
+}
+
+/**
+ * King and pawn against king, looked up in the bitbase. Drawn
+ * positions are scored as draws, won ones by how far the pawn is.
+ * @param position Position to evaluate
+ * @param strong Color with the pawn
+ * @return Score from the strong side's point of view
+ */
+int EvaluateKPK(const Position &position, int strong)
+{
+    // Seen from white, with the pawn on files a to d
+    int flip = (strong == WHITE ? 0 : 56) ^ (FileOf(position.Squares(strong + PAWN)[0]) > 3 ? 7 : 0);
+    int strongKing = position.KingSquare(strong) ^ flip;
+    int weakKing = position.KingSquare(Opponent(strong)) ^ flip;
+    int pawn = position.Squares(strong + PAWN)[0] ^ flip;
+
+    if (!ProbeKpk(strongKing, pawn, weakKing, position.SideToMove() == strong))
+    {
+        return VALUE_DRAW;
+    }
+    return VALUE_KNOWN_WIN + PieceValue[PAWN] + 10 * RankOf(pawn);
+}
+
+/**
+ * Bishops of opposite colors with only pawns besides are hard to
+ * win even a pawn or two up
+ * @param position Position to scale
+ * @param strong Color the evaluation favours
+ * @return Scale factor, SCALE_NONE if the bishops share a color
+ */
+int ScaleOppositeBishops(const Position &position, int strong)
+{
+    int ours = position.Squares(strong + BISHOP)[0];
+    int theirs = position.Squares(Opponent(strong) + BISHOP)[0];
+    if ((FileOf(ours) + RankOf(ours)) % 2 == (FileOf(theirs) + RankOf(theirs)) % 2)
+    {
+        return SCALE_NONE;
+    }
+    int extraPawns = position.PieceCount(strong + PAWN) - position.PieceCount(Opponent(strong) + PAWN);
+    return extraPawns <= 1 ? 16 : 32;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file Endgame.h
+ * @author John Korreck
+ *
+ * Special evaluation and scaling for endings the general
+ * evaluation gets wrong.
+ */
+
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+class Position;
+
+/// Scale factors applied to the evaluation, out of SCALE_NORMAL
+const int SCALE_DRAW = 0;
+const int SCALE_NORMAL = 64;
+
+/// Returned by a scale function that has no opinion on the position
+const int SCALE_NONE = -1;
+
+/**
+ * Evaluates a known ending in place of the normal evaluation
+ * @param position Position to evaluate
+ * @param strong Color of the side with the extra material
+ * @return Score from the strong side's point of view
+ */
+using EndgameFunction = int (*)(const Position &position, int strong);
+
+/**
+ * Scales the normal evaluation of a drawish ending
+ * @param position Position to evaluate
+ * @param strong Color of the side the evaluation favours
+ * @return Scale factor out of SCALE_NORMAL, or SCALE_NONE
+ */
+using ScaleFunction = int (*)(const Position &position, int strong);
+
+int EvaluateKXK(const Position &position, int strong);
+int EvaluateKBNK(const Position &position, int strong);
+int EvaluateKPK(const Position &position, int strong);
+int ScaleOppositeBishops(const Position &position, int strong);
+
+#endif //ENDGAME_H
@@ -0,0 +1,653 @@
+/**
+ * @file EndgameTable.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "EndgameTable.h"
+#include "Bitboard.h"
+#include "Position.h"
+#include "Search.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+/// First bytes of an endgame table file
+const char EndgameTableMagic[4] = {'E', 'G', 'T', '1'};
+
+/// Size of the file header: magic, positions, reserved and the name
+const size_t EndgameTableHeader = 32;
+
+/// Returned by IndexOf() and Encode() for positions without an index
+const uint64_t NO_INDEX = ~uint64_t(0);
+
+/// Piece letters by type
+const char PieceLetters[] = " KPNBRQ";
+
+/// Index of the king pair by whether there are pawns, then the white and black king squares, -1 for none
+static int KingPairIndex[2][SQUARE_NB][SQUARE_NB];
+
+/// White and black king squares of each king pair index
+static std::vector<std::pair<int, int>> KingPairs[2];
+
+/**
+ * How far a square is above the a1-h8 diagonal
+ * @param square The square
+ * @return Positive above, 0 on and negative below the diagonal
+ */
+static int OffDiagonal(int square)
+{
+    return RankOf(square) - FileOf(square);
+}
+
+/**
+ * Mirror a square in the a1-h8 diagonal
+ * @param square The square
+ * @return Square with the file and rank swapped
+ */
+static int FlipDiagonal(int square)
+{
+    return ((square >> 3) | (square << 3)) & 63;
+}
+
+/**
+ * Number the placements of the two kings, once. Without pawns the
+ * white king is in the a1-d1-d4 triangle and, if on the diagonal,
+ * the black king is not above it. With pawns the white king is on
+ * files a to d.
+ */
+static void InitKingPairs()
+{
+    for (int pawns = 0; pawns < 2; pawns++)
+    {
+        for (int white = 0; white < SQUARE_NB; white++)
+        {
+            for (int black = 0; black < SQUARE_NB; black++)
+            {
+                bool canonical = pawns ? FileOf(white) <= 3
+                    : FileOf(white) <= 3 && OffDiagonal(white) <= 0
+                        && (OffDiagonal(white) < 0 || OffDiagonal(black) <= 0);
+                if (canonical && white != black && !Contains(KingAttacks[white], black))
+                {
+                    KingPairIndex[pawns][white][black] = int(KingPairs[pawns].size());
+                    KingPairs[pawns].emplace_back(white, black);
+                }
+                else
+                {
+                    KingPairIndex[pawns][white][black] = -1;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Read a signature into the piece counts of its two sides
+ * @param name Signature such as KRPvKR
+ * @param counts Receives the counts of the side named first, then the other, by piece type
+ * @return False if it is not a signature
+ */
+static bool ParseSignature(const std::string &name, int counts[2][7])
+{
+    std::fill(&counts[0][0], &counts[0][0] + 14, 0);
+    int side = 0;
+    for (size_t i = 0; i < name.size(); i++)
+    {
+        const char *letter = name[i] != ' ' ? std::strchr(PieceLetters, name[i]) : nullptr;
+        if (name[i] == 'v' && side == 0)
+        {
+            side = 1;
+        }
+        else if (letter != nullptr && *letter != '\0' && (name[i] == 'K') == (i == 0 || name[i - 1] == 'v'))
+        {
+            counts[side][letter - PieceLetters]++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    int pieces = 0;
+    for (int s = 0; s < 2; s++)
+    {
+        for (int type = KING; type <= QUEEN; type++)
+        {
+            pieces += counts[s][type];
+        }
+    }
+    return side == 1 && counts[0][KING] == 1 && counts[1][KING] == 1 && pieces <= EGT_PIECES;
+}
+
+/**
+ * Write one side of a signature, strongest pieces first
+ * @param count Piece counts of the side by type
+ * @return Letters such as KRP
+ */
+static std::string SideName(const int count[7])
+{
+    std::string name = "K";
+    for (int type : {QUEEN, ROOK, BISHOP, KNIGHT, PAWN})
+    {
+        name.append(count[type], PieceLetters[type]);
+    }
+    return name;
+}
+
+/**
+ * Put a signature in the form tables are named by, the side with
+ * more material first
+ * @param name Signature such as KvKQ
+ * @return Normalized signature such as KQvK, empty if it is not one
+ */
+std::string EndgameTable::Normalize(const std::string &name)
+{
+    int counts[2][7];
+    if (!ParseSignature(name, counts))
+    {
+        return "";
+    }
+    const int strength[7] = {0, 0, 1, 3, 3, 5, 9};
+    int material[2] = {0, 0};
+    for (int s = 0; s < 2; s++)
+    {
+        for (int type = PAWN; type <= QUEEN; type++)
+        {
+            material[s] += strength[type] * counts[s][type];
+        }
+    }
+    std::string sides[2] = {SideName(counts[0]), SideName(counts[1])};
+    bool swap = material[1] > material[0] || (material[1] == material[0] && sides[1].size() > sides[0].size())
+        || (material[1] == material[0] && sides[1].size() == sides[0].size() && sides[1] < sides[0]);
+    return swap ? sides[1] + "v" + sides[0] : sides[0] + "v" + sides[1];
+}
+
+/**
+ * Material key of a set of pieces, as Position::MaterialKey()
+ * @param pieces Piece codes
+ * @param count Number of pieces
+ * @return The key
+ */
+uint64_t EndgameTable::MaterialKey(const int pieces[], int count)
+{
+    int seen[PIECE_CODE_NB] = {};
+    uint64_t key = 0;
+    for (int i = 0; i < count; i++)
+    {
+        key ^= Zobrist.mPieceSquare[pieces[i]][seen[pieces[i]]++];
+    }
+    return key;
+}
+
+/**
+ * Set up the index of a signature
+ * @param name Signature such as KRPvK, white first
+ * @return False if it is not a signature of at most EGT_PIECES pieces
+ */
+bool EndgameTable::SetName(const std::string &name)
+{
+    static std::once_flag kingPairs;
+    std::call_once(kingPairs, InitKingPairs);
+
+    int counts[2][7];
+    if (!ParseSignature(name, counts))
+    {
+        return false;
+    }
+
+    mName = SideName(counts[0]) + "v" + SideName(counts[1]);
+    mCount = 0;
+    mPieces[mCount++] = WHITE + KING;
+    mPieces[mCount++] = BLACK + KING;
+    for (int s = 0; s < 2; s++)
+    {
+        for (int type : {QUEEN, ROOK, BISHOP, KNIGHT, PAWN})
+        {
+            for (int i = 0; i < counts[s][type]; i++)
+            {
+                mPieces[mCount++] = (s == 0 ? WHITE : BLACK) + type;
+            }
+        }
+    }
+
+    int swapped[EGT_PIECES];
+    for (int i = 0; i < mCount; i++)
+    {
+        swapped[i] = mPieces[i] ^ (WHITE | BLACK);
+    }
+    mKey = MaterialKey(mPieces, mCount);
+    mKey2 = MaterialKey(swapped, mCount);
+    mHasPawns = counts[0][PAWN] + counts[1][PAWN] > 0;
+
+    mSidePositions = KingPairs[mHasPawns].size();
+    for (int slot = 2; slot < mCount; slot++)
+    {
+        mSidePositions *= TypeOf(mPieces[slot]) == PAWN ? 48 : 64;
+    }
+    mResults = nullptr;
+    mWdl = nullptr;
+    return true;
+}
+
+/**
+ * Allocate results to generate into, all EGT_DRAW
+ */
+void EndgameTable::Allocate()
+{
+    mFile.Close();
+    mOwned.assign(Size(), EGT_DRAW);
+    mResults = mOwned.data();
+    mWdl = nullptr;
+}
+
+/**
+ * Map a table file
+ * @param path The file
+ * @return False if it is not a complete table file
+ */
+bool EndgameTable::Open(const std::string &path)
+{
+    mOwned.clear();
+    mResults = nullptr;
+    mWdl = nullptr;
+    if (!mFile.Open(path))
+    {
+        return false;
+    }
+
+    const uint8_t *data = mFile.Data();
+    uint64_t positions = 0;
+    for (int b = 7; b >= 0 && mFile.Size() >= EndgameTableHeader; b--)
+    {
+        positions = positions << 8 | data[4 + b];
+    }
+    std::string name(reinterpret_cast<const char *>(data) + 16, 16);
+    name.resize(std::strlen(name.c_str()));
+    if (mFile.Size() < EndgameTableHeader || std::memcmp(data, EndgameTableMagic, 4) != 0 || !SetName(name)
+        || positions != Size() || mFile.Size() != EndgameTableHeader + (Size() + 3) / 4 + Size())
+    {
+        mFile.Close();
+        return false;
+    }
+    mWdl = data + EndgameTableHeader;
+    mResults = mWdl + (Size() + 3) / 4;
+    return true;
+}
+
+/**
+ * Write the table to a file
+ * @param path The file
+ * @return False if it could not be written
+ */
+bool EndgameTable::Write(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file || mResults == nullptr)
+    {
+        return false;
+    }
+
+    char header[EndgameTableHeader] = {};
+    std::memcpy(header, EndgameTableMagic, 4);
+    for (int b = 0; b < 8; b++)
+    {
+        header[4 + b] = char(Size() >> (8 * b));
+    }
+    std::memcpy(header + 16, mName.data(), std::min<size_t>(mName.size(), 15));
+    file.write(header, sizeof(header));
+
+    std::vector<uint8_t> wdl((Size() + 3) / 4, 0);
+    for (uint64_t i = 0; i < Size(); i++)
+    {
+        uint8_t result = mResults[i];
+        int bits = result == EGT_BROKEN ? 3 : result >= EGT_LOSS ? 2 : result >= EGT_WIN ? 1 : 0;
+        wdl[i / 4] |= uint8_t(bits << (2 * (i % 4)));
+    }
+    file.write(reinterpret_cast<const char *>(wdl.data()), std::streamsize(wdl.size()));
+    file.write(reinterpret_cast<const char *>(mResults), std::streamsize(Size()));
+    return bool(file);
+}
+
+/**
+ * Index of a position in canonical form
+ * @param squares Square of each slot, identical pieces get sorted
+ * @param stm 0 for white to move, 1 for black
+ * @return The index, NO_INDEX if the position has none
+ */
+uint64_t EndgameTable::IndexOf(int squares[], int stm) const
+{
+    for (int slot = 2; slot < mCount; slot++)
+    {
+        for (int other = slot; other > 2 && mPieces[other - 1] == mPieces[other] && squares[other - 1] > squares[other];
+             other--)
+        {
+            std::swap(squares[other - 1], squares[other]);
+        }
+    }
+
+    int kings = KingPairIndex[mHasPawns][squares[0]][squares[1]];
+    if (kings < 0)
+    {
+        return NO_INDEX;
+    }
+    uint64_t index = uint64_t(kings);
+    for (int slot = 2; slot < mCount; slot++)
+    {
+        if (TypeOf(mPieces[slot]) == PAWN)
+        {
+            if (RankOf(squares[slot]) == 0 || RankOf(squares[slot]) == 7)
+            {
+                return NO_INDEX;
+            }
+            index = index * 48 + uint64_t(squares[slot] - 8);
+        }
+        else
+        {
+            index = index * 64 + uint64_t(squares[slot]);
+        }
+    }
+    return uint64_t(stm) * mSidePositions + index;
+}
+
+/**
+ * Index of a position, the same for all positions the board's
+ * symmetry turns into each other
+ * @param squares Square of each slot
+ * @param stm 0 for white to move, 1 for black
+ * @return The index, NO_INDEX if the position has none
+ */
+uint64_t EndgameTable::Encode(const int squares[], int stm) const
+{
+    int board[EGT_PIECES];
+    std::copy(squares, squares + mCount, board);
+    auto transform = [this, &board](auto function) {
+        for (int i = 0; i < mCount; i++)
+        {
+            board[i] = function(board[i]);
+        }
+    };
+
+    if (FileOf(board[0]) > 3)
+    {
+        transform([](int square) { return square ^ 7; });
+    }
+    if (!mHasPawns)
+    {
+        if (RankOf(board[0]) > 3)
+        {
+            transform([](int square) { return square ^ 56; });
+        }
+        if (OffDiagonal(board[0]) > 0 || (OffDiagonal(board[0]) == 0 && OffDiagonal(board[1]) > 0))
+        {
+            transform(FlipDiagonal);
+        }
+        else if (OffDiagonal(board[0]) == 0 && OffDiagonal(board[1]) == 0)
+        {
+            // With both kings on the diagonal either side of it will do
+            int flipped[EGT_PIECES];
+            for (int i = 0; i < mCount; i++)
+            {
+                flipped[i] = FlipDiagonal(board[i]);
+            }
+            return std::min(IndexOf(board, stm), IndexOf(flipped, stm));
+        }
+    }
+    return IndexOf(board, stm);
+}
+
+/**
+ * Position at an index
+ * @param index Index below Size()
+ * @param squares Receives the square of each slot
+ * @param stm Receives 0 for white to move, 1 for black
+ */
+void EndgameTable::Decode(uint64_t index, int squares[], int &stm) const
+{
+    stm = index >= mSidePositions ? 1 : 0;
+    index %= mSidePositions;
+    for (int slot = mCount - 1; slot >= 2; slot--)
+    {
+        if (TypeOf(mPieces[slot]) == PAWN)
+        {
+            squares[slot] = int(index % 48) + 8;
+            index /= 48;
+        }
+        else
+        {
+            squares[slot] = int(index % 64);
+            index /= 64;
+        }
+    }
+    squares[0] = KingPairs[mHasPawns][index].first;
+    squares[1] = KingPairs[mHasPawns][index].second;
+}
+
+/**
+ * Look up a position with this table's material in either color
+ * @param pieces Piece code of each piece, in any order
+ * @param squares Square of each piece
+ * @param count Number of pieces
+ * @param stm 0 for white to move, 1 for black
+ * @return Stored result, EGT_BROKEN if the pieces do not match
+ */
+uint8_t EndgameTable::Lookup(const int pieces[], const int squares[], int count, int stm) const
+{
+    if (count != mCount)
+    {
+        return EGT_BROKEN;
+    }
+
+    // Positions with the colors swapped are looked up mirrored
+    int flip = mKey != mKey2 && MaterialKey(pieces, count) != mKey ? WHITE | BLACK : 0;
+    int board[EGT_PIECES];
+    bool used[EGT_PIECES] = {};
+    for (int slot = 0; slot < mCount; slot++)
+    {
+        int found = 0;
+        while (found < count && (used[found] || pieces[found] != (mPieces[slot] ^ flip)))
+        {
+            found++;
+        }
+        if (found == count)
+        {
+            return EGT_BROKEN;
+        }
+        used[found] = true;
+        board[slot] = flip ? squares[found] ^ 56 : squares[found];
+    }
+
+    uint64_t index = Encode(board, flip ? stm ^ 1 : stm);
+    return index == NO_INDEX ? EGT_BROKEN : mResults[index];
+}
+
+/**
+ * Result of a position from the result after a move
+ * @param result Result after the move, for the opponent
+ * @return Result before it, for the side that moves
+ */
+uint8_t EndgameTable::BeforeMove(uint8_t result)
+{
+    if (result == EGT_DRAW || result == EGT_BROKEN)
+    {
+        return result;
+    }
+    return result >= EGT_LOSS ? uint8_t(EGT_WIN + (result - EGT_LOSS)) : uint8_t(EGT_LOSS + (result - EGT_WIN + 1));
+}
+
+/**
+ * Order results from best to worst for the side to move
+ * @param result A result
+ * @return Higher for faster wins and slower losses
+ */
+int EndgameTable::Rank(uint8_t result)
+{
+    if (result == EGT_DRAW || result == EGT_BROKEN)
+    {
+        return 0;
+    }
+    return result >= EGT_LOSS ? -1000 + (result - EGT_LOSS) : 1000 - (result - EGT_WIN);
+}
+
+/**
+ * Find the tables in a list of directories. Any search using
+ * these tables must be stopped first.
+ * @param paths Directories separated by ':', or ';' on Windows,
+ * empty or "<empty>" for none
+ * @return Number of tables found
+ */
+int EndgameTables::Init(const std::string &paths)
+{
+    mByKey.clear();
+    mTables.clear();
+    mMaxPieces = 0;
+    if (paths.empty() || paths == "<empty>")
+    {
+        return 0;
+    }
+
+#ifdef _WIN32
+    const char separator = ';';
+#else
+    const char separator = ':';
+#endif
+    size_t start = 0;
+    while (start <= paths.size())
+    {
+        size_t end = std::min(paths.find(separator, start), paths.size());
+        std::error_code error;
+        for (auto const &file : std::filesystem::directory_iterator(paths.substr(start, end - start), error))
+        {
+            if (file.path().extension() != EndgameTableExtension)
+            {
+                continue;
+            }
+            auto table = std::make_unique<EndgameTable>();
+            if (table->Open(file.path().string()) && mByKey.count(table->Key()) == 0)
+            {
+                mByKey[table->Key()] = table.get();
+                mByKey[table->Key2()] = table.get();
+                mMaxPieces = std::max(mMaxPieces, table->Count());
+                mTables.push_back(std::move(table));
+            }
+        }
+        start = end + 1;
+    }
+    return int(mTables.size());
+}
+
+/**
+ * Probe the tables, safe to call from several threads
+ * @param position Position with no castling rights, returned unchanged
+ * @param result Receives the result for the side to move
+ * @return False if there is no table for the position
+ */
+bool EndgameTables::Probe(Position &position, uint8_t &result) const
+{
+    Bitboard occupied = position.Occupied();
+    if (position.CastlingRights() != 0 || PopCount(occupied) > EGT_PIECES)
+    {
+        return false;
+    }
+    if (PopCount(occupied) == 2)
+    {
+        result = EGT_DRAW;
+        return true;
+    }
+    auto found = mByKey.find(position.MaterialKey());
+    if (found == mByKey.end())
+    {
+        return false;
+    }
+
+    int pieces[EGT_PIECES];
+    int squares[EGT_PIECES];
+    int count = 0;
+    while (occupied != 0)
+    {
+        squares[count] = PopLsb(occupied);
+        pieces[count] = position.PieceOn(squares[count]);
+        count++;
+    }
+    result = found->second->Lookup(pieces, squares, count, ColorIndex(position.SideToMove()));
+    if (result == EGT_BROKEN)
+    {
+        return false;
+    }
+
+    // Tables do not know en passant captures, try them here
+    if (position.EnPassantSquare() != NO_SQUARE)
+    {
+        MoveList moves;
+        position.GenerateLegalMoves(moves);
+        for (Move move : moves)
+        {
+            if (move.GetType() != Move::EN_PASSANT)
+            {
+                continue;
+            }
+            uint8_t after;
+            position.DoMove(move);
+            bool probed = Probe(position, after);
+            position.UndoMove();
+            if (!probed)
+            {
+                return false;
+            }
+            if (EndgameTable::Rank(EndgameTable::BeforeMove(after)) > EndgameTable::Rank(result))
+            {
+                result = EndgameTable::BeforeMove(after);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Rank the root moves by the distance to mate. The fifty move
+ * rule is not taken into account.
+ * @param position Root position with no castling rights
+ * @param rootMoves Receive mTbRank and mTbScore
+ * @return False if a table is missing
+ */
+bool EndgameTables::RankRootMoves(Position &position, std::vector<RootMove> &rootMoves) const
+{
+    for (RootMove &rootMove : rootMoves)
+    {
+        uint8_t after;
+        position.DoMove(rootMove.mMove);
+        bool probed = !position.IsDraw() ? Probe(position, after) : (after = EGT_DRAW, true);
+        position.UndoMove();
+        if (!probed)
+        {
+            return false;
+        }
+        uint8_t result = EndgameTable::BeforeMove(after);
+        rootMove.mTbRank = EndgameTable::Rank(result);
+        rootMove.mTbScore = Score(result, 0);
+    }
+    return true;
+}
+
+/**
+ * Convert a result to a search score
+ * @param result Result for the side to move
+ * @param ply Distance from the root
+ * @return Mate score, or a tablebase win beyond the search's reach
+ */
+int EndgameTables::Score(uint8_t result, int ply)
+{
+    if (result == EGT_DRAW || result == EGT_BROKEN)
+    {
+        return VALUE_DRAW;
+    }
+    if (result >= EGT_LOSS)
+    {
+        int plies = ply + 2 * (result - EGT_LOSS);
+        return plies < MAX_PLY ? MatedIn(plies) : -VALUE_TB_WIN + ply;
+    }
+    int plies = ply + 2 * (result - EGT_WIN) + 1;
+    return plies < MAX_PLY ? MateIn(plies) : VALUE_TB_WIN - ply;
+}
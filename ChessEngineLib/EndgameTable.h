@@ -0,0 +1,178 @@
+/**
+ * @file EndgameTable.h
+ * @author John Korreck
+ *
+ * Win, draw, loss and distance to mate tables of small endings,
+ * as written by RetrogradeGenerator.
+ */
+
+#ifndef ENDGAMETABLE_H
+#define ENDGAMETABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+
+class Position;
+struct RootMove;
+
+/// Most pieces, kings included, in an endgame table
+const int EGT_PIECES = 5;
+
+/// Stored result of a draw, or of a position not decided yet
+const uint8_t EGT_DRAW = 0;
+
+/// Stored result of a win in 1 move, up to EGT_WIN + 126
+const uint8_t EGT_WIN = 1;
+
+/// Stored result of being mated at once, up to EGT_LOSS + 126 moves
+const uint8_t EGT_LOSS = 128;
+
+/// Stored result of an illegal position or a duplicate index
+const uint8_t EGT_BROKEN = 255;
+
+/// Extension of endgame table files
+const std::string EndgameTableExtension = ".egt";
+
+/**
+ * The results of one material signature, such as KRPvK.
+ *
+ * Each position is stored once for either side to move. The white
+ * king is moved into the a1-d1-d4 triangle by the board's symmetry,
+ * or to files a to d when there are pawns, and identical pieces
+ * are put in order. Positions with castling or en passant rights
+ * are not stored.
+ *
+ * A result byte holds the distance to mate in moves from the side
+ * to move's point of view, see EGT_WIN and EGT_LOSS. Files also hold
+ * a two bit win, draw or loss per position, so that probes which
+ * need no distance touch a quarter of the pages.
+ */
+class EndgameTable {
+private:
+    /// Signature, white first
+    std::string mName;
+
+    /// Piece code of each slot: the kings, then white's and black's other pieces
+    int mPieces[EGT_PIECES] = {};
+
+    /// Number of pieces
+    int mCount = 0;
+
+    /// Are there any pawns?
+    bool mHasPawns = false;
+
+    /// Position::MaterialKey() of the signature
+    uint64_t mKey = 0;
+
+    /// Position::MaterialKey() with the colors swapped
+    uint64_t mKey2 = 0;
+
+    /// Positions per side to move
+    uint64_t mSidePositions = 0;
+
+    /// Distance to mate results, mSidePositions for white to move then for black
+    const uint8_t *mResults = nullptr;
+
+    /// Two bit results, 0 draw, 1 win, 2 loss and 3 broken, or nullptr
+    const uint8_t *mWdl = nullptr;
+
+    /// Results owned while generating
+    std::vector<uint8_t> mOwned;
+
+    /// The mapped file
+    MappedFile mFile;
+
+    uint64_t IndexOf(int squares[], int stm) const;
+
+public:
+    EndgameTable() = default;
+
+    /// Copy constructor (disabled)
+    EndgameTable(const EndgameTable &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const EndgameTable &) = delete;
+
+    bool SetName(const std::string &name);
+    bool Open(const std::string &path);
+    bool Write(const std::string &path) const;
+    void Allocate();
+
+    static std::string Normalize(const std::string &name);
+    static uint64_t MaterialKey(const int pieces[], int count);
+    static uint8_t BeforeMove(uint8_t result);
+    static int Rank(uint8_t result);
+
+    /// Signature, white first
+    const std::string &Name() const { return mName; }
+
+    /// Number of pieces
+    int Count() const { return mCount; }
+
+    /// Piece code of a slot
+    int PieceAt(int slot) const { return mPieces[slot]; }
+
+    /// Are there any pawns?
+    bool HasPawns() const { return mHasPawns; }
+
+    /// Position::MaterialKey() of the signature
+    uint64_t Key() const { return mKey; }
+
+    /// Position::MaterialKey() with the colors swapped
+    uint64_t Key2() const { return mKey2; }
+
+    /// Number of indexes, for both sides to move
+    uint64_t Size() const { return 2 * mSidePositions; }
+
+    /// Are there results to probe?
+    bool IsOpen() const { return mResults != nullptr; }
+
+    /// Results while generating, Size() of them
+    uint8_t *Results() { return mOwned.data(); }
+
+    /**
+     * Result stored at an index
+     * @param index Index below Size()
+     * @return Stored result
+     */
+    uint8_t Result(uint64_t index) const { return mResults[index]; }
+
+    uint64_t Encode(const int squares[], int stm) const;
+    void Decode(uint64_t index, int squares[], int &stm) const;
+    uint8_t Lookup(const int pieces[], const int squares[], int count, int stm) const;
+};
+
+/**
+ * The endgame tables found in a set of directories. Every table is
+ * mapped when it is found, so probing takes no locks and any number
+ * of search threads can probe while nobody calls Init().
+ */
+class EndgameTables {
+private:
+    /// The tables
+    std::vector<std::unique_ptr<EndgameTable>> mTables;
+
+    /// Tables by both of their material keys
+    std::unordered_map<uint64_t, const EndgameTable *> mByKey;
+
+    /// Most pieces in any table
+    int mMaxPieces = 0;
+
+public:
+    int Init(const std::string &paths);
+
+    /// Most pieces in any table found, 0 if there are none
+    int MaxPieces() const { return mMaxPieces; }
+
+    bool Probe(Position &position, uint8_t &result) const;
+    bool RankRootMoves(Position &position, std::vector<RootMove> &rootMoves) const;
+
+    static int Score(uint8_t result, int ply);
+};
+
+#endif //ENDGAMETABLE_H
@@ -0,0 +1,249 @@
+/**
+ * @file Engine.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Engine.h"
+#include "Tune.h"
+
+/**
+ * Constructor, evaluates with the network compiled
+ * into the program if there is one
+ */
+Engine::Engine() : mSearch(mTT)
+{
+    mSearch.SetTablebases(&mTablebases);
+    mSearch.SetEndgameTables(&mEndgameTables);
+    if (mNetwork.LoadEmbedded())
+    {
+        mSearch.SetNetwork(&mNetwork);
+    }
+}
+
+/**
+ * Forget everything learned in the previous game
+ */
+void Engine::NewGame()
+{
+    ClearHash();
+    mPosition.SetFen(Position::StartFen);
+}
+
+/**
+ * Empty the transposition table and the evaluation caches
+ */
+void Engine::ClearHash()
+{
+    Stop();
+    Wait();
+    mTT.Clear();
+    mSearch.ClearEvaluation();
+}
+
+/**
+ * Set the position to search
+ * @param fen Starting position
+ * @param moves Moves played from it in UCI notation
+ * @return False if the FEN or a move could not be read
+ */
+bool Engine::SetPosition(const std::string &fen, const std::vector<std::string> &moves)
+{
+    Position position;
+    if (!position.SetFen(fen))
+    {
+        return false;
+    }
+    for (auto const &uci : moves)
+    {
+        Move move = position.ParseMove(uci);
+        if (!move.IsValid())
+        {
+            return false;
+        }
+        position.DoMove(move);
+    }
+    mPosition = position;
+    return true;
+}
+
+/**
+ * Resize the transposition table
+ * @param megabytes New size
+ */
+void Engine::SetHashSize(size_t megabytes)
+{
+    Stop();
+    Wait();
+    mTT.Resize(megabytes);
+}
+
+/**
+ * Set a search or evaluation constant, stopping any search first.
+ * Changing an evaluation term empties the pawn and material tables,
+ * whose entries were worked out with the old value.
+ * @param name Option name of the constant
+ * @param value New value, clamped to the constant's range
+ * @return False if there is no constant of that name
+ */
+bool Engine::SetParameter(const std::string &name, int value)
+{
+    const TuneParameter *parameter = TuneParameter::Find(name);
+    if (parameter == nullptr)
+    {
+        return false;
+    }
+    Stop();
+    Wait();
+    TuneParameter::Set(name, value);
+    if (parameter->mCached)
+    {
+        mSearch.ClearEvaluation();
+    }
+    return true;
+}
+
+/**
+ * Set the number of best moves searched for
+ * @param lines Number of lines, 1 for normal play
+ */
+void Engine::SetMultiPV(int lines)
+{
+    Stop();
+    Wait();
+    mSearch.SetMultiPV(lines);
+}
+
+/**
+ * Load the network to evaluate with
+ * @param path Network file, EmbeddedNetworkName for the one compiled
+ * into the program or empty to use the hand written evaluation
+ * @return False if the network could not be loaded, the previous
+ * evaluation stays in use
+ */
+bool Engine::LoadNetwork(const std::string &path)
+{
+    Stop();
+    Wait();
+    if (path.empty())
+    {
+        mSearch.SetNetwork(nullptr);
+        return true;
+    }
+    bool loaded = path == EmbeddedNetworkName ? mNetwork.LoadEmbedded() : mNetwork.Load(path);
+    if (!loaded)
+    {
+        return false;
+    }
+    mSearch.SetNetwork(&mNetwork);
+    return true;
+}
+
+/**
+ * Open the opening book
+ * @param path Polyglot book file, or empty to play without a book
+ * @return False if the book could not be opened, no book is used then
+ */
+bool Engine::OpenBook(const std::string &path)
+{
+    if (path.empty())
+    {
+        mBook.Close();
+        return true;
+    }
+    return mBook.Open(path);
+}
+
+/**
+ * Find the Syzygy tablebases to probe
+ * @param paths Directories separated by ':', or ';' on Windows,
+ * empty for none
+ * @return Number of tables found
+ */
+int Engine::SetSyzygyPath(const std::string &paths)
+{
+    Stop();
+    Wait();
+    return mTablebases.Init(paths);
+}
+
+/**
+ * Set how deep the search must still go to probe tables with the
+ * most pieces, smaller tables are probed at any depth
+ * @param depth Least remaining depth
+ */
+void Engine::SetSyzygyProbeDepth(int depth)
+{
+    Stop();
+    Wait();
+    mTbProbeDepth = depth;
+    mSearch.SetTablebaseOptions(mTbProbeDepth, mTbRule50);
+}
+
+/**
+ * Set whether tablebase wins the fifty move rule spoils count as draws
+ * @param rule50 True to respect the rule
+ */
+void Engine::SetSyzygy50MoveRule(bool rule50)
+{
+    Stop();
+    Wait();
+    mTbRule50 = rule50;
+    mSearch.SetTablebaseOptions(mTbProbeDepth, mTbRule50);
+}
+
+/**
+ * Play a book move, or else start searching the current position.
+ * Pondering and infinite analysis always search.
+ * @param limits When to stop
+ */
+void Engine::Go(const SearchLimits &limits)
+{
+    if (!limits.mPonder && !limits.mInfinite)
+    {
+        Move move = mBook.Probe(mPosition);
+        if (move.IsValid())
+        {
+            mSearch.ReportBestMove(move);
+            return;
+        }
+    }
+    mSearch.Start(mPosition, limits);
+}
+
+/**
+ * Stop searching, the best move is reported through the search callback
+ */
+void Engine::Stop()
+{
+    mSearch.Stop();
+}
+
+/**
+ * The expected move was played, turn the ponder search into a normal one
+ */
+void Engine::PonderHit()
+{
+    mSearch.PonderHit();
+}
+
+/**
+ * Wait for the search to report its move
+ */
+void Engine::Wait()
+{
+    mSearch.Wait();
+}
+
+/**
+ * Find the distance to mate tables to probe
+ * @param paths Directories separated by ':', or ';' on Windows,
+ * empty for none
+ * @return Number of tables found
+ */
+int Engine::SetEndgameTablePath(const std::string &paths)
+{
+    Stop();
+    Wait();
+    return mEndgameTables.Init(paths);
+}
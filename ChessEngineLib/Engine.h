@@ -0,0 +1,102 @@
+/**
+ * @file Engine.h
+ * @author John Korreck
+ *
+ * The chess engine as used by both the GUI and the UCI front end.
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <string>
+#include <vector>
+
+#include "Book.h"
+#include "Nnue.h"
+#include "Position.h"
+#include "Search.h"
+#include "Tablebases.h"
+#include "EndgameTable.h"
+#include "TranspositionTable.h"
+
+/**
+ * Owns the current game position, the transposition table and
+ * the search. The table outlives individual searches so that
+ * pondering and consecutive moves reuse each other's work.
+ */
+class Engine {
+private:
+    /// Transposition table shared by every search
+    TranspositionTable mTT;
+
+    /// Evaluation network, used once one is loaded
+    Network mNetwork;
+
+    /// The search worker
+    Search mSearch;
+
+    /// Opening book, consulted before searching
+    Book mBook;
+
+    /// Endgame tablebases, probed by the search
+    Tablebases mTablebases;
+
+    /// Least remaining depth to probe the tablebases at
+    int mTbProbeDepth = 1;
+
+    /// Do tablebase results respect the fifty move rule?
+    bool mTbRule50 = true;
+
+    /// Distance to mate tables, probed where the tablebases have no table
+    EndgameTables mEndgameTables;
+
+    /// The position searched by Go()
+    Position mPosition;
+
+public:
+    Engine();
+
+    /// Copy constructor (disabled)
+    Engine(const Engine &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const Engine &) = delete;
+
+    void NewGame();
+    void ClearHash();
+    bool SetPosition(const std::string &fen, const std::vector<std::string> &moves);
+    void SetHashSize(size_t megabytes);
+    bool SetParameter(const std::string &name, int value);
+    void SetMultiPV(int lines);
+    bool LoadNetwork(const std::string &path);
+    bool OpenBook(const std::string &path);
+    int SetSyzygyPath(const std::string &paths);
+    void SetSyzygyProbeDepth(int depth);
+    void SetSyzygy50MoveRule(bool rule50);
+    int SetEndgameTablePath(const std::string &paths);
+
+    /// The evaluation network
+    const Network &GetNetwork() const { return mNetwork; }
+
+    /// The opening book
+    const Book &GetBook() const { return mBook; }
+
+    /// The endgame tablebases
+    const Tablebases &GetTablebases() const { return mTablebases; }
+
+    /// The distance to mate tables
+    const EndgameTables &GetEndgameTables() const { return mEndgameTables; }
+
+    /// The position searched by Go()
+    Position &GetPosition() { return mPosition; }
+
+    /// The search worker, to install callbacks
+    Search &GetSearch() { return mSearch; }
+
+    void Go(const SearchLimits &limits);
+    void Stop();
+    void PonderHit();
+    void Wait();
+};
+
+#endif //ENGINE_H
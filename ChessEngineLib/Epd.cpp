@@ -0,0 +1,206 @@
+/**
+ * @file Epd.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Epd.h"
+#include "Position.h"
+
+#include <algorithm>
+#include <sstream>
+
+/**
+ * Remove the spaces around some text
+ * @param text Text to trim
+ * @return The text without leading and trailing spaces
+ */
+static std::string Trim(const std::string &text)
+{
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos)
+    {
+        return "";
+    }
+    return text.substr(start, text.find_last_not_of(" \t\r\n") - start + 1);
+}
+
+/**
+ * Is some text a move counter?
+ * @param text Text to test
+ * @return True if it is all digits
+ */
+static bool IsNumber(const std::string &text)
+{
+    return !text.empty() && text.find_first_not_of("0123456789") == std::string::npos;
+}
+
+/**
+ * Get the operands of an operation
+ * @param opcode Opcode such as "c0"
+ * @return The operands, empty if the position has no such operation
+ */
+std::string EpdPosition::Operation(const std::string &opcode) const
+{
+    for (auto const &operation : mOperations)
+    {
+        if (operation.first == opcode)
+        {
+            return operation.second;
+        }
+    }
+    return "";
+}
+
+/**
+ * Does a move solve the position?
+ * @param move Move chosen for the position
+ * @return True if it is one of the best moves, or there are
+ * only moves to avoid and it is none of them
+ */
+bool EpdPosition::IsSolution(Move move) const
+{
+    if (!mBestMoves.empty())
+    {
+        return std::find(mBestMoves.begin(), mBestMoves.end(), move) != mBestMoves.end();
+    }
+    return !mAvoidMoves.empty() && move.IsValid()
+        && std::find(mAvoidMoves.begin(), mAvoidMoves.end(), move) == mAvoidMoves.end();
+}
+
+/**
+ * Read a position from an EPD line. The moves of bm and am may be
+ * in SAN or UCI notation.
+ * @param line The line
+ * @return False if the position or one of its moves could not be read
+ */
+bool EpdPosition::Parse(const std::string &line)
+{
+    *this = EpdPosition();
+
+    std::istringstream input(line);
+    std::string fen;
+    for (int i = 0; i < 4; i++)
+    {
+        std::string field;
+        if (!(input >> field))
+        {
+            return false;
+        }
+        fen += (i == 0 ? "" : " ") + field;
+    }
+
+    // A full FEN has the move counters before any operations
+    std::string halfmove = "0";
+    std::string fullmove = "1";
+    auto operationsStart = input.tellg();
+    std::string first;
+    std::string second;
+    if (input >> first >> second && IsNumber(first) && IsNumber(second))
+    {
+        halfmove = first;
+        fullmove = second;
+        operationsStart = input.tellg();
+    }
+    std::string rest = operationsStart < 0 ? "" : line.substr(size_t(operationsStart));
+
+    // Operations end at a ';' outside of a quoted string
+    std::vector<std::string> operations(1);
+    bool quoted = false;
+    for (char c : rest)
+    {
+        if (c == '"')
+        {
+            quoted = !quoted;
+        }
+        if (c == ';' && !quoted)
+        {
+            operations.emplace_back();
+        }
+        else
+        {
+            operations.back() += c;
+        }
+    }
+    for (auto const &text : operations)
+    {
+        std::string operation = Trim(text);
+        if (operation.empty())
+        {
+            continue;
+        }
+        size_t space = operation.find_first_of(" \t");
+        std::string opcode = operation.substr(0, space);
+        std::string operands = space == std::string::npos ? "" : Trim(operation.substr(space));
+        operands.erase(std::remove(operands.begin(), operands.end(), '"'), operands.end());
+        mOperations.emplace_back(opcode, operands);
+    }
+
+    std::string counter = Operation("hmvc");
+    halfmove = IsNumber(counter) ? counter : halfmove;
+    counter = Operation("fmvn");
+    fullmove = IsNumber(counter) ? counter : fullmove;
+    mFen = fen + " " + halfmove + " " + fullmove;
+
+    Position position;
+    if (!position.SetFen(mFen))
+    {
+        return false;
+    }
+    mId = Operation("id");
+    for (auto const &operation : mOperations)
+    {
+        if (operation.first != "bm" && operation.first != "am")
+        {
+            continue;
+        }
+        auto &moves = operation.first == "bm" ? mBestMoves : mAvoidMoves;
+        std::istringstream operands(operation.second);
+        std::string text;
+        while (operands >> text)
+        {
+            Move move = position.ParseSan(text);
+            move = move.IsValid() ? move : position.ParseMove(text);
+            if (!move.IsValid())
+            {
+                return false;
+            }
+            moves.push_back(move);
+        }
+    }
+    return true;
+}
+
+/**
+ * Read the positions of an EPD stream, one per line. Blank lines
+ * and lines starting with '#' are skipped.
+ * @param input Stream to read
+ * @param positions Receives the positions read
+ * @return Number of lines that could not be read
+ */
+int EpdPosition::Load(std::istream &input, std::vector<EpdPosition> &positions)
+{
+    int bad = 0;
+    int number = 0;
+    std::string line;
+    EpdPosition position;
+    while (std::getline(input, line))
+    {
+        number++;
+        line = Trim(line);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        if (position.Parse(line))
+        {
+            position.mLine = number;
+            positions.push_back(position);
+        }
+        else
+        {
+            bad++;
+        }
+    }
+    return bad;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file Epd.h
+ * @author John Korreck
+ *
+ * Reading positions in Extended Position Description.
+ */
+
+#ifndef EPD_H
+#define EPD_H
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Move.h"
+
+/**
+ * A position as written in an EPD line: the first four FEN fields
+ * followed by operations such as bm, am and id ending in ';'.
+ * Lines that carry the two move counters of a full FEN are read too.
+ */
+struct EpdPosition {
+    /// The position as a full FEN, counters from hmvc and fmvn if given
+    std::string mFen;
+
+    /// The id operation, empty if there is none
+    std::string mId;
+
+    /// Moves of the bm operation, any of them solves the position
+    std::vector<Move> mBestMoves;
+
+    /// Moves of the am operation, any other move solves the position
+    std::vector<Move> mAvoidMoves;
+
+    /// Every operation as an opcode and its operands, quotes removed
+    std::vector<std::pair<std::string, std::string>> mOperations;
+
+    /// Line of the stream the position was loaded from, from 1, 0 if not loaded
+    int mLine = 0;
+
+    std::string Operation(const std::string &opcode) const;
+    bool IsSolution(Move move) const;
+    bool Parse(const std::string &line);
+
+    static int Load(std::istream &input, std::vector<EpdPosition> &positions);
+};
+
+#endif //EPD_H
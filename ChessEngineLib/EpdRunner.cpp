@@ -0,0 +1,154 @@
+/**
+ * @file EpdRunner.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "EpdRunner.h"
+#include "Engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+/**
+ * Search every position of a suite
+ * @param positions The suite
+ * @param callback Called with each result as its search finishes, on
+ * the worker threads but never by two at once, or nullptr
+ */
+void EpdRunner::Run(const std::vector<EpdPosition> &positions, const std::function<void(const Result &)> &callback)
+{
+    auto start = std::chrono::steady_clock::now();
+    mStats = Stats();
+    mResults.assign(positions.size(), Result());
+    mNext = 0;
+
+    std::vector<std::thread> workers;
+    int threads = std::max(1, std::min<int>(mOptions.mThreads, int(positions.size())));
+    for (int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&EpdRunner::Worker, this, std::cref(positions), std::cref(callback));
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    mStats.mMilliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Search positions until there are none left
+ * @param positions The suite
+ * @param callback Called with each result, or nullptr
+ */
+void EpdRunner::Worker(const std::vector<EpdPosition> &positions, const std::function<void(const Result &)> &callback)
+{
+    Engine engine;
+    engine.SetHashSize(mOptions.mHash);
+    if (!mOptions.mSyzygyPath.empty())
+    {
+        engine.SetSyzygyPath(mOptions.mSyzygyPath);
+    }
+
+    SearchLimits limits;
+    limits.mMoveTime = mOptions.mMoveTime;
+    limits.mNodes = mOptions.mNodes;
+    limits.mDepth = mOptions.mDepth;
+
+    while (true)
+    {
+        size_t index;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mNext == positions.size())
+            {
+                break;
+            }
+            index = mNext++;
+        }
+
+        const EpdPosition &position = positions[index];
+        Result result;
+        result.mIndex = index;
+        engine.ClearHash();
+        if (!engine.SetPosition(position.mFen, {}))
+        {
+            result.mError = (position.mLine > 0 ? "line " + std::to_string(position.mLine) + ": " : std::string())
+                + "invalid FEN \"" + position.mFen + "\"";
+            Record(result, callback);
+            continue;
+        }
+
+        // The solution counts from the iteration that found it, as
+        // long as no later iteration changed its mind
+        engine.GetSearch().SetInfoCallback([&position, &result](const SearchInfo &info) {
+            if (info.mMultiPV != 1 || info.mPv.empty())
+            {
+                return;
+            }
+            result.mScore = info.mScore;
+            result.mDepth = info.mDepth;
+            if (!position.IsSolution(info.mPv[0]))
+            {
+                result.mSolveTime = -1;
+            }
+            else if (result.mSolveTime < 0)
+            {
+                result.mSolveTime = info.mTime;
+                result.mSolveNodes = info.mNodes;
+            }
+        });
+        engine.GetSearch().SetBestMoveCallback([&result](Move best, Move) { result.mMove = best; });
+
+        auto start = std::chrono::steady_clock::now();
+        engine.Go(limits);
+        engine.Wait();
+        result.mMilliseconds =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        result.mNodes = engine.GetSearch().Nodes();
+
+        result.mSolved = position.IsSolution(result.mMove);
+        if (!result.mSolved)
+        {
+            result.mSolveTime = -1;
+            result.mSolveNodes = 0;
+        }
+        else if (result.mSolveTime < 0)
+        {
+            // Found in an iteration the search did not finish
+            result.mSolveTime = result.mMilliseconds;
+            result.mSolveNodes = result.mNodes;
+        }
+
+        Record(result, callback);
+    }
+    engine.GetSearch().SetInfoCallback(nullptr);
+    engine.GetSearch().SetBestMoveCallback(nullptr);
+}
+
+/**
+ * Store the result of a position and add it to the statistics
+ * @param result The result
+ * @param callback Called with the result, or nullptr
+ */
+void EpdRunner::Record(const Result &result, const std::function<void(const Result &)> &callback)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResults[result.mIndex] = result;
+    mStats.mPositions++;
+    mStats.mNodes += result.mNodes;
+    mStats.mErrors += result.mError.empty() ? 0 : 1;
+    if (result.mSolved)
+    {
+        mStats.mSolved++;
+        mStats.mSolveTime += result.mSolveTime;
+        mStats.mSolveNodes += result.mSolveNodes;
+    }
+    if (callback)
+    {
+        callback(result);
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file EpdRunner.h
+ * @author John Korreck
+ *
+ * Runs test suites of EPD positions through the search.
+ */
+
+#ifndef EPDRUNNER_H
+#define EPDRUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Epd.h"
+
+/**
+ * Settings for running a suite
+ */
+struct EpdRunnerOptions {
+    /// Positions searched at once, each by its own engine
+    int mThreads = 1;
+
+    /// Time to search each position in milliseconds, 0 for no limit
+    int64_t mMoveTime = 1000;
+
+    /// Nodes to search each position, 0 for no limit
+    uint64_t mNodes = 0;
+
+    /// Depth to search each position to, 0 for no limit
+    int mDepth = 0;
+
+    /// Transposition table of each engine in megabytes
+    size_t mHash = 16;
+
+    /// Syzygy tablebase directories, empty for none
+    std::string mSyzygyPath;
+};
+
+/**
+ * Searches the positions of a test suite and checks the moves
+ * found against their bm and am operations.
+ *
+ * Every worker thread owns an engine and takes the next position
+ * not searched yet, so long and short searches even out. The
+ * transposition table is cleared before each position, so results
+ * do not depend on which positions a worker searched before.
+ *
+ * A position is solved when the move the search plays is a solution.
+ * The time and nodes to solution are those of the iteration that
+ * found the solution and kept it to the end of the search.
+ */
+class EpdRunner {
+public:
+    /**
+     * What the search found for one position
+     */
+    struct Result {
+        /// Index of the position in the suite
+        size_t mIndex = 0;
+
+        /// Move the search played
+        Move mMove;
+
+        /// Was it a solution?
+        bool mSolved = false;
+
+        /// Score of the last iteration
+        int mScore = 0;
+
+        /// Depth of the last iteration
+        int mDepth = 0;
+
+        /// Nodes searched
+        uint64_t mNodes = 0;
+
+        /// Time searched in milliseconds
+        int64_t mMilliseconds = 0;
+
+        /// Time to solution in milliseconds, -1 if not solved
+        int64_t mSolveTime = -1;
+
+        /// Nodes to solution, 0 if not solved
+        uint64_t mSolveNodes = 0;
+
+        /// Why the position could not be searched, empty if it was
+        std::string mError;
+    };
+
+    /**
+     * Statistics of a run
+     */
+    struct Stats {
+        /// Positions searched
+        uint64_t mPositions = 0;
+
+        /// Positions solved
+        uint64_t mSolved = 0;
+
+        /// Positions that could not be searched, counted as not solved
+        uint64_t mErrors = 0;
+
+        /// Nodes searched over all positions
+        uint64_t mNodes = 0;
+
+        /// Time to solution added up over the solved positions
+        int64_t mSolveTime = 0;
+
+        /// Nodes to solution added up over the solved positions
+        uint64_t mSolveNodes = 0;
+
+        /// Time taken by the run in milliseconds
+        int64_t mMilliseconds = 0;
+    };
+
+private:
+    /// Settings for the run
+    EpdRunnerOptions mOptions;
+
+    /// Statistics of the last run
+    Stats mStats;
+
+    /// Results of the last run, in suite order
+    std::vector<Result> mResults;
+
+    /// Index of the next position to search
+    size_t mNext = 0;
+
+    /// Protects mNext, the results and the statistics
+    std::mutex mMutex;
+
+    void Worker(const std::vector<EpdPosition> &positions, const std::function<void(const Result &)> &callback);
+    void Record(const Result &result, const std::function<void(const Result &)> &callback);
+
+public:
+    /**
+     * Constructor
+     * @param options Settings for the run
+     */
+    EpdRunner(const EpdRunnerOptions &options) : mOptions(options) {}
+
+    /// Copy constructor (disabled)
+    EpdRunner(const EpdRunner &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const EpdRunner &) = delete;
+
+    void Run(const std::vector<EpdPosition> &positions, const std::function<void(const Result &)> &callback = nullptr);
+
+    /// Results of the last run, in suite order
+    const std::vector<Result> &GetResults() const { return mResults; }
+
+    /// Statistics of the last run
+    const Stats &GetStats() const { return mStats; }
+};
+
+#endif //EPDRUNNER_H
@@ -0,0 +1,445 @@
+/**
+ * @file Evaluation.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Evaluation.h"
+#include "Position.h"
+#include "Bitbase.h"
+#include "Tune.h"
+
+// Piece-square tables from white's point of view, a8 is the first entry
+
+/// Pawn piece-square table
+const int PawnTable[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0};
+
+/// Knight piece-square table
+const int KnightTable[64] = {
+    -50,-40,-30,-30,-30,-30,-40,-50,
+    -40,-20,  0,  0,  0,  0,-20,-40,
+    -30,  0, 10, 15, 15, 10,  0,-30,
+    -30,  5, 15, 20, 20, 15,  5,-30,
+    -30,  0, 15, 20, 20, 15,  0,-30,
+    -30,  5, 10, 15, 15, 10,  5,-30,
+    -40,-20,  0,  5,  5,  0,-20,-40,
+    -50,-40,-30,-30,-30,-30,-40,-50};
+
+/// Bishop piece-square table
+const int BishopTable[64] = {
+    -20,-10,-10,-10,-10,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5, 10, 10,  5,  0,-10,
+    -10,  5,  5, 10, 10,  5,  5,-10,
+    -10,  0, 10, 10, 10, 10,  0,-10,
+    -10, 10, 10, 10, 10, 10, 10,-10,
+    -10,  5,  0,  0,  0,  0,  5,-10,
+    -20,-10,-10,-10,-10,-10,-10,-20};
+
+/// Rook piece-square table
+const int RookTable[64] = {
+      0,  0,  0,  0,  0,  0,  0,  0,
+      5, 10, 10, 10, 10, 10, 10,  5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+      0,  0,  0,  5,  5,  0,  0,  0};
+
+/// Queen piece-square table
+const int QueenTable[64] = {
+    -20,-10,-10, -5, -5,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5,  5,  5,  5,  0,-10,
+     -5,  0,  5,  5,  5,  5,  0, -5,
+      0,  0,  5,  5,  5,  5,  0, -5,
+    -10,  5,  5,  5,  5,  5,  0,-10,
+    -10,  0,  5,  0,  0,  0,  0,-10,
+    -20,-10,-10, -5, -5,-10,-10,-20};
+
+/// King piece-square table while there is material on the board
+const int KingMiddleTable[64] = {
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -20,-30,-30,-40,-40,-30,-30,-20,
+    -10,-20,-20,-20,-20,-20,-20,-10,
+     20, 20,  0,  0,  0,  0, 20, 20,
+     20, 30, 10,  0,  0, 10, 30, 20};
+
+/// King piece-square table in the endgame
+const int KingEndTable[64] = {
+    -50,-40,-30,-20,-20,-30,-40,-50,
+    -30,-20,-10,  0,  0,-10,-20,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-30,  0,  0,  0,  0,-30,-30,
+    -50,-30,-30,-30,-30,-30,-30,-50};
+
+/// Game phase contributed by each piece type, 24 is a full board
+const int PhaseWeight[7] = {0, 0, 0, 1, 1, 2, 4};
+
+/// Middlegame bonus for a passed pawn by rank from its own side
+const int PassedMiddlegame[8] = {0, 5, 10, 15, 25, 40, 60, 0};
+
+/// Endgame bonus for a passed pawn by rank from its own side
+const int PassedEndgame[8] = {0, 10, 20, 35, 60, 100, 150, 0};
+
+/// Penalty for each pawn behind another of its side on the same file
+static int DoubledMiddlegame = 10;
+static int DoubledEndgame = 20;
+
+/// Penalty for a pawn with no pawns of its side on the files next to it
+static int IsolatedMiddlegame = 10;
+static int IsolatedEndgame = 15;
+
+/// Penalty for a pawn that can neither be defended by a pawn nor advance safely
+static int BackwardMiddlegame = 8;
+static int BackwardEndgame = 10;
+
+/// Middlegame bonus for a pawn one and two ranks in front of its king
+const int ShieldBonus[3] = {0, 10, 5};
+
+/// Bonus for having both bishops
+static int BishopPair = 30;
+
+/// Change in a knight's value for each pawn of its side above five
+const int KnightPawnAdjustment = 6;
+
+/// Change in a rook's value for each pawn of its side above five
+const int RookPawnAdjustment = -12;
+
+/// The pawn structure and bishop pair terms are options for tuning
+static const bool Tunable = TuneParameter::Add({
+    {"DoubledMiddlegame", &DoubledMiddlegame, 0, 0, 100, true},
+    {"DoubledEndgame", &DoubledEndgame, 0, 0, 100, true},
+    {"IsolatedMiddlegame", &IsolatedMiddlegame, 0, 0, 100, true},
+    {"IsolatedEndgame", &IsolatedEndgame, 0, 0, 100, true},
+    {"BackwardMiddlegame", &BackwardMiddlegame, 0, 0, 100, true},
+    {"BackwardEndgame", &BackwardEndgame, 0, 0, 100, true},
+    {"BishopPair", &BishopPair, 0, 0, 150, true},
+});
+
+/**
+ * Work out the phase, imbalance and special endgame handling of
+ * a material balance into a material table entry
+ * @param position Position with the material
+ * @param entry Entry to fill in
+ */
+void Evaluation::EvaluateMaterial(const Position &position, MaterialEntry &entry)
+{
+    int phase = 0;
+    int nonPawn[2] = {};
+    for (int color : {WHITE, BLACK})
+    {
+        int sign = color == WHITE ? 1 : -1;
+        int pawns = position.PieceCount(color + PAWN);
+        for (int type = KNIGHT; type <= QUEEN; type++)
+        {
+            phase += PhaseWeight[type] * position.PieceCount(color + type);
+            nonPawn[ColorIndex(color)] += PieceValue[type] * position.PieceCount(color + type);
+        }
+
+        if (position.PieceCount(color + BISHOP) >= 2)
+        {
+            entry.mImbalance += sign * BishopPair;
+        }
+
+        // Knights gain and rooks lose value as pawns are added
+        entry.mImbalance += sign * position.PieceCount(color + KNIGHT) * (pawns - 5) * KnightPawnAdjustment;
+        entry.mImbalance += sign * position.PieceCount(color + ROOK) * (pawns - 5) * RookPawnAdjustment;
+    }
+    entry.mPhase = std::min(phase, 24);
+
+    for (int strong : {WHITE, BLACK})
+    {
+        int weak = Opponent(strong);
+        int us = ColorIndex(strong);
+        int them = ColorIndex(weak);
+        bool weakBare = nonPawn[them] == 0 && position.PieceCount(weak + PAWN) == 0;
+        int pawns = position.PieceCount(strong + PAWN);
+        int knights = position.PieceCount(strong + KNIGHT);
+        int bishops = position.PieceCount(strong + BISHOP);
+        int majors = position.PieceCount(strong + ROOK) + position.PieceCount(strong + QUEEN);
+
+        if (weakBare && pawns == 0 && knights == 1 && bishops == 1 && majors == 0)
+        {
+            entry.mEndgame = EvaluateKBNK;
+            entry.mEndgameColor = strong;
+            return;
+        }
+        if (weakBare && pawns == 0 && (majors > 0 || bishops >= 2))
+        {
+            entry.mEndgame = EvaluateKXK;
+            entry.mEndgameColor = strong;
+            return;
+        }
+        if (weakBare && pawns == 1 && nonPawn[us] == 0)
+        {
+            InitKpkBitbase();
+            entry.mEndgame = EvaluateKPK;
+            entry.mEndgameColor = strong;
+            return;
+        }
+
+        // Without pawns a side needs more than a minor piece extra to win
+        if (pawns == 0 && nonPawn[us] - nonPawn[them] <= PieceValue[BISHOP])
+        {
+            entry.mScaleFactor[us] = nonPawn[us] < PieceValue[ROOK] ? SCALE_DRAW : 16;
+        }
+    }
+
+    // A bishop each and nothing else but pawns
+    bool bishopsOnly = true;
+    for (int color : {WHITE, BLACK})
+    {
+        bishopsOnly = bishopsOnly && position.PieceCount(color + BISHOP) == 1
+            && nonPawn[ColorIndex(color)] == PieceValue[BISHOP];
+    }
+    if (bishopsOnly)
+    {
+        entry.mScale[0] = entry.mScale[1] = ScaleOppositeBishops;
+    }
+}
+
+/**
+ * Find the material balance of a position, working it out only
+ * if it is not already in the material table
+ * @param position Position to look up
+ * @return The material entry
+ */
+MaterialEntry &Evaluation::ProbeMaterial(const Position &position)
+{
+    bool found;
+    MaterialEntry *entry = mMaterialTable.Probe(position.MaterialKey(), found);
+    if (!found)
+    {
+        EvaluateMaterial(position, *entry);
+    }
+    return *entry;
+}
+
+/**
+ * Get the scale factor for the side the evaluation favours
+ * @param position Position being evaluated
+ * @param material Material entry for the position
+ * @param strong Color the evaluation favours
+ * @return Scale factor out of SCALE_NORMAL
+ */
+int Evaluation::ScaleFactor(const Position &position, const MaterialEntry &material, int strong)
+{
+    int index = ColorIndex(strong);
+    if (material.mScale[index] != nullptr)
+    {
+        int factor = material.mScale[index](position, strong);
+        if (factor != SCALE_NONE)
+        {
+            return std::min(factor, material.mScaleFactor[index]);
+        }
+    }
+    return material.mScaleFactor[index];
+}
+
+/**
+ * Score the pawn structure of both sides into a pawn table entry
+ * @param position Position the pawns are on
+ * @param entry Entry to fill in
+ */
+void Evaluation::EvaluatePawns(const Position &position, PawnEntry &entry)
+{
+    for (int color : {WHITE, BLACK})
+    {
+        int sign = color == WHITE ? 1 : -1;
+        Bitboard ours = position.Pieces(color + PAWN);
+        Bitboard theirs = position.Pieces(Opponent(color) + PAWN);
+        Bitboard pawns = ours;
+        while (pawns)
+        {
+            int square = PopLsb(pawns);
+            int file = FileOf(square);
+            int rank = color == WHITE ? RankOf(square) : 7 - RankOf(square);
+            Bitboard ahead = ForwardRanksBB(color, square);
+            Bitboard neighbours = ours & AdjacentFilesBB(file);
+
+            bool doubled = (ours & ahead & FileBB(file)) != 0;
+            bool passed = !(theirs & ahead & (FileBB(file) | AdjacentFilesBB(file))) && !doubled;
+            bool isolated = neighbours == 0;
+
+            // No neighbour level or behind to defend it, and the
+            // square in front is covered by an enemy pawn
+            int stop = square + (color == WHITE ? 8 : -8);
+            bool backward = !isolated && !(neighbours & ~ahead)
+                && (PawnAttacks[ColorIndex(color)][stop] & theirs);
+
+            if (passed)
+            {
+                entry.mPassed[ColorIndex(color)] |= SquareBB(square);
+                entry.mMiddlegame += sign * PassedMiddlegame[rank];
+                entry.mEndgame += sign * PassedEndgame[rank];
+            }
+            if (doubled)
+            {
+                entry.mMiddlegame -= sign * DoubledMiddlegame;
+                entry.mEndgame -= sign * DoubledEndgame;
+            }
+            if (isolated)
+            {
+                entry.mMiddlegame -= sign * IsolatedMiddlegame;
+                entry.mEndgame -= sign * IsolatedEndgame;
+            }
+            else if (backward)
+            {
+                entry.mMiddlegame -= sign * BackwardMiddlegame;
+                entry.mEndgame -= sign * BackwardEndgame;
+            }
+        }
+    }
+}
+
+/**
+ * Score the pawns sheltering a king, cached in the pawn entry
+ * for as long as the king stays on the same square
+ * @param position Position the king is in
+ * @param color Color of the king
+ * @param entry Pawn entry for the position
+ * @return Middlegame bonus for the shelter
+ */
+int Evaluation::Shelter(const Position &position, int color, PawnEntry &entry)
+{
+    int kingSquare = position.KingSquare(color);
+    int index = ColorIndex(color);
+    if (entry.mShelterKing[index] == kingSquare)
+    {
+        return entry.mShelter[index];
+    }
+
+    int file = FileOf(kingSquare);
+    Bitboard shield = position.Pieces(color + PAWN) & ForwardRanksBB(color, kingSquare)
+        & (FileBB(file) | AdjacentFilesBB(file));
+    int shelter = 0;
+    while (shield)
+    {
+        int distance = std::abs(RankOf(PopLsb(shield)) - RankOf(kingSquare));
+        if (distance <= 2)
+        {
+            shelter += ShieldBonus[distance];
+        }
+    }
+
+    entry.mShelterKing[index] = kingSquare;
+    entry.mShelter[index] = shelter;
+    return shelter;
+}
+
+/**
+ * Find the pawn structure of a position, evaluating it only if
+ * it is not already in the pawn table
+ * @param position Position to look up
+ * @return The pawn entry
+ */
+PawnEntry &Evaluation::ProbePawns(const Position &position)
+{
+    bool found;
+    PawnEntry *entry = mPawnTable.Probe(position.PawnKey(), found);
+    if (!found)
+    {
+        EvaluatePawns(position, *entry);
+    }
+    return *entry;
+}
+
+/**
+ * Forget the cached pawn structures and material balances, so they
+ * are worked out again with the current evaluation constants
+ */
+void Evaluation::Clear()
+{
+    mPawnTable.Clear();
+    mMaterialTable.Clear();
+}
+
+/**
+ * Evaluate a position
+ * @param position Position to evaluate
+ * @return Score in centipawns from the side to move's point of view
+ */
+int Evaluation::Evaluate(const Position &position)
+{
+    // Known endings have their own evaluation
+    MaterialEntry &material = ProbeMaterial(position);
+    if (material.mEndgame != nullptr)
+    {
+        int score = material.mEndgame(position, material.mEndgameColor);
+        return position.SideToMove() == material.mEndgameColor ? score : -score;
+    }
+
+    // A network replaces the hand written terms, drawish endings still scale it
+    if (mNetwork != nullptr)
+    {
+        int score = mAccumulators.Evaluate(position);
+        int strong = score > 0 ? position.SideToMove() : Opponent(position.SideToMove());
+        return score * ScaleFactor(position, material, strong) / SCALE_NORMAL;
+    }
+
+    int score = material.mImbalance;
+    int kingMiddle = 0;
+    int kingEnd = 0;
+
+    for (int color : {WHITE, BLACK})
+    {
+        int sign = color == WHITE ? 1 : -1;
+        for (int type = KING; type <= QUEEN; type++)
+        {
+            int piece = color + type;
+            const int *squares = position.Squares(piece);
+            for (int i = 0; i < position.PieceCount(piece); i++)
+            {
+                int index = color == WHITE ? squares[i] ^ 56 : squares[i];
+
+                int value = PieceValue[type];
+                switch (type)
+                {
+                case PAWN: value += PawnTable[index]; break;
+                case KNIGHT: value += KnightTable[index]; break;
+                case BISHOP: value += BishopTable[index]; break;
+                case ROOK: value += RookTable[index]; break;
+                case QUEEN: value += QueenTable[index]; break;
+                case KING:
+                    kingMiddle += sign * KingMiddleTable[index];
+                    kingEnd += sign * KingEndTable[index];
+                    break;
+                default: ;
+                }
+                score += sign * value;
+            }
+        }
+    }
+
+    // Pawn structure and king shelter come from the pawn table
+    PawnEntry &pawns = ProbePawns(position);
+    int shelter = Shelter(position, WHITE, pawns) - Shelter(position, BLACK, pawns);
+    int middlegame = kingMiddle + pawns.mMiddlegame + shelter;
+    int endgame = kingEnd + pawns.mEndgame;
+
+    // Blend the middlegame and endgame terms by how much material is left
+    int phase = material.mPhase;
+    score += (middlegame * phase + endgame * (24 - phase)) / 24;
+
+    // Drawish endings pull the score towards zero
+    int strong = score > 0 ? WHITE : BLACK;
+    score = score * ScaleFactor(position, material, strong) / SCALE_NORMAL;
+
+    return position.SideToMove() == WHITE ? score : -score;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file Evaluation.h
+ * @author John Korreck
+ *
+ * Static evaluation of a position.
+ */
+
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "AccumulatorStack.h"
+#include "MaterialHashTable.h"
+#include "PawnHashTable.h"
+
+class Position;
+
+/// Material value of each piece type in centipawns, indexed by piece type
+const int PieceValue[7] = {0, 0, 100, 320, 330, 500, 900};
+
+/**
+ * Static evaluation used at the leaves of the search.
+ *
+ * Each search thread owns its own Evaluation so that any
+ * caches it keeps need no locking.
+ */
+class Evaluation {
+private:
+    /// Cached pawn structures
+    PawnHashTable mPawnTable;
+
+    /// Cached material balances
+    MaterialHashTable mMaterialTable;
+
+    /// Network used instead of the hand written terms, nullptr if none
+    const Network *mNetwork = nullptr;
+
+    /// Network accumulators along the game and search
+    AccumulatorStack mAccumulators;
+
+    MaterialEntry &ProbeMaterial(const Position &position);
+    static void EvaluateMaterial(const Position &position, MaterialEntry &entry);
+    static int ScaleFactor(const Position &position, const MaterialEntry &material, int strong);
+
+    PawnEntry &ProbePawns(const Position &position);
+    static void EvaluatePawns(const Position &position, PawnEntry &entry);
+    static int Shelter(const Position &position, int color, PawnEntry &entry);
+
+public:
+    int Evaluate(const Position &position);
+    void Clear();
+
+    /**
+     * Set the network to evaluate with
+     * @param network A loaded network, or nullptr for the hand written evaluation
+     */
+    void SetNetwork(const Network *network)
+    {
+        mNetwork = network;
+        mAccumulators.SetNetwork(network);
+    }
+
+    /// The network accumulators, for their update counts
+    const AccumulatorStack &GetAccumulators() const { return mAccumulators; }
+
+    /// The pawn structure cache
+    const PawnHashTable &GetPawnTable() const { return mPawnTable; }
+};
+
+#endif //EVALUATION_H
@@ -6,6 +6,25 @@
 #include "pch.h"
 #include "ImageDrawable.h"
 
+#include <map>
+
+/**
+ * Get the image in a file, reading each file only once.
+ * A board has up to 32 pieces but only 12 different images.
+ * @param filename The filename for the image
+ * @return The shared image
+ */
+static std::shared_ptr<wxImage> SharedImage(const std::wstring &filename)
+{
+ static std::map<std::wstring, std::shared_ptr<wxImage>> images;
+ auto &image = images[filename];
+ if (image == nullptr)
+ {
+  image = std::make_shared<wxImage>(filename, wxBITMAP_TYPE_ANY);
+ }
+ return image;
+}
+
 /**
  * Constructor
  * @param name The drawable name
@@ -14,7 +33,7 @@
 ImageDrawable::ImageDrawable(const std::wstring &name, const std::wstring &filename) :
         Drawable(name)
 {
- mImage = std::make_unique<wxImage>(filename, wxBITMAP_TYPE_ANY);
+ mImage = SharedImage(filename);
 }
 
 /**
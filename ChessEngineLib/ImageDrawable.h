@@ -20,8 +20,9 @@ private:
     /** The graphics bitmap used for the image */
     wxGraphicsBitmap mBitmap;
 protected:
-    /** The wxImage object that holds the image data */
-    std::unique_ptr<wxImage> mImage;
+    /** The wxImage object that holds the image data, shared by
+     * every drawable made from the same file */
+    std::shared_ptr<wxImage> mImage;
 
 public:
     /**
@@ -11,6 +11,8 @@
 #include "MainFrame.h"
 #include "ViewEdit.h"
 #include "PictureFactory.h"
+#include "Picture.h"
+#include "Position.h"
 
 /// Directory within resources that contains the images.
 const std::wstring ImagesDirectory = L"/images";
@@ -52,6 +54,10 @@ void MainFrame::Initialize()
     Bind(wxEVT_COMMAND_MENU_SELECTED, &MainFrame::OnExit, this, wxID_EXIT);
     Bind(wxEVT_COMMAND_MENU_SELECTED, &MainFrame::OnAbout, this, wxID_ABOUT);
     Bind(wxEVT_CLOSE_WINDOW, &MainFrame::OnClose, this);
+    Bind(wxEVT_COMMAND_MENU_SELECTED, &MainFrame::OnEnginePlayBlack, this, XRCID("EnginePlayBlack"));
+    Bind(wxEVT_COMMAND_MENU_SELECTED, &MainFrame::OnEnginePonder, this, XRCID("EnginePonder"));
+    Bind(wxEVT_COMMAND_MENU_SELECTED, &MainFrame::OnEngineAnalyze, this, XRCID("EngineAnalyze"));
+    Bind(wxEVT_COMMAND_MENU_SELECTED, &MainFrame::OnFileOpen, this, wxID_OPEN);
 
 
     //
@@ -95,4 +101,89 @@ void MainFrame::OnAbout(wxCommandEvent& event)
 void MainFrame::OnClose(wxCloseEvent& event)
 {
     Destroy();
-}
\ No newline at end of file
+}
+
+/**
+ * Engine>Play Black menu handler
+ * @param event The menu command event
+ */
+void MainFrame::OnEnginePlayBlack(wxCommandEvent& event)
+{
+    mViewEdit->SetEngineEnabled(event.IsChecked());
+}
+
+/**
+ * Engine>Ponder menu handler
+ * @param event The menu command event
+ */
+void MainFrame::OnEnginePonder(wxCommandEvent& event)
+{
+    mViewEdit->SetPonderEnabled(event.IsChecked());
+}
+
+/**
+ * Engine>Show Best Moves menu handler
+ * @param event The menu command event
+ */
+void MainFrame::OnEngineAnalyze(wxCommandEvent& event)
+{
+    mViewEdit->SetAnalysisEnabled(event.IsChecked());
+}
+
+/**
+ * File>Open Games menu handler. Shows the game of the file on the
+ * board, asking which one when the file holds several.
+ * @param event The menu command event
+ */
+void MainFrame::OnFileOpen(wxCommandEvent& event)
+{
+    wxFileDialog loadFileDialog(this, L"Open Games", L"", L"",
+            L"PGN Files (*.pgn)|*.pgn", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+    if (loadFileDialog.ShowModal() == wxID_CANCEL)
+    {
+        return;
+    }
+
+    if (!mPicture->Load(loadFileDialog.GetPath()))
+    {
+        wxMessageBox(L"Unable to read " + loadFileDialog.GetPath(), L"Open Games", wxOK | wxICON_ERROR, this);
+        return;
+    }
+    auto const &games = mPicture->GetGames();
+    if (games.empty())
+    {
+        wxMessageBox(L"There are no games in " + loadFileDialog.GetPath(), L"Open Games", wxOK | wxICON_ERROR, this);
+        return;
+    }
+
+    int choice = 0;
+    if (games.size() > 1)
+    {
+        wxArrayString names;
+        for (auto const &game : games)
+        {
+            names.Add(wxString(game.mGame.Tag("White")) + L" - " + wxString(game.mGame.Tag("Black")) +
+                    L"  " + wxString(game.mGame.mResult));
+        }
+        choice = wxGetSingleChoiceIndex(L"Choose the game to show", L"Open Games", names, this);
+        if (choice < 0)
+        {
+            return;
+        }
+    }
+
+    auto const &game = games[choice];
+    if (game.mStartFen != Position::StartFen)
+    {
+        // The board can only be set up in the standard starting position
+        wxMessageBox(L"Only games from the standard starting position can be shown", L"Open Games",
+                wxOK | wxICON_ERROR, this);
+        return;
+    }
+    mViewEdit->LoadGame(game.mMoves);
+    if (!game.mComplete)
+    {
+        wxMessageBox(wxString::Format(L"Only the first %zu moves of the game could be read", game.mMoves.size()),
+                L"Open Games", wxOK | wxICON_INFORMATION, this);
+    }
+}
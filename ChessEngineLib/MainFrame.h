@@ -22,6 +22,10 @@ private:
  void OnExit(wxCommandEvent& event);
  void OnAbout(wxCommandEvent&);
  void OnClose(wxCloseEvent &event);
+ void OnEnginePlayBlack(wxCommandEvent& event);
+ void OnEnginePonder(wxCommandEvent& event);
+ void OnEngineAnalyze(wxCommandEvent& event);
+ void OnFileOpen(wxCommandEvent& event);
 
  /// The resources directory to use
  std::wstring mResourcesDir;
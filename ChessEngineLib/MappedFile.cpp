@@ -0,0 +1,142 @@
+/**
+ * @file MappedFile.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Destructor, unmaps the file
+ */
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+/**
+ * Move constructor, the other file is left closed
+ * @param other File to take the mapping from
+ */
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+/**
+ * Move assignment, the other file is left closed
+ * @param other File to take the mapping from
+ * @return This file
+ */
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(mData, other.mData);
+        std::swap(mSize, other.mSize);
+#ifdef _WIN32
+        std::swap(mMapping, other.mMapping);
+#endif
+    }
+    return *this;
+}
+
+/**
+ * Map a file, closing any file mapped before
+ * @param path File name
+ * @return False if the file could not be opened or is empty
+ */
+bool MappedFile::Open(const std::string &path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    // The mapping keeps the file open
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    mMapping = mapping;
+    mData = static_cast<const unsigned char *>(data);
+    mSize = size_t(size.QuadPart);
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    void *data = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        data = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+    }
+    // The mapping keeps the file open
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    mData = static_cast<const unsigned char *>(data);
+    mSize = size_t(status.st_size);
+#endif
+    return true;
+}
+
+/**
+ * Unmap the file, if one is mapped
+ */
+void MappedFile::Close()
+{
+    if (mData == nullptr)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(mData);
+    CloseHandle(mMapping);
+    mMapping = nullptr;
+#else
+    munmap(const_cast<unsigned char *>(mData), mSize);
+#endif
+    mData = nullptr;
+    mSize = 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file MappedFile.h
+ * @author John Korreck
+ *
+ * Read-only memory mapping of a file.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * A file mapped read-only into memory.
+ *
+ * Large data such as networks, opening books and tablebases is used
+ * straight from the mapping. Nothing is read until a page is touched,
+ * so opening is nearly instant, and engines running side by side on
+ * one machine share the same pages of the operating system's cache.
+ */
+class MappedFile {
+private:
+    /// Start of the mapping, nullptr if nothing is mapped
+    const unsigned char *mData = nullptr;
+
+    /// Size of the file in bytes
+    size_t mSize = 0;
+
+#ifdef _WIN32
+    /// File mapping object handle
+    void *mMapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    /// Copy constructor (disabled)
+    MappedFile(const MappedFile &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    bool Open(const std::string &path);
+    void Close();
+
+    /// Is a file mapped?
+    bool IsOpen() const { return mData != nullptr; }
+
+    /// The bytes of the file
+    const unsigned char *Data() const { return mData; }
+
+    /// Size of the file in bytes
+    size_t Size() const { return mSize; }
+};
+
+#endif //MAPPEDFILE_H
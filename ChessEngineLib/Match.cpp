@@ -0,0 +1,601 @@
+/**
+ * @file Match.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Match.h"
+#include "Epd.h"
+#include "Position.h"
+#include "UciProcess.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <sstream>
+#include <thread>
+
+/// Time an engine gets to answer "isready", in milliseconds
+const int64_t ReadyTimeout = 10000;
+
+/// Time an engine that overstepped its clock gets to answer "stop", in milliseconds
+const int64_t StopTimeout = 1000;
+
+/// Time an engine searching a fixed number of nodes gets per move, in milliseconds
+const int64_t NodesTimeout = 60000;
+
+/**
+ * Milliseconds since some fixed point
+ * @return The time
+ */
+static int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Write a time in seconds the way a PGN TimeControl tag does
+ * @param milliseconds The time
+ * @return Seconds such as "10" or "0.1"
+ */
+static std::string Seconds(int64_t milliseconds)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%lld.%03lld", (long long)(milliseconds / 1000),
+                  (long long)(milliseconds % 1000));
+    std::string seconds = text;
+    seconds.erase(seconds.find_last_not_of('0') + 1);
+    if (seconds.back() == '.')
+    {
+        seconds.pop_back();
+    }
+    return seconds;
+}
+
+/**
+ * Read the score of a UCI info line
+ * @param line The line
+ * @param score Receives the score from the side to move's point of view
+ * @return False if the line has no score
+ */
+static bool ParseScore(const std::string &line, int &score)
+{
+    std::istringstream input(line);
+    std::string token;
+    while (input >> token)
+    {
+        if (token != "score")
+        {
+            continue;
+        }
+        std::string type;
+        int value;
+        if (!(input >> type >> value))
+        {
+            return false;
+        }
+        if (type == "cp")
+        {
+            score = value;
+            return true;
+        }
+        if (type == "mate")
+        {
+            score = value > 0 ? MateIn(2 * value - 1) : MatedIn(-2 * value);
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+/**
+ * Constructor
+ * @param options Settings for the match
+ */
+Match::Match(const MatchOptions &options) : mOptions(options)
+{
+}
+
+/**
+ * Read the openings file of the options
+ * @return False if the file could not be read or has no openings
+ */
+bool Match::LoadOpenings()
+{
+    mOpenings.clear();
+    return mOptions.mOpenings.empty() || ReadOpenings(mOptions.mOpenings, mOptions.mOpeningPlies, mOpenings);
+}
+
+/**
+ * Read a file of openings. Games from a file ending in ".pgn" give
+ * their first moves, any other file is read as EPD.
+ * @param path The file
+ * @param plies Half moves taken from each game of a PGN file
+ * @param openings Receives the openings in the order of the file
+ * @return False if the file could not be read or has no openings
+ */
+bool Match::ReadOpenings(const std::string &path, int plies, std::vector<MatchOpening> &openings)
+{
+    openings.clear();
+    std::string extension = path.size() < 4 ? "" : path.substr(path.size() - 4);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".pgn")
+    {
+        PgnParser parser(int(std::max(1u, std::thread::hardware_concurrency())));
+        std::vector<ParsedGame> games;
+        if (!parser.Load(path, games))
+        {
+            return false;
+        }
+        for (auto const &game : games)
+        {
+            MatchOpening opening;
+            opening.mFen = game.mStartFen;
+            size_t count = std::min(game.mMoves.size(), size_t(std::max(0, plies)));
+            for (size_t ply = 0; ply < count; ply++)
+            {
+                opening.mMoves.push_back(game.mMoves[ply].ToUci());
+            }
+            openings.push_back(std::move(opening));
+        }
+    }
+    else
+    {
+        std::ifstream input(path);
+        if (!input)
+        {
+            return false;
+        }
+        std::vector<EpdPosition> positions;
+        EpdPosition::Load(input, positions);
+        for (auto const &position : positions)
+        {
+            openings.push_back({position.mFen, {}});
+        }
+    }
+    return !openings.empty();
+}
+
+/**
+ * Play the match
+ * @param callback Called with the result of each game as it ends, on
+ * the worker threads but never by two at once, or nullptr
+ * @return False if the PGN file could not be opened or an engine
+ * could not be started
+ */
+bool Match::Run(const std::function<void(const GameResult &)> &callback)
+{
+    auto start = Now();
+    mStats = Stats();
+    mNextPair = 0;
+    mStopping = false;
+    mFailed = false;
+    if (mOpenings.empty())
+    {
+        mOpenings.push_back({Position::StartFen, {}});
+    }
+    if (!mOptions.mSyzygyPath.empty())
+    {
+        mTablebases.Init(mOptions.mSyzygyPath);
+    }
+    if (!mOptions.mPgnPath.empty())
+    {
+        mPgn.open(mOptions.mPgnPath, std::ios::app);
+        if (!mPgn)
+        {
+            return false;
+        }
+    }
+
+    char date[16];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+    mDate = date;
+
+    int pairs = (mOptions.mGames + 1) / 2;
+    int threads = std::max(1, std::min(mOptions.mConcurrency, pairs));
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&Match::Worker, this, std::cref(callback));
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    mPgn.close();
+
+    mStats.mMilliseconds = Now() - start;
+    return !mFailed;
+}
+
+/**
+ * Play pairs of games until there are none left
+ * @param callback Called with the result of each game, or nullptr
+ */
+void Match::Worker(const std::function<void(const GameResult &)> &callback)
+{
+    UciProcess engines[2];
+    int pairs = (mOptions.mGames + 1) / 2;
+    while (!mStopping)
+    {
+        int pair;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mNextPair == pairs)
+            {
+                break;
+            }
+            pair = mNextPair++;
+        }
+
+        // The first engine has white in the first game of a pair. Nothing is
+        // counted until both games are over, so a match cut short never holds
+        // half a pair.
+        size_t opening = size_t(pair) % mOpenings.size();
+        GameResult results[2];
+        PgnGame pgns[2];
+        for (int game = 0; game < 2; game++)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                if (!engines[i].IsRunning() && !StartEngine(engines[i], i))
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mFailed = true;
+                    mStopping = true;
+                    return;
+                }
+            }
+            results[game] = Play(engines, pair * 2 + game + 1, opening, game == 0, pgns[game]);
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (int game = 0; game < 2; game++)
+        {
+            Record(results[game], pgns[game]);
+            if (mPgn.is_open())
+            {
+                pgns[game].Write(mPgn);
+                mPgn.flush();
+            }
+            if (callback)
+            {
+                callback(results[game]);
+            }
+        }
+        mStats.mPairs[results[0].mScore + results[1].mScore]++;
+    }
+}
+
+/**
+ * Count a finished game in the statistics, with the mutex held
+ * @param result How the game ended
+ * @param pgn The game, whose Termination tag is counted
+ */
+void Match::Record(const GameResult &result, const PgnGame &pgn)
+{
+    if (result.mScore == 2)
+    {
+        mStats.mWins++;
+    }
+    else if (result.mScore == 0)
+    {
+        mStats.mLosses++;
+    }
+    else
+    {
+        mStats.mDraws++;
+    }
+
+    std::string termination;
+    for (auto const &tag : pgn.mTags)
+    {
+        if (tag.first == "Termination")
+        {
+            termination = tag.second;
+        }
+    }
+    mStats.mTimeLosses += termination == "time forfeit" ? 1 : 0;
+    mStats.mCrashes += termination == "abandoned" || termination == "rules infraction" ? 1 : 0;
+    mStats.mAdjudicated += termination == "adjudication" ? 1 : 0;
+}
+
+/**
+ * Start an engine, set its options and wait until it is ready
+ * @param process Process to run it in
+ * @param engine Index of the engine in the options
+ * @return False if it did not start or answer
+ */
+bool Match::StartEngine(UciProcess &process, int engine)
+{
+    const MatchEngine &config = mOptions.mEngines[engine];
+    std::string name;
+    if (!process.Start(config.mCommand) || !process.Handshake(&name))
+    {
+        process.Close();
+        return false;
+    }
+    for (auto const &option : config.mOptions)
+    {
+        process.Send("setoption name " + option.first + (option.second.empty() ? "" : " value " + option.second));
+    }
+    if (!process.Send("isready") || !process.WaitFor("readyok", ReadyTimeout))
+    {
+        process.Close();
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mNames[engine].empty())
+    {
+        mNames[engine] = !config.mName.empty() ? config.mName : !name.empty() ? name : "Engine " + std::to_string(engine + 1);
+    }
+    return true;
+}
+
+/**
+ * Play one game
+ * @param engines The two engines, both running
+ * @param round Game number, from 1
+ * @param opening Index of the opening to start from
+ * @param firstIsWhite Does the first engine have white?
+ * @param pgn Receives the game
+ * @return How the game ended
+ */
+Match::GameResult Match::Play(UciProcess *engines, int round, size_t opening, bool firstIsWhite, PgnGame &pgn)
+{
+    const TimeControl &timeControl = mOptions.mTimeControl;
+    GameResult result;
+    result.mRound = round;
+    result.mOpening = opening;
+    result.mFirstIsWhite = firstIsWhite;
+    int white = firstIsWhite ? 0 : 1;
+
+    Position position;
+    position.SetFen(mOpenings[opening].mFen);
+    std::vector<std::string> moves;
+    for (auto const &text : mOpenings[opening].mMoves)
+    {
+        Move move = position.ParseMove(text);
+        if (!move.IsValid())
+        {
+            break;
+        }
+        pgn.mMoves.push_back(position.SanText(move).ToString());
+        position.DoMove(move);
+        moves.push_back(text);
+    }
+
+    int loser = -1;
+    bool drawn = false;
+    std::string termination = "normal";
+    for (int i = 0; i < 2 && loser < 0; i++)
+    {
+        if (!engines[i].Send("ucinewgame") || !engines[i].Send("isready") || !engines[i].WaitFor("readyok", ReadyTimeout))
+        {
+            loser = i;
+            termination = "abandoned";
+            result.mReason = "engine did not answer";
+            engines[i].Close();
+        }
+    }
+
+    int64_t clocks[2] = {timeControl.mBase, timeControl.mBase};
+    int lastScore = 0;
+    bool haveLast = false;
+    int losing = -1;
+    int resignPlies = 0;
+    int drawPlies = 0;
+    while (loser < 0 && !drawn)
+    {
+        int mover = position.SideToMove() == WHITE ? white : 1 - white;
+        if (!position.HasLegalMove())
+        {
+            if (position.InCheck())
+            {
+                loser = mover;
+            }
+            drawn = !position.InCheck();
+            result.mReason = position.InCheck() ? "checkmate" : "stalemate";
+            break;
+        }
+        if (position.HalfmoveClock() >= 100 || position.IsRepetition(2) || position.IsInsufficientMaterial())
+        {
+            drawn = true;
+            result.mReason = position.HalfmoveClock() >= 100 ? "fifty move rule"
+                : position.IsRepetition(2) ? "threefold repetition" : "insufficient material";
+            break;
+        }
+        if (mTablebases.MaxPieces() > 0 && position.CastlingRights() == 0
+            && PopCount(position.Occupied()) <= mTablebases.MaxPieces())
+        {
+            ProbeState state;
+            WdlScore wdl = mTablebases.ProbeWdl(position, state);
+            if (state != PROBE_FAIL)
+            {
+                loser = wdl == WDL_WIN ? 1 - mover : wdl == WDL_LOSS ? mover : -1;
+                drawn = loser < 0;
+                termination = "adjudication";
+                result.mReason = "tablebase";
+                break;
+            }
+        }
+
+        std::string command = "position fen " + mOpenings[opening].mFen;
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            command += (i == 0 ? " moves " : " ") + moves[i];
+        }
+        std::string go;
+        int64_t timeout;
+        if (timeControl.mMoveTime > 0)
+        {
+            go = "go movetime " + std::to_string(timeControl.mMoveTime);
+            timeout = timeControl.mMoveTime + timeControl.mMargin;
+        }
+        else if (timeControl.mNodes > 0)
+        {
+            go = "go nodes " + std::to_string(timeControl.mNodes);
+            timeout = NodesTimeout;
+        }
+        else
+        {
+            go = "go wtime " + std::to_string(clocks[white]) + " btime " + std::to_string(clocks[1 - white])
+                + " winc " + std::to_string(timeControl.mIncrement) + " binc " + std::to_string(timeControl.mIncrement);
+            timeout = clocks[mover] + timeControl.mMargin;
+        }
+
+        UciProcess &engine = engines[mover];
+        int64_t start = Now();
+        engine.Send(command);
+        engine.Send(go);
+        std::string line;
+        std::string best;
+        int score = 0;
+        bool haveScore = false;
+        while (engine.ReadLine(line, start + timeout - Now()))
+        {
+            if (line.compare(0, 5, "info ") == 0)
+            {
+                haveScore = ParseScore(line, score) || haveScore;
+            }
+            else if (line.compare(0, 9, "bestmove ") == 0)
+            {
+                std::istringstream words(line.substr(9));
+                words >> best;
+                break;
+            }
+        }
+        int64_t elapsed = Now() - start;
+
+        if (best.empty())
+        {
+            loser = mover;
+            if (!engine.IsRunning())
+            {
+                termination = "abandoned";
+                result.mReason = "engine died";
+            }
+            else
+            {
+                termination = "time forfeit";
+                result.mReason = "time forfeit";
+                engine.Send("stop");
+                if (!engine.WaitFor("bestmove", StopTimeout))
+                {
+                    // Out of step with the protocol, start it afresh
+                    engine.Close();
+                }
+            }
+            break;
+        }
+        if (timeControl.mMoveTime <= 0 && timeControl.mNodes == 0)
+        {
+            if (elapsed > clocks[mover] + timeControl.mMargin)
+            {
+                loser = mover;
+                termination = "time forfeit";
+                result.mReason = "time forfeit";
+                break;
+            }
+            clocks[mover] = std::max<int64_t>(0, clocks[mover] - elapsed) + timeControl.mIncrement;
+        }
+
+        Move move = position.ParseMove(best);
+        if (!move.IsValid())
+        {
+            loser = mover;
+            termination = "rules infraction";
+            result.mReason = "illegal move " + best;
+            break;
+        }
+        pgn.mMoves.push_back(position.SanText(move).ToString());
+        position.DoMove(move);
+        moves.push_back(best);
+        result.mPlies++;
+
+        // Adjudicate only on what both engines say, move after move
+        if (haveScore && haveLast)
+        {
+            int side = score <= -mOptions.mResignScore && lastScore >= mOptions.mResignScore ? mover
+                : score >= mOptions.mResignScore && lastScore <= -mOptions.mResignScore ? 1 - mover : -1;
+            resignPlies = side >= 0 && side == losing ? resignPlies + 1 : side >= 0 ? 1 : 0;
+            losing = side;
+
+            bool level = std::abs(score) <= mOptions.mDrawScore && std::abs(lastScore) <= mOptions.mDrawScore;
+            drawPlies = level && position.FullmoveNumber() >= mOptions.mDrawMoveNumber ? drawPlies + 1 : 0;
+        }
+        else
+        {
+            resignPlies = 0;
+            drawPlies = 0;
+        }
+        lastScore = score;
+        haveLast = haveScore;
+
+        if (mOptions.mResignMoves > 0 && resignPlies >= 2 * mOptions.mResignMoves)
+        {
+            loser = losing;
+            termination = "adjudication";
+            result.mReason = "score";
+        }
+        else if (mOptions.mDrawMoves > 0 && drawPlies >= 2 * mOptions.mDrawMoves)
+        {
+            drawn = true;
+            termination = "adjudication";
+            result.mReason = "score";
+        }
+    }
+
+    if (drawn)
+    {
+        result.mResult = "1/2-1/2";
+        result.mScore = 1;
+    }
+    else
+    {
+        result.mResult = loser == white ? "0-1" : "1-0";
+        result.mScore = loser == 0 ? 0 : 2;
+    }
+
+    std::string timeControlTag = timeControl.mMoveTime > 0 ? "*" + Seconds(timeControl.mMoveTime)
+        : timeControl.mNodes > 0 ? "-" : Seconds(timeControl.mBase) + "+" + Seconds(timeControl.mIncrement);
+    pgn.mTags = {{"Event", mOptions.mEvent}, {"Site", "?"}, {"Date", mDate}, {"Round", std::to_string(round)},
+                 {"White", mNames[white]}, {"Black", mNames[1 - white]}, {"Result", result.mResult}};
+    if (mOpenings[opening].mFen != Position::StartFen)
+    {
+        pgn.mTags.emplace_back("SetUp", "1");
+        pgn.mTags.emplace_back("FEN", mOpenings[opening].mFen);
+    }
+    pgn.mTags.emplace_back("TimeControl", timeControlTag);
+    pgn.mTags.emplace_back("Termination", termination);
+    pgn.mResult = result.mResult;
+    return result;
+}
+
+/**
+ * Number of games to play at once so that every search thread of
+ * the engines has a core. Only one engine of a game thinks at a time.
+ * @param options Settings for the match, whose engines may set "Threads"
+ * @return Games to play at once, at least 1
+ */
+int Match::DefaultConcurrency(const MatchOptions &options)
+{
+    int cores = int(std::max(1u, std::thread::hardware_concurrency()));
+    int threads = 1;
+    for (auto const &engine : options.mEngines)
+    {
+        for (auto const &option : engine.mOptions)
+        {
+            if (option.first == "Threads")
+            {
+                threads = std::max(threads, std::atoi(option.second.c_str()));
+            }
+        }
+    }
+    return std::max(1, cores / threads);
+}
@@ -0,0 +1,269 @@
+/**
+ * @file Match.h
+ * @author John Korreck
+ *
+ * Plays matches between two UCI engines.
+ */
+
+#ifndef MATCH_H
+#define MATCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Pgn.h"
+#include "Tablebases.h"
+
+class UciProcess;
+
+/**
+ * An engine taking part in a match
+ */
+struct MatchEngine {
+    /// Name for the PGN, empty to use the name the engine gives
+    std::string mName;
+
+    /// Program to run followed by its arguments
+    std::vector<std::string> mCommand;
+
+    /// UCI options set before the first game, as name and value
+    std::vector<std::pair<std::string, std::string>> mOptions;
+};
+
+/**
+ * How long the engines may think
+ */
+struct TimeControl {
+    /// Time for the whole game in milliseconds
+    int64_t mBase = 10000;
+
+    /// Time added after each move in milliseconds
+    int64_t mIncrement = 100;
+
+    /// Fixed time per move in milliseconds, replaces the clock if set
+    int64_t mMoveTime = 0;
+
+    /// Fixed nodes per move, replaces the clock if set
+    uint64_t mNodes = 0;
+
+    /// Time an engine may overstep its clock before it loses, in milliseconds
+    int64_t mMargin = 100;
+};
+
+/**
+ * The position a game starts from
+ */
+struct MatchOpening {
+    /// Start position
+    std::string mFen;
+
+    /// Moves played from it, in UCI notation
+    std::vector<std::string> mMoves;
+};
+
+/**
+ * Settings for a match
+ */
+struct MatchOptions {
+    /// The two engines, results are from the first one's point of view
+    MatchEngine mEngines[2];
+
+    /// Games to play, rounded up to an even number
+    int mGames = 100;
+
+    /// Games played at once
+    int mConcurrency = 1;
+
+    /// How long the engines may think
+    TimeControl mTimeControl;
+
+    /// EPD or PGN file of openings, empty to start every game from the start position
+    std::string mOpenings;
+
+    /// Half moves taken from each game of a PGN opening file
+    int mOpeningPlies = 8;
+
+    /// Syzygy tablebase directories to adjudicate with, empty for none
+    std::string mSyzygyPath;
+
+    /// Move number from which a game may be adjudicated a draw
+    int mDrawMoveNumber = 40;
+
+    /// Moves in a row both engines must score within mDrawScore, 0 to never adjudicate a draw
+    int mDrawMoves = 8;
+
+    /// Largest score in centipawns either side of 0 that counts towards a draw
+    int mDrawScore = 10;
+
+    /// Moves in a row both engines must agree a side is lost, 0 to never adjudicate a win
+    int mResignMoves = 3;
+
+    /// Score in centipawns at which a side counts as lost
+    int mResignScore = 1000;
+
+    /// File the games are appended to, empty for none
+    std::string mPgnPath;
+
+    /// Event tag of the games
+    std::string mEvent = "Match";
+};
+
+/**
+ * Plays games between two engines, each started as its own process
+ * and driven over UCI.
+ *
+ * Games come in pairs that start from the same opening with the
+ * colours swapped, so neither engine gains from a lopsided opening.
+ * Each worker thread starts both engines once, plays whole pairs
+ * and reuses the engines between games, restarting one only when
+ * it dies. An engine thinks only on its own move, so a game keeps
+ * at most one core busy for each search thread of the engines.
+ * DefaultConcurrency() plays as many games at once as there are
+ * cores for that, and no more.
+ *
+ * A game ends by the rules, on time, on an illegal move or a dead
+ * engine, or by adjudication: a tablebase position is scored from
+ * the tables, a game whose engines agree for long enough that one
+ * side is lost or that the position is dead level is ended there.
+ */
+class Match {
+public:
+    /**
+     * How one game ended
+     */
+    struct GameResult {
+        /// Game number, from 1
+        int mRound = 0;
+
+        /// Index of the opening
+        size_t mOpening = 0;
+
+        /// Did the first engine have white?
+        bool mFirstIsWhite = true;
+
+        /// Half points scored by the first engine, 0 to 2
+        int mScore = 1;
+
+        /// "1-0", "0-1" or "1/2-1/2"
+        std::string mResult;
+
+        /// Why the game ended, such as "checkmate" or "time forfeit"
+        std::string mReason;
+
+        /// Half moves played after the opening
+        int mPlies = 0;
+    };
+
+    /**
+     * Results of a match so far, from the first engine's point of view
+     */
+    struct Stats {
+        /// Games won by the first engine
+        uint64_t mWins = 0;
+
+        /// Games drawn
+        uint64_t mDraws = 0;
+
+        /// Games lost by the first engine
+        uint64_t mLosses = 0;
+
+        /// Finished pairs by the half points the first engine scored in them, 0 to 4
+        uint64_t mPairs[5] = {};
+
+        /// Games lost on time
+        uint64_t mTimeLosses = 0;
+
+        /// Games lost to an engine dying or making an illegal move
+        uint64_t mCrashes = 0;
+
+        /// Games ended by adjudication
+        uint64_t mAdjudicated = 0;
+
+        /// Time taken in milliseconds
+        int64_t mMilliseconds = 0;
+
+        /// Games played
+        uint64_t Games() const { return mWins + mDraws + mLosses; }
+    };
+
+private:
+    /// Settings for the match
+    MatchOptions mOptions;
+
+    /// Openings, played in order and from the start again when used up
+    std::vector<MatchOpening> mOpenings;
+
+    /// Tables to adjudicate with
+    Tablebases mTablebases;
+
+    /// Names of the engines for the PGN
+    std::string mNames[2];
+
+    /// Date the match started, for the PGN
+    std::string mDate;
+
+    /// Results so far
+    Stats mStats;
+
+    /// Index of the next pair to play
+    int mNextPair = 0;
+
+    /// No further pairs are to be started
+    std::atomic<bool> mStopping{false};
+
+    /// An engine could not be started
+    bool mFailed = false;
+
+    /// Where the games are written
+    std::ofstream mPgn;
+
+    /// Protects everything above
+    std::mutex mMutex;
+
+    void Worker(const std::function<void(const GameResult &)> &callback);
+    bool StartEngine(UciProcess &process, int engine);
+    GameResult Play(UciProcess *engines, int round, size_t opening, bool firstIsWhite, PgnGame &pgn);
+    void Record(const GameResult &result, const PgnGame &pgn);
+
+public:
+    Match(const MatchOptions &options);
+
+    /// Copy constructor (disabled)
+    Match(const Match &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const Match &) = delete;
+
+    bool LoadOpenings();
+
+    /**
+     * Set the openings instead of loading them
+     * @param openings Openings to play in order
+     */
+    void SetOpenings(const std::vector<MatchOpening> &openings) { mOpenings = openings; }
+
+    bool Run(const std::function<void(const GameResult &)> &callback = nullptr);
+
+    /**
+     * Start no further games. Pairs in progress are finished, so a
+     * match stopped from the result callback still has whole pairs.
+     */
+    void Stop() { mStopping = true; }
+
+    /// Number of openings loaded
+    size_t OpeningCount() const { return mOpenings.size(); }
+
+    /// Results so far, to be read from the result callback or after Run()
+    const Stats &GetStats() const { return mStats; }
+
+    static bool ReadOpenings(const std::string &path, int plies, std::vector<MatchOpening> &openings);
+    static int DefaultConcurrency(const MatchOptions &options);
+};
+
+#endif //MATCH_H
@@ -0,0 +1,41 @@
+/**
+ * @file MaterialHashTable.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "MaterialHashTable.h"
+
+/**
+ * Constructor
+ */
+MaterialHashTable::MaterialHashTable() : mTable(Size)
+{
+}
+
+/**
+ * Find the entry for a material balance. A balance that is not
+ * in the table replaces whatever was in its slot.
+ * @param key Material key
+ * @param found Set to true if the entry already holds the balance
+ * @return The entry, to be filled in by the caller if not found
+ */
+MaterialEntry *MaterialHashTable::Probe(uint64_t key, bool &found)
+{
+    MaterialEntry *entry = &mTable[key & (Size - 1)];
+    found = entry->mKey == key && key != 0;
+    if (!found)
+    {
+        *entry = MaterialEntry();
+        entry->mKey = key;
+    }
+    return entry;
+}
+
+/**
+ * Erase every entry
+ */
+void MaterialHashTable::Clear()
+{
+    std::fill(mTable.begin(), mTable.end(), MaterialEntry());
+}
@@ -0,0 +1,66 @@
+/**
+ * @file MaterialHashTable.h
+ * @author John Korreck
+ *
+ * Small hash table caching what follows from the material alone.
+ */
+
+#ifndef MATERIALHASHTABLE_H
+#define MATERIALHASHTABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ChessTypes.h"
+#include "Endgame.h"
+
+/**
+ * Everything the evaluation knows about one material balance
+ */
+struct MaterialEntry {
+    /// Material key of the balance
+    uint64_t mKey = 0;
+
+    /// Imbalance bonus, white minus black
+    int mImbalance = 0;
+
+    /// Game phase from 0 for bare kings to 24 for a full board
+    int mPhase = 0;
+
+    /// Evaluation replacing the normal one, nullptr if none
+    EndgameFunction mEndgame = nullptr;
+
+    /// Color the endgame function is called for
+    int mEndgameColor = WHITE;
+
+    /// Scaling when the evaluation favours a side, indexed by ColorIndex()
+    ScaleFunction mScale[2] = {nullptr, nullptr};
+
+    /// Scale factor used when there is no scale function or it has no opinion
+    int mScaleFactor[2] = {SCALE_NORMAL, SCALE_NORMAL};
+};
+
+/**
+ * Material cache keyed by Position::MaterialKey().
+ *
+ * Captures are rare compared to other moves, so the phase, the
+ * imbalance and the choice of endgame evaluation are found once
+ * for each balance. Each Evaluation owns its own table, so no
+ * locking is needed.
+ */
+class MaterialHashTable {
+private:
+    /// Number of entries, a power of two
+    static const size_t Size = 8192;
+
+    /// The entries
+    std::vector<MaterialEntry> mTable;
+
+public:
+    MaterialHashTable();
+
+    MaterialEntry *Probe(uint64_t key, bool &found);
+    void Clear();
+};
+
+#endif //MATERIALHASHTABLE_H
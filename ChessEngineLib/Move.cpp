@@ -0,0 +1,29 @@
+/**
+ * @file Move.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Move.h"
+
+/**
+ * Write the move in UCI long algebraic notation
+ * @return Move text such as "e2e4" or "e7e8q"
+ */
+MoveText Move::UciText() const
+{
+    MoveText text;
+    if (!IsValid())
+    {
+        text.Add(mData == 0 ? "(none)" : "0000");
+        return text;
+    }
+
+    text.AddSquare(From());
+    text.AddSquare(To());
+    if (GetType() == PROMOTION)
+    {
+        text.Add("  pnbrq"[PromotionType()]);
+    }
+    return text;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file Move.h
+ * @author John Korreck
+ *
+ * Packed 16 bit move representation used by the engine.
+ */
+
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ChessTypes.h"
+
+/**
+ * A move written out in a fixed buffer, so that writing
+ * moves in UCI or SAN notation never allocates. The longest
+ * moves are "Qh4xe1+", "exd8=Q+" and "(none)".
+ */
+class MoveText {
+private:
+    /// The characters, not terminated
+    char mText[8] = {};
+
+    /// Number of characters
+    uint8_t mSize = 0;
+
+public:
+    /**
+     * Add a character
+     * @param c Character to add
+     */
+    void Add(char c) { mText[mSize++] = c; }
+
+    /**
+     * Add the name of a square
+     * @param square Square index
+     */
+    void AddSquare(int square)
+    {
+        Add(char('a' + FileOf(square)));
+        Add(char('1' + RankOf(square)));
+    }
+
+    /**
+     * Add several characters
+     * @param text Characters to add
+     */
+    void Add(std::string_view text)
+    {
+        for (char c : text)
+        {
+            Add(c);
+        }
+    }
+
+    /// The text written
+    std::string_view View() const { return {mText, mSize}; }
+
+    /// Number of characters
+    int Size() const { return mSize; }
+
+    /// The text written as a string
+    std::string ToString() const { return std::string(mText, mSize); }
+
+    bool operator==(std::string_view other) const { return View() == other; }
+};
+
+/**
+ * A move packed into 16 bits.
+ *
+ * Bits 0-5 hold the from square, bits 6-11 the to square,
+ * bits 12-13 the promotion piece (knight to queen) and
+ * bits 14-15 the move type. Castling is encoded as the
+ * king moving two squares, the same way UCI writes it.
+ */
+class Move {
+private:
+    /// The packed move
+    uint16_t mData = 0;
+
+    explicit Move(uint16_t data) : mData(data) {}
+
+public:
+    /// Move types stored in the top two bits
+    enum Type { NORMAL = 0, PROMOTION = 1 << 14, EN_PASSANT = 2 << 14, CASTLING = 3 << 14 };
+
+    /// Default constructor creates Move::None()
+    Move() = default;
+
+    /**
+     * Constructor for a normal move
+     * @param from Square the piece moves from
+     * @param to Square the piece moves to
+     */
+    Move(int from, int to) : mData(uint16_t(from | (to << 6))) {}
+
+    /**
+     * Create a move of a given type
+     * @param from Square the piece moves from
+     * @param to Square the piece moves to
+     * @param type One of the Move::Type values
+     * @param promotion Piece type to promote to
+     * @return The packed move
+     */
+    static Move Make(int from, int to, int type, int promotion = KNIGHT)
+    {
+        return Move(uint16_t(from | (to << 6) | ((promotion - KNIGHT) << 12) | type));
+    }
+
+    /// The empty move
+    static Move None() { return Move(); }
+
+    /// The null move (a pass), used by null move pruning
+    static Move Null() { return Move(65); }
+
+    /**
+     * Recreate a move from its packed bits
+     * @param data Value returned by Raw()
+     * @return The move
+     */
+    static Move FromRaw(uint16_t data) { return Move(data); }
+
+    int From() const { return mData & 63; }
+    int To() const { return (mData >> 6) & 63; }
+    int GetType() const { return mData & (3 << 14); }
+    int PromotionType() const { return ((mData >> 12) & 3) + KNIGHT; }
+    uint16_t Raw() const { return mData; }
+
+    /// Is this a real move (not None or Null)?
+    bool IsValid() const { return From() != To(); }
+
+    bool operator==(const Move &other) const { return mData == other.mData; }
+    bool operator!=(const Move &other) const { return mData != other.mData; }
+
+    MoveText UciText() const;
+
+    /// Convert the move to UCI long algebraic notation, see UciText()
+    std::string ToUci() const { return UciText().ToString(); }
+};
+
+/// Most moves possible in any legal chess position
+const int MAX_MOVES = 256;
+
+/**
+ * Fixed capacity list of moves, avoids heap
+ * allocation in the move generator.
+ */
+class MoveList {
+private:
+    /// The moves
+    Move mMoves[MAX_MOVES];
+
+    /// Number of moves in the list
+    int mSize = 0;
+
+public:
+    void Add(Move move) { mMoves[mSize++] = move; }
+    void Clear() { mSize = 0; }
+    int Size() const { return mSize; }
+    bool Empty() const { return mSize == 0; }
+    Move &operator[](int i) { return mMoves[i]; }
+    const Move &operator[](int i) const { return mMoves[i]; }
+    Move *begin() { return mMoves; }
+    Move *end() { return mMoves + mSize; }
+    const Move *begin() const { return mMoves; }
+    const Move *end() const { return mMoves + mSize; }
+
+    /**
+     * Is a move in this list?
+     * @param move Move to look for
+     * @return True if found
+     */
+    bool Contains(Move move) const
+    {
+        for (int i = 0; i < mSize; i++)
+        {
+            if (mMoves[i] == move)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif //MOVE_H
@@ -0,0 +1,257 @@
+/**
+ * @file MovePicker.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "MovePicker.h"
+#include "Evaluation.h"
+
+/**
+ * Constructor for the main search
+ * @param position Position to pick moves in
+ * @param ttMove Move from the transposition table, may be anything
+ * @param killers The two killer moves for this ply
+ * @param history Cutoff history by piece and to square
+ */
+MovePicker::MovePicker(const Position &position, Move ttMove, const Move killers[2], const int history[][SQUARE_NB])
+    : mPosition(position), mHistory(history), mKillers{killers[0], killers[1]}
+{
+    mStage = position.InCheck() ? EVASION_TT : MAIN_TT;
+    mTTMove = position.IsPseudoLegal(ttMove) ? ttMove : Move::None();
+    if (!mTTMove.IsValid())
+    {
+        mStage++;
+    }
+}
+
+/**
+ * Constructor for the quiescence search. Only captures and queen
+ * promotions are picked unless the side to move is in check.
+ * @param position Position to pick moves in
+ * @param ttMove Move from the transposition table, may be anything
+ * @param history Cutoff history by piece and to square
+ */
+MovePicker::MovePicker(const Position &position, Move ttMove, const int history[][SQUARE_NB])
+    : mPosition(position), mHistory(history)
+{
+    mStage = position.InCheck() ? EVASION_TT : QSEARCH_TT;
+    bool usable = position.IsPseudoLegal(ttMove)
+        && (position.InCheck() || position.IsCapture(ttMove) || ttMove.GetType() == Move::PROMOTION);
+    mTTMove = usable ? ttMove : Move::None();
+    if (!mTTMove.IsValid())
+    {
+        mStage++;
+    }
+}
+
+/**
+ * Constructor for the root, where the moves are already ordered
+ * @param position Position to pick moves in
+ * @param rootMoves Moves to hand out, in this order
+ */
+MovePicker::MovePicker(const Position &position, const MoveList &rootMoves)
+    : mPosition(position), mHistory(nullptr), mStage(ROOT_MOVES), mMoves(rootMoves)
+{
+}
+
+/**
+ * Score captures by most valuable victim, least valuable attacker.
+ * Queen promotions without a capture go after the captures.
+ */
+void MovePicker::ScoreCaptures()
+{
+    for (int i = 0; i < mMoves.Size(); i++)
+    {
+        Move move = mMoves[i];
+        if (!mPosition.IsCapture(move))
+        {
+            mScores[i] = -1;
+            continue;
+        }
+        int victim = move.GetType() == Move::EN_PASSANT ? PAWN : TypeOf(mPosition.PieceOn(move.To()));
+        int attacker = TypeOf(mPosition.PieceOn(move.From()));
+        mScores[i] = PieceValue[victim] * 10 - PieceValue[attacker] / 10;
+    }
+}
+
+/**
+ * Score quiet moves by their cutoff history, under promotions last
+ */
+void MovePicker::ScoreQuiets()
+{
+    for (int i = 0; i < mMoves.Size(); i++)
+    {
+        Move move = mMoves[i];
+        if (move.GetType() == Move::PROMOTION)
+        {
+            mScores[i] = -1000000;
+            continue;
+        }
+        mScores[i] = mHistory[mPosition.PieceOn(move.From())][move.To()];
+    }
+}
+
+/**
+ * Score evasions, captures of the checker first
+ */
+void MovePicker::ScoreEvasions()
+{
+    for (int i = 0; i < mMoves.Size(); i++)
+    {
+        Move move = mMoves[i];
+        if (mPosition.IsCapture(move))
+        {
+            int victim = move.GetType() == Move::EN_PASSANT ? PAWN : TypeOf(mPosition.PieceOn(move.To()));
+            int attacker = TypeOf(mPosition.PieceOn(move.From()));
+            mScores[i] = 1000000 + PieceValue[victim] * 10 - PieceValue[attacker] / 10;
+        }
+        else
+        {
+            mScores[i] = mHistory[mPosition.PieceOn(move.From())][move.To()];
+        }
+    }
+}
+
+/**
+ * Take the best scored move that has not been handed out yet
+ * @return The move, Move::None() when the stage is used up
+ */
+Move MovePicker::PickBest()
+{
+    if (mIndex >= mMoves.Size())
+    {
+        return Move::None();
+    }
+
+    int best = mIndex;
+    for (int i = mIndex + 1; i < mMoves.Size(); i++)
+    {
+        if (mScores[i] > mScores[best])
+        {
+            best = i;
+        }
+    }
+    std::swap(mMoves[mIndex], mMoves[best]);
+    std::swap(mScores[mIndex], mScores[best]);
+    return mMoves[mIndex++];
+}
+
+/**
+ * Get the next move to search
+ * @return The move, Move::None() once every move has been picked
+ */
+Move MovePicker::NextMove()
+{
+    while (true)
+    {
+        switch (mStage)
+        {
+        case MAIN_TT:
+        case EVASION_TT:
+        case QSEARCH_TT:
+            mStage++;
+            return mTTMove;
+
+        case CAPTURE_INIT:
+        case QCAPTURE_INIT:
+            mMoves.Clear();
+            mIndex = 0;
+            mPosition.GenerateMoves<CAPTURES>(mMoves);
+            ScoreCaptures();
+            mStage++;
+            break;
+
+        case CAPTURE_MOVES:
+        case QCAPTURE_MOVES:
+        {
+            Move move = PickBest();
+            if (!move.IsValid())
+            {
+                // Killers are tried in order, mIndex counts them
+                mStage = mStage == CAPTURE_MOVES ? KILLERS : DONE;
+                mIndex = 0;
+                break;
+            }
+            if (move != mTTMove)
+            {
+                return move;
+            }
+            break;
+        }
+
+        case KILLERS:
+        {
+            if (mIndex >= 2)
+            {
+                mStage++;
+                break;
+            }
+            Move killer = mKillers[mIndex++];
+            if (killer != mTTMove && !mPosition.IsCapture(killer) && killer.GetType() != Move::PROMOTION
+                && mPosition.IsPseudoLegal(killer))
+            {
+                return killer;
+            }
+            break;
+        }
+
+        case QUIET_INIT:
+            mMoves.Clear();
+            mIndex = 0;
+            mPosition.GenerateMoves<QUIETS>(mMoves);
+            ScoreQuiets();
+            mStage++;
+            break;
+
+        case QUIET_MOVES:
+        {
+            Move move = PickBest();
+            if (!move.IsValid())
+            {
+                mStage = DONE;
+                break;
+            }
+            if (move != mTTMove && move != mKillers[0] && move != mKillers[1])
+            {
+                return move;
+            }
+            break;
+        }
+
+        case EVASION_INIT:
+            mMoves.Clear();
+            mIndex = 0;
+            mPosition.GenerateMoves<EVASIONS>(mMoves);
+            ScoreEvasions();
+            mStage++;
+            break;
+
+        case EVASION_MOVES:
+        {
+            Move move = PickBest();
+            if (!move.IsValid())
+            {
+                mStage = DONE;
+                break;
+            }
+            if (move != mTTMove)
+            {
+                return move;
+            }
+            break;
+        }
+
+        case ROOT_MOVES:
+            if (mIndex < mMoves.Size())
+            {
+                return mMoves[mIndex++];
+            }
+            mStage = DONE;
+            break;
+
+        default:
+            return Move::None();
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file MovePicker.h
+ * @author John Korreck
+ *
+ * Hands out the moves of a position one at a time, best guesses
+ * first, generating each group of moves only when it is reached.
+ */
+
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "Position.h"
+
+/**
+ * Staged move ordering for the search.
+ *
+ * The hash move is validated with Position::IsPseudoLegal and tried
+ * before anything is generated, since it very often causes a cutoff
+ * on its own. Then come the captures, best victim first, the killer
+ * moves and finally the quiet moves by history. When in check the
+ * evasions follow the hash move instead.
+ *
+ * Moves are pseudo-legal, the caller still tests Position::IsLegal.
+ */
+class MovePicker {
+private:
+    /// Steps the picker goes through, in order
+    enum Stage {
+        MAIN_TT, CAPTURE_INIT, CAPTURE_MOVES, KILLERS, QUIET_INIT, QUIET_MOVES,
+        EVASION_TT, EVASION_INIT, EVASION_MOVES,
+        QSEARCH_TT, QCAPTURE_INIT, QCAPTURE_MOVES,
+        ROOT_MOVES,
+        DONE
+    };
+
+    /// Position the moves are for
+    const Position &mPosition;
+
+    /// Cutoff history by piece and to square
+    const int (*mHistory)[SQUARE_NB];
+
+    /// Move from the transposition table, Move::None() if none
+    Move mTTMove;
+
+    /// Killer moves for this ply
+    Move mKillers[2];
+
+    /// Current stage
+    int mStage;
+
+    /// Moves of the current stage
+    MoveList mMoves;
+
+    /// Ordering score of each move in mMoves
+    int mScores[MAX_MOVES] = {};
+
+    /// Next move of mMoves to hand out
+    int mIndex = 0;
+
+    void ScoreCaptures();
+    void ScoreQuiets();
+    void ScoreEvasions();
+    Move PickBest();
+
+public:
+    MovePicker(const Position &position, Move ttMove, const Move killers[2], const int history[][SQUARE_NB]);
+    MovePicker(const Position &position, Move ttMove, const int history[][SQUARE_NB]);
+    MovePicker(const Position &position, const MoveList &rootMoves);
+
+    /// Copy constructor (disabled)
+    MovePicker(const MovePicker &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const MovePicker &) = delete;
+
+    Move NextMove();
+};
+
+#endif //MOVEPICKER_H
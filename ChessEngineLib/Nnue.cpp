@@ -0,0 +1,329 @@
+/**
+ * @file Nnue.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Nnue.h"
+#include "Position.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iterator>
+
+// A default network given at build time with EMBEDDED_NETWORK is
+// assembled straight into the read-only data of the program
+#if defined(EMBEDDED_NETWORK) && (defined(__GNUC__) || defined(__clang__))
+#if defined(__APPLE__)
+#define EMBED_SECTION ".const_data\n"
+#define EMBED_SYMBOL(name) "_" #name
+#elif defined(_WIN32)
+#define EMBED_SECTION ".section .rdata,\"dr\"\n"
+#define EMBED_SYMBOL(name) #name
+#else
+#define EMBED_SECTION ".section .rodata\n"
+#define EMBED_SYMBOL(name) #name
+#endif
+asm(EMBED_SECTION
+    ".balign 64\n"
+    ".globl " EMBED_SYMBOL(EmbeddedNetworkBegin) "\n"
+    EMBED_SYMBOL(EmbeddedNetworkBegin) ":\n"
+    ".incbin \"" EMBEDDED_NETWORK "\"\n"
+    ".globl " EMBED_SYMBOL(EmbeddedNetworkEnd) "\n"
+    EMBED_SYMBOL(EmbeddedNetworkEnd) ":\n"
+    ".text\n");
+extern "C" const unsigned char EmbeddedNetworkBegin[];
+extern "C" const unsigned char EmbeddedNetworkEnd[];
+#define HAVE_EMBEDDED_NETWORK
+#endif
+
+/// Size of the file header in bytes
+const size_t HeaderSize = 6 * 4;
+
+/// Value size and count of each block after the header, in file order
+const std::pair<size_t, size_t> Blocks[] = {
+    {2, NnueHalfDims},
+    {2, size_t(NnueFeatures) * NnueHalfDims},
+    {4, NnueHidden1},
+    {1, NnueHidden1 * 2 * NnueHalfDims},
+    {4, NnueHidden2},
+    {1, NnueHidden2 * NnueHidden1},
+    {4, 1},
+    {1, NnueHidden2},
+};
+
+/**
+ * Read a little endian uint32
+ * @param bytes The four bytes
+ * @return The value
+ */
+static uint32_t ReadLittle32(const unsigned char *bytes)
+{
+    return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+/**
+ * Constructor, no network is loaded yet
+ */
+Network::Network() : mKernels(&GetNnueKernels(DetectSimdLevel()))
+{
+}
+
+/**
+ * Point the layers into a network file held in memory
+ * @param data The file, which must stay where it is, already
+ * in the byte order of this machine
+ * @param size Size of the file in bytes
+ * @return False if it is not a network of this architecture
+ */
+bool Network::Bind(const unsigned char *data, size_t size)
+{
+    size_t expected = HeaderSize;
+    for (auto [valueSize, count] : Blocks)
+    {
+        expected += valueSize * count;
+    }
+    if (size != expected
+        || ReadLittle32(data) != NnueMagic || ReadLittle32(data + 4) != NnueVersion
+        || ReadLittle32(data + 8) != uint32_t(NnueFeatures) || ReadLittle32(data + 12) != uint32_t(NnueHalfDims)
+        || ReadLittle32(data + 16) != uint32_t(NnueHidden1) || ReadLittle32(data + 20) != uint32_t(NnueHidden2))
+    {
+        return false;
+    }
+
+    const unsigned char *blocks[std::size(Blocks)];
+    const unsigned char *next = data + HeaderSize;
+    for (size_t i = 0; i < std::size(Blocks); i++)
+    {
+        blocks[i] = next;
+        next += Blocks[i].first * Blocks[i].second;
+    }
+    mFeatureBiases = reinterpret_cast<const int16_t *>(blocks[0]);
+    mFeatureWeights = reinterpret_cast<const int16_t *>(blocks[1]);
+    mHidden1Biases = reinterpret_cast<const int32_t *>(blocks[2]);
+    mHidden1Weights = reinterpret_cast<const int8_t *>(blocks[3]);
+    mHidden2Biases = reinterpret_cast<const int32_t *>(blocks[4]);
+    mHidden2Weights = reinterpret_cast<const int8_t *>(blocks[5]);
+    mOutputBias = reinterpret_cast<const int32_t *>(blocks[6]);
+    mOutputWeights = reinterpret_cast<const int8_t *>(blocks[7]);
+    mLoaded = true;
+    return true;
+}
+
+/**
+ * Use a network file read into memory
+ * @param buffer The file, taken over by the network
+ * @return False if it is not a network of this architecture, in
+ * which case the current network is kept
+ */
+bool Network::LoadBuffer(std::vector<unsigned char> buffer)
+{
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        // Turn every value after the header around
+        unsigned char *next = buffer.data() + std::min(HeaderSize, buffer.size());
+        for (auto [valueSize, count] : Blocks)
+        {
+            for (size_t i = 0; i < count && next + valueSize <= buffer.data() + buffer.size(); i++)
+            {
+                std::reverse(next, next + valueSize);
+                next += valueSize;
+            }
+        }
+    }
+
+    Network network;
+    network.mKernels = mKernels;
+    network.mBuffer = std::move(buffer);
+    if (!network.Bind(network.mBuffer.data(), network.mBuffer.size()))
+    {
+        return false;
+    }
+    *this = std::move(network);
+    return true;
+}
+
+/**
+ * Read a network
+ * @param stream Stream positioned at the start of the network
+ * @return False if it is not a network of this architecture, in
+ * which case the current network is kept
+ */
+bool Network::Load(std::istream &stream)
+{
+    std::vector<unsigned char> buffer;
+    const size_t chunk = 1 << 20;
+    while (stream)
+    {
+        size_t used = buffer.size();
+        buffer.resize(used + chunk);
+        stream.read(reinterpret_cast<char *>(buffer.data() + used), std::streamsize(chunk));
+        buffer.resize(used + size_t(stream.gcount()));
+    }
+    return LoadBuffer(std::move(buffer));
+}
+
+/**
+ * Map a network file and use it in place
+ * @param path File name
+ * @return False if the file could not be read or is not a network,
+ * in which case the current network is kept
+ */
+bool Network::Load(const std::string &path)
+{
+    if constexpr (std::endian::native == std::endian::little)
+    {
+        Network network;
+        network.mKernels = mKernels;
+        if (!network.mFile.Open(path) || !network.Bind(network.mFile.Data(), network.mFile.Size()))
+        {
+            return false;
+        }
+        *this = std::move(network);
+        return true;
+    }
+
+    std::ifstream stream(path, std::ios::binary);
+    return stream && Load(stream);
+}
+
+/**
+ * Is a default network compiled into the program?
+ * @return True if LoadEmbedded() can succeed
+ */
+bool Network::HasEmbedded()
+{
+#ifdef HAVE_EMBEDDED_NETWORK
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Use the network compiled into the program
+ * @return False if there is none, in which case the current network is kept
+ */
+bool Network::LoadEmbedded()
+{
+#ifdef HAVE_EMBEDDED_NETWORK
+    size_t size = size_t(EmbeddedNetworkEnd - EmbeddedNetworkBegin);
+    if constexpr (std::endian::native == std::endian::little)
+    {
+        Network network;
+        network.mKernels = mKernels;
+        if (!network.Bind(EmbeddedNetworkBegin, size))
+        {
+            return false;
+        }
+        *this = std::move(network);
+        return true;
+    }
+    return LoadBuffer(std::vector<unsigned char>(EmbeddedNetworkBegin, EmbeddedNetworkEnd));
+#else
+    return false;
+#endif
+}
+
+/**
+ * Choose the instruction set used for inference. The result
+ * is the same for all of them, only the speed differs.
+ * @param level Wanted instruction set, lowered if not supported
+ */
+void Network::SetSimdLevel(SimdLevel level)
+{
+    mKernels = &GetNnueKernels(level);
+}
+
+/**
+ * Get the input a piece feeds in one half of the network.
+ * Black sees the board flipped, so both halves share weights.
+ * @param perspective WHITE or BLACK, whose half this is
+ * @param kingSquare Square of that side's king
+ * @param piece Non-king piece code
+ * @param square Square of the piece
+ * @return Feature index
+ */
+int Network::FeatureIndex(int perspective, int kingSquare, int piece, int square)
+{
+    int flip = perspective == WHITE ? 0 : 56;
+    int kind = (TypeOf(piece) - PAWN) * 2 + (ColorOf(piece) == perspective ? 0 : 1);
+    return ((kingSquare ^ flip) * 10 + kind) * 64 + (square ^ flip);
+}
+
+/**
+ * Compute one half of the first layer from scratch
+ * @param position Position to evaluate
+ * @param perspective WHITE or BLACK, which half to compute
+ * @param accumulator Receives the half
+ */
+void Network::Refresh(const Position &position, int perspective, NnueAccumulator &accumulator) const
+{
+    int16_t *values = accumulator.mValues[ColorIndex(perspective)];
+    std::copy_n(mFeatureBiases, NnueHalfDims, values);
+
+    // Gather the rows first so the kernel can sum them in registers
+    const int16_t *rows[SQUARE_NB];
+    int rowCount = 0;
+    int king = position.KingSquare(perspective);
+    for (int color : {WHITE, BLACK})
+    {
+        for (int type = PAWN; type <= QUEEN; type++)
+        {
+            int piece = color + type;
+            const int *squares = position.Squares(piece);
+            for (int i = 0; i < position.PieceCount(piece); i++)
+            {
+                int feature = FeatureIndex(perspective, king, piece, squares[i]);
+                rows[rowCount++] = FeatureRow(feature);
+            }
+        }
+    }
+    mKernels->mAddRows(values, rows, rowCount, NnueHalfDims);
+}
+
+/**
+ * Run the layers after the first one
+ * @param accumulator First layer output for both sides
+ * @param sideToMove WHITE or BLACK
+ * @return Score in centipawns from the side to move's point of view
+ */
+int Network::Propagate(const NnueAccumulator &accumulator, int sideToMove) const
+{
+    alignas(64) uint8_t input[2 * NnueHalfDims];
+    mKernels->mClamp(accumulator.mValues[ColorIndex(sideToMove)], input, NnueHalfDims);
+    mKernels->mClamp(accumulator.mValues[ColorIndex(Opponent(sideToMove))], input + NnueHalfDims, NnueHalfDims);
+
+    alignas(64) int32_t sums[NnueHidden1];
+    alignas(64) uint8_t hidden1[NnueHidden1];
+    mKernels->mAffine(input, 2 * NnueHalfDims, mHidden1Weights, mHidden1Biases, sums, NnueHidden1);
+    for (int i = 0; i < NnueHidden1; i++)
+    {
+        hidden1[i] = uint8_t(std::clamp(sums[i] >> NnueWeightShift, 0, 127));
+    }
+
+    alignas(64) uint8_t hidden2[NnueHidden2];
+    mKernels->mAffine(hidden1, NnueHidden1, mHidden2Weights, mHidden2Biases, sums, NnueHidden2);
+    for (int i = 0; i < NnueHidden2; i++)
+    {
+        hidden2[i] = uint8_t(std::clamp(sums[i] >> NnueWeightShift, 0, 127));
+    }
+
+    int32_t output;
+    mKernels->mAffine(hidden2, NnueHidden2, mOutputWeights, mOutputBias, &output, 1);
+    return output / NnueOutputScale;
+}
+
+/**
+ * Evaluate a position, computing the first layer from scratch
+ * @param position Position to evaluate
+ * @return Score in centipawns from the side to move's point of view
+ */
+int Network::Evaluate(const Position &position) const
+{
+    NnueAccumulator accumulator;
+    Refresh(position, WHITE, accumulator);
+    Refresh(position, BLACK, accumulator);
+    return Propagate(accumulator, position.SideToMove());
+}
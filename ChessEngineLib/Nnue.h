@@ -0,0 +1,152 @@
+/**
+ * @file Nnue.h
+ * @author John Korreck
+ *
+ * Efficiently updatable neural network evaluation.
+ */
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "NnueKernels.h"
+
+class Position;
+
+/// Inputs of one half of the network: own king square, ten kinds of
+/// non-king piece and the square that piece is on (HalfKP)
+const int NnueFeatures = 64 * 10 * 64;
+
+/// Size of the accumulator for one side
+const int NnueHalfDims = 256;
+
+/// Size of the first hidden layer
+const int NnueHidden1 = 32;
+
+/// Size of the second hidden layer
+const int NnueHidden2 = 32;
+
+/// Hidden layer sums are shifted right this much before clamping
+const int NnueWeightShift = 6;
+
+/// The network output divided by this is in centipawns
+const int NnueOutputScale = 16;
+
+/// First four bytes of a network file
+const uint32_t NnueMagic = 0x45554E4E;
+
+/// Format version of a network file
+const uint32_t NnueVersion = 1;
+
+/// EvalFile name of the network compiled into the program
+const std::string EmbeddedNetworkName = "<embedded>";
+
+/**
+ * The first layer output for both sides, indexed by ColorIndex()
+ */
+struct NnueAccumulator {
+    /// Feature transformer sums seen from white and from black
+    alignas(64) int16_t mValues[2][NnueHalfDims];
+};
+
+/**
+ * A quantized HalfKP network.
+ *
+ * Each side's half of the first layer sums one weight row for every
+ * piece other than the kings, seen from that side's king. Both halves
+ * are clamped to 0..127, the side to move first, and go through two
+ * small int8 layers to a single output.
+ *
+ * The file is little endian: magic, version, the layer sizes as four
+ * uint32 values, then the biases and weights of each layer in order.
+ * Every block starts at a multiple of its value size, so on little
+ * endian machines the layers are used in place, straight from a
+ * mapped file or from the network compiled into the program. The
+ * network is read-only once loaded and shared by all searches.
+ */
+class Network {
+private:
+    /// Holds the file when it was read from a stream
+    std::vector<unsigned char> mBuffer;
+
+    /// Holds the file when it is mapped
+    MappedFile mFile;
+
+    // The layers point into the file, wherever it is kept
+
+    /// Feature transformer biases
+    const int16_t *mFeatureBiases = nullptr;
+
+    /// Feature transformer weights, NnueHalfDims per feature
+    const int16_t *mFeatureWeights = nullptr;
+
+    /// First hidden layer biases
+    const int32_t *mHidden1Biases = nullptr;
+
+    /// First hidden layer weights, one row of 2 * NnueHalfDims per output
+    const int8_t *mHidden1Weights = nullptr;
+
+    /// Second hidden layer biases
+    const int32_t *mHidden2Biases = nullptr;
+
+    /// Second hidden layer weights, one row of NnueHidden1 per output
+    const int8_t *mHidden2Weights = nullptr;
+
+    /// Output bias
+    const int32_t *mOutputBias = nullptr;
+
+    /// Output weights, one per second layer output
+    const int8_t *mOutputWeights = nullptr;
+
+    /// Kernels used for inference
+    const NnueKernels *mKernels;
+
+    /// True once a network was read successfully
+    bool mLoaded = false;
+
+    bool Bind(const unsigned char *data, size_t size);
+    bool LoadBuffer(std::vector<unsigned char> buffer);
+
+public:
+    Network();
+
+    bool Load(std::istream &stream);
+    bool Load(const std::string &path);
+    bool LoadEmbedded();
+
+    static bool HasEmbedded();
+
+    /// Was a network read successfully?
+    bool IsLoaded() const { return mLoaded; }
+
+    void SetSimdLevel(SimdLevel level);
+
+    /// Name of the kernels used for inference
+    const char *KernelName() const { return mKernels->mName; }
+
+    /// Kernels used for inference
+    const NnueKernels &Kernels() const { return *mKernels; }
+
+    /// Feature transformer biases, the first layer with no pieces
+    const int16_t *FeatureBiases() const { return mFeatureBiases; }
+
+    /**
+     * Weights a feature adds to the first layer
+     * @param feature Index from FeatureIndex()
+     * @return NnueHalfDims weights
+     */
+    const int16_t *FeatureRow(int feature) const { return mFeatureWeights + size_t(feature) * NnueHalfDims; }
+
+    static int FeatureIndex(int perspective, int kingSquare, int piece, int square);
+
+    void Refresh(const Position &position, int perspective, NnueAccumulator &accumulator) const;
+    int Propagate(const NnueAccumulator &accumulator, int sideToMove) const;
+    int Evaluate(const Position &position) const;
+};
+
+#endif //NNUE_H
@@ -0,0 +1,549 @@
+/**
+ * @file NnueKernels.cpp
+ * @author John Korreck
+ *
+ * The vector versions are compiled for their instruction set with
+ * function attributes, so the rest of the program still runs on any
+ * x86-64 machine. Which ones are used is decided by DetectSimdLevel().
+ */
+
+#include "pch.h"
+#include "NnueKernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NNUE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NNUE_TARGET(features) __attribute__((target(features)))
+#else
+#define NNUE_TARGET(features)
+#endif
+
+//
+// Scalar versions, also the reference the others must match
+//
+
+/**
+ * Add a weight row to an accumulator
+ * @param accumulator Accumulator values, count long
+ * @param row Weight row to add, count long
+ * @param count Number of values
+ */
+static void AddRowScalar(int16_t *accumulator, const int16_t *row, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        accumulator[i] = int16_t(accumulator[i] + row[i]);
+    }
+}
+
+/**
+ * Subtract a weight row from an accumulator
+ * @param accumulator Accumulator values, count long
+ * @param row Weight row to subtract, count long
+ * @param count Number of values
+ */
+static void SubRowScalar(int16_t *accumulator, const int16_t *row, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        accumulator[i] = int16_t(accumulator[i] - row[i]);
+    }
+}
+
+/**
+ * Add several weight rows to an accumulator, one after another
+ * @param accumulator Accumulator values, count long
+ * @param rows Weight rows to add, each count long
+ * @param rowCount Number of rows
+ * @param count Number of values in each row
+ */
+static void AddRowsScalar(int16_t *accumulator, const int16_t *const *rows, int rowCount, int count)
+{
+    for (int r = 0; r < rowCount; r++)
+    {
+        AddRowScalar(accumulator, rows[r], count);
+    }
+}
+
+/**
+ * Clamp accumulator values to 0..127 as the first layer's inputs
+ * @param accumulator Accumulator values, count long
+ * @param output Receives the clamped values
+ * @param count Number of values
+ */
+static void ClampScalar(const int16_t *accumulator, uint8_t *output, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        output[i] = uint8_t(std::clamp<int>(accumulator[i], 0, 127));
+    }
+}
+
+/**
+ * Fully connected layer, output = biases + weights * input
+ * @param input Layer inputs, each 0..127
+ * @param inputs Number of inputs
+ * @param weights One row of inputs weights for each output
+ * @param biases Bias of each output
+ * @param output Receives the outputs
+ * @param outputs Number of outputs
+ */
+static void AffineScalar(const uint8_t *input, int inputs, const int8_t *weights,
+                         const int32_t *biases, int32_t *output, int outputs)
+{
+    for (int o = 0; o < outputs; o++)
+    {
+        const int8_t *row = weights + o * inputs;
+        int32_t sum = biases[o];
+        for (int i = 0; i < inputs; i++)
+        {
+            sum += input[i] * row[i];
+        }
+        output[o] = sum;
+    }
+}
+
+#ifdef NNUE_X86
+
+//
+// SSE4.1, 16 bytes at a time
+//
+
+NNUE_TARGET("sse4.1")
+static void AddRowSse41(int16_t *accumulator, const int16_t *row, int count)
+{
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(accumulator + i));
+        __m128i r = _mm_loadu_si128((const __m128i *)(row + i));
+        _mm_storeu_si128((__m128i *)(accumulator + i), _mm_add_epi16(a, r));
+    }
+}
+
+NNUE_TARGET("sse4.1")
+static void SubRowSse41(int16_t *accumulator, const int16_t *row, int count)
+{
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(accumulator + i));
+        __m128i r = _mm_loadu_si128((const __m128i *)(row + i));
+        _mm_storeu_si128((__m128i *)(accumulator + i), _mm_sub_epi16(a, r));
+    }
+}
+
+NNUE_TARGET("sse4.1")
+static void AddRowsSse41(int16_t *accumulator, const int16_t *const *rows, int rowCount, int count)
+{
+    // Four registers per tile, so each value is loaded and stored once
+    int tile = 0;
+    for (; tile + 32 <= count; tile += 32)
+    {
+        __m128i sum0 = _mm_loadu_si128((const __m128i *)(accumulator + tile));
+        __m128i sum1 = _mm_loadu_si128((const __m128i *)(accumulator + tile + 8));
+        __m128i sum2 = _mm_loadu_si128((const __m128i *)(accumulator + tile + 16));
+        __m128i sum3 = _mm_loadu_si128((const __m128i *)(accumulator + tile + 24));
+        for (int r = 0; r < rowCount; r++)
+        {
+            const int16_t *row = rows[r] + tile;
+            sum0 = _mm_add_epi16(sum0, _mm_loadu_si128((const __m128i *)row));
+            sum1 = _mm_add_epi16(sum1, _mm_loadu_si128((const __m128i *)(row + 8)));
+            sum2 = _mm_add_epi16(sum2, _mm_loadu_si128((const __m128i *)(row + 16)));
+            sum3 = _mm_add_epi16(sum3, _mm_loadu_si128((const __m128i *)(row + 24)));
+        }
+        _mm_storeu_si128((__m128i *)(accumulator + tile), sum0);
+        _mm_storeu_si128((__m128i *)(accumulator + tile + 8), sum1);
+        _mm_storeu_si128((__m128i *)(accumulator + tile + 16), sum2);
+        _mm_storeu_si128((__m128i *)(accumulator + tile + 24), sum3);
+    }
+    for (int r = 0; r < rowCount && tile < count; r++)
+    {
+        AddRowSse41(accumulator + tile, rows[r] + tile, count - tile);
+    }
+}
+
+NNUE_TARGET("sse4.1")
+static void ClampSse41(const int16_t *accumulator, uint8_t *output, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < count; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(accumulator + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(accumulator + i + 8));
+        // Saturate to -128..127, then cut off the negative half
+        __m128i packed = _mm_max_epi8(_mm_packs_epi16(a, b), zero);
+        _mm_storeu_si128((__m128i *)(output + i), packed);
+    }
+}
+
+NNUE_TARGET("sse4.1")
+static void AffineSse41(const uint8_t *input, int inputs, const int8_t *weights,
+                        const int32_t *biases, int32_t *output, int outputs)
+{
+    // Inputs are at most 127, so the pairwise sums of maddubs never saturate.
+    // Four outputs at a time share the input loads and one reduction.
+    const __m128i ones = _mm_set1_epi16(1);
+    int o = 0;
+    for (; o + 4 <= outputs; o += 4)
+    {
+        const int8_t *row = weights + o * inputs;
+        __m128i sum0 = _mm_setzero_si128(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (int i = 0; i < inputs; i += 16)
+        {
+            __m128i in = _mm_loadu_si128((const __m128i *)(input + i));
+            __m128i w0 = _mm_loadu_si128((const __m128i *)(row + i));
+            __m128i w1 = _mm_loadu_si128((const __m128i *)(row + inputs + i));
+            __m128i w2 = _mm_loadu_si128((const __m128i *)(row + 2 * inputs + i));
+            __m128i w3 = _mm_loadu_si128((const __m128i *)(row + 3 * inputs + i));
+            sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_maddubs_epi16(in, w0), ones));
+            sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_maddubs_epi16(in, w1), ones));
+            sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_maddubs_epi16(in, w2), ones));
+            sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_maddubs_epi16(in, w3), ones));
+        }
+        __m128i sum = _mm_hadd_epi32(_mm_hadd_epi32(sum0, sum1), _mm_hadd_epi32(sum2, sum3));
+        sum = _mm_add_epi32(sum, _mm_loadu_si128((const __m128i *)(biases + o)));
+        _mm_storeu_si128((__m128i *)(output + o), sum);
+    }
+    for (; o < outputs; o++)
+    {
+        const int8_t *row = weights + o * inputs;
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < inputs; i += 16)
+        {
+            __m128i in = _mm_loadu_si128((const __m128i *)(input + i));
+            __m128i w = _mm_loadu_si128((const __m128i *)(row + i));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(in, w), ones));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        output[o] = biases[o] + _mm_cvtsi128_si32(sum);
+    }
+}
+
+//
+// AVX2, 32 bytes at a time
+//
+
+NNUE_TARGET("avx2")
+static void AddRowAvx2(int16_t *accumulator, const int16_t *row, int count)
+{
+    for (int i = 0; i < count; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(accumulator + i));
+        __m256i r = _mm256_loadu_si256((const __m256i *)(row + i));
+        _mm256_storeu_si256((__m256i *)(accumulator + i), _mm256_add_epi16(a, r));
+    }
+}
+
+NNUE_TARGET("avx2")
+static void SubRowAvx2(int16_t *accumulator, const int16_t *row, int count)
+{
+    for (int i = 0; i < count; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(accumulator + i));
+        __m256i r = _mm256_loadu_si256((const __m256i *)(row + i));
+        _mm256_storeu_si256((__m256i *)(accumulator + i), _mm256_sub_epi16(a, r));
+    }
+}
+
+NNUE_TARGET("avx2")
+static void AddRowsAvx2(int16_t *accumulator, const int16_t *const *rows, int rowCount, int count)
+{
+    int tile = 0;
+    for (; tile + 64 <= count; tile += 64)
+    {
+        __m256i sum0 = _mm256_loadu_si256((const __m256i *)(accumulator + tile));
+        __m256i sum1 = _mm256_loadu_si256((const __m256i *)(accumulator + tile + 16));
+        __m256i sum2 = _mm256_loadu_si256((const __m256i *)(accumulator + tile + 32));
+        __m256i sum3 = _mm256_loadu_si256((const __m256i *)(accumulator + tile + 48));
+        for (int r = 0; r < rowCount; r++)
+        {
+            const int16_t *row = rows[r] + tile;
+            sum0 = _mm256_add_epi16(sum0, _mm256_loadu_si256((const __m256i *)row));
+            sum1 = _mm256_add_epi16(sum1, _mm256_loadu_si256((const __m256i *)(row + 16)));
+            sum2 = _mm256_add_epi16(sum2, _mm256_loadu_si256((const __m256i *)(row + 32)));
+            sum3 = _mm256_add_epi16(sum3, _mm256_loadu_si256((const __m256i *)(row + 48)));
+        }
+        _mm256_storeu_si256((__m256i *)(accumulator + tile), sum0);
+        _mm256_storeu_si256((__m256i *)(accumulator + tile + 16), sum1);
+        _mm256_storeu_si256((__m256i *)(accumulator + tile + 32), sum2);
+        _mm256_storeu_si256((__m256i *)(accumulator + tile + 48), sum3);
+    }
+    for (int r = 0; r < rowCount && tile < count; r++)
+    {
+        AddRowAvx2(accumulator + tile, rows[r] + tile, count - tile);
+    }
+}
+
+NNUE_TARGET("avx2")
+static void ClampAvx2(const int16_t *accumulator, uint8_t *output, int count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    for (int i = 0; i < count; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(accumulator + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(accumulator + i + 16));
+        // Packing works within 128 bit lanes, put the quarters back in order
+        __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(a, b), zero);
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256((__m256i *)(output + i), packed);
+    }
+}
+
+NNUE_TARGET("avx2")
+static int32_t HorizontalSumAvx2(__m256i sum)
+{
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+}
+
+NNUE_TARGET("avx2")
+static __m128i HorizontalSum4Avx2(__m256i sum0, __m256i sum1, __m256i sum2, __m256i sum3)
+{
+    __m256i pairs = _mm256_hadd_epi32(_mm256_hadd_epi32(sum0, sum1), _mm256_hadd_epi32(sum2, sum3));
+    return _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+}
+
+NNUE_TARGET("avx2")
+static void AffineAvx2(const uint8_t *input, int inputs, const int8_t *weights,
+                       const int32_t *biases, int32_t *output, int outputs)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    int o = 0;
+    for (; o + 4 <= outputs; o += 4)
+    {
+        const int8_t *row = weights + o * inputs;
+        __m256i sum0 = _mm256_setzero_si256(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (int i = 0; i < inputs; i += 32)
+        {
+            __m256i in = _mm256_loadu_si256((const __m256i *)(input + i));
+            __m256i w0 = _mm256_loadu_si256((const __m256i *)(row + i));
+            __m256i w1 = _mm256_loadu_si256((const __m256i *)(row + inputs + i));
+            __m256i w2 = _mm256_loadu_si256((const __m256i *)(row + 2 * inputs + i));
+            __m256i w3 = _mm256_loadu_si256((const __m256i *)(row + 3 * inputs + i));
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_maddubs_epi16(in, w0), ones));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_maddubs_epi16(in, w1), ones));
+            sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_maddubs_epi16(in, w2), ones));
+            sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_maddubs_epi16(in, w3), ones));
+        }
+        __m128i sum = _mm_add_epi32(HorizontalSum4Avx2(sum0, sum1, sum2, sum3),
+                                    _mm_loadu_si128((const __m128i *)(biases + o)));
+        _mm_storeu_si128((__m128i *)(output + o), sum);
+    }
+    for (; o < outputs; o++)
+    {
+        const int8_t *row = weights + o * inputs;
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < inputs; i += 32)
+        {
+            __m256i in = _mm256_loadu_si256((const __m256i *)(input + i));
+            __m256i w = _mm256_loadu_si256((const __m256i *)(row + i));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(in, w), ones));
+        }
+        output[o] = biases[o] + HorizontalSumAvx2(sum);
+    }
+}
+
+//
+// AVX-512, 64 bytes at a time with an AVX2 step for a 32 byte tail
+//
+
+NNUE_TARGET("avx512f,avx512bw")
+static void AddRowAvx512(int16_t *accumulator, const int16_t *row, int count)
+{
+    int i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m512i a = _mm512_loadu_si512(accumulator + i);
+        __m512i r = _mm512_loadu_si512(row + i);
+        _mm512_storeu_si512(accumulator + i, _mm512_add_epi16(a, r));
+    }
+    if (i < count)
+    {
+        AddRowAvx2(accumulator + i, row + i, count - i);
+    }
+}
+
+NNUE_TARGET("avx512f,avx512bw")
+static void SubRowAvx512(int16_t *accumulator, const int16_t *row, int count)
+{
+    int i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m512i a = _mm512_loadu_si512(accumulator + i);
+        __m512i r = _mm512_loadu_si512(row + i);
+        _mm512_storeu_si512(accumulator + i, _mm512_sub_epi16(a, r));
+    }
+    if (i < count)
+    {
+        SubRowAvx2(accumulator + i, row + i, count - i);
+    }
+}
+
+NNUE_TARGET("avx512f,avx512bw")
+static void AddRowsAvx512(int16_t *accumulator, const int16_t *const *rows, int rowCount, int count)
+{
+    int tile = 0;
+    for (; tile + 128 <= count; tile += 128)
+    {
+        __m512i sum0 = _mm512_loadu_si512(accumulator + tile);
+        __m512i sum1 = _mm512_loadu_si512(accumulator + tile + 32);
+        __m512i sum2 = _mm512_loadu_si512(accumulator + tile + 64);
+        __m512i sum3 = _mm512_loadu_si512(accumulator + tile + 96);
+        for (int r = 0; r < rowCount; r++)
+        {
+            const int16_t *row = rows[r] + tile;
+            sum0 = _mm512_add_epi16(sum0, _mm512_loadu_si512(row));
+            sum1 = _mm512_add_epi16(sum1, _mm512_loadu_si512(row + 32));
+            sum2 = _mm512_add_epi16(sum2, _mm512_loadu_si512(row + 64));
+            sum3 = _mm512_add_epi16(sum3, _mm512_loadu_si512(row + 96));
+        }
+        _mm512_storeu_si512(accumulator + tile, sum0);
+        _mm512_storeu_si512(accumulator + tile + 32, sum1);
+        _mm512_storeu_si512(accumulator + tile + 64, sum2);
+        _mm512_storeu_si512(accumulator + tile + 96, sum3);
+    }
+    for (int r = 0; r < rowCount && tile < count; r++)
+    {
+        AddRowAvx2(accumulator + tile, rows[r] + tile, count - tile);
+    }
+}
+
+NNUE_TARGET("avx512f,avx512bw")
+static void ClampAvx512(const int16_t *accumulator, uint8_t *output, int count)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i order = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+    int i = 0;
+    for (; i + 64 <= count; i += 64)
+    {
+        __m512i a = _mm512_loadu_si512(accumulator + i);
+        __m512i b = _mm512_loadu_si512(accumulator + i + 32);
+        __m512i packed = _mm512_max_epi8(_mm512_packs_epi16(a, b), zero);
+        packed = _mm512_permutexvar_epi64(order, packed);
+        _mm512_storeu_si512(output + i, packed);
+    }
+    if (i < count)
+    {
+        ClampAvx2(accumulator + i, output + i, count - i);
+    }
+}
+
+NNUE_TARGET("avx512f,avx512bw")
+static void AffineAvx512(const uint8_t *input, int inputs, const int8_t *weights,
+                         const int32_t *biases, int32_t *output, int outputs)
+{
+    if (inputs % 64 != 0 || outputs % 4 != 0)
+    {
+        AffineAvx2(input, inputs, weights, biases, output, outputs);
+        return;
+    }
+
+    const __m512i ones = _mm512_set1_epi16(1);
+    for (int o = 0; o < outputs; o += 4)
+    {
+        const int8_t *row = weights + o * inputs;
+        __m512i sum0 = _mm512_setzero_si512(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (int i = 0; i < inputs; i += 64)
+        {
+            __m512i in = _mm512_loadu_si512(input + i);
+            __m512i w0 = _mm512_loadu_si512(row + i);
+            __m512i w1 = _mm512_loadu_si512(row + inputs + i);
+            __m512i w2 = _mm512_loadu_si512(row + 2 * inputs + i);
+            __m512i w3 = _mm512_loadu_si512(row + 3 * inputs + i);
+            sum0 = _mm512_add_epi32(sum0, _mm512_madd_epi16(_mm512_maddubs_epi16(in, w0), ones));
+            sum1 = _mm512_add_epi32(sum1, _mm512_madd_epi16(_mm512_maddubs_epi16(in, w1), ones));
+            sum2 = _mm512_add_epi32(sum2, _mm512_madd_epi16(_mm512_maddubs_epi16(in, w2), ones));
+            sum3 = _mm512_add_epi32(sum3, _mm512_madd_epi16(_mm512_maddubs_epi16(in, w3), ones));
+        }
+
+        // Fold each sum to 256 bits and finish like AVX2
+        __m128i sum = HorizontalSum4Avx2(
+            _mm256_add_epi32(_mm512_castsi512_si256(sum0), _mm512_extracti64x4_epi64(sum0, 1)),
+            _mm256_add_epi32(_mm512_castsi512_si256(sum1), _mm512_extracti64x4_epi64(sum1, 1)),
+            _mm256_add_epi32(_mm512_castsi512_si256(sum2), _mm512_extracti64x4_epi64(sum2, 1)),
+            _mm256_add_epi32(_mm512_castsi512_si256(sum3), _mm512_extracti64x4_epi64(sum3, 1)));
+        sum = _mm_add_epi32(sum, _mm_loadu_si128((const __m128i *)(biases + o)));
+        _mm_storeu_si128((__m128i *)(output + o), sum);
+    }
+}
+
+#endif // NNUE_X86
+
+/// Kernel sets indexed by SimdLevel
+static const NnueKernels Kernels[] = {
+    {"scalar", AddRowScalar, SubRowScalar, AddRowsScalar, ClampScalar, AffineScalar},
+#ifdef NNUE_X86
+    {"sse4.1", AddRowSse41, SubRowSse41, AddRowsSse41, ClampSse41, AffineSse41},
+    {"avx2", AddRowAvx2, SubRowAvx2, AddRowsAvx2, ClampAvx2, AffineAvx2},
+    {"avx512", AddRowAvx512, SubRowAvx512, AddRowsAvx512, ClampAvx512, AffineAvx512},
+#endif
+};
+
+/**
+ * Find the best instruction set both the processor and the
+ * operating system support
+ * @return The fastest usable kernel level
+ */
+SimdLevel DetectSimdLevel()
+{
+#if defined(NNUE_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        return SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        return SIMD_SSE41;
+    }
+#elif defined(NNUE_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    uint64_t xcr0 = osxsave ? _xgetbv(0) : 0;
+
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06;
+    bool avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0 && (xcr0 & 0xE6) == 0xE6;
+    if (avx512)
+    {
+        return SIMD_AVX512;
+    }
+    if (avx2)
+    {
+        return SIMD_AVX2;
+    }
+    if (sse41)
+    {
+        return SIMD_SSE41;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+/**
+ * Get the kernels for an instruction set. Levels the machine does
+ * not support fall back to the best one it does.
+ * @param level Wanted instruction set
+ * @return The kernels
+ */
+const NnueKernels &GetNnueKernels(SimdLevel level)
+{
+    static const SimdLevel supported = DetectSimdLevel();
+    return Kernels[std::min(level, supported)];
+}
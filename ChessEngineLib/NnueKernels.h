@@ -0,0 +1,54 @@
+/**
+ * @file NnueKernels.h
+ * @author John Korreck
+ *
+ * Vector kernels for the network evaluation, one set per
+ * instruction set, chosen when the program starts.
+ */
+
+#ifndef NNUEKERNELS_H
+#define NNUEKERNELS_H
+
+#include <cstdint>
+
+/// Instruction sets the kernels are written for, slowest first
+enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_SSE41,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+/**
+ * The inner loops of the network.
+ *
+ * Every set computes exactly the same integers as the scalar one,
+ * so the evaluation does not depend on the machine it runs on.
+ * Lengths must be multiples of 32 and pointers need no alignment.
+ */
+struct NnueKernels {
+    /// Name shown to the user
+    const char *mName;
+
+    /// Add a weight row to an accumulator, both count values long
+    void (*mAddRow)(int16_t *accumulator, const int16_t *row, int count);
+
+    /// Subtract a weight row from an accumulator
+    void (*mSubRow)(int16_t *accumulator, const int16_t *row, int count);
+
+    /// Add many weight rows at once, keeping the sums in registers
+    void (*mAddRows)(int16_t *accumulator, const int16_t *const *rows, int rowCount, int count);
+
+    /// Clamp accumulator values to 0..127 for the first layer
+    void (*mClamp)(const int16_t *accumulator, uint8_t *output, int count);
+
+    /// Fully connected layer, output = biases + weights * input with
+    /// one row of inputs weights per output
+    void (*mAffine)(const uint8_t *input, int inputs, const int8_t *weights,
+                    const int32_t *biases, int32_t *output, int outputs);
+};
+
+SimdLevel DetectSimdLevel();
+const NnueKernels &GetNnueKernels(SimdLevel level);
+
+#endif //NNUEKERNELS_H
@@ -0,0 +1,47 @@
+/**
+ * @file PawnHashTable.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "PawnHashTable.h"
+
+/**
+ * Constructor
+ */
+PawnHashTable::PawnHashTable() : mTable(Size)
+{
+}
+
+/**
+ * Find the entry for a pawn structure. A structure that is not
+ * in the table replaces whatever was in its slot.
+ * @param key Pawn key
+ * @param found Set to true if the entry already holds the structure
+ * @return The entry, to be filled in by the caller if not found
+ */
+PawnEntry *PawnHashTable::Probe(uint64_t key, bool &found)
+{
+    PawnEntry *entry = &mTable[key & (Size - 1)];
+    mProbes++;
+    found = entry->mKey == key;
+    if (found)
+    {
+        mHits++;
+    }
+    else
+    {
+        *entry = PawnEntry();
+        entry->mKey = key;
+    }
+    return entry;
+}
+
+/**
+ * Erase every entry and the statistics
+ */
+void PawnHashTable::Clear()
+{
+    std::fill(mTable.begin(), mTable.end(), PawnEntry());
+    mProbes = mHits = 0;
+}
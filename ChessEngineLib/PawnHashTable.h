@@ -0,0 +1,70 @@
+/**
+ * @file PawnHashTable.h
+ * @author John Korreck
+ *
+ * Small hash table caching the evaluation of pawn structures.
+ */
+
+#ifndef PAWNHASHTABLE_H
+#define PAWNHASHTABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Bitboard.h"
+
+/**
+ * Everything the evaluation knows about one pawn structure
+ */
+struct PawnEntry {
+    /// Pawn key of the structure
+    uint64_t mKey = 0;
+
+    /// Middlegame pawn structure score, white minus black
+    int mMiddlegame = 0;
+
+    /// Endgame pawn structure score, white minus black
+    int mEndgame = 0;
+
+    /// Passed pawns, indexed by ColorIndex()
+    Bitboard mPassed[2] = {};
+
+    /// King square the shelter was computed for, indexed by ColorIndex()
+    int mShelterKing[2] = {NO_SQUARE, NO_SQUARE};
+
+    /// Middlegame bonus for the pawns in front of that king
+    int mShelter[2] = {};
+};
+
+/**
+ * Pawn structure cache keyed by Position::PawnKey().
+ *
+ * Pawns move rarely compared to the other pieces, so almost every
+ * probe during a search finds its structure already evaluated. Each
+ * Evaluation owns its own table, so no locking is needed.
+ */
+class PawnHashTable {
+private:
+    /// Number of entries, a power of two
+    static const size_t Size = 16384;
+
+    /// The entries
+    std::vector<PawnEntry> mTable;
+
+    /// Probes made
+    uint64_t mProbes = 0;
+
+    /// Probes that found their structure
+    uint64_t mHits = 0;
+
+public:
+    PawnHashTable();
+
+    PawnEntry *Probe(uint64_t key, bool &found);
+    void Clear();
+
+    /// Share of probes that found their structure, in permill
+    int HitRate() const { return mProbes == 0 ? 0 : int(mHits * 1000 / mProbes); }
+};
+
+#endif //PAWNHASHTABLE_H
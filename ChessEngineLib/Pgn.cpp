@@ -0,0 +1,510 @@
+/**
+ * @file Pgn.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Pgn.h"
+#include "MappedFile.h"
+#include "Position.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+
+/// Games handed to a worker at a time
+const size_t GamesPerBatch = 64;
+
+/// Batches queued per worker before the splitter waits
+const size_t QueuedBatchesPerThread = 4;
+
+/// Longest movetext line written
+const size_t PgnLineLength = 79;
+
+/**
+ * Get the value of a tag
+ * @param name Tag name such as "White"
+ * @return The value, empty if the game has no such tag
+ */
+std::string PgnGame::Tag(const std::string &name) const
+{
+    for (auto const &tag : mTags)
+    {
+        if (tag.first == name)
+        {
+            return tag.second;
+        }
+    }
+    return "";
+}
+
+/**
+ * Empty the game so it can be read into again
+ */
+void PgnGame::Clear()
+{
+    mTags.clear();
+    mMoves.clear();
+    mResult = "*";
+}
+
+/**
+ * Write the game, its tags, then its moves wrapped into lines
+ * and its result, followed by a blank line
+ * @param output Stream to write to
+ */
+void PgnGame::Write(std::ostream &output) const
+{
+    for (auto const &tag : mTags)
+    {
+        output << '[' << tag.first << " \"";
+        for (char c : tag.second)
+        {
+            if (c == '"' || c == '\\')
+            {
+                output << '\\';
+            }
+            output << c;
+        }
+        output << "\"]\n";
+    }
+    if (!mTags.empty())
+    {
+        output << '\n';
+    }
+
+    // The side to move and move number come from the FEN tag, if any
+    std::istringstream fen(Tag("FEN"));
+    std::string field;
+    int fields = 0;
+    bool whiteToMove = true;
+    int number = 1;
+    while (fen >> field)
+    {
+        fields++;
+        if (fields == 2)
+        {
+            whiteToMove = field != "b";
+        }
+        else if (fields == 6)
+        {
+            number = std::max(1, std::atoi(field.c_str()));
+        }
+    }
+
+    std::string line;
+    auto add = [&output, &line](const std::string &token) {
+        if (!line.empty() && line.size() + 1 + token.size() > PgnLineLength)
+        {
+            output << line << '\n';
+            line.clear();
+        }
+        line += line.empty() ? token : " " + token;
+    };
+    for (size_t ply = 0; ply < mMoves.size(); ply++)
+    {
+        if (whiteToMove)
+        {
+            add(std::to_string(number) + ". " + mMoves[ply]);
+        }
+        else
+        {
+            add(ply == 0 ? std::to_string(number) + "... " + mMoves[ply] : mMoves[ply]);
+            number++;
+        }
+        whiteToMove = !whiteToMove;
+    }
+    add(mResult);
+    output << line << "\n\n";
+}
+
+/**
+ * Read the next line, the pending tag line first if there is one
+ * @param line Receives the line without its end of line characters
+ * @return False at the end of the stream
+ */
+bool PgnReader::ReadLine(std::string &line)
+{
+    if (!mPending.empty())
+    {
+        line.swap(mPending);
+        mPending.clear();
+        mLineStart = mPendingStart;
+        return true;
+    }
+    if (mInput == nullptr)
+    {
+        if (mNext >= mText.size())
+        {
+            return false;
+        }
+        size_t end = std::min(mText.find('\n', mNext), mText.size());
+        line.assign(mText.substr(mNext, end - mNext));
+        mLineStart = mNext;
+        mNext = end + 1;
+    }
+    else if (!std::getline(*mInput, line))
+    {
+        return false;
+    }
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.pop_back();
+    }
+    return true;
+}
+
+/**
+ * Read the next game. A game ends at its result, or failing
+ * that where the tags of the next game begin.
+ * @param game Receives the game
+ * @return False if there are no more games
+ */
+bool PgnReader::Next(PgnGame &game)
+{
+    game.Clear();
+    bool inComment = false;
+    int variationDepth = 0;
+
+    std::string line;
+    for (bool first = true; ReadLine(line); first = false)
+    {
+        if (first)
+        {
+            mGameStart = mLineStart;
+        }
+        size_t start = line.find_first_not_of(" \t");
+        if (!inComment && variationDepth == 0 && start != std::string::npos && line[start] == '[')
+        {
+            if (!game.mMoves.empty())
+            {
+                mPending = line;
+                mPendingStart = mLineStart;
+                return true;
+            }
+
+            // [Name "Value"], with \" and \\ escapes in the value
+            size_t nameEnd = line.find_first_of(" \t\"]", start + 1);
+            size_t quote = line.find('"', start);
+            if (nameEnd == std::string::npos || quote == std::string::npos)
+            {
+                continue;
+            }
+            std::string value;
+            for (size_t i = quote + 1; i < line.size() && line[i] != '"'; i++)
+            {
+                if (line[i] == '\\' && i + 1 < line.size())
+                {
+                    i++;
+                }
+                value += line[i];
+            }
+            game.mTags.emplace_back(line.substr(start + 1, nameEnd - start - 1), value);
+            continue;
+        }
+        if (!line.empty() && line[0] == '%')
+        {
+            continue;
+        }
+
+        size_t i = 0;
+        while (i < line.size())
+        {
+            char c = line[i];
+            if (inComment)
+            {
+                inComment = c != '}';
+                i++;
+            }
+            else if (c == '{')
+            {
+                inComment = true;
+                i++;
+            }
+            else if (c == ';')
+            {
+                break;
+            }
+            else if (c == '(')
+            {
+                variationDepth++;
+                i++;
+            }
+            else if (c == ')')
+            {
+                variationDepth = std::max(0, variationDepth - 1);
+                i++;
+            }
+            else if (std::isspace((unsigned char)c))
+            {
+                i++;
+            }
+            else
+            {
+                size_t end = line.find_first_of(" \t{}();", i);
+                end = end == std::string::npos ? line.size() : end;
+                std::string token = line.substr(i, end - i);
+                i = end;
+                if (variationDepth > 0 || token[0] == '$')
+                {
+                    continue;
+                }
+                if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+                {
+                    game.mResult = token;
+                    return true;
+                }
+
+                // Move numbers, "12." or "12...", may be joined to the move
+                size_t digits = token.find_first_not_of("0123456789");
+                if (digits == std::string::npos)
+                {
+                    continue;
+                }
+                if (token[digits] == '.')
+                {
+                    token.erase(0, token.find_first_not_of('.', digits));
+                }
+                if (!token.empty() && token != std::string(token.size(), '.'))
+                {
+                    game.mMoves.push_back(token);
+                }
+            }
+        }
+    }
+    return !game.mMoves.empty() || !game.mTags.empty();
+}
+
+/**
+ * Find where the game after the one at an offset starts, which
+ * is the first tag line after some movetext, outside of comments
+ * and variations
+ * @param data Text of the file
+ * @param start Offset of the line the game starts on
+ * @return Offset of the next game, data.size() if there is none
+ */
+size_t PgnParser::NextGame(std::string_view data, size_t start)
+{
+    bool inMoves = false;
+    bool inComment = false;
+    int variationDepth = 0;
+    size_t next = start;
+    while (next < data.size())
+    {
+        size_t lineStart = next;
+        size_t end = std::min(data.find('\n', next), data.size());
+        next = end + 1;
+
+        size_t first = data.find_first_not_of(" \t\r", lineStart);
+        if (first >= end || (!inComment && data[lineStart] == '%'))
+        {
+            continue;
+        }
+        if (!inComment && variationDepth == 0 && data[first] == '[')
+        {
+            if (inMoves)
+            {
+                return lineStart;
+            }
+            continue;
+        }
+        for (size_t i = first; i < end; i++)
+        {
+            char c = data[i];
+            if (inComment)
+            {
+                inComment = c != '}';
+            }
+            else if (c == '{')
+            {
+                inComment = true;
+            }
+            else if (c == ';')
+            {
+                break;
+            }
+            else if (c == '(')
+            {
+                variationDepth++;
+            }
+            else if (c == ')')
+            {
+                variationDepth = std::max(0, variationDepth - 1);
+            }
+            else if (!std::isspace((unsigned char)c))
+            {
+                inMoves = true;
+            }
+        }
+    }
+    return data.size();
+}
+
+/**
+ * Read every game of a PGN file. The games are handed to the
+ * callback on the worker threads as they are decoded, so they
+ * arrive in no particular order and the callback may be called
+ * by several threads at once. It may move from the game.
+ * @param path The PGN file
+ * @param callback Called with each game
+ * @return False if the file could not be read
+ */
+bool PgnParser::Parse(const std::string &path, const std::function<void(ParsedGame &)> &callback)
+{
+    auto start = std::chrono::steady_clock::now();
+    mStats = Stats();
+    mQueue.clear();
+    mDone = false;
+
+    std::error_code error;
+    auto size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return false;
+    }
+    MappedFile file;
+    if (size > 0 && !file.Open(path))
+    {
+        return false;
+    }
+    std::string_view data((const char *)file.Data(), file.Size());
+    mBase = data.data();
+    mStats.mBytes = data.size();
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < mThreads; i++)
+    {
+        workers.emplace_back(&PgnParser::Worker, this, std::cref(callback));
+    }
+
+    std::vector<std::string_view> batch;
+    for (size_t offset = 0; offset < data.size();)
+    {
+        size_t next = NextGame(data, offset);
+        batch.push_back(data.substr(offset, next - offset));
+        offset = next;
+        if (batch.size() == GamesPerBatch || offset == data.size())
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mQueue.size() < QueuedBatchesPerThread * mThreads; });
+            mQueue.push_back(std::move(batch));
+            lock.unlock();
+            mCondition.notify_all();
+            batch.clear();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mDone = true;
+    }
+    mCondition.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    mBase = nullptr;
+
+    mStats.mMilliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+/**
+ * Take batches of game texts off the queue and decode their games
+ * @param callback Called with each game
+ */
+void PgnParser::Worker(const std::function<void(ParsedGame &)> &callback)
+{
+    Position position;
+    ParsedGame parsed;
+    while (true)
+    {
+        std::vector<std::string_view> batch;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mDone || !mQueue.empty(); });
+            if (mQueue.empty())
+            {
+                break;
+            }
+            batch = std::move(mQueue.front());
+            mQueue.pop_front();
+        }
+        mCondition.notify_all();
+
+        // A game without tags does not start a new text, so one
+        // text can hold more than one game
+        Stats stats;
+        for (auto text : batch)
+        {
+            PgnReader reader(text);
+            while (reader.Next(parsed.mGame))
+            {
+                parsed.mOffset = uint64_t(text.data() - mBase) + reader.GameOffset();
+                Decode(parsed, position);
+                stats.mGames++;
+                stats.mBadGames += parsed.mComplete ? 0 : 1;
+                stats.mPositions += parsed.mMoves.size();
+                callback(parsed);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.mGames += stats.mGames;
+        mStats.mBadGames += stats.mBadGames;
+        mStats.mPositions += stats.mPositions;
+    }
+}
+
+/**
+ * Read every game of a PGN file into memory
+ * @param path The PGN file
+ * @param games Receives the games in the order of the file
+ * @return False if the file could not be read
+ */
+bool PgnParser::Load(const std::string &path, std::vector<ParsedGame> &games)
+{
+    games.clear();
+    std::mutex mutex;
+    bool read = Parse(path, [&games, &mutex](ParsedGame &game) {
+        std::lock_guard<std::mutex> lock(mutex);
+        games.push_back(std::move(game));
+    });
+    std::sort(games.begin(), games.end(), [](const ParsedGame &a, const ParsedGame &b) {
+        return a.mOffset < b.mOffset;
+    });
+    return read;
+}
+
+/**
+ * Decode the SAN moves of a game into moves, from the position
+ * of its FEN tag or the standard start
+ * @param game The game, with mGame read
+ * @param position Position to play the moves on
+ */
+void PgnParser::Decode(ParsedGame &game, Position &position)
+{
+    game.mMoves.clear();
+    game.mStartFen = game.mGame.Tag("FEN");
+    if (game.mStartFen.empty())
+    {
+        game.mStartFen = Position::StartFen;
+    }
+    game.mComplete = position.SetFen(game.mStartFen);
+    for (size_t ply = 0; game.mComplete && ply < game.mGame.mMoves.size(); ply++)
+    {
+        Move move = position.ParseSan(game.mGame.mMoves[ply]);
+        if (!move.IsValid())
+        {
+            game.mComplete = false;
+            break;
+        }
+        game.mMoves.push_back(move);
+        position.DoMove(move);
+    }
+}
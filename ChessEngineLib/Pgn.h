@@ -0,0 +1,198 @@
+/**
+ * @file Pgn.h
+ * @author John Korreck
+ *
+ * Reading games in Portable Game Notation.
+ */
+
+#ifndef PGN_H
+#define PGN_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Move.h"
+
+class Position;
+
+/**
+ * A game as written in a PGN file
+ */
+struct PgnGame {
+    /// Tag pairs in file order
+    std::vector<std::pair<std::string, std::string>> mTags;
+
+    /// Main line moves in standard algebraic notation
+    std::vector<std::string> mMoves;
+
+    /// "1-0", "0-1", "1/2-1/2" or "*"
+    std::string mResult = "*";
+
+    std::string Tag(const std::string &name) const;
+    void Clear();
+    void Write(std::ostream &output) const;
+};
+
+/**
+ * Reads the games of a PGN stream or text one at a time.
+ *
+ * Comments, variations, numeric annotation glyphs and move numbers
+ * are skipped, leaving the tags, the main line and the result.
+ */
+class PgnReader {
+private:
+    /// The stream being read, nullptr when reading mText
+    std::istream *mInput = nullptr;
+
+    /// Text being read when there is no stream
+    std::string_view mText;
+
+    /// Offset in mText of the next line
+    size_t mNext = 0;
+
+    /// Offset in mText of the line last read
+    size_t mLineStart = 0;
+
+    /// A tag line already read that starts the next game
+    std::string mPending;
+
+    /// Offset in mText of the pending line
+    size_t mPendingStart = 0;
+
+    /// Offset in mText of the game last read
+    size_t mGameStart = 0;
+
+    bool ReadLine(std::string &line);
+
+public:
+    /**
+     * Constructor
+     * @param input Stream to read games from
+     */
+    PgnReader(std::istream &input) : mInput(&input) {}
+
+    /**
+     * Constructor
+     * @param text Text to read games from, which must outlive the reader
+     */
+    PgnReader(std::string_view text) : mText(text) {}
+
+    /// Copy constructor (disabled)
+    PgnReader(const PgnReader &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const PgnReader &) = delete;
+
+    bool Next(PgnGame &game);
+
+    /// Offset in the text where the game last read starts, 0 when reading a stream
+    size_t GameOffset() const { return mGameStart; }
+};
+
+/**
+ * A game with its moves decoded into engine moves
+ */
+struct ParsedGame {
+    /// Offset in the file where the game starts, which orders the games
+    uint64_t mOffset = 0;
+
+    /// The game as written
+    PgnGame mGame;
+
+    /// Starting position, from the FEN tag or the standard start
+    std::string mStartFen;
+
+    /// Main line moves, up to the first that could not be decoded
+    std::vector<Move> mMoves;
+
+    /// Were all the moves decoded?
+    bool mComplete = true;
+};
+
+/**
+ * Reads PGN files with several threads.
+ *
+ * The file is mapped into memory and the calling thread only finds
+ * where each game starts, by the tag lines that follow movetext.
+ * Batches of games go to worker threads, which read the tags and
+ * moves and decode the SAN moves with the legal move generator.
+ */
+class PgnParser {
+public:
+    /**
+     * Statistics of a parse
+     */
+    struct Stats {
+        /// Games read
+        uint64_t mGames = 0;
+
+        /// Games with a move that could not be decoded, or a bad FEN tag
+        uint64_t mBadGames = 0;
+
+        /// Moves decoded
+        uint64_t mPositions = 0;
+
+        /// Size of the file in bytes
+        uint64_t mBytes = 0;
+
+        /// Time taken in milliseconds
+        int64_t mMilliseconds = 0;
+    };
+
+private:
+    /// Worker threads
+    int mThreads;
+
+    /// Statistics of the last parse
+    Stats mStats;
+
+    /// Start of the mapped file
+    const char *mBase = nullptr;
+
+    /// Batches of game texts waiting for a worker
+    std::deque<std::vector<std::string_view>> mQueue;
+
+    /// No more batches will be queued
+    bool mDone = false;
+
+    /// Protects the queue and the statistics
+    std::mutex mMutex;
+
+    /// Signals a change in the queue
+    std::condition_variable mCondition;
+
+    void Worker(const std::function<void(ParsedGame &)> &callback);
+    static size_t NextGame(std::string_view data, size_t start);
+
+public:
+    /**
+     * Constructor
+     * @param threads Worker threads
+     */
+    PgnParser(int threads = 1) : mThreads(std::max(1, threads)) {}
+
+    /// Copy constructor (disabled)
+    PgnParser(const PgnParser &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const PgnParser &) = delete;
+
+    bool Parse(const std::string &path, const std::function<void(ParsedGame &)> &callback);
+    bool Load(const std::string &path, std::vector<ParsedGame> &games);
+    static void Decode(ParsedGame &game, Position &position);
+
+    /// Statistics of the last parse
+    const Stats &GetStats() const { return mStats; }
+};
+
+#endif //PGN_H
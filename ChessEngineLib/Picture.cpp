@@ -4,6 +4,7 @@
  */
 #include "pch.h"
 #include <wx/stdpaths.h>
+#include <thread>
 
 #include "Picture.h"
 #include "PictureObserver.h"
@@ -73,4 +74,15 @@ void Picture::AddItem(std::shared_ptr<Item> item)
 {
     mItems.push_back(item);
     item->SetPicture(this);
-}
\ No newline at end of file
+}
+
+/**
+ * Load the games of a PGN file, decoding them on every core
+ * @param filename The PGN file
+ * @return False if the file could not be read
+ */
+bool Picture::Load(const wxString& filename)
+{
+    PgnParser parser(int(std::thread::hardware_concurrency()));
+    return parser.Load(filename.ToStdString(), mGames);
+}
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "Pgn.h"
+
 class PictureObserver;
 class Item;
 class Board;
@@ -30,6 +32,9 @@ private:
     /// The board inside the picture
     std::shared_ptr<Board> mBoard = nullptr;
 
+    /// Games loaded from a PGN file
+    std::vector<ParsedGame> mGames;
+
 public:
     Picture();
 
@@ -121,9 +126,13 @@ public:
 
     double GetAnimationTime();
 
-    void Load(const wxString& filename);
+    bool Load(const wxString& filename);
     /// Updates picture time
     void UpdateTime();
 
-    void Save(const wxString& filename);
+    /**
+     * Get the loaded games
+     * @return Games in the order of their file
+     */
+    const std::vector<ParsedGame> &GetGames() const { return mGames; }
 };
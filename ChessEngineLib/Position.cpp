@@ -0,0 +1,1469 @@
+/**
+ * @file Position.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Position.h"
+#include "Zobrist.h"
+
+#include <sstream>
+
+const std::string Position::StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+/**
+ * Castling rights lost when a piece moves from or to a square
+ * @param square Square index
+ * @return Rights that are removed
+ */
+static int CastlingMask(int square)
+{
+    switch (square)
+    {
+    case 0: return WHITE_OOO;
+    case 4: return WHITE_OO | WHITE_OOO;
+    case 7: return WHITE_OO;
+    case 56: return BLACK_OOO;
+    case 60: return BLACK_OO | BLACK_OOO;
+    case 63: return BLACK_OO;
+    default: return 0;
+    }
+}
+
+/**
+ * Constructor, sets up the starting position
+ */
+Position::Position()
+{
+    mHistory.reserve(MAX_PLY * 2);
+    SetFen(StartFen);
+}
+
+/**
+ * Put a piece on an empty square
+ * @param piece Piece code
+ * @param square Square to put it on
+ */
+void Position::PutPiece(int piece, int square)
+{
+    mBoard[square] = piece;
+    mMaterialKey ^= Zobrist.mPieceSquare[piece][mPieceCount[piece]];
+    mPieceIndex[square] = mPieceCount[piece]++;
+    mPieceList[piece][mPieceIndex[square]] = square;
+    mByPiece[piece] |= SquareBB(square);
+    mByColor[ColorIndex(ColorOf(piece))] |= SquareBB(square);
+    mKey ^= Zobrist.mPieceSquare[piece][square];
+    if (TypeOf(piece) == PAWN)
+    {
+        mPawnKey ^= Zobrist.mPieceSquare[piece][square];
+    }
+}
+
+/**
+ * Remove the piece on a square
+ * @param square Square to clear
+ */
+void Position::RemovePiece(int square)
+{
+    // Fill the hole in the list with the last piece of the same code
+    int piece = mBoard[square];
+    int last = mPieceList[piece][--mPieceCount[piece]];
+    mMaterialKey ^= Zobrist.mPieceSquare[piece][mPieceCount[piece]];
+    mPieceIndex[last] = mPieceIndex[square];
+    mPieceList[piece][mPieceIndex[last]] = last;
+    mByPiece[piece] ^= SquareBB(square);
+    mByColor[ColorIndex(ColorOf(piece))] ^= SquareBB(square);
+
+    mKey ^= Zobrist.mPieceSquare[piece][square];
+    if (TypeOf(piece) == PAWN)
+    {
+        mPawnKey ^= Zobrist.mPieceSquare[piece][square];
+    }
+    mBoard[square] = EMPTY;
+}
+
+/**
+ * Move a piece to an empty square
+ * @param from Square the piece is on
+ * @param to Square to move it to
+ */
+void Position::MovePiece(int from, int to)
+{
+    int piece = mBoard[from];
+    mKey ^= Zobrist.mPieceSquare[piece][from] ^ Zobrist.mPieceSquare[piece][to];
+    if (TypeOf(piece) == PAWN)
+    {
+        mPawnKey ^= Zobrist.mPieceSquare[piece][from] ^ Zobrist.mPieceSquare[piece][to];
+    }
+    mBoard[to] = piece;
+    mBoard[from] = EMPTY;
+    mPieceIndex[to] = mPieceIndex[from];
+    mPieceList[piece][mPieceIndex[to]] = to;
+    mByPiece[piece] ^= SquareBB(from) | SquareBB(to);
+    mByColor[ColorIndex(ColorOf(piece))] ^= SquareBB(from) | SquareBB(to);
+}
+
+/**
+ * Compute the position key from scratch
+ * @return Zobrist key
+ */
+uint64_t Position::ComputeKey() const
+{
+    uint64_t key = 0;
+    for (int square = 0; square < SQUARE_NB; square++)
+    {
+        if (mBoard[square] != EMPTY)
+        {
+            key ^= Zobrist.mPieceSquare[mBoard[square]][square];
+        }
+    }
+    key ^= Zobrist.mCastling[mCastlingRights];
+    if (mEnPassant != NO_SQUARE)
+    {
+        key ^= Zobrist.mEnPassant[FileOf(mEnPassant)];
+    }
+    if (mSideToMove == BLACK)
+    {
+        key ^= Zobrist.mSideToMove;
+    }
+    return key;
+}
+
+/**
+ * Set up the position from a FEN string
+ * @param fen FEN string, the move counters may be omitted
+ * @return False if the piece placement could not be read or has a
+ * pawn on the first or last rank, a castling right has its king or
+ * rook off its square or the en passant square is not behind a pawn
+ * that just moved two squares
+ */
+bool Position::SetFen(const std::string &fen)
+{
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    stream >> placement >> side >> castling >> enPassant;
+
+    int board[SQUARE_NB] = {};
+    int counts[PIECE_CODE_NB] = {};
+    int file = 0;
+    int rank = 7;
+    for (char letter : placement)
+    {
+        if (letter == '/')
+        {
+            rank--;
+            file = 0;
+        }
+        else if (isdigit(letter))
+        {
+            file += letter - '0';
+        }
+        else
+        {
+            int piece = EMPTY;
+            switch (letter)
+            {
+            case 'P': piece = WHITE_PAWN; break;
+            case 'N': piece = WHITE_KNIGHT; break;
+            case 'B': piece = WHITE_BISHOP; break;
+            case 'R': piece = WHITE_ROOK; break;
+            case 'Q': piece = WHITE_QUEEN; break;
+            case 'K': piece = WHITE_KING; break;
+            case 'p': piece = BLACK_PAWN; break;
+            case 'n': piece = BLACK_KNIGHT; break;
+            case 'b': piece = BLACK_BISHOP; break;
+            case 'r': piece = BLACK_ROOK; break;
+            case 'q': piece = BLACK_QUEEN; break;
+            case 'k': piece = BLACK_KING; break;
+            default: return false;
+            }
+            if (file > 7 || rank < 0 || ++counts[piece] > MAX_PIECES_PER_CODE)
+            {
+                return false;
+            }
+            if (TypeOf(piece) == PAWN && (rank == 0 || rank == 7))
+            {
+                return false;
+            }
+            board[MakeSquare(file, rank)] = piece;
+            file++;
+        }
+    }
+    if (counts[WHITE_KING] != 1 || counts[BLACK_KING] != 1)
+    {
+        return false;
+    }
+    int sideToMove = side == "b" ? BLACK : WHITE;
+
+    // Each right needs the king and that rook still on their squares
+    int castlingRights = 0;
+    for (char letter : castling)
+    {
+        int right = 0;
+        int rook = 0;
+        switch (letter)
+        {
+        case 'K': right = WHITE_OO; rook = MakeSquare(7, 0); break;
+        case 'Q': right = WHITE_OOO; rook = MakeSquare(0, 0); break;
+        case 'k': right = BLACK_OO; rook = MakeSquare(7, 7); break;
+        case 'q': right = BLACK_OOO; rook = MakeSquare(0, 7); break;
+        default: continue;
+        }
+        int color = (right & (WHITE_OO | WHITE_OOO)) != 0 ? WHITE : BLACK;
+        if (board[MakeSquare(4, RankOf(rook))] != color + KING || board[rook] != color + ROOK)
+        {
+            return false;
+        }
+        castlingRights |= right;
+    }
+
+    // The square a pawn just skipped, with that pawn in front of it
+    int enPassantSquare = NO_SQUARE;
+    if (!enPassant.empty() && enPassant != "-")
+    {
+        int epRank = sideToMove == WHITE ? 5 : 2;
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] != '1' + epRank)
+        {
+            return false;
+        }
+        enPassantSquare = MakeSquare(enPassant[0] - 'a', epRank);
+        int pushed = enPassantSquare + (sideToMove == WHITE ? -8 : 8);
+        if (board[pushed] != Opponent(sideToMove) + PAWN || board[enPassantSquare] != EMPTY)
+        {
+            return false;
+        }
+    }
+
+    std::fill(std::begin(mBoard), std::end(mBoard), EMPTY);
+    std::fill(std::begin(mPieceCount), std::end(mPieceCount), 0);
+    std::fill(std::begin(mByPiece), std::end(mByPiece), 0);
+    mByColor[0] = mByColor[1] = 0;
+    mPawnKey = 0;
+    mMaterialKey = 0;
+    for (int square = 0; square < SQUARE_NB; square++)
+    {
+        if (board[square] != EMPTY)
+        {
+            PutPiece(board[square], square);
+        }
+    }
+    mSideToMove = sideToMove;
+    mCastlingRights = castlingRights;
+    mEnPassant = enPassantSquare;
+
+    mHalfmoveClock = 0;
+    mFullmoveNumber = 1;
+    stream >> mHalfmoveClock >> mFullmoveNumber;
+
+    mHistory.clear();
+    mPliesFromNull = 0;
+    mKey = ComputeKey();
+    UpdateCheckInfo();
+    return true;
+}
+
+/**
+ * Write the position as a FEN string
+ * @return FEN string
+ */
+std::string Position::GetFen() const
+{
+    const std::string pieceLetters = " KPNBRQ  kpnbrq";
+    std::string fen;
+    for (int rank = 7; rank >= 0; rank--)
+    {
+        int empty = 0;
+        for (int file = 0; file < 8; file++)
+        {
+            int piece = mBoard[MakeSquare(file, rank)];
+            if (piece == EMPTY)
+            {
+                empty++;
+                continue;
+            }
+            if (empty > 0)
+            {
+                fen += char('0' + empty);
+                empty = 0;
+            }
+            fen += pieceLetters[TypeOf(piece) + (ColorOf(piece) == WHITE ? 0 : 8)];
+        }
+        if (empty > 0)
+        {
+            fen += char('0' + empty);
+        }
+        if (rank > 0)
+        {
+            fen += '/';
+        }
+    }
+
+    fen += mSideToMove == WHITE ? " w " : " b ";
+    if (mCastlingRights == 0)
+    {
+        fen += '-';
+    }
+    if (mCastlingRights & WHITE_OO) fen += 'K';
+    if (mCastlingRights & WHITE_OOO) fen += 'Q';
+    if (mCastlingRights & BLACK_OO) fen += 'k';
+    if (mCastlingRights & BLACK_OOO) fen += 'q';
+
+    fen += ' ';
+    fen += mEnPassant == NO_SQUARE ? "-" : SquareName(mEnPassant);
+    fen += ' ' + std::to_string(mHalfmoveClock) + ' ' + std::to_string(mFullmoveNumber);
+    return fen;
+}
+
+/**
+ * Find the pieces of a color that attack a square
+ * @param square Square to test
+ * @param byColor Color of the attacking side
+ * @param occupied Occupied squares the sliders are blocked by
+ * @return Squares of the attackers
+ */
+Bitboard Position::AttackersTo(int square, int byColor, Bitboard occupied) const
+{
+    // Every attack is symmetric except the pawn's, so look from the
+    // square with the other side's pawn captures
+    Bitboard bishops = mByPiece[byColor + BISHOP] | mByPiece[byColor + QUEEN];
+    Bitboard rooks = mByPiece[byColor + ROOK] | mByPiece[byColor + QUEEN];
+    return (PawnAttacks[ColorIndex(Opponent(byColor))][square] & mByPiece[byColor + PAWN])
+        | (KnightAttacks[square] & mByPiece[byColor + KNIGHT])
+        | (KingAttacks[square] & mByPiece[byColor + KING])
+        | (BishopAttacks(square, occupied) & bishops)
+        | (RookAttacks(square, occupied) & rooks);
+}
+
+/**
+ * Does a move capture a piece?
+ * @param move Move for the side to move
+ * @return True for captures and en passant
+ */
+bool Position::IsCapture(Move move) const
+{
+    return (mBoard[move.To()] != EMPTY && move.GetType() != Move::CASTLING) || move.GetType() == Move::EN_PASSANT;
+}
+
+/**
+ * Find the pieces that alone stand between a king and an enemy
+ * slider that would otherwise attack it
+ * @param color Color of the king
+ * @param pinners Receives the enemy sliders pinning a piece of color
+ * @return Blocking pieces of either color
+ */
+Bitboard Position::SliderBlockers(int color, Bitboard &pinners) const
+{
+    int them = Opponent(color);
+    int kingSquare = KingSquare(color);
+    Bitboard snipers = (RookRays[kingSquare] & (mByPiece[them + ROOK] | mByPiece[them + QUEEN]))
+        | (BishopRays[kingSquare] & (mByPiece[them + BISHOP] | mByPiece[them + QUEEN]));
+    Bitboard occupied = Occupied() ^ snipers;
+
+    Bitboard blockers = 0;
+    pinners = 0;
+    while (snipers)
+    {
+        int sniper = PopLsb(snipers);
+        Bitboard between = BetweenBB(kingSquare, sniper) & occupied;
+        if (between && PopCount(between) == 1)
+        {
+            blockers |= between;
+            if (between & ColorPieces(color))
+            {
+                pinners |= SquareBB(sniper);
+            }
+        }
+    }
+    return blockers;
+}
+
+/**
+ * Recompute the checkers, blockers and check squares after the
+ * board or the side to move changed
+ */
+void Position::UpdateCheckInfo()
+{
+    int us = mSideToMove;
+    int them = Opponent(us);
+    int theirKing = KingSquare(them);
+
+    mCheckInfo.mCheckers = AttackersTo(KingSquare(us), them);
+    mCheckInfo.mBlockers[ColorIndex(WHITE)] = SliderBlockers(WHITE, mCheckInfo.mPinners[ColorIndex(WHITE)]);
+    mCheckInfo.mBlockers[ColorIndex(BLACK)] = SliderBlockers(BLACK, mCheckInfo.mPinners[ColorIndex(BLACK)]);
+
+    // Attacks are symmetric apart from the pawn's
+    mCheckInfo.mCheckSquares[PAWN] = PawnAttacks[ColorIndex(them)][theirKing];
+    mCheckInfo.mCheckSquares[KNIGHT] = KnightAttacks[theirKing];
+    mCheckInfo.mCheckSquares[BISHOP] = BishopAttacks(theirKing, Occupied());
+    mCheckInfo.mCheckSquares[ROOK] = RookAttacks(theirKing, Occupied());
+    mCheckInfo.mCheckSquares[QUEEN] = mCheckInfo.mCheckSquares[BISHOP] | mCheckInfo.mCheckSquares[ROOK];
+    mCheckInfo.mCheckSquares[KING] = 0;
+}
+
+/**
+ * Does a move give check? This uses the check squares and blockers
+ * of the position, so the move does not have to be made.
+ * @param move Pseudo-legal move for the side to move
+ * @return True if the opponent will be in check after the move
+ */
+bool Position::GivesCheck(Move move) const
+{
+    int us = mSideToMove;
+    int them = Opponent(us);
+    int from = move.From();
+    int to = move.To();
+    int theirKing = KingSquare(them);
+
+    // Direct check
+    if (Contains(mCheckInfo.mCheckSquares[TypeOf(mBoard[from])], to))
+    {
+        return true;
+    }
+
+    // Discovered check, a piece of ours moves off the line to their king
+    if (Contains(mCheckInfo.mBlockers[ColorIndex(them)] & ColorPieces(us), from) && !Aligned(from, to, theirKing))
+    {
+        return true;
+    }
+
+    Bitboard bishops = mByPiece[us + BISHOP] | mByPiece[us + QUEEN];
+    Bitboard rooks = mByPiece[us + ROOK] | mByPiece[us + QUEEN];
+    switch (move.GetType())
+    {
+    case Move::PROMOTION:
+    {
+        // The pawn's square is empty for the new piece
+        Bitboard occupied = Occupied() ^ SquareBB(from);
+        switch (move.PromotionType())
+        {
+        case KNIGHT: return Contains(KnightAttacks[to], theirKing);
+        case BISHOP: return Contains(BishopAttacks(to, occupied), theirKing);
+        case ROOK: return Contains(RookAttacks(to, occupied), theirKing);
+        default: return Contains(BishopAttacks(to, occupied) | RookAttacks(to, occupied), theirKing);
+        }
+    }
+
+    case Move::EN_PASSANT:
+    {
+        // Two pawns leave the line, either may uncover a slider
+        int captureSquare = MakeSquare(FileOf(to), RankOf(from));
+        Bitboard occupied = (Occupied() ^ SquareBB(from) ^ SquareBB(captureSquare)) | SquareBB(to);
+        return (BishopAttacks(theirKing, occupied) & bishops) || (RookAttacks(theirKing, occupied) & rooks);
+    }
+
+    case Move::CASTLING:
+    {
+        // Only the rook can check
+        bool kingSide = to > from;
+        int rookFrom = kingSide ? to + 1 : to - 2;
+        int rookTo = kingSide ? to - 1 : to + 1;
+        Bitboard occupied = (Occupied() ^ SquareBB(from) ^ SquareBB(rookFrom)) | SquareBB(to) | SquareBB(rookTo);
+        return Contains(RookAttacks(rookTo, occupied), theirKing);
+    }
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * Could a move be played in this position? This checks a move from
+ * the transposition table or a killer slot in constant time. Moves
+ * that pass are exactly those the generator would produce for the
+ * position, EVASIONS when in check and NON_EVASIONS otherwise.
+ * @param move Any move
+ * @return True if the move is pseudo-legal
+ */
+bool Position::IsPseudoLegal(Move move) const
+{
+    int us = mSideToMove;
+    int them = Opponent(us);
+    int from = move.From();
+    int to = move.To();
+    int piece = mBoard[from];
+    if (!move.IsValid() || piece == EMPTY || ColorOf(piece) != us || (ColorPieces(us) & SquareBB(to)))
+    {
+        return false;
+    }
+
+    int type = TypeOf(piece);
+    if (move.GetType() == Move::CASTLING)
+    {
+        // The same tests the generator makes
+        int home = us == WHITE ? MakeSquare(4, 0) : MakeSquare(4, 7);
+        if (type != KING || from != home || InCheck())
+        {
+            return false;
+        }
+        if (to == from + 2)
+        {
+            return (mCastlingRights & (us == WHITE ? WHITE_OO : BLACK_OO)) && mBoard[from + 1] == EMPTY
+                && mBoard[from + 2] == EMPTY && !IsSquareAttacked(from + 1, them);
+        }
+        if (to == from - 2)
+        {
+            return (mCastlingRights & (us == WHITE ? WHITE_OOO : BLACK_OOO)) && mBoard[from - 1] == EMPTY
+                && mBoard[from - 2] == EMPTY && mBoard[from - 3] == EMPTY && !IsSquareAttacked(from - 1, them);
+        }
+        return false;
+    }
+
+    if (type == PAWN)
+    {
+        int up = us == WHITE ? NORTH : SOUTH;
+        int lastRank = us == WHITE ? 7 : 0;
+        int startRank = us == WHITE ? 1 : 6;
+        if ((RankOf(to) == lastRank) != (move.GetType() == Move::PROMOTION))
+        {
+            return false;
+        }
+
+        bool valid;
+        if (move.GetType() == Move::EN_PASSANT)
+        {
+            valid = to == mEnPassant && Contains(PawnAttacks[ColorIndex(us)][from], to);
+        }
+        else if (Contains(PawnAttacks[ColorIndex(us)][from] & ColorPieces(them), to))
+        {
+            valid = true;
+        }
+        else
+        {
+            valid = mBoard[to] == EMPTY
+                && (to == from + up
+                    || (to == from + 2 * up && RankOf(from) == startRank && mBoard[from + up] == EMPTY));
+        }
+        if (!valid)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (move.GetType() != Move::NORMAL)
+        {
+            return false;
+        }
+
+        Bitboard attacks = 0;
+        switch (type)
+        {
+        case KNIGHT: attacks = Attacks<KNIGHT>(from); break;
+        case BISHOP: attacks = Attacks<BISHOP>(from); break;
+        case ROOK: attacks = Attacks<ROOK>(from); break;
+        case QUEEN: attacks = Attacks<QUEEN>(from); break;
+        default: attacks = Attacks<KING>(from); break;
+        }
+        if (!Contains(attacks, to))
+        {
+            return false;
+        }
+    }
+
+    // In check, anything but the king must capture the single checker
+    // or block it. En passant is left to IsLegal.
+    if (InCheck() && type != KING && move.GetType() != Move::EN_PASSANT)
+    {
+        Bitboard checkers = mCheckInfo.mCheckers;
+        if (PopCount(checkers) > 1)
+        {
+            return false;
+        }
+        return Contains(checkers | BetweenBB(KingSquare(us), Lsb(checkers)), to);
+    }
+    return true;
+}
+
+/**
+ * Does a pseudo-legal move leave the mover's king safe? Pins are
+ * looked up in the blockers, so the move does not have to be made.
+ * @param move Move that passes IsPseudoLegal
+ * @return True if the move is legal
+ */
+bool Position::IsLegal(Move move) const
+{
+    int us = mSideToMove;
+    int them = Opponent(us);
+    int from = move.From();
+    int to = move.To();
+    int kingSquare = KingSquare(us);
+
+    if (move.GetType() == Move::EN_PASSANT)
+    {
+        // Two pawns leave their squares, so look at every attacker
+        // with the captured pawn gone
+        int captureSquare = MakeSquare(FileOf(to), RankOf(from));
+        Bitboard occupied = (Occupied() ^ SquareBB(from) ^ SquareBB(captureSquare)) | SquareBB(to);
+        return !(AttackersTo(kingSquare, them, occupied) & ~SquareBB(captureSquare));
+    }
+
+    if (move.GetType() == Move::CASTLING)
+    {
+        // The generator has checked the squares before the last one
+        return !IsSquareAttacked(to, them);
+    }
+
+    if (from == kingSquare)
+    {
+        // The king no longer blocks a slider checking along its line
+        return !AttackersTo(to, them, Occupied() ^ SquareBB(from));
+    }
+
+    // Any other piece may only move along the line of a pin
+    return !Contains(BlockersForKing(us) & ColorPieces(us), from) || Aligned(from, to, kingSquare);
+}
+
+/**
+ * Does a side have any pieces besides pawns and the king?
+ * @param color WHITE or BLACK
+ * @return True if it has a knight, bishop, rook or queen
+ */
+bool Position::HasNonPawnMaterial(int color) const
+{
+    return mPieceCount[color + KNIGHT] + mPieceCount[color + BISHOP]
+        + mPieceCount[color + ROOK] + mPieceCount[color + QUEEN] > 0;
+}
+
+/**
+ * Has the current position occurred before since the last
+ * irreversible move? The search scores a single repetition as a
+ * draw, since whatever the side to move did there it can do again.
+ * Positions before a null move are not looked at, the null move
+ * is not a move of the game.
+ * @param count Earlier occurrences needed, 2 for a threefold repetition
+ * @return True if the position is a repetition
+ */
+bool Position::IsRepetition(int count) const
+{
+    int size = int(mHistory.size());
+    int end = std::min(mHalfmoveClock, mPliesFromNull);
+    for (int back = 4; back <= end; back += 2)
+    {
+        if (mHistory[size - back].mKey == mKey && --count == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Is there too little material left for either side to mate?
+ * @return True for K v K, K+minor v K
+ */
+bool Position::IsInsufficientMaterial() const
+{
+    int minors = 0;
+    for (int color : {WHITE, BLACK})
+    {
+        if (mPieceCount[color + PAWN] + mPieceCount[color + ROOK] + mPieceCount[color + QUEEN] > 0)
+        {
+            return false;
+        }
+        minors += mPieceCount[color + KNIGHT] + mPieceCount[color + BISHOP];
+    }
+    return minors <= 1;
+}
+
+/**
+ * Is the position drawn by rule?
+ * @return True for fifty moves, repetition or insufficient material
+ */
+bool Position::IsDraw() const
+{
+    return mHalfmoveClock >= 100 || IsRepetition() || IsInsufficientMaterial();
+}
+
+/**
+ * Add the promotions of a pawn that belong to a generation type
+ * @param moves List to add the moves to
+ * @param from Square of the pawn
+ * @param to Square on the last rank
+ */
+template<GenType Gen>
+static void AddPromotions(MoveList &moves, int from, int to)
+{
+    if constexpr (Gen == CAPTURES || Gen == EVASIONS || Gen == NON_EVASIONS)
+    {
+        moves.Add(Move::Make(from, to, Move::PROMOTION, QUEEN));
+    }
+    if constexpr (Gen == QUIETS || Gen == EVASIONS || Gen == NON_EVASIONS)
+    {
+        for (int promotion = ROOK; promotion >= KNIGHT; promotion--)
+        {
+            moves.Add(Move::Make(from, to, Move::PROMOTION, promotion));
+        }
+    }
+}
+
+/**
+ * Add a move for every square in a set, the from square
+ * being a fixed offset away
+ * @param moves List to add the moves to
+ * @param targets Squares the moves go to
+ * @param offset Offset from the from square to the to square
+ */
+static void AddPawnMoves(MoveList &moves, Bitboard targets, int offset)
+{
+    while (targets)
+    {
+        int to = PopLsb(targets);
+        moves.Add(Move(to - offset, to));
+    }
+}
+
+/**
+ * Generate the pawn moves of one side. All pawns are moved at
+ * once by shifting the set of pawns, so there is one loop per kind
+ * of pawn move rather than one per pawn.
+ * @param moves List to add the moves to
+ * @param target Squares the moves may go to, promotions aside
+ */
+template<int Us, GenType Gen>
+void Position::GeneratePawnMoves(MoveList &moves, Bitboard target) const
+{
+    constexpr int Them = Opponent(Us);
+    constexpr int Up = Us == WHITE ? NORTH : SOUTH;
+    constexpr int UpEast = Us == WHITE ? NORTH_EAST : SOUTH_EAST;
+    constexpr int UpWest = Us == WHITE ? NORTH_WEST : SOUTH_WEST;
+    constexpr Bitboard PromotionRank = RankBB(Us == WHITE ? 6 : 1);
+    constexpr Bitboard DoublePushRank = RankBB(Us == WHITE ? 2 : 5);
+
+    Bitboard empty = ~Occupied();
+    Bitboard enemies = ColorPieces(Them);
+    Bitboard pawns = mByPiece[Us + PAWN] & ~PromotionRank;
+    Bitboard promoting = mByPiece[Us + PAWN] & PromotionRank;
+
+    if constexpr (Gen != CAPTURES)
+    {
+        // Double pushes continue from single pushes that land on the third rank
+        Bitboard single = Shift<Up>(pawns) & empty;
+        Bitboard twice = Shift<Up>(single & DoublePushRank) & empty;
+        single &= target;
+        twice &= target;
+        if constexpr (Gen == QUIET_CHECKS)
+        {
+            // Direct checks, and pushes off a line to their king
+            // unless the line is the pawn's own file
+            Bitboard discoverers = pawns & BlockersForKing(Them) & ~FileBB(FileOf(KingSquare(Them)));
+            Bitboard checkSquares = mCheckInfo.mCheckSquares[PAWN];
+            Bitboard discovered = Shift<Up>(discoverers) & empty;
+            single &= checkSquares | discovered;
+            twice &= checkSquares | Shift<Up>(discovered & DoublePushRank);
+        }
+        AddPawnMoves(moves, single, Up);
+        AddPawnMoves(moves, twice, Up + Up);
+    }
+
+    if (promoting)
+    {
+        Bitboard pushes = Shift<Up>(promoting) & empty;
+        Bitboard east = Shift<UpEast>(promoting) & enemies;
+        Bitboard west = Shift<UpWest>(promoting) & enemies;
+        if constexpr (Gen == EVASIONS)
+        {
+            pushes &= target;
+            east &= target;
+            west &= target;
+        }
+        while (pushes)
+        {
+            int to = PopLsb(pushes);
+            AddPromotions<Gen>(moves, to - Up, to);
+        }
+        while (east)
+        {
+            int to = PopLsb(east);
+            AddPromotions<Gen>(moves, to - UpEast, to);
+        }
+        while (west)
+        {
+            int to = PopLsb(west);
+            AddPromotions<Gen>(moves, to - UpWest, to);
+        }
+    }
+
+    if constexpr (Gen == CAPTURES || Gen == EVASIONS || Gen == NON_EVASIONS)
+    {
+        AddPawnMoves(moves, Shift<UpEast>(pawns) & enemies & target, UpEast);
+        AddPawnMoves(moves, Shift<UpWest>(pawns) & enemies & target, UpWest);
+
+        if (mEnPassant != NO_SQUARE)
+        {
+            Bitboard attackers = pawns & PawnAttacks[ColorIndex(Them)][mEnPassant];
+            while (attackers)
+            {
+                moves.Add(Move::Make(PopLsb(attackers), mEnPassant, Move::EN_PASSANT));
+            }
+        }
+    }
+}
+
+/**
+ * Generate the moves of the knights, bishops, rooks, queens or king of one side
+ * @param moves List to add the moves to
+ * @param target Squares the moves may go to
+ */
+template<int Us, int Type, GenType Gen>
+void Position::GeneratePieceMoves(MoveList &moves, Bitboard target) const
+{
+    for (int i = 0; i < mPieceCount[Us + Type]; i++)
+    {
+        int from = mPieceList[Us + Type][i];
+        Bitboard attacks = Attacks<Type>(from) & target;
+        if constexpr (Gen == QUIET_CHECKS)
+        {
+            // A piece shielding their king from one of our sliders checks
+            // from anywhere off that line, any other piece only from
+            // the squares it would attack the king from
+            int theirKing = KingSquare(Opponent(Us));
+            if (Contains(BlockersForKing(Opponent(Us)), from))
+            {
+                Bitboard direct = attacks & mCheckInfo.mCheckSquares[Type];
+                Bitboard discovered = attacks & ~direct;
+                while (discovered)
+                {
+                    int to = PopLsb(discovered);
+                    if (!Aligned(from, to, theirKing))
+                    {
+                        direct |= SquareBB(to);
+                    }
+                }
+                attacks = direct;
+            }
+            else
+            {
+                attacks &= mCheckInfo.mCheckSquares[Type];
+            }
+        }
+        while (attacks)
+        {
+            moves.Add(Move(from, PopLsb(attacks)));
+        }
+    }
+}
+
+/**
+ * Generate pseudo-legal moves of one generation type for one
+ * side. Moves may still leave the king in check.
+ * @param moves List to add the moves to
+ */
+template<int Us, GenType Gen>
+void Position::GenerateAll(MoveList &moves) const
+{
+    constexpr int Them = Opponent(Us);
+    int kingSquare = KingSquare(Us);
+
+    Bitboard target;
+    if constexpr (Gen == EVASIONS)
+    {
+        Bitboard kingMoves = KingAttacks[kingSquare] & ~ColorPieces(Us);
+        while (kingMoves)
+        {
+            moves.Add(Move(kingSquare, PopLsb(kingMoves)));
+        }
+
+        // In double check only the king can move, otherwise the
+        // checker can be captured or the check blocked
+        Bitboard checkers = mCheckInfo.mCheckers;
+        if (PopCount(checkers) > 1)
+        {
+            return;
+        }
+        target = checkers | BetweenBB(kingSquare, Lsb(checkers));
+    }
+    else if constexpr (Gen == CAPTURES)
+    {
+        target = ColorPieces(Them);
+    }
+    else if constexpr (Gen == NON_EVASIONS)
+    {
+        target = ~ColorPieces(Us);
+    }
+    else
+    {
+        target = ~Occupied();
+    }
+
+    GeneratePawnMoves<Us, Gen>(moves, target);
+    GeneratePieceMoves<Us, KNIGHT, Gen>(moves, target);
+    GeneratePieceMoves<Us, BISHOP, Gen>(moves, target);
+    GeneratePieceMoves<Us, ROOK, Gen>(moves, target);
+    GeneratePieceMoves<Us, QUEEN, Gen>(moves, target);
+
+    if constexpr (Gen == CAPTURES || Gen == QUIETS || Gen == NON_EVASIONS)
+    {
+        GeneratePieceMoves<Us, KING, Gen>(moves, target);
+    }
+    else if constexpr (Gen == QUIET_CHECKS)
+    {
+        // The king only ever gives a discovered check
+        if (Contains(BlockersForKing(Them), kingSquare))
+        {
+            GeneratePieceMoves<Us, KING, Gen>(moves, target);
+        }
+    }
+
+    if constexpr (Gen == QUIETS || Gen == NON_EVASIONS)
+    {
+        // Castling, the king may not castle out of or through check
+        constexpr int KingSide = Us == WHITE ? WHITE_OO : BLACK_OO;
+        constexpr int QueenSide = Us == WHITE ? WHITE_OOO : BLACK_OOO;
+        if ((mCastlingRights & (KingSide | QueenSide)) && !InCheck())
+        {
+            if ((mCastlingRights & KingSide) && mBoard[kingSquare + 1] == EMPTY && mBoard[kingSquare + 2] == EMPTY
+                && !IsSquareAttacked(kingSquare + 1, Them))
+            {
+                moves.Add(Move::Make(kingSquare, kingSquare + 2, Move::CASTLING));
+            }
+            if ((mCastlingRights & QueenSide) && mBoard[kingSquare - 1] == EMPTY && mBoard[kingSquare - 2] == EMPTY
+                && mBoard[kingSquare - 3] == EMPTY && !IsSquareAttacked(kingSquare - 1, Them))
+            {
+                moves.Add(Move::Make(kingSquare, kingSquare - 2, Move::CASTLING));
+            }
+        }
+    }
+}
+
+/**
+ * Generate pseudo-legal moves for the side to move. Moves
+ * may still leave the king in check.
+ * @param moves List to add the moves to
+ */
+template<GenType Gen>
+void Position::GenerateMoves(MoveList &moves) const
+{
+    if (mSideToMove == WHITE)
+    {
+        GenerateAll<WHITE, Gen>(moves);
+    }
+    else
+    {
+        GenerateAll<BLACK, Gen>(moves);
+    }
+}
+
+template void Position::GenerateMoves<CAPTURES>(MoveList &moves) const;
+template void Position::GenerateMoves<QUIETS>(MoveList &moves) const;
+template void Position::GenerateMoves<QUIET_CHECKS>(MoveList &moves) const;
+template void Position::GenerateMoves<EVASIONS>(MoveList &moves) const;
+template void Position::GenerateMoves<NON_EVASIONS>(MoveList &moves) const;
+
+/**
+ * Generate only the legal moves for the side to move
+ * @param moves List to add the moves to
+ */
+void Position::GenerateLegalMoves(MoveList &moves) const
+{
+    MoveList pseudoLegal;
+    if (InCheck())
+    {
+        GenerateMoves<EVASIONS>(pseudoLegal);
+    }
+    else
+    {
+        GenerateMoves<NON_EVASIONS>(pseudoLegal);
+    }
+    for (Move move : pseudoLegal)
+    {
+        if (IsLegal(move))
+        {
+            moves.Add(move);
+        }
+    }
+}
+
+/**
+ * Does the side to move have any legal move? King steps and the
+ * moves of pieces that are not pinned are tried square by square,
+ * so the usual position answers without generating a move list.
+ * @return False for checkmate or stalemate
+ */
+bool Position::HasLegalMove() const
+{
+    int us = mSideToMove;
+    int them = Opponent(us);
+    int king = KingSquare(us);
+    Bitboard own = ColorPieces(us);
+
+    Bitboard withoutKing = Occupied() ^ SquareBB(king);
+    for (Bitboard targets = KingAttacks[king] & ~own; targets != 0;)
+    {
+        if (AttackersTo(PopLsb(targets), them, withoutKing) == 0)
+        {
+            return true;
+        }
+    }
+    if (PopCount(Checkers()) > 1)
+    {
+        return false;
+    }
+
+    if (!InCheck())
+    {
+        Bitboard unpinned = own & ~BlockersForKing(us);
+        for (Bitboard pieces = Pieces(us + KNIGHT) & unpinned; pieces != 0;)
+        {
+            if ((Attacks<KNIGHT>(PopLsb(pieces)) & ~own) != 0)
+            {
+                return true;
+            }
+        }
+        for (Bitboard pieces = Pieces(us + BISHOP) & unpinned; pieces != 0;)
+        {
+            if ((Attacks<BISHOP>(PopLsb(pieces)) & ~own) != 0)
+            {
+                return true;
+            }
+        }
+        for (Bitboard pieces = Pieces(us + ROOK) & unpinned; pieces != 0;)
+        {
+            if ((Attacks<ROOK>(PopLsb(pieces)) & ~own) != 0)
+            {
+                return true;
+            }
+        }
+        for (Bitboard pieces = Pieces(us + QUEEN) & unpinned; pieces != 0;)
+        {
+            if ((Attacks<QUEEN>(PopLsb(pieces)) & ~own) != 0)
+            {
+                return true;
+            }
+        }
+    }
+
+    // Pawns, pinned pieces and check evasions
+    MoveList pseudoLegal;
+    if (InCheck())
+    {
+        GenerateMoves<EVASIONS>(pseudoLegal);
+    }
+    else
+    {
+        GenerateMoves<NON_EVASIONS>(pseudoLegal);
+    }
+    for (Move move : pseudoLegal)
+    {
+        if (IsLegal(move))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Is the game over, and if so why? Checkmate takes priority over
+ * the fifty move rule, as it does over the board.
+ * @return GAME_ONGOING or the reason the game ended
+ */
+GameStatus Position::GetGameStatus() const
+{
+    if (!HasLegalMove())
+    {
+        return InCheck() ? GAME_CHECKMATE : GAME_STALEMATE;
+    }
+    if (mHalfmoveClock >= 100)
+    {
+        return GAME_FIFTY_MOVES;
+    }
+    if (IsRepetition(2))
+    {
+        return GAME_REPETITION;
+    }
+    if (IsInsufficientMaterial())
+    {
+        return GAME_INSUFFICIENT;
+    }
+    return GAME_ONGOING;
+}
+
+/**
+ * Find the legal move matching a UCI move string
+ * @param uci Move such as "e2e4" or "e7e8q"
+ * @return The move or Move::None() if it is not legal
+ */
+Move Position::ParseMove(std::string_view uci) const
+{
+    if (uci.size() < 4 || uci.size() > 5)
+    {
+        return Move::None();
+    }
+    int fromFile = uci[0] - 'a';
+    int fromRank = uci[1] - '1';
+    int toFile = uci[2] - 'a';
+    int toRank = uci[3] - '1';
+    if (fromFile < 0 || fromFile > 7 || fromRank < 0 || fromRank > 7
+        || toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7)
+    {
+        return Move::None();
+    }
+    int promotion = EMPTY;
+    if (uci.size() == 5)
+    {
+        size_t letter = std::string_view("nbrq").find(uci[4]);
+        if (letter == std::string_view::npos)
+        {
+            return Move::None();
+        }
+        promotion = KNIGHT + int(letter);
+    }
+
+    int from = MakeSquare(fromFile, fromRank);
+    int to = MakeSquare(toFile, toRank);
+    MoveList moves;
+    GenerateLegalMoves(moves);
+    for (Move move : moves)
+    {
+        if (move.From() == from && move.To() == to
+            && (move.GetType() == Move::PROMOTION ? move.PromotionType() == promotion : promotion == EMPTY))
+        {
+            return move;
+        }
+    }
+    return Move::None();
+}
+
+/**
+ * Find the legal move written in standard algebraic notation.
+ * Check marks, annotations and a missing "=" before the promotion
+ * piece are accepted, as is castling written with zeros.
+ * @param san Move such as "Nbd7", "exd6", "e8=Q+" or "O-O"
+ * @return The move, or Move::None() if no single legal move matches
+ */
+Move Position::ParseSan(std::string_view san) const
+{
+    while (!san.empty() && std::string_view("+#!?").find(san.back()) != std::string_view::npos)
+    {
+        san.remove_suffix(1);
+    }
+
+    MoveList moves;
+    GenerateLegalMoves(moves);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+    {
+        bool queenSide = san.size() == 5;
+        for (Move move : moves)
+        {
+            if (move.GetType() == Move::CASTLING && (move.To() < move.From()) == queenSide)
+            {
+                return move;
+            }
+        }
+        return Move::None();
+    }
+
+    // Piece letter, then the promotion piece from the end
+    int type = PAWN;
+    const std::string_view pieceLetters = "NBRQK";
+    if (!san.empty() && pieceLetters.find(san.front()) != std::string_view::npos)
+    {
+        const int types[] = {KNIGHT, BISHOP, ROOK, QUEEN, KING};
+        type = types[pieceLetters.find(san.front())];
+        san.remove_prefix(1);
+    }
+    int promotion = EMPTY;
+    if (type == PAWN && !san.empty() && pieceLetters.find(san.back()) < 4)
+    {
+        const int types[] = {KNIGHT, BISHOP, ROOK, QUEEN};
+        promotion = types[pieceLetters.find(san.back())];
+        san.remove_suffix(san.size() > 1 && san[san.size() - 2] == '=' ? 2 : 1);
+    }
+
+    // The last two characters are the destination, anything
+    // before them other than the capture mark disambiguates
+    if (san.size() < 2)
+    {
+        return Move::None();
+    }
+    int toFile = san[san.size() - 2] - 'a';
+    int toRank = san[san.size() - 1] - '1';
+    if (toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7)
+    {
+        return Move::None();
+    }
+    int fromFile = -1;
+    int fromRank = -1;
+    for (char c : san.substr(0, san.size() - 2))
+    {
+        if (c >= 'a' && c <= 'h')
+        {
+            fromFile = c - 'a';
+        }
+        else if (c >= '1' && c <= '8')
+        {
+            fromRank = c - '1';
+        }
+        else if (c != 'x' && c != '-' && c != ':')
+        {
+            return Move::None();
+        }
+    }
+
+    Move found = Move::None();
+    int to = MakeSquare(toFile, toRank);
+    for (Move move : moves)
+    {
+        int from = move.From();
+        int moveType = move.GetType();
+        if (move.To() != to || TypeOf(mBoard[from]) != type || moveType == Move::CASTLING
+            || (fromFile >= 0 && FileOf(from) != fromFile) || (fromRank >= 0 && RankOf(from) != fromRank)
+            || (moveType == Move::PROMOTION ? move.PromotionType() != promotion : promotion != EMPTY))
+        {
+            continue;
+        }
+        if (found.IsValid())
+        {
+            // Ambiguous
+            return Move::None();
+        }
+        found = move;
+    }
+    return found;
+}
+
+/**
+ * Write a legal move in standard algebraic notation, with just
+ * enough of the from square to tell it apart from the other legal
+ * moves and a "+" or "#" when it checks or mates. The move is made
+ * and taken back to find the mates.
+ * @param move A legal move
+ * @return Move text such as "Nbd7", "exd6", "e8=Q+" or "O-O"
+ */
+MoveText Position::SanText(Move move)
+{
+    MoveText text;
+    int from = move.From();
+    int to = move.To();
+    if (move.GetType() == Move::CASTLING)
+    {
+        text.Add(to > from ? "O-O" : "O-O-O");
+    }
+    else
+    {
+        int type = TypeOf(mBoard[from]);
+        bool capture = mBoard[to] != EMPTY || move.GetType() == Move::EN_PASSANT;
+        if (type == PAWN)
+        {
+            if (capture)
+            {
+                text.Add(char('a' + FileOf(from)));
+            }
+        }
+        else
+        {
+            text.Add(" KPNBRQ"[type]);
+
+            // Other pieces of the same type that attack the square. If this move is legal
+            // any of them may go there too, unless it is pinned off the line to it.
+            int us = mSideToMove;
+            Bitboard others = AttackersTo(to, us) & Pieces(mBoard[from]) & ~SquareBB(from);
+            bool ambiguous = false;
+            bool sameFile = false;
+            bool sameRank = false;
+            while (others != 0)
+            {
+                int other = PopLsb(others);
+                if (!Contains(BlockersForKing(us), other) || Aligned(other, to, KingSquare(us)))
+                {
+                    ambiguous = true;
+                    sameFile |= FileOf(other) == FileOf(from);
+                    sameRank |= RankOf(other) == RankOf(from);
+                }
+            }
+            if (ambiguous && (!sameFile || sameRank))
+            {
+                text.Add(char('a' + FileOf(from)));
+            }
+            if (sameFile)
+            {
+                text.Add(char('1' + RankOf(from)));
+            }
+        }
+        if (capture)
+        {
+            text.Add('x');
+        }
+        text.AddSquare(to);
+        if (move.GetType() == Move::PROMOTION)
+        {
+            text.Add('=');
+            text.Add(" KPNBRQ"[move.PromotionType()]);
+        }
+    }
+
+    if (GivesCheck(move))
+    {
+        DoMove(move);
+        text.Add(HasLegalMove() ? '+' : '#');
+        UndoMove();
+    }
+    return text;
+}
+
+/**
+ * Make a move. The move must be pseudo-legal.
+ * @param move Move to make
+ */
+void Position::DoMove(Move move)
+{
+    int us = mSideToMove;
+    int them = Opponent(us);
+    int from = move.From();
+    int to = move.To();
+    int piece = mBoard[from];
+    int captureSquare = move.GetType() == Move::EN_PASSANT ? to - (us == WHITE ? 8 : -8) : to;
+    int captured = move.GetType() == Move::CASTLING ? EMPTY : mBoard[captureSquare];
+
+    mHistory.push_back({move, captured, mCastlingRights, mEnPassant, mHalfmoveClock, mPliesFromNull, mKey, mCheckInfo,
+                        DirtyPiece()});
+
+    mKey ^= Zobrist.mSideToMove ^ Zobrist.mCastling[mCastlingRights];
+    if (mEnPassant != NO_SQUARE)
+    {
+        mKey ^= Zobrist.mEnPassant[FileOf(mEnPassant)];
+        mEnPassant = NO_SQUARE;
+    }
+    mHalfmoveClock++;
+    mPliesFromNull++;
+
+    DirtyPiece &dirty = mHistory.back().mDirty;
+    if (move.GetType() == Move::CASTLING)
+    {
+        bool kingSide = to > from;
+        int rookFrom = kingSide ? to + 1 : to - 2;
+        int rookTo = kingSide ? to - 1 : to + 1;
+        dirty.Add(us + ROOK, rookFrom, rookTo);
+        MovePiece(rookFrom, rookTo);
+    }
+
+    if (captured != EMPTY)
+    {
+        dirty.Add(captured, captureSquare, NO_SQUARE);
+        RemovePiece(captureSquare);
+        mHalfmoveClock = 0;
+    }
+
+    MovePiece(from, to);
+
+    if (TypeOf(piece) == PAWN)
+    {
+        mHalfmoveClock = 0;
+        if (move.GetType() == Move::PROMOTION)
+        {
+            // The pawn leaves the board and the new piece appears
+            dirty.Add(piece, from, NO_SQUARE);
+            dirty.Add(us + move.PromotionType(), NO_SQUARE, to);
+            RemovePiece(to);
+            PutPiece(us + move.PromotionType(), to);
+        }
+        else if (std::abs(to - from) == 16)
+        {
+            // Only record the en passant square if a pawn can use it
+            int passed = (from + to) / 2;
+            if (PawnAttacks[ColorIndex(us)][passed] & mByPiece[them + PAWN])
+            {
+                mEnPassant = passed;
+                mKey ^= Zobrist.mEnPassant[FileOf(mEnPassant)];
+            }
+        }
+    }
+
+    if (move.GetType() != Move::PROMOTION)
+    {
+        dirty.Add(piece, from, to);
+    }
+
+    mCastlingRights &= ~(CastlingMask(from) | CastlingMask(to));
+    mKey ^= Zobrist.mCastling[mCastlingRights];
+
+    if (us == BLACK)
+    {
+        mFullmoveNumber++;
+    }
+    mSideToMove = them;
+    UpdateCheckInfo();
+}
+
+/**
+ * Take back the last move made with DoMove
+ */
+void Position::UndoMove()
+{
+    StateInfo const &state = mHistory.back();
+    Move move = state.mMove;
+    int them = mSideToMove;
+    int us = Opponent(them);
+    int from = move.From();
+    int to = move.To();
+
+    mSideToMove = us;
+    if (us == BLACK)
+    {
+        mFullmoveNumber--;
+    }
+
+    // The piece helpers also update the key, which is simply restored below
+    if (move.GetType() == Move::PROMOTION)
+    {
+        RemovePiece(to);
+        PutPiece(us + PAWN, to);
+    }
+
+    MovePiece(to, from);
+
+    if (move.GetType() == Move::CASTLING)
+    {
+        bool kingSide = to > from;
+        MovePiece(kingSide ? to - 1 : to + 1, kingSide ? to + 1 : to - 2);
+    }
+
+    if (state.mCaptured != EMPTY)
+    {
+        int captureSquare = move.GetType() == Move::EN_PASSANT ? to - (us == WHITE ? 8 : -8) : to;
+        PutPiece(state.mCaptured, captureSquare);
+    }
+
+    mCastlingRights = state.mCastlingRights;
+    mEnPassant = state.mEnPassant;
+    mHalfmoveClock = state.mHalfmoveClock;
+    mPliesFromNull = state.mPliesFromNull;
+    mKey = state.mKey;
+    mCheckInfo = state.mCheckInfo;
+    mHistory.pop_back();
+}
+
+/**
+ * Pass the move to the opponent, used by null move pruning
+ */
+void Position::DoNullMove()
+{
+    mHistory.push_back({Move::Null(), EMPTY, mCastlingRights, mEnPassant, mHalfmoveClock, mPliesFromNull, mKey,
+                        mCheckInfo, DirtyPiece()});
+    mKey ^= Zobrist.mSideToMove;
+    if (mEnPassant != NO_SQUARE)
+    {
+        mKey ^= Zobrist.mEnPassant[FileOf(mEnPassant)];
+        mEnPassant = NO_SQUARE;
+    }
+    mHalfmoveClock++;
+    mPliesFromNull = 0;
+    mSideToMove = Opponent(mSideToMove);
+    UpdateCheckInfo();
+}
+
+/**
+ * Take back a null move
+ */
+void Position::UndoNullMove()
+{
+    StateInfo const &state = mHistory.back();
+    mSideToMove = Opponent(mSideToMove);
+    mEnPassant = state.mEnPassant;
+    mHalfmoveClock = state.mHalfmoveClock;
+    mPliesFromNull = state.mPliesFromNull;
+    mKey = state.mKey;
+    mCheckInfo = state.mCheckInfo;
+    mHistory.pop_back();
+}
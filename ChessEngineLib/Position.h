@@ -0,0 +1,347 @@
+/**
+ * @file Position.h
+ * @author John Korreck
+ *
+ * Chess position used by the search. Unlike Board, which owns
+ * the drawables for the GUI, Position is a plain value that can
+ * be copied into a search thread and supports make/unmake.
+ */
+
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bitboard.h"
+#include "ChessTypes.h"
+#include "Move.h"
+
+/// Most pieces with the same code a position can hold, eight pawns
+/// promoted to the same piece plus the two originals
+const int MAX_PIECES_PER_CODE = 10;
+
+/**
+ * Kinds of pseudo-legal moves Position::GenerateMoves produces.
+ * CAPTURES and QUIETS together make up NON_EVASIONS.
+ */
+enum GenType {
+    CAPTURES,       ///< Captures and queen promotions
+    QUIETS,         ///< Non-captures and under promotions
+    QUIET_CHECKS,   ///< Non-captures that give direct check
+    EVASIONS,       ///< Replies to check, only when in check
+    NON_EVASIONS    ///< Every move, only when not in check
+};
+
+/**
+ * Whether a game is over and why, see Position::GetGameStatus
+ */
+enum GameStatus {
+    GAME_ONGOING,           ///< The side to move has a legal move and no draw rule applies
+    GAME_CHECKMATE,         ///< The side to move is checkmated
+    GAME_STALEMATE,         ///< The side to move has no legal move but is not in check
+    GAME_FIFTY_MOVES,       ///< Fifty moves by each side without a capture or pawn move
+    GAME_REPETITION,        ///< The position has occurred three times
+    GAME_INSUFFICIENT       ///< Neither side has the material to mate
+};
+
+/**
+ * Check related squares of a position. These are recomputed after
+ * every move so that GivesCheck and check evasion do not have to
+ * make a move or search for attackers.
+ */
+struct CheckInfo {
+    /// Pieces giving check to the side to move
+    Bitboard mCheckers = 0;
+
+    /// Pieces of either side that alone stand between a king and an
+    /// enemy slider, indexed by ColorIndex() of the king
+    Bitboard mBlockers[2] = {};
+
+    /// Sliders pinning a piece to the king, indexed by ColorIndex() of the king
+    Bitboard mPinners[2] = {};
+
+    /// Squares each piece type of the side to move would check the
+    /// enemy king from, indexed by piece type
+    Bitboard mCheckSquares[QUEEN + 1] = {};
+};
+
+/**
+ * Pieces a move put on, took off or moved, so that evaluation
+ * terms kept up to date move by move know what changed
+ */
+struct DirtyPiece {
+    /// Number of changes, up to three for a capture that promotes
+    int mCount = 0;
+
+    /// Piece code of each change
+    int mPiece[3] = {};
+
+    /// Square the piece left, NO_SQUARE if it was put on the board
+    int mFrom[3] = {};
+
+    /// Square the piece arrived on, NO_SQUARE if it was taken off
+    int mTo[3] = {};
+
+    /**
+     * Record a change
+     * @param piece Piece code
+     * @param from Square it left or NO_SQUARE
+     * @param to Square it arrived on or NO_SQUARE
+     */
+    void Add(int piece, int from, int to)
+    {
+        mPiece[mCount] = piece;
+        mFrom[mCount] = from;
+        mTo[mCount] = to;
+        mCount++;
+    }
+};
+
+/**
+ * The state needed to take back a move
+ */
+struct StateInfo {
+    /// The move that was made
+    Move mMove;
+
+    /// The piece captured by the move, EMPTY if none
+    int mCaptured = EMPTY;
+
+    /// Castling rights before the move
+    int mCastlingRights = 0;
+
+    /// En passant square before the move
+    int mEnPassant = NO_SQUARE;
+
+    /// Fifty move counter before the move
+    int mHalfmoveClock = 0;
+
+    /// Plies since the last null move before the move
+    int mPliesFromNull = 0;
+
+    /// Position key before the move
+    uint64_t mKey = 0;
+
+    /// Check information before the move
+    CheckInfo mCheckInfo;
+
+    /// Pieces changed by the move
+    DirtyPiece mDirty;
+};
+
+/**
+ * A chess position with incremental make/unmake of moves.
+ *
+ * Alongside the board the position keeps a list of squares for
+ * each piece code, so move generation and evaluation only visit
+ * the pieces that are actually on the board.
+ */
+class Position {
+private:
+    /// Piece code on each square, a1 = 0 ... h8 = 63
+    int mBoard[SQUARE_NB] = {};
+
+    /// WHITE or BLACK
+    int mSideToMove = WHITE;
+
+    /// Castling rights as WHITE_OO | WHITE_OOO | ...
+    int mCastlingRights = 0;
+
+    /// Square a pawn may capture en passant on, NO_SQUARE if none
+    int mEnPassant = NO_SQUARE;
+
+    /// Half moves since the last capture or pawn move
+    int mHalfmoveClock = 0;
+
+    /// Plies made since the last null move, or since SetFen
+    int mPliesFromNull = 0;
+
+    /// Full move number as written in FEN
+    int mFullmoveNumber = 1;
+
+    /// Number of pieces of each piece code
+    int mPieceCount[PIECE_CODE_NB] = {};
+
+    /// Squares of the pieces of each piece code, unordered
+    int mPieceList[PIECE_CODE_NB][MAX_PIECES_PER_CODE] = {};
+
+    /// Index of the piece on each square in its piece list
+    int mPieceIndex[SQUARE_NB] = {};
+
+    /// Squares of the pieces of each piece code
+    Bitboard mByPiece[PIECE_CODE_NB] = {};
+
+    /// Squares of each side's pieces, indexed by ColorIndex()
+    Bitboard mByColor[2] = {};
+
+    /// Zobrist key of the position
+    uint64_t mKey = 0;
+
+    /// Zobrist key of the pawns alone. The piece helpers keep it up
+    /// to date in both directions, so undo needs nothing extra.
+    uint64_t mPawnKey = 0;
+
+    /// Key of the number of pieces of each piece code, whatever their
+    /// squares. Like mPawnKey it is kept up to date by the piece helpers.
+    uint64_t mMaterialKey = 0;
+
+    /// Checkers, pins and check squares of the position
+    CheckInfo mCheckInfo;
+
+    /// Undo information for every move made so far
+    std::vector<StateInfo> mHistory;
+
+    void PutPiece(int piece, int square);
+    void RemovePiece(int square);
+    void MovePiece(int from, int to);
+    uint64_t ComputeKey() const;
+    void UpdateCheckInfo();
+    Bitboard SliderBlockers(int color, Bitboard &pinners) const;
+
+    template<int Us, GenType Gen>
+    void GenerateAll(MoveList &moves) const;
+
+    template<int Us, GenType Gen>
+    void GeneratePawnMoves(MoveList &moves, Bitboard target) const;
+
+    template<int Us, int Type, GenType Gen>
+    void GeneratePieceMoves(MoveList &moves, Bitboard target) const;
+
+public:
+    /// Standard starting position
+    static const std::string StartFen;
+
+    Position();
+
+    bool SetFen(const std::string &fen);
+    std::string GetFen() const;
+
+    int PieceOn(int square) const { return mBoard[square]; }
+    int SideToMove() const { return mSideToMove; }
+    int CastlingRights() const { return mCastlingRights; }
+    int EnPassantSquare() const { return mEnPassant; }
+    int HalfmoveClock() const { return mHalfmoveClock; }
+    int FullmoveNumber() const { return mFullmoveNumber; }
+    int KingSquare(int color) const { return mPieceList[color + KING][0]; }
+
+    /// Number of pieces with a piece code
+    int PieceCount(int piece) const { return mPieceCount[piece]; }
+
+    /// Squares of the pieces with a piece code, PieceCount() of them
+    const int *Squares(int piece) const { return mPieceList[piece]; }
+
+    /// Set of the squares holding a piece code
+    Bitboard Pieces(int piece) const { return mByPiece[piece]; }
+
+    /// Set of the squares holding pieces of a color
+    Bitboard ColorPieces(int color) const { return mByColor[ColorIndex(color)]; }
+
+    /// Set of the occupied squares
+    Bitboard Occupied() const { return mByColor[0] | mByColor[1]; }
+
+    /**
+     * Squares a piece type attacks from a square on this board
+     * @param square Square the piece stands on
+     * @return Attacked squares, pawns excluded
+     */
+    template<int Type>
+    Bitboard Attacks(int square) const
+    {
+        if constexpr (Type == KNIGHT) return KnightAttacks[square];
+        if constexpr (Type == BISHOP) return BishopAttacks(square, Occupied());
+        if constexpr (Type == ROOK) return RookAttacks(square, Occupied());
+        if constexpr (Type == QUEEN) return BishopAttacks(square, Occupied()) | RookAttacks(square, Occupied());
+        if constexpr (Type == KING) return KingAttacks[square];
+        return 0;
+    }
+
+    /**
+     * Pieces of a color attacking a square
+     * @param square Square to test
+     * @param byColor Color of the attacking side
+     * @return Set of the attackers
+     */
+    Bitboard AttackersTo(int square, int byColor) const { return AttackersTo(square, byColor, Occupied()); }
+
+    Bitboard AttackersTo(int square, int byColor, Bitboard occupied) const;
+    uint64_t Key() const { return mKey; }
+
+    /// Key of the pawn structure, for the pawn hash table
+    uint64_t PawnKey() const { return mPawnKey; }
+
+    /// Key of the material on the board, for the material hash table
+    uint64_t MaterialKey() const { return mMaterialKey; }
+
+    /// Number of moves made since SetFen
+    int GamePly() const { return int(mHistory.size()); }
+
+    /**
+     * Key of a position reached earlier in the game
+     * @param ply Game ply, 0 for the SetFen position up to GamePly()
+     * @return Position key
+     */
+    uint64_t KeyAtPly(int ply) const { return ply == GamePly() ? mKey : mHistory[ply].mKey; }
+
+    /**
+     * Pieces changed by the move that reached a game ply
+     * @param ply Game ply, 1 to GamePly()
+     * @return The changes, none for a null move
+     */
+    const DirtyPiece &ChangesToPly(int ply) const { return mHistory[ply - 1].mDirty; }
+
+    /// The last move made, Move::None() if there is none
+    Move LastMove() const { return mHistory.empty() ? Move::None() : mHistory.back().mMove; }
+
+    /**
+     * Is a square attacked by any piece of a color?
+     * @param square Square to test
+     * @param byColor Color of the attacking side
+     * @return True if attacked
+     */
+    bool IsSquareAttacked(int square, int byColor) const { return AttackersTo(square, byColor) != 0; }
+
+    /// Is the side to move in check?
+    bool InCheck() const { return mCheckInfo.mCheckers != 0; }
+
+    /// Pieces giving check to the side to move
+    Bitboard Checkers() const { return mCheckInfo.mCheckers; }
+
+    /**
+     * Pieces of either side shielding a king from an enemy slider.
+     * Our own are pinned, the opponent's can give discovered check.
+     * @param color Color of the king
+     * @return Set of blocking pieces
+     */
+    Bitboard BlockersForKing(int color) const { return mCheckInfo.mBlockers[ColorIndex(color)]; }
+
+    /// After DoMove, did the move leave the mover's king safe?
+    bool LastMoveWasLegal() const { return !IsSquareAttacked(KingSquare(Opponent(mSideToMove)), mSideToMove); }
+
+    bool IsCapture(Move move) const;
+    bool GivesCheck(Move move) const;
+    bool IsPseudoLegal(Move move) const;
+    bool IsLegal(Move move) const;
+    bool HasNonPawnMaterial(int color) const;
+    bool IsRepetition(int count = 1) const;
+    bool IsInsufficientMaterial() const;
+    bool IsDraw() const;
+    bool HasLegalMove() const;
+    GameStatus GetGameStatus() const;
+
+    template<GenType Gen>
+    void GenerateMoves(MoveList &moves) const;
+    void GenerateLegalMoves(MoveList &moves) const;
+    Move ParseMove(std::string_view uci) const;
+    Move ParseSan(std::string_view san) const;
+    MoveText SanText(Move move);
+
+    void DoMove(Move move);
+    void UndoMove();
+    void DoNullMove();
+    void UndoNullMove();
+};
+
+#endif //POSITION_H
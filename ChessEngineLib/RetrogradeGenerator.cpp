@@ -0,0 +1,872 @@
+/**
+ * @file RetrogradeGenerator.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "RetrogradeGenerator.h"
+#include "Bitboard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <set>
+#include <thread>
+
+/// Positions a thread takes from a pass at a time
+const uint64_t PassChunk = 1 << 14;
+
+/// Value of a candidate that was neither lost nor ruled out
+const int VERIFY_KEEP = 1;
+
+/// Value of a candidate found to be lost
+const int VERIFY_LOST = 2;
+
+/**
+ * Squares a piece attacks
+ * @param piece Piece code
+ * @param square Square of the piece
+ * @param occupied Occupied squares
+ * @return Attacked squares
+ */
+static Bitboard PieceAttacks(int piece, int square, Bitboard occupied)
+{
+    switch (TypeOf(piece))
+    {
+    case PAWN:
+        return PawnAttacks[ColorIndex(ColorOf(piece))][square];
+    case KNIGHT:
+        return KnightAttacks[square];
+    case BISHOP:
+        return BishopAttacks(square, occupied);
+    case ROOK:
+        return RookAttacks(square, occupied);
+    case QUEEN:
+        return BishopAttacks(square, occupied) | RookAttacks(square, occupied);
+    default:
+        return KingAttacks[square];
+    }
+}
+
+/**
+ * Is a king in check?
+ * @param pieces Piece code of each piece
+ * @param squares Square of each piece
+ * @param count Number of pieces
+ * @param color Color of the king, WHITE or BLACK
+ * @return True if the other color attacks the king
+ */
+static bool InCheck(const int pieces[], const int squares[], int count, int color)
+{
+    Bitboard occupied = 0;
+    int king = NO_SQUARE;
+    for (int i = 0; i < count; i++)
+    {
+        occupied |= SquareBB(squares[i]);
+        if (pieces[i] == color + KING)
+        {
+            king = squares[i];
+        }
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (ColorOf(pieces[i]) != color && Contains(PieceAttacks(pieces[i], squares[i], occupied), king))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Signature of a set of pieces
+ * @param pieces Piece codes, both kings included
+ * @param count Number of pieces
+ * @return Normalized signature
+ */
+static std::string SignatureOf(const int pieces[], int count)
+{
+    const char letters[] = " KPNBRQ";
+    std::string sides[2];
+    for (int type : {KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN})
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (TypeOf(pieces[i]) == type)
+            {
+                sides[ColorIndex(ColorOf(pieces[i]))] += letters[type];
+            }
+        }
+    }
+    return EndgameTable::Normalize(sides[0] + "v" + sides[1]);
+}
+
+/**
+ * Signatures a capture or a promotion leads to
+ * @param table Table with the material before the move
+ * @return Normalized signatures of more than two pieces
+ */
+static std::set<std::string> SmallerTables(const EndgameTable &table)
+{
+    std::set<std::string> names;
+    int count = table.Count();
+    auto add = [&names, &table, count](int removed, int promoted, int type) {
+        int pieces[EGT_PIECES];
+        int left = 0;
+        for (int slot = 0; slot < count; slot++)
+        {
+            if (slot != removed)
+            {
+                pieces[left++] = slot == promoted ? ColorOf(table.PieceAt(slot)) + type : table.PieceAt(slot);
+            }
+        }
+        if (left > 2)
+        {
+            names.insert(SignatureOf(pieces, left));
+        }
+    };
+
+    for (int slot = 2; slot < count; slot++)
+    {
+        add(slot, -1, 0);
+        if (TypeOf(table.PieceAt(slot)) != PAWN)
+        {
+            continue;
+        }
+        for (int type : {KNIGHT, BISHOP, ROOK, QUEEN})
+        {
+            add(-1, slot, type);
+            for (int other = 2; other < count; other++)
+            {
+                if (ColorOf(table.PieceAt(other)) != ColorOf(table.PieceAt(slot)))
+                {
+                    add(other, slot, type);
+                }
+            }
+        }
+    }
+    return names;
+}
+
+/**
+ * Run a pass over the positions on several threads
+ * @param size Number of items
+ * @param threads Number of threads
+ * @param body Called with each item, returns true if it found work
+ * @return True if any call returned true
+ */
+template <typename Body> static bool ParallelFor(uint64_t size, int threads, Body &&body)
+{
+    std::atomic<uint64_t> next{0};
+    std::atomic<bool> found{false};
+    auto work = [&]() {
+        bool any = false;
+        for (uint64_t start; (start = next.fetch_add(PassChunk, std::memory_order_relaxed)) < size;)
+        {
+            uint64_t end = std::min(size, start + PassChunk);
+            for (uint64_t i = start; i < end; i++)
+            {
+                any |= body(i);
+            }
+        }
+        if (any)
+        {
+            found.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++)
+    {
+        pool.emplace_back(work);
+    }
+    work();
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+    return found.load();
+}
+
+/**
+ * Is a result a win for the side to move?
+ * @param result Stored result
+ * @return True for EGT_WIN to EGT_WIN + 126
+ */
+static bool IsWin(uint8_t result)
+{
+    return result >= EGT_WIN && result < EGT_LOSS;
+}
+
+/**
+ * Is a result a loss for the side to move?
+ * @param result Stored result
+ * @return True for EGT_LOSS to EGT_LOSS + 126
+ */
+static bool IsLoss(uint8_t result)
+{
+    return result >= EGT_LOSS && result != EGT_BROKEN;
+}
+
+/**
+ * The passes over one table being generated.
+ *
+ * All passes touch the results through std::atomic_ref, as a pass may
+ * write a position while another thread reads it. Within one pass a
+ * position only ever changes one way, so the order the threads get to
+ * it does not matter.
+ */
+class RetrogradeSolver {
+private:
+    /// Table being generated
+    const EndgameTable &mTable;
+
+    /// Smaller tables
+    const RetrogradeGenerator &mGenerator;
+
+    /// Results being generated
+    uint8_t *mResults;
+
+    /// One bit per position waiting to be checked for a loss
+    uint64_t *mCandidates;
+
+    /// Piece code of each slot
+    int mPieces[EGT_PIECES];
+
+    /// Number of pieces
+    int mCount;
+
+    /// Highest level some position is known to need
+    std::atomic<int> mMaxLevel{0};
+
+    /// Set if a distance does not fit in a result byte
+    std::atomic<bool> mOverflow{false};
+
+    /// Read a result
+    uint8_t Load(uint64_t index) const
+    {
+        return std::atomic_ref<uint8_t>(mResults[index]).load(std::memory_order_relaxed);
+    }
+
+    /// Write a result
+    void Store(uint64_t index, uint8_t result)
+    {
+        std::atomic_ref<uint8_t>(mResults[index]).store(result, std::memory_order_relaxed);
+    }
+
+    /// Mark a position to be checked for a loss
+    void MarkCandidate(uint64_t index)
+    {
+        std::atomic_ref<uint64_t>(mCandidates[index / 64]).fetch_or(uint64_t(1) << (index % 64), std::memory_order_relaxed);
+    }
+
+    /// Make sure a level is not finished before a position at it is
+    void NeedLevel(int level)
+    {
+        int current = mMaxLevel.load(std::memory_order_relaxed);
+        while (level > current && !mMaxLevel.compare_exchange_weak(current, level, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /// Level a result is handled at: a loss in N moves at N, a win in N at N - 1
+    static int LevelOf(uint8_t result)
+    {
+        return IsLoss(result) ? result - EGT_LOSS : IsWin(result) ? result - EGT_WIN : 0;
+    }
+
+    /**
+     * Result of a position after a capture or promotion
+     * @param pieces Piece code of each piece
+     * @param squares Square of each piece
+     * @param count Number of pieces
+     * @param stm 0 for white to move, 1 for black
+     * @return Result for the side to move
+     */
+    uint8_t Smaller(const int pieces[], const int squares[], int count, int stm) const
+    {
+        return count == 2 ? EGT_DRAW : mGenerator.Lookup(pieces, squares, count, stm);
+    }
+
+    uint8_t EnPassant(const int squares[], int stm, int pushed) const;
+
+    template <typename InTable, typename Leaving> void Moves(const int squares[], int stm, InTable &&inTable,
+                                                             Leaving &&leaving) const;
+    template <typename Visit> void Unmoves(const int squares[], int stm, Visit &&visit) const;
+
+public:
+    /**
+     * Constructor
+     * @param table Table being generated, allocated
+     * @param generator Generator holding the smaller tables
+     * @param candidates Zeroed candidate bits, one per position
+     */
+    RetrogradeSolver(EndgameTable &table, const RetrogradeGenerator &generator, uint64_t *candidates)
+        : mTable(table), mGenerator(generator), mResults(table.Results()), mCandidates(candidates),
+          mCount(table.Count())
+    {
+        for (int slot = 0; slot < mCount; slot++)
+        {
+            mPieces[slot] = table.PieceAt(slot);
+        }
+    }
+
+    /// Highest level some position is known to need
+    int MaxLevel() const { return mMaxLevel.load(); }
+
+    /// Did a distance not fit in a result byte?
+    bool Overflow() const { return mOverflow.load(); }
+
+    void Init(uint64_t index);
+    bool Propagate(uint64_t index, int level);
+    bool Mark(uint64_t index, int level);
+    int Verify(uint64_t index, int level);
+};
+
+/**
+ * Best result of capturing a pawn en passant right after its double push
+ * @param squares Square of each slot, after the push
+ * @param stm 0 if white may capture, 1 if black
+ * @param pushed Square the pawn was pushed to
+ * @return Best result for the side to move, EGT_BROKEN if no capture is legal
+ */
+uint8_t RetrogradeSolver::EnPassant(const int squares[], int stm, int pushed) const
+{
+    int color = stm == 0 ? WHITE : BLACK;
+    int target = stm == 0 ? pushed + 8 : pushed - 8;
+    uint8_t best = EGT_BROKEN;
+    for (int slot = 0; slot < mCount; slot++)
+    {
+        if (mPieces[slot] != color + PAWN || RankOf(squares[slot]) != RankOf(pushed)
+            || std::abs(FileOf(squares[slot]) - FileOf(pushed)) != 1)
+        {
+            continue;
+        }
+
+        int pieces[EGT_PIECES];
+        int after[EGT_PIECES];
+        int count = 0;
+        for (int other = 0; other < mCount; other++)
+        {
+            if (squares[other] != pushed)
+            {
+                pieces[count] = mPieces[other];
+                after[count++] = other == slot ? target : squares[other];
+            }
+        }
+        if (!InCheck(pieces, after, count, color))
+        {
+            uint8_t result = EndgameTable::BeforeMove(Smaller(pieces, after, count, stm ^ 1));
+            if (best == EGT_BROKEN || EndgameTable::Rank(result) > EndgameTable::Rank(best))
+            {
+                best = result;
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * Visit the legal moves of a position
+ * @param squares Square of each slot
+ * @param stm 0 for white to move, 1 for black
+ * @param inTable Called with the squares after each move that stays in
+ * the table and the opponent's best en passant capture, EGT_BROKEN if none
+ * @param leaving Called with the pieces, squares and count after each
+ * capture and promotion
+ */
+template <typename InTable, typename Leaving>
+void RetrogradeSolver::Moves(const int squares[], int stm, InTable &&inTable, Leaving &&leaving) const
+{
+    int color = stm == 0 ? WHITE : BLACK;
+    Bitboard occupied = 0;
+    Bitboard ours = 0;
+    for (int slot = 0; slot < mCount; slot++)
+    {
+        occupied |= SquareBB(squares[slot]);
+        ours |= ColorOf(mPieces[slot]) == color ? SquareBB(squares[slot]) : 0;
+    }
+
+    for (int slot = 0; slot < mCount; slot++)
+    {
+        if (ColorOf(mPieces[slot]) != color)
+        {
+            continue;
+        }
+        int from = squares[slot];
+        bool pawn = TypeOf(mPieces[slot]) == PAWN;
+        Bitboard targets;
+        if (pawn)
+        {
+            int forward = stm == 0 ? from + 8 : from - 8;
+            targets = PawnAttacks[stm][from] & occupied & ~ours;
+            if (!Contains(occupied, forward))
+            {
+                targets |= SquareBB(forward);
+                int twice = stm == 0 ? from + 16 : from - 16;
+                if (RankOf(from) == (stm == 0 ? 1 : 6) && !Contains(occupied, twice))
+                {
+                    targets |= SquareBB(twice);
+                }
+            }
+        }
+        else
+        {
+            targets = PieceAttacks(mPieces[slot], from, occupied) & ~ours;
+        }
+
+        while (targets != 0)
+        {
+            int to = PopLsb(targets);
+            bool capture = Contains(occupied, to);
+            bool promotion = pawn && (RankOf(to) == 0 || RankOf(to) == 7);
+            if (!capture && !promotion)
+            {
+                int after[EGT_PIECES];
+                std::copy(squares, squares + mCount, after);
+                after[slot] = to;
+                if (!InCheck(mPieces, after, mCount, color))
+                {
+                    inTable(after, pawn && std::abs(to - from) == 16 ? EnPassant(after, stm ^ 1, to) : EGT_BROKEN);
+                }
+                continue;
+            }
+
+            int pieces[EGT_PIECES];
+            int after[EGT_PIECES];
+            int count = 0;
+            int moved = 0;
+            for (int other = 0; other < mCount; other++)
+            {
+                if (other == slot)
+                {
+                    moved = count;
+                    pieces[count] = mPieces[other];
+                    after[count++] = to;
+                }
+                else if (squares[other] != to)
+                {
+                    pieces[count] = mPieces[other];
+                    after[count++] = squares[other];
+                }
+            }
+            if (InCheck(pieces, after, count, color))
+            {
+                continue;
+            }
+            if (!promotion)
+            {
+                leaving(pieces, after, count);
+                continue;
+            }
+            for (int type : {QUEEN, ROOK, BISHOP, KNIGHT})
+            {
+                pieces[moved] = color + type;
+                leaving(pieces, after, count);
+            }
+        }
+    }
+}
+
+/**
+ * Visit the positions a move without a capture or promotion leads
+ * from to a position
+ * @param squares Square of each slot
+ * @param stm 0 for white to move, 1 for black
+ * @param visit Called with the index of each position before, the
+ * moved pawn's square after a double push or NO_SQUARE
+ */
+template <typename Visit> void RetrogradeSolver::Unmoves(const int squares[], int stm, Visit &&visit) const
+{
+    int mover = stm ^ 1;
+    int color = mover == 0 ? WHITE : BLACK;
+    Bitboard occupied = 0;
+    for (int slot = 0; slot < mCount; slot++)
+    {
+        occupied |= SquareBB(squares[slot]);
+    }
+
+    for (int slot = 0; slot < mCount; slot++)
+    {
+        if (ColorOf(mPieces[slot]) != color)
+        {
+            continue;
+        }
+        int to = squares[slot];
+        Bitboard froms = 0;
+        if (TypeOf(mPieces[slot]) == PAWN)
+        {
+            int back = mover == 0 ? to - 8 : to + 8;
+            if ((mover == 0 ? RankOf(to) >= 2 : RankOf(to) <= 5) && !Contains(occupied, back))
+            {
+                froms |= SquareBB(back);
+                int twice = mover == 0 ? to - 16 : to + 16;
+                if (RankOf(to) == (mover == 0 ? 3 : 4) && !Contains(occupied, twice))
+                {
+                    froms |= SquareBB(twice);
+                }
+            }
+        }
+        else
+        {
+            froms = PieceAttacks(mPieces[slot], to, occupied) & ~occupied;
+        }
+
+        while (froms != 0)
+        {
+            int from = PopLsb(froms);
+            int before[EGT_PIECES];
+            std::copy(squares, squares + mCount, before);
+            before[slot] = from;
+            uint64_t index = mTable.Encode(before, mover);
+            if (index < mTable.Size())
+            {
+                visit(index, std::abs(to - from) == 16 && TypeOf(mPieces[slot]) == PAWN ? to : NO_SQUARE);
+            }
+        }
+    }
+}
+
+/**
+ * First pass: mark illegal positions, find mates and stalemates and
+ * score the captures and promotions
+ * @param index Position index
+ */
+void RetrogradeSolver::Init(uint64_t index)
+{
+    int squares[EGT_PIECES];
+    int stm;
+    mTable.Decode(index, squares, stm);
+    Bitboard occupied = 0;
+    bool broken = mTable.Encode(squares, stm) != index;
+    for (int slot = 0; slot < mCount && !broken; slot++)
+    {
+        broken = Contains(occupied, squares[slot]);
+        occupied |= SquareBB(squares[slot]);
+    }
+    if (broken || InCheck(mPieces, squares, mCount, stm == 0 ? BLACK : WHITE))
+    {
+        Store(index, EGT_BROKEN);
+        return;
+    }
+
+    int moves = 0;
+    int inTable = 0;
+    bool enPassant = false;
+    uint8_t best = EGT_BROKEN;
+    Moves(squares, stm,
+          [&](const int *, uint8_t capture) {
+              moves++;
+              inTable++;
+              enPassant |= capture != EGT_BROKEN;
+          },
+          [&](const int pieces[], const int after[], int count) {
+              moves++;
+              uint8_t result = Smaller(pieces, after, count, stm ^ 1);
+              if (result == EGT_WIN + 126)
+              {
+                  mOverflow = true;
+              }
+              result = EndgameTable::BeforeMove(result);
+              if (best == EGT_BROKEN || EndgameTable::Rank(result) > EndgameTable::Rank(best))
+              {
+                  best = result;
+              }
+          });
+
+    uint8_t result = EGT_DRAW;
+    if (moves == 0)
+    {
+        result = InCheck(mPieces, squares, mCount, stm == 0 ? WHITE : BLACK) ? EGT_LOSS : EGT_DRAW;
+    }
+    else if (IsWin(best) || inTable == 0)
+    {
+        result = best;
+    }
+    else if (enPassant)
+    {
+        // Whether an en passant capture saves the opponent is only
+        // known later, so check this position on every level
+        MarkCandidate(index);
+    }
+    NeedLevel(LevelOf(result));
+    Store(index, result);
+}
+
+/**
+ * Second pass of a level: positions a loss in level moves is reached
+ * from are wins in level + 1
+ * @param index Position index
+ * @param level The level
+ * @return True if the position is lost in level moves
+ */
+bool RetrogradeSolver::Propagate(uint64_t index, int level)
+{
+    if (Load(index) != EGT_LOSS + level)
+    {
+        return false;
+    }
+    int squares[EGT_PIECES];
+    int stm;
+    mTable.Decode(index, squares, stm);
+    uint8_t win = uint8_t(EGT_WIN + level);
+    Unmoves(squares, stm, [&](uint64_t before, int pushed) {
+        uint8_t result = Load(before);
+        if (result != EGT_DRAW && !(IsWin(result) && result > win))
+        {
+            return;
+        }
+        if (pushed != NO_SQUARE)
+        {
+            uint8_t capture = EnPassant(squares, stm, pushed);
+            if (capture != EGT_BROKEN && EndgameTable::Rank(capture) > EndgameTable::Rank(EGT_LOSS + level))
+            {
+                return;
+            }
+        }
+        Store(before, win);
+    });
+    return true;
+}
+
+/**
+ * Third pass of a level: positions a win in level + 1 moves is reached
+ * from may be lost
+ * @param index Position index
+ * @param level The level
+ * @return True if the position is won in level + 1 moves
+ */
+bool RetrogradeSolver::Mark(uint64_t index, int level)
+{
+    if (Load(index) != EGT_WIN + level)
+    {
+        return false;
+    }
+    int squares[EGT_PIECES];
+    int stm;
+    mTable.Decode(index, squares, stm);
+    Unmoves(squares, stm, [&](uint64_t before, int) {
+        if (Load(before) == EGT_DRAW)
+        {
+            MarkCandidate(before);
+        }
+    });
+    return true;
+}
+
+/**
+ * Last pass of a level: a candidate is lost if every move reaches a
+ * win for the opponent already known
+ * @param index Position index of a candidate
+ * @param level The level
+ * @return VERIFY_LOST, VERIFY_KEEP to check it again on the next level, or 0
+ */
+int RetrogradeSolver::Verify(uint64_t index, int level)
+{
+    if (Load(index) != EGT_DRAW)
+    {
+        return 0;
+    }
+    int squares[EGT_PIECES];
+    int stm;
+    mTable.Decode(index, squares, stm);
+
+    bool lost = true;
+    bool pending = false;
+    int depth = 0;
+    uint8_t known = uint8_t(EGT_WIN + level);
+    Moves(squares, stm,
+          [&](const int after[], uint8_t capture) {
+              uint8_t result = Load(mTable.Encode(after, stm ^ 1));
+              bool final = IsWin(result) && result <= known;
+              if (capture != EGT_BROKEN && IsWin(capture)
+                  && (final ? capture < result : capture <= known || IsLoss(result)))
+              {
+                  // The opponent does better taking en passant
+                  result = capture;
+                  final = true;
+              }
+              else if (capture != EGT_BROKEN && IsWin(capture) && !final)
+              {
+                  pending = true;
+                  NeedLevel(capture - EGT_WIN);
+                  return;
+              }
+              lost &= final;
+              depth = std::max(depth, result - EGT_WIN + 1);
+          },
+          [&](const int pieces[], const int after[], int count) {
+              uint8_t result = Smaller(pieces, after, count, stm ^ 1);
+              lost &= IsWin(result);
+              depth = std::max(depth, result - EGT_WIN + 1);
+          });
+
+    if (!lost)
+    {
+        return 0;
+    }
+    if (pending)
+    {
+        return VERIFY_KEEP;
+    }
+    if (depth > 126)
+    {
+        mOverflow = true;
+        return 0;
+    }
+    NeedLevel(depth);
+    Store(index, uint8_t(EGT_LOSS + depth));
+    return VERIFY_LOST;
+}
+
+/**
+ * Generate a table and the smaller tables it needs, writing each to
+ * the directory, which is created if needed. Smaller tables already in the directory are read.
+ * @param name Signature such as KRPvK
+ * @return False if it is not a signature or a table could not be written
+ */
+bool RetrogradeGenerator::Generate(const std::string &name)
+{
+    mError.clear();
+    std::error_code error;
+    std::filesystem::create_directories(mOptions.mDirectory, error);
+    return Require(name, true);
+}
+
+/**
+ * Make a table available, with the smaller tables it needs
+ * @param name Signature
+ * @param generate Generate it even if its file exists
+ * @return False on failure, with mError set
+ */
+bool RetrogradeGenerator::Require(const std::string &name, bool generate)
+{
+    auto table = std::make_unique<EndgameTable>();
+    if (!table->SetName(EndgameTable::Normalize(name)))
+    {
+        mError = "not an endgame of up to " + std::to_string(EGT_PIECES) + " pieces: " + name;
+        return false;
+    }
+    if (mByKey.count(table->Key()) != 0)
+    {
+        return true;
+    }
+
+    std::string path = (std::filesystem::path(mOptions.mDirectory) / (table->Name() + EndgameTableExtension)).string();
+    if (generate || !table->Open(path))
+    {
+        for (const std::string &smaller : SmallerTables(*table))
+        {
+            if (!Require(smaller, false))
+            {
+                return false;
+            }
+        }
+
+        Stats stats;
+        stats.mName = table->Name();
+        if (!Solve(*table, stats))
+        {
+            return false;
+        }
+        if (!table->Write(path) || !table->Open(path))
+        {
+            mError = "cannot write " + path;
+            return false;
+        }
+        mStats.push_back(stats);
+    }
+
+    mByKey[table->Key()] = table.get();
+    mByKey[table->Key2()] = table.get();
+    mTables.push_back(std::move(table));
+    return true;
+}
+
+/**
+ * Compute the results of a table
+ * @param table Table with its name set
+ * @param stats Receives the statistics
+ * @return False if a distance was too long to store
+ */
+bool RetrogradeGenerator::Solve(EndgameTable &table, Stats &stats)
+{
+    auto start = std::chrono::steady_clock::now();
+    int threads = std::max(1, mOptions.mThreads);
+    table.Allocate();
+    std::vector<uint64_t> candidates((table.Size() + 63) / 64, 0);
+    stats.mPeakMemory = table.Size() + candidates.size() * sizeof(uint64_t);
+
+    RetrogradeSolver solver(table, *this, candidates.data());
+    ParallelFor(table.Size(), threads, [&solver](uint64_t index) {
+        solver.Init(index);
+        return false;
+    });
+
+    for (int level = 0; !solver.Overflow(); level++)
+    {
+        bool active = ParallelFor(table.Size(), threads, [&](uint64_t index) { return solver.Propagate(index, level); });
+        active |= ParallelFor(table.Size(), threads, [&](uint64_t index) { return solver.Mark(index, level); });
+        active |= ParallelFor(candidates.size(), threads, [&](uint64_t word) {
+            uint64_t bits = candidates[word];
+            candidates[word] = 0;
+            bool any = false;
+            while (bits != 0)
+            {
+                uint64_t bit = bits & (0 - bits);
+                int verified = solver.Verify(word * 64 + uint64_t(Lsb(bits)), level);
+                candidates[word] |= verified == VERIFY_KEEP ? bit : 0;
+                any |= verified != 0;
+                bits ^= bit;
+            }
+            return any;
+        });
+        if (!active && level >= solver.MaxLevel())
+        {
+            break;
+        }
+    }
+    if (solver.Overflow())
+    {
+        mError = table.Name() + " has a mate longer than the tables can store";
+        return false;
+    }
+
+    for (uint64_t index = 0; index < table.Size(); index++)
+    {
+        uint8_t result = table.Result(index);
+        if (result == EGT_BROKEN)
+        {
+            continue;
+        }
+        stats.mPositions++;
+        if (IsWin(result))
+        {
+            stats.mWins++;
+            stats.mLongestMate = std::max(stats.mLongestMate, result - EGT_WIN + 1);
+        }
+        else
+        {
+            (IsLoss(result) ? stats.mLosses : stats.mDraws)++;
+        }
+    }
+    stats.mMilliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+/**
+ * Result of a position in a table generated or read so far
+ * @param pieces Piece code of each piece
+ * @param squares Square of each piece
+ * @param count Number of pieces
+ * @param stm 0 for white to move, 1 for black
+ * @return Result for the side to move, EGT_BROKEN if there is no table
+ */
+uint8_t RetrogradeGenerator::Lookup(const int pieces[], const int squares[], int count, int stm) const
+{
+    auto found = mByKey.find(EndgameTable::MaterialKey(pieces, count));
+    return found != mByKey.end() ? found->second->Lookup(pieces, squares, count, stm) : EGT_BROKEN;
+}
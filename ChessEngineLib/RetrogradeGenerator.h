@@ -0,0 +1,115 @@
+/**
+ * @file RetrogradeGenerator.h
+ * @author John Korreck
+ *
+ * Generates endgame tables by retrograde analysis.
+ */
+
+#ifndef RETROGRADEGENERATOR_H
+#define RETROGRADEGENERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "EndgameTable.h"
+
+/**
+ * Settings for generating tables
+ */
+struct RetrogradeOptions {
+    /// Worker threads
+    int mThreads = 1;
+
+    /// Directory tables are written to and smaller tables read from
+    std::string mDirectory = ".";
+};
+
+/**
+ * Solves endings of up to EGT_PIECES pieces backwards from mate.
+ *
+ * Every position is first scored by its captures and promotions,
+ * which lead into smaller tables, and checkmates and stalemates are
+ * found. Then, for each distance in turn, the positions lost in that
+ * many moves are un-moved to find the positions won in one more,
+ * and the positions those are un-moved to are checked to see whether
+ * every move now loses. The smaller tables are generated first, or
+ * read if their files already exist.
+ *
+ * Each position takes one result byte, plus one bit while it waits
+ * to be checked. The passes over the positions are shared out between
+ * the threads in chunks.
+ */
+class RetrogradeGenerator {
+public:
+    /**
+     * Statistics of a generated table
+     */
+    struct Stats {
+        /// Signature of the table
+        std::string mName;
+
+        /// Legal positions
+        uint64_t mPositions = 0;
+
+        /// Positions won, drawn and lost by the side to move
+        uint64_t mWins = 0;
+        uint64_t mDraws = 0;
+        uint64_t mLosses = 0;
+
+        /// Longest win in moves
+        int mLongestMate = 0;
+
+        /// Time taken in milliseconds
+        int64_t mMilliseconds = 0;
+
+        /// Most memory held for the table while generating, in bytes
+        uint64_t mPeakMemory = 0;
+    };
+
+private:
+    /// Settings for the generator
+    RetrogradeOptions mOptions;
+
+    /// Tables generated or read so far
+    std::vector<std::unique_ptr<EndgameTable>> mTables;
+
+    /// Tables by both of their material keys
+    std::unordered_map<uint64_t, const EndgameTable *> mByKey;
+
+    /// Statistics of every table generated
+    std::vector<Stats> mStats;
+
+    /// What went wrong
+    std::string mError;
+
+    bool Require(const std::string &name, bool generate);
+    bool Solve(EndgameTable &table, Stats &stats);
+
+public:
+    /**
+     * Constructor
+     * @param options Settings for the generator
+     */
+    RetrogradeGenerator(const RetrogradeOptions &options) : mOptions(options) {}
+
+    /// Copy constructor (disabled)
+    RetrogradeGenerator(const RetrogradeGenerator &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const RetrogradeGenerator &) = delete;
+
+    bool Generate(const std::string &name);
+
+    uint8_t Lookup(const int pieces[], const int squares[], int count, int stm) const;
+
+    /// Statistics of every table generated, smaller tables first
+    const std::vector<Stats> &GetStats() const { return mStats; }
+
+    /// What went wrong when Generate() returned false
+    const std::string &Error() const { return mError; }
+};
+
+#endif //RETROGRADEGENERATOR_H
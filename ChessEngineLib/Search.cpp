@@ -0,0 +1,780 @@
+/**
+ * @file Search.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Search.h"
+#include "MovePicker.h"
+#include "Tablebases.h"
+#include "EndgameTable.h"
+#include "TranspositionTable.h"
+#include "Tune.h"
+
+#include <chrono>
+
+/// Milliseconds kept in reserve for communication delays
+const int64_t MoveOverhead = 30;
+
+/// Moves assumed to remain in sudden death time controls
+const int DefaultMovesToGo = 30;
+
+/// Half width of the first aspiration window in centipawns
+static int AspirationDelta = 25;
+
+/// Null move reduction is NullMoveReduction + depth / NullMoveDepthDivisor
+static int NullMoveReduction = 2;
+static int NullMoveDepthDivisor = 4;
+
+/// Moves searched before quiet moves are reduced by one ply, and by two
+static int LmrMoves = 3;
+static int LmrDeepMoves = 8;
+
+/// The constants above are options for tuning
+static const bool Tunable = TuneParameter::Add({
+    {"AspirationDelta", &AspirationDelta, 0, 5, 200, false},
+    {"NullMoveReduction", &NullMoveReduction, 0, 1, 4, false},
+    {"NullMoveDepthDivisor", &NullMoveDepthDivisor, 0, 2, 12, false},
+    {"LmrMoves", &LmrMoves, 0, 1, 16, false},
+    {"LmrDeepMoves", &LmrDeepMoves, 0, 2, 40, false},
+});
+
+/**
+ * Current steady clock time
+ * @return Milliseconds
+ */
+static int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Convert a score to a form that does not depend on the ply it
+ * was found at, so mate and tablebase scores can be shared
+ * through the table.
+ * @param score Search score
+ * @param ply Distance from the root
+ * @return Score to store
+ */
+static int ScoreToTT(int score, int ply)
+{
+    return score >= VALUE_TB_WIN_IN_MAX_PLY ? score + ply : score <= -VALUE_TB_WIN_IN_MAX_PLY ? score - ply : score;
+}
+
+/**
+ * Inverse of ScoreToTT
+ * @param score Stored score
+ * @param ply Distance from the root
+ * @return Search score
+ */
+static int ScoreFromTT(int score, int ply)
+{
+    return score >= VALUE_TB_WIN_IN_MAX_PLY ? score - ply : score <= -VALUE_TB_WIN_IN_MAX_PLY ? score + ply : score;
+}
+
+/**
+ * Constructor
+ * @param tt Transposition table shared with later searches
+ */
+Search::Search(TranspositionTable &tt) : mTT(tt)
+{
+}
+
+/**
+ * Destructor, stops any running search
+ */
+Search::~Search()
+{
+    Stop();
+    Wait();
+}
+
+/**
+ * Start searching a position on the worker thread.
+ * Any search already running is stopped first.
+ * @param position Position to search
+ * @param limits When to stop
+ */
+void Search::Start(const Position &position, const SearchLimits &limits)
+{
+    Stop();
+    Wait();
+
+    mPosition = position;
+    mLimits = limits;
+    mStop = false;
+    mPondering = limits.mPonder;
+    mStartTime = Now();
+    mSearchStartTime = mStartTime;
+    InitTimeManagement();
+
+    mThread = std::thread(&Search::Run, this);
+}
+
+/**
+ * Stop the search. The best move found so far is still reported.
+ */
+void Search::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+}
+
+/**
+ * The opponent played the move we were pondering on. Keep
+ * searching, but from now on the clock applies.
+ */
+void Search::PonderHit()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStartTime = Now();
+        mPondering = false;
+    }
+    mCondition.notify_all();
+}
+
+/**
+ * Wait for the worker thread to finish
+ */
+void Search::Wait()
+{
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+/**
+ * Report a move chosen without searching, such as a book move,
+ * exactly as a finished search reports its best move
+ * @param move The move to play
+ */
+void Search::ReportBestMove(Move move)
+{
+    Stop();
+    Wait();
+    mNodes = 0;
+    if (mBestMoveCallback)
+    {
+        mBestMoveCallback(move, Move::None());
+    }
+}
+
+/**
+ * Decide how long to think from the clock
+ */
+void Search::InitTimeManagement()
+{
+    mOptimumTime = 0;
+    mMaximumTime = 0;
+
+    if (mLimits.mMoveTime > 0)
+    {
+        mOptimumTime = mMaximumTime = mLimits.mMoveTime;
+        return;
+    }
+
+    int us = ColorIndex(mPosition.SideToMove());
+    int64_t time = mLimits.mTime[us];
+    if (time <= 0)
+    {
+        return;
+    }
+
+    int movesToGo = mLimits.mMovesToGo > 0 ? std::min(mLimits.mMovesToGo, DefaultMovesToGo) : DefaultMovesToGo;
+    int64_t available = std::max<int64_t>(1, time - MoveOverhead);
+    mOptimumTime = std::min(available, available / movesToGo + mLimits.mIncrement[us] * 3 / 4);
+    mMaximumTime = std::min(available, mOptimumTime * 4);
+}
+
+/**
+ * Time used since the clock started
+ * @return Milliseconds
+ */
+int64_t Search::Elapsed() const
+{
+    return Now() - mStartTime;
+}
+
+/**
+ * Stop the search if it has run out of nodes or time.
+ * The clock does not run while pondering.
+ */
+void Search::CheckLimits()
+{
+    if (mLimits.mNodes > 0 && mNodes >= mLimits.mNodes)
+    {
+        mStop = true;
+    }
+
+    if (mPondering || mLimits.mInfinite || mMaximumTime == 0)
+    {
+        return;
+    }
+
+    if (Elapsed() >= mMaximumTime)
+    {
+        mStop = true;
+    }
+}
+
+/**
+ * Body of the worker thread, iterative deepening
+ */
+void Search::Run()
+{
+    mTT.NewSearch();
+    mNodes = 0;
+    mTbHits = 0;
+    for (auto &killers : mKillers)
+    {
+        killers[0] = killers[1] = Move::None();
+    }
+    for (auto &piece : mHistory)
+    {
+        std::fill(std::begin(piece), std::end(piece), 0);
+    }
+
+    MoveList legalMoves;
+    mPosition.GenerateLegalMoves(legalMoves);
+    mRootMoves.clear();
+    for (Move move : legalMoves)
+    {
+        RootMove rootMove;
+        rootMove.mMove = move;
+        rootMove.mPv.push_back(move);
+        mRootMoves.push_back(rootMove);
+    }
+    RankTablebaseMoves();
+
+    auto byScore = [](const RootMove &a, const RootMove &b) { return a.mScore > b.mScore; };
+    int lines = std::min<int>(mMultiPV, (int)mRootMoves.size());
+    int maxDepth = mLimits.mDepth > 0 ? std::min(mLimits.mDepth, MAX_PLY - 1) : MAX_PLY - 1;
+    for (int depth = 1; depth <= maxDepth && lines > 0; depth++)
+    {
+        for (mPvIndex = 0; mPvIndex < lines && !mStop; mPvIndex++)
+        {
+            mSelDepth = 0;
+            for (size_t i = mPvIndex; i < mRootMoves.size(); i++)
+            {
+                mRootMoves[i].mScore = -VALUE_INFINITE;
+            }
+
+            // Aspiration window around the last score of this line
+            int previous = mRootMoves[mPvIndex].mPreviousScore;
+            int delta = AspirationDelta;
+            int alpha = depth >= 4 ? std::max(previous - delta, -VALUE_INFINITE) : -VALUE_INFINITE;
+            int beta = depth >= 4 ? std::min(previous + delta, VALUE_INFINITE) : VALUE_INFINITE;
+            while (true)
+            {
+                int score = AlphaBeta(alpha, beta, depth, 0, false);
+
+                // Sort even when stopped so the best move found so far is first
+                std::stable_sort(mRootMoves.begin() + mPvIndex, mRootMoves.end(), byScore);
+                if (mStop)
+                {
+                    break;
+                }
+                if (score <= alpha)
+                {
+                    alpha = std::max(score - delta, -VALUE_INFINITE);
+                }
+                else if (score >= beta)
+                {
+                    beta = std::min(score + delta, VALUE_INFINITE);
+                }
+                else
+                {
+                    break;
+                }
+                delta += delta;
+            }
+
+            // A later line can come out ahead of an earlier one
+            std::stable_sort(mRootMoves.begin(), mRootMoves.begin() + mPvIndex + 1, byScore);
+        }
+
+        if (mStop)
+        {
+            break;
+        }
+
+        for (auto &rootMove : mRootMoves)
+        {
+            rootMove.mPreviousScore = rootMove.mScore;
+        }
+        SendInfo(depth, lines);
+
+        // Do not start an iteration we are unlikely to finish
+        if (!mPondering && !mLimits.mInfinite && mOptimumTime > 0 && mLimits.mMoveTime == 0
+            && Elapsed() > mOptimumTime / 2)
+        {
+            break;
+        }
+    }
+
+    // UCI forbids reporting a move while pondering or in infinite
+    // mode, so wait here for ponderhit or stop
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]() { return mStop || (!mPondering && !mLimits.mInfinite); });
+    }
+
+    Move bestMove = !mRootMoves.empty() ? mRootMoves[0].mMove : Move::None();
+    Move ponderMove = PonderMove(bestMove);
+    mPondering = false;
+    if (mBestMoveCallback)
+    {
+        mBestMoveCallback(bestMove, ponderMove);
+    }
+}
+
+/**
+ * Rank the root moves with the tablebases when the position is in
+ * them, and keep only the best ranked. Once DTZ or the distance to
+ * mate tables have ranked them every kept move makes progress, so the
+ * search stops probing. Otherwise it probes WDL while winning, to find
+ * its way.
+ */
+void Search::RankTablebaseMoves()
+{
+    mRootInTB = false;
+    mTbCardinality = std::max(mTablebases != nullptr ? mTablebases->MaxPieces() : 0,
+                              mEndgameTables != nullptr ? mEndgameTables->MaxPieces() : 0);
+    if (mTbCardinality < PopCount(mPosition.Occupied()) || mPosition.CastlingRights() != 0 || mRootMoves.empty())
+    {
+        return;
+    }
+
+    bool dtz = mTablebases != nullptr && mTablebases->RankRootMoves(mPosition, mRootMoves, mTbRule50);
+    mRootInTB = dtz || (mTablebases != nullptr && mTablebases->RankRootMovesWdl(mPosition, mRootMoves, mTbRule50));
+    if (!mRootInTB && mEndgameTables != nullptr)
+    {
+        dtz = mRootInTB = mEndgameTables->RankRootMoves(mPosition, mRootMoves);
+    }
+    if (!mRootInTB)
+    {
+        return;
+    }
+    mTbHits += mRootMoves.size();
+
+    std::stable_sort(mRootMoves.begin(), mRootMoves.end(),
+                     [](const RootMove &a, const RootMove &b) { return a.mTbRank > b.mTbRank; });
+    int bestRank = mRootMoves[0].mTbRank;
+    std::erase_if(mRootMoves, [bestRank](const RootMove &rootMove) { return rootMove.mTbRank != bestRank; });
+    if (dtz || mRootMoves[0].mTbScore <= VALUE_DRAW)
+    {
+        mTbCardinality = 0;
+    }
+}
+
+/**
+ * Report each line of a completed iteration
+ * @param depth Depth of the iteration
+ * @param lines Number of lines searched
+ */
+void Search::SendInfo(int depth, int lines)
+{
+    if (!mInfoCallback)
+    {
+        return;
+    }
+
+    SearchInfo info;
+    info.mDepth = depth;
+    info.mSelDepth = mSelDepth;
+    info.mNodes = mNodes;
+    info.mTime = Now() - mSearchStartTime;
+    info.mHashfull = mTT.Hashfull();
+    info.mTbHits = mTbHits;
+    for (int line = 0; line < lines; line++)
+    {
+        // Below mate scores the tablebases know better than the search
+        int score = mRootMoves[line].mScore;
+        info.mMultiPV = line + 1;
+        info.mScore = mRootInTB && std::abs(score) < VALUE_TB_WIN_IN_MAX_PLY ? mRootMoves[line].mTbScore : score;
+        info.mPv = mRootMoves[line].mPv;
+        mInfoCallback(info);
+    }
+}
+
+/**
+ * Find a move in the root moves that are still searched
+ * @param move Move to look for
+ * @return Index in mRootMoves, or -1 if it is excluded or illegal
+ */
+int Search::RootMoveIndex(Move move) const
+{
+    for (int i = mPvIndex; i < (int)mRootMoves.size(); i++)
+    {
+        if (mRootMoves[i].mMove == move)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Find the reply we expect to the best move
+ * @param bestMove The move we are going to play
+ * @return Expected reply or Move::None()
+ */
+Move Search::PonderMove(Move bestMove)
+{
+    if (!bestMove.IsValid())
+    {
+        return Move::None();
+    }
+    if (mRootMoves[0].mPv.size() >= 2)
+    {
+        return mRootMoves[0].mPv[1];
+    }
+
+    // The PV was cut short, fall back on the transposition table
+    Move ponderMove = Move::None();
+    mPosition.DoMove(bestMove);
+    TTEntry entry;
+    if (mTT.Probe(mPosition.Key(), entry))
+    {
+        MoveList replies;
+        mPosition.GenerateLegalMoves(replies);
+        if (replies.Contains(entry.GetMove()))
+        {
+            ponderMove = entry.GetMove();
+        }
+    }
+    mPosition.UndoMove();
+    return ponderMove;
+}
+
+/**
+ * Principal variation search
+ * @param alpha Lower bound
+ * @param beta Upper bound
+ * @param depth Remaining depth
+ * @param ply Distance from the root
+ * @param nullAllowed May a null move be tried here?
+ * @return Score from the side to move's point of view
+ */
+int Search::AlphaBeta(int alpha, int beta, int depth, int ply, bool nullAllowed)
+{
+    bool pvNode = beta - alpha > 1;
+    bool root = ply == 0;
+    mPvLength[ply] = ply;
+
+    if (depth <= 0)
+    {
+        return Quiescence(alpha, beta, ply);
+    }
+
+    if ((++mNodes & 2047) == 0)
+    {
+        CheckLimits();
+    }
+    if (mStop)
+    {
+        return 0;
+    }
+    mSelDepth = std::max(mSelDepth, ply);
+
+    if (!root)
+    {
+        if (mPosition.IsDraw())
+        {
+            // Mate on the hundredth half move still counts as mate
+            if (mPosition.InCheck() && !mPosition.HasLegalMove())
+            {
+                return MatedIn(ply);
+            }
+            return VALUE_DRAW;
+        }
+        if (ply >= MAX_PLY - 1)
+        {
+            return mEvaluation.Evaluate(mPosition);
+        }
+
+        // Mate distance pruning
+        alpha = std::max(alpha, MatedIn(ply));
+        beta = std::min(beta, MateIn(ply + 1));
+        if (alpha >= beta)
+        {
+            return alpha;
+        }
+    }
+
+    TTEntry entry;
+    bool ttHit = mTT.Probe(mPosition.Key(), entry);
+    Move ttMove = ttHit ? entry.GetMove() : Move::None();
+    if (ttHit && !pvNode && entry.mDepth >= depth)
+    {
+        int ttScore = ScoreFromTT(entry.mScore, ply);
+        Bound bound = entry.GetBound();
+        if (bound == BOUND_EXACT || (bound == BOUND_LOWER && ttScore >= beta) || (bound == BOUND_UPPER && ttScore <= alpha))
+        {
+            return ttScore;
+        }
+    }
+
+    // The tables know nothing of the fifty move counter, so they are
+    // only probed right after a capture or a pawn move
+    if (!root && mTbCardinality > 0 && mPosition.HalfmoveClock() == 0 && mPosition.CastlingRights() == 0)
+    {
+        int pieces = PopCount(mPosition.Occupied());
+        if (pieces < mTbCardinality || (pieces == mTbCardinality && depth >= mTbProbeDepth))
+        {
+            ProbeState state = PROBE_FAIL;
+            WdlScore wdl = mTablebases != nullptr ? mTablebases->ProbeWdl(mPosition, state) : WDL_DRAW;
+            uint8_t result = EGT_DRAW;
+            if (state != PROBE_FAIL || (mEndgameTables != nullptr && mEndgameTables->Probe(mPosition, result)))
+            {
+                mTbHits++;
+                int drawScore = mTbRule50 ? 1 : 0;
+                int score = state == PROBE_FAIL ? EndgameTables::Score(result, ply)
+                    : wdl < -drawScore ? -VALUE_TB_WIN + ply
+                    : wdl > drawScore ? VALUE_TB_WIN - ply
+                    : VALUE_DRAW + 2 * wdl * drawScore;
+                Bound bound = state == PROBE_FAIL ? BOUND_EXACT
+                    : wdl < -drawScore ? BOUND_UPPER
+                    : wdl > drawScore ? BOUND_LOWER : BOUND_EXACT;
+                if (bound == BOUND_EXACT || (bound == BOUND_LOWER ? score >= beta : score <= alpha))
+                {
+                    int eval = mPosition.InCheck() ? 0 : mEvaluation.Evaluate(mPosition);
+                    mTT.Store(mPosition.Key(), Move::None(), ScoreToTT(score, ply), eval,
+                              std::min(MAX_PLY - 1, depth + 6), bound);
+                    return score;
+                }
+            }
+        }
+    }
+
+    int us = mPosition.SideToMove();
+    bool inCheck = mPosition.InCheck();
+    int staticEval = inCheck ? VALUE_NONE : ttHit ? entry.mEval : mEvaluation.Evaluate(mPosition);
+
+    // Null move pruning, if passing still beats beta a real move will too
+    if (!pvNode && !inCheck && nullAllowed && depth >= 3 && staticEval >= beta && mPosition.HasNonPawnMaterial(us))
+    {
+        int reduction = NullMoveReduction + depth / NullMoveDepthDivisor;
+        mPosition.DoNullMove();
+        int score = -AlphaBeta(-beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+        mPosition.UndoNullMove();
+        if (mStop)
+        {
+            return 0;
+        }
+        if (score >= beta)
+        {
+            return score >= VALUE_TB_WIN_IN_MAX_PLY ? beta : score;
+        }
+    }
+
+    // The previous iteration already sorted the root moves, and the
+    // best moves of earlier lines are left out
+    MoveList rootMoves;
+    if (root)
+    {
+        for (int i = mPvIndex; i < int(mRootMoves.size()); i++)
+        {
+            rootMoves.Add(mRootMoves[i].mMove);
+        }
+    }
+    MovePicker picker = root ? MovePicker(mPosition, rootMoves) : MovePicker(mPosition, ttMove, mKillers[ply], mHistory);
+
+    int originalAlpha = alpha;
+    int bestScore = -VALUE_INFINITE;
+    Move bestMove = Move::None();
+    int legalMoves = 0;
+
+    for (Move move = picker.NextMove(); move.IsValid(); move = picker.NextMove())
+    {
+        if (!mPosition.IsLegal(move))
+        {
+            continue;
+        }
+        int rootIndex = root ? RootMoveIndex(move) : 0;
+        bool quiet = !mPosition.IsCapture(move) && move.GetType() != Move::PROMOTION;
+        int piece = mPosition.PieceOn(move.From());
+        bool givesCheck = mPosition.GivesCheck(move);
+
+        mPosition.DoMove(move);
+        legalMoves++;
+
+        int newDepth = depth - 1 + (givesCheck ? 1 : 0);
+
+        int score;
+        if (legalMoves == 1)
+        {
+            score = -AlphaBeta(-beta, -alpha, newDepth, ply + 1, true);
+        }
+        else
+        {
+            // Late move reductions for quiet moves ordered near the end
+            int reduction = 0;
+            if (depth >= 3 && legalMoves > LmrMoves && quiet && !inCheck && !givesCheck)
+            {
+                reduction = legalMoves > LmrDeepMoves ? 2 : 1;
+            }
+
+            score = -AlphaBeta(-alpha - 1, -alpha, newDepth - reduction, ply + 1, true);
+            if (score > alpha && reduction > 0)
+            {
+                score = -AlphaBeta(-alpha - 1, -alpha, newDepth, ply + 1, true);
+            }
+            if (score > alpha && score < beta)
+            {
+                score = -AlphaBeta(-beta, -alpha, newDepth, ply + 1, true);
+            }
+        }
+        mPosition.UndoMove();
+
+        if (mStop)
+        {
+            return 0;
+        }
+
+        if (root)
+        {
+            // Moves that do not raise alpha only have an upper bound
+            // and are sorted behind the ones that do
+            RootMove &rootMove = mRootMoves[rootIndex];
+            if (legalMoves == 1 || score > alpha)
+            {
+                rootMove.mScore = score;
+                rootMove.mPv.assign(1, move);
+                rootMove.mPv.insert(rootMove.mPv.end(), mPv[1] + 1, mPv[1] + mPvLength[1]);
+            }
+            else
+            {
+                rootMove.mScore = -VALUE_INFINITE;
+            }
+        }
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha)
+            {
+                alpha = score;
+                mPv[ply][ply] = move;
+                for (int next = ply + 1; next < mPvLength[ply + 1]; next++)
+                {
+                    mPv[ply][next] = mPv[ply + 1][next];
+                }
+                mPvLength[ply] = std::max(mPvLength[ply + 1], ply + 1);
+
+                if (score >= beta)
+                {
+                    if (quiet)
+                    {
+                        if (mKillers[ply][0] != move)
+                        {
+                            mKillers[ply][1] = mKillers[ply][0];
+                            mKillers[ply][0] = move;
+                        }
+                        mHistory[piece][move.To()] = std::min(mHistory[piece][move.To()] + depth * depth, 80000);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (legalMoves == 0)
+    {
+        return inCheck ? MatedIn(ply) : VALUE_DRAW;
+    }
+
+    // Later lines exclude root moves, so their score is not the root's
+    if (root && mPvIndex > 0)
+    {
+        return bestScore;
+    }
+
+    Bound bound = bestScore >= beta ? BOUND_LOWER : pvNode && bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER;
+    mTT.Store(mPosition.Key(), bestMove, ScoreToTT(bestScore, ply), staticEval == VALUE_NONE ? 0 : staticEval, depth, bound);
+    return bestScore;
+}
+
+/**
+ * Search captures only until the position is quiet
+ * @param alpha Lower bound
+ * @param beta Upper bound
+ * @param ply Distance from the root
+ * @return Score from the side to move's point of view
+ */
+int Search::Quiescence(int alpha, int beta, int ply)
+{
+    mPvLength[ply] = ply;
+    if ((++mNodes & 2047) == 0)
+    {
+        CheckLimits();
+    }
+    if (mStop)
+    {
+        return 0;
+    }
+    mSelDepth = std::max(mSelDepth, ply);
+
+    if (ply >= MAX_PLY - 1)
+    {
+        return mEvaluation.Evaluate(mPosition);
+    }
+
+    // When in check every evasion is searched, there is no standing pat
+    bool inCheck = mPosition.InCheck();
+    int bestScore = -VALUE_INFINITE;
+    if (!inCheck)
+    {
+        bestScore = mEvaluation.Evaluate(mPosition);
+        if (bestScore >= beta)
+        {
+            return bestScore;
+        }
+        alpha = std::max(alpha, bestScore);
+    }
+
+    MovePicker picker(mPosition, Move::None(), mHistory);
+    int legalMoves = 0;
+    for (Move move = picker.NextMove(); move.IsValid(); move = picker.NextMove())
+    {
+        if (!mPosition.IsLegal(move))
+        {
+            continue;
+        }
+
+        mPosition.DoMove(move);
+        legalMoves++;
+        int score = -Quiescence(-beta, -alpha, ply + 1);
+        mPosition.UndoMove();
+
+        if (mStop)
+        {
+            return 0;
+        }
+        if (score > bestScore)
+        {
+            bestScore = score;
+            if (score > alpha)
+            {
+                alpha = score;
+                if (score >= beta)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (inCheck && legalMoves == 0)
+    {
+        return MatedIn(ply);
+    }
+    return bestScore;
+}
@@ -0,0 +1,314 @@
+/**
+ * @file Search.h
+ * @author John Korreck
+ *
+ * Iterative deepening alpha-beta search run on a worker thread.
+ */
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Position.h"
+#include "Evaluation.h"
+
+class TranspositionTable;
+class Tablebases;
+class EndgameTables;
+
+/**
+ * Limits for a search, as given by the UCI go command
+ */
+struct SearchLimits {
+    /// Maximum depth, 0 for no limit
+    int mDepth = 0;
+
+    /// Exact time to search in milliseconds, 0 if not used
+    int64_t mMoveTime = 0;
+
+    /// Remaining clock time in milliseconds, indexed by ColorIndex()
+    int64_t mTime[2] = {0, 0};
+
+    /// Increment per move in milliseconds, indexed by ColorIndex()
+    int64_t mIncrement[2] = {0, 0};
+
+    /// Moves until the next time control, 0 if sudden death
+    int mMovesToGo = 0;
+
+    /// Maximum nodes to search, 0 for no limit
+    uint64_t mNodes = 0;
+
+    /// Search until told to stop
+    bool mInfinite = false;
+
+    /// Search on the opponent's time until ponderhit or stop
+    bool mPonder = false;
+};
+
+/**
+ * Progress report sent after each completed iteration
+ */
+struct SearchInfo {
+    /// Depth of the iteration
+    int mDepth = 0;
+
+    /// Deepest ply reached
+    int mSelDepth = 0;
+
+    /// Score from the side to move's point of view
+    int mScore = 0;
+
+    /// Nodes searched so far
+    uint64_t mNodes = 0;
+
+    /// Milliseconds since the search started
+    int64_t mTime = 0;
+
+    /// Line number when searching several lines, 1 for the best
+    int mMultiPV = 1;
+
+    /// Transposition table use in permill
+    int mHashfull = 0;
+
+    /// Tablebase probes that found a result
+    uint64_t mTbHits = 0;
+
+    /// The principal variation
+    std::vector<Move> mPv;
+};
+
+/**
+ * A legal move at the root and what the search found for it
+ */
+struct RootMove {
+    /// The move
+    Move mMove;
+
+    /// Score in the current iteration, -VALUE_INFINITE until searched
+    int mScore = -VALUE_INFINITE;
+
+    /// Score in the last completed iteration
+    int mPreviousScore = -VALUE_INFINITE;
+
+    /// Principal variation starting with mMove
+    std::vector<Move> mPv;
+
+    /// Rank given by the tablebases, higher is better
+    int mTbRank = 0;
+
+    /// Score the tablebases give the move
+    int mTbScore = 0;
+};
+
+/**
+ * Searches a position on its own thread.
+ *
+ * A search started with SearchLimits::mPonder ignores the clock
+ * until PonderHit() is called, at which point it becomes a normal
+ * timed search that keeps everything it has found so far. The
+ * transposition table is shared with later searches, so even a
+ * ponder miss leaves useful entries behind.
+ *
+ * With MultiPV set above one, each iteration searches the best
+ * line, then the best line excluding that move and so on. Every
+ * line after the first starts from a table filled by the ones
+ * before it, so N lines cost far less than N searches.
+ */
+class Search {
+private:
+    /// The shared transposition table
+    TranspositionTable &mTT;
+
+    /// Static evaluation owned by this search thread
+    Evaluation mEvaluation;
+
+    /// Copy of the position being searched
+    Position mPosition;
+
+    /// Limits for the current search
+    SearchLimits mLimits;
+
+    /// The worker thread
+    std::thread mThread;
+
+    /// Set to abort the search as soon as possible
+    std::atomic<bool> mStop{false};
+
+    /// True while searching on the opponent's time
+    std::atomic<bool> mPondering{false};
+
+    /// Time the clock started, in steady clock milliseconds. This is
+    /// moved forward on ponderhit since pondering is on the opponent's time.
+    std::atomic<int64_t> mStartTime{0};
+
+    /// Time the search started, for reporting
+    int64_t mSearchStartTime = 0;
+
+    /// Guards waiting for ponderhit or stop once the search is done
+    std::mutex mMutex;
+
+    /// Signalled by Stop() and PonderHit()
+    std::condition_variable mCondition;
+
+    /// Time after which no new iteration is started
+    int64_t mOptimumTime = 0;
+
+    /// Time after which the search is aborted
+    int64_t mMaximumTime = 0;
+
+    /// Nodes searched
+    uint64_t mNodes = 0;
+
+    /// Deepest ply reached
+    int mSelDepth = 0;
+
+    /// Quiet moves that caused a beta cutoff, per ply
+    Move mKillers[MAX_PLY + 1][2];
+
+    /// Cutoff history for quiet moves by piece and to square
+    int mHistory[PIECE_CODE_NB][SQUARE_NB] = {};
+
+    /// Triangular principal variation table
+    Move mPv[MAX_PLY + 1][MAX_PLY + 1];
+
+    /// Length of the principal variation at each ply
+    int mPvLength[MAX_PLY + 1] = {};
+
+    /// Number of lines to search
+    int mMultiPV = 1;
+
+    /// Legal moves at the root, best first
+    std::vector<RootMove> mRootMoves;
+
+    /// Line being searched, root moves before it are excluded
+    int mPvIndex = 0;
+
+    /// Endgame tablebases, shared with other searches
+    Tablebases *mTablebases = nullptr;
+
+    /// Distance to mate tables, probed where the tablebases have no table
+    const EndgameTables *mEndgameTables = nullptr;
+
+    /// Least remaining depth to probe the tablebases at with the most pieces
+    int mTbProbeDepth = 1;
+
+    /// Do tablebase results respect the fifty move rule?
+    bool mTbRule50 = true;
+
+    /// Most pieces to probe the tablebases with in this search, 0 for none
+    int mTbCardinality = 0;
+
+    /// Were the root moves ranked by the tablebases?
+    bool mRootInTB = false;
+
+    /// Tablebase probes that found a result
+    uint64_t mTbHits = 0;
+
+    /// Called after each completed iteration
+    std::function<void(const SearchInfo &)> mInfoCallback;
+
+    /// Called once with the best move and the expected reply
+    std::function<void(Move, Move)> mBestMoveCallback;
+
+    void Run();
+    void RankTablebaseMoves();
+    void InitTimeManagement();
+    int64_t Elapsed() const;
+    void CheckLimits();
+    int AlphaBeta(int alpha, int beta, int depth, int ply, bool nullAllowed);
+    int Quiescence(int alpha, int beta, int ply);
+    int RootMoveIndex(Move move) const;
+    void SendInfo(int depth, int lines);
+    Move PonderMove(Move bestMove);
+
+public:
+    Search(TranspositionTable &tt);
+    ~Search();
+
+    /// Copy constructor (disabled)
+    Search(const Search &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const Search &) = delete;
+
+    void Start(const Position &position, const SearchLimits &limits);
+    void Stop();
+    void PonderHit();
+    void Wait();
+    void ReportBestMove(Move move);
+
+    /// Is the search currently pondering?
+    bool IsPondering() const { return mPondering; }
+
+    /**
+     * Set the number of lines to search, takes effect on the next Start()
+     * @param lines Number of best moves to find
+     */
+    void SetMultiPV(int lines) { mMultiPV = std::max(1, lines); }
+
+    /// Number of lines searched
+    int GetMultiPV() const { return mMultiPV; }
+
+    /**
+     * Set the network to evaluate with, takes effect on the next Start()
+     * @param network A loaded network, or nullptr for the hand written evaluation
+     */
+    void SetNetwork(const Network *network) { mEvaluation.SetNetwork(network); }
+
+    /**
+     * Set the tablebases to probe, takes effect on the next Start()
+     * @param tablebases The tablebases, or nullptr for none
+     */
+    void SetTablebases(Tablebases *tablebases) { mTablebases = tablebases; }
+
+    /**
+     * Set the distance to mate tables to probe, takes effect on the next Start()
+     * @param tables The tables, or nullptr for none
+     */
+    void SetEndgameTables(const EndgameTables *tables) { mEndgameTables = tables; }
+
+    /**
+     * Set the tablebase probing options, takes effect on the next Start()
+     * @param probeDepth Least remaining depth to probe at with the most pieces
+     * @param rule50 Count wins the fifty move rule spoils as draws
+     */
+    void SetTablebaseOptions(int probeDepth, bool rule50)
+    {
+        mTbProbeDepth = std::max(1, probeDepth);
+        mTbRule50 = rule50;
+    }
+
+    /// Tablebase hits of the last search, read once it has finished
+    uint64_t TbHits() const { return mTbHits; }
+
+    /// The evaluation of this search thread
+    const Evaluation &GetEvaluation() const { return mEvaluation; }
+
+    /// Forget the evaluation caches, only while no search is running
+    void ClearEvaluation() { mEvaluation.Clear(); }
+
+    /// Nodes searched by the last search, read once it has finished
+    uint64_t Nodes() const { return mNodes; }
+
+    /**
+     * Set the function called after each iteration
+     * @param callback Receives the search progress
+     */
+    void SetInfoCallback(std::function<void(const SearchInfo &)> callback) { mInfoCallback = callback; }
+
+    /**
+     * Set the function called when the search finishes
+     * @param callback Receives the best move and the move to ponder on
+     */
+    void SetBestMoveCallback(std::function<void(Move, Move)> callback) { mBestMoveCallback = callback; }
+};
+
+#endif //SEARCH_H
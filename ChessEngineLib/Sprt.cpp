@@ -0,0 +1,147 @@
+/**
+ * @file Sprt.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Sprt.h"
+
+#include <algorithm>
+#include <cmath>
+
+/// z value of a two sided 95% confidence interval
+const double Z95 = 1.959963984540054;
+
+/**
+ * Expected score for an Elo difference on the logistic scale
+ * @param elo The difference
+ * @return Score between 0 and 1
+ */
+static double EloToScore(double elo)
+{
+    return 1 / (1 + std::pow(10.0, -elo / 400));
+}
+
+/**
+ * Elo difference on the logistic scale for an expected score
+ * @param score Score between 0 and 1, exclusive
+ * @return The difference
+ */
+static double ScoreToElo(double score)
+{
+    return -400 * std::log10(1 / score - 1);
+}
+
+/// Count given to outcomes not seen yet, so the variance is never 0
+const double UnseenCount = 1e-3;
+
+/**
+ * Mean and variance of the score of a pair
+ * @param pairs Pairs by the half points the first engine scored, 0 to 4
+ * @param mean Receives the mean score
+ * @param variance Receives the variance of the score of one pair
+ * @param regularize Count unseen outcomes as UnseenCount?
+ * @return Number of pairs
+ */
+static double PairMoments(const uint64_t pairs[5], double &mean, double &variance, bool regularize)
+{
+    double counts[5];
+    double count = 0;
+    double sum = 0;
+    bool any = false;
+    for (int i = 0; i < 5; i++)
+    {
+        any = any || pairs[i] > 0;
+    }
+    for (int i = 0; i < 5; i++)
+    {
+        counts[i] = pairs[i] == 0 && regularize && any ? UnseenCount : double(pairs[i]);
+        count += counts[i];
+        sum += counts[i] * i / 4;
+    }
+    mean = count > 0 ? sum / count : 0.5;
+    variance = 0;
+    for (int i = 0; i < 5 && count > 0; i++)
+    {
+        variance += counts[i] * (i / 4.0 - mean) * (i / 4.0 - mean) / count;
+    }
+    return count;
+}
+
+/**
+ * Log likelihood ratio of H1 against H0
+ * @param pairs Pairs by the half points the first engine scored, 0 to 4
+ * @return The ratio, 0 before the first pair
+ */
+double Sprt::Llr(const uint64_t pairs[5]) const
+{
+    double mean;
+    double variance;
+    double count = PairMoments(pairs, mean, variance, true);
+    if (count == 0 || variance <= 0)
+    {
+        return 0;
+    }
+    double score0 = EloToScore(mOptions.mElo0);
+    double score1 = EloToScore(mOptions.mElo1);
+    return count * (score1 - score0) * (2 * mean - score0 - score1) / (2 * variance);
+}
+
+/**
+ * The ratio below which H0 is accepted
+ * @return log(beta / (1 - alpha))
+ */
+double Sprt::LowerBound() const
+{
+    return std::log(mOptions.mBeta / (1 - mOptions.mAlpha));
+}
+
+/**
+ * The ratio above which H1 is accepted
+ * @return log((1 - beta) / alpha)
+ */
+double Sprt::UpperBound() const
+{
+    return std::log((1 - mOptions.mBeta) / mOptions.mAlpha);
+}
+
+/**
+ * Decide the test on the pairs played so far
+ * @param pairs Pairs by the half points the first engine scored, 0 to 4
+ * @return Which hypothesis is accepted, if either
+ */
+SprtDecision Sprt::Decide(const uint64_t pairs[5]) const
+{
+    double llr = Llr(pairs);
+    return llr >= UpperBound() ? SPRT_H1 : llr <= LowerBound() ? SPRT_H0 : SPRT_CONTINUE;
+}
+
+/**
+ * Estimate the Elo difference of the engines from game pairs
+ * @param pairs Pairs by the half points the first engine scored, 0 to 4
+ * @return The estimate, with a 95% confidence interval and the
+ * likelihood of superiority
+ */
+EloEstimate Sprt::Estimate(const uint64_t pairs[5])
+{
+    EloEstimate estimate;
+    double mean;
+    double variance;
+    double count = PairMoments(pairs, mean, variance, false);
+    if (count == 0)
+    {
+        return estimate;
+    }
+
+    // A score of 0 or 1 would be infinite Elo
+    const double limit = 1e-6;
+    double deviation = std::sqrt(variance / count);
+    double score = std::clamp(mean, limit, 1 - limit);
+    estimate.mElo = ScoreToElo(score);
+    double low = ScoreToElo(std::clamp(mean - Z95 * deviation, limit, 1 - limit));
+    double high = ScoreToElo(std::clamp(mean + Z95 * deviation, limit, 1 - limit));
+    estimate.mError = (high - low) / 2;
+    estimate.mLos = deviation > 0 ? 0.5 * (1 + std::erf((mean - 0.5) / deviation / std::sqrt(2.0)))
+        : mean > 0.5 ? 1 : mean < 0.5 ? 0 : 0.5;
+    return estimate;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file Sprt.h
+ * @author John Korreck
+ *
+ * Sequential probability ratio test on the results of a match.
+ */
+
+#ifndef SPRT_H
+#define SPRT_H
+
+#include <cstdint>
+
+/**
+ * Settings for a test, with Elo on the logistic scale
+ */
+struct SprtOptions {
+    /// Elo difference of the hypothesis that the change is no better
+    double mElo0 = 0;
+
+    /// Elo difference of the hypothesis that the change is better
+    double mElo1 = 5;
+
+    /// Chance of accepting H1 when H0 is true
+    double mAlpha = 0.05;
+
+    /// Chance of accepting H0 when H1 is true
+    double mBeta = 0.05;
+};
+
+/**
+ * What a test has decided so far
+ */
+enum SprtDecision {
+    SPRT_CONTINUE,      ///< Neither bound has been crossed
+    SPRT_H0,            ///< The change is no better than mElo0
+    SPRT_H1             ///< The change is at least as good as mElo1
+};
+
+/**
+ * Estimate of the Elo difference from a match
+ */
+struct EloEstimate {
+    /// Elo difference, positive when the first engine is stronger
+    double mElo = 0;
+
+    /// Half the width of the 95% confidence interval
+    double mError = 0;
+
+    /// Likelihood of superiority, the chance the first engine is stronger
+    double mLos = 0.5;
+};
+
+/**
+ * A sequential probability ratio test over game pairs.
+ *
+ * The games of a pair share an opening and swap colours, so their
+ * results are correlated and the pair, not the game, is the unit of
+ * the test. Each pair scores 0, 1/4, 1/2, 3/4 or 1, and the counts of
+ * the five outcomes form the pentanomial distribution. The log
+ * likelihood ratio uses the normal approximation of the generalized
+ * SPRT, which needs only the mean and variance of the pair scores, so
+ * it can be recomputed after every pair. The test stops as soon as it
+ * leaves the bounds set by alpha and beta.
+ */
+class Sprt {
+private:
+    /// Settings for the test
+    SprtOptions mOptions;
+
+public:
+    /**
+     * Constructor
+     * @param options Settings for the test
+     */
+    Sprt(const SprtOptions &options) : mOptions(options) {}
+
+    double Llr(const uint64_t pairs[5]) const;
+    double LowerBound() const;
+    double UpperBound() const;
+    SprtDecision Decide(const uint64_t pairs[5]) const;
+
+    static EloEstimate Estimate(const uint64_t pairs[5]);
+};
+
+#endif //SPRT_H
@@ -0,0 +1,280 @@
+/**
+ * @file Spsa.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Spsa.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+/**
+ * Read the options to tune, one per line as
+ * "name, value, min, max, c_end, r_end". Blank lines and lines
+ * starting with '#' are skipped.
+ * @param input Stream to read
+ * @param parameters Receives the options
+ * @return False if a line could not be read
+ */
+bool Spsa::ReadParameters(std::istream &input, std::vector<SpsaParameter> &parameters)
+{
+    parameters.clear();
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        SpsaParameter parameter;
+        if (!(fields >> parameter.mName >> parameter.mValue >> parameter.mMin >> parameter.mMax
+              >> parameter.mPerturbation >> parameter.mRate)
+            || parameter.mMin > parameter.mMax || parameter.mPerturbation <= 0)
+        {
+            return false;
+        }
+        parameter.mValue = std::clamp(parameter.mValue, parameter.mMin, parameter.mMax);
+        parameters.push_back(parameter);
+    }
+    return true;
+}
+
+/**
+ * Read the openings file of the options
+ * @return False if the file could not be read or has no openings
+ */
+bool Spsa::LoadOpenings()
+{
+    mOpenings.clear();
+    return mOptions.mOpenings.empty() || Match::ReadOpenings(mOptions.mOpenings, mOptions.mOpeningPlies, mOpenings);
+}
+
+/**
+ * Carry on from the checkpoint file of the options, if there is one
+ * @return False if the file exists but could not be read
+ */
+bool Spsa::LoadCheckpoint()
+{
+    if (mOptions.mCheckpoint.empty() || !std::filesystem::exists(mOptions.mCheckpoint))
+    {
+        return true;
+    }
+    std::ifstream input(mOptions.mCheckpoint);
+    std::string line;
+    std::string token;
+    if (!input || !std::getline(input, line))
+    {
+        return false;
+    }
+    std::istringstream header(line);
+    Stats stats;
+    header >> token >> stats.mIterations;
+    if (token != "iterations" || !(header >> token >> stats.mWins >> token >> stats.mDraws >> token >> stats.mLosses))
+    {
+        return false;
+    }
+
+    while (std::getline(input, line))
+    {
+        std::istringstream fields(line);
+        std::string name;
+        double value;
+        if (!(fields >> name >> value))
+        {
+            continue;
+        }
+        for (auto &parameter : mOptions.mParameters)
+        {
+            if (parameter.mName == name)
+            {
+                parameter.mValue = std::clamp(value, parameter.mMin, parameter.mMax);
+            }
+        }
+    }
+    mStats = stats;
+    mNext = stats.mIterations + 1;
+    return true;
+}
+
+/**
+ * Save the values and progress to the checkpoint file. The file is
+ * written under another name first and renamed over the old one, so
+ * a run stopped part way through writing loses nothing.
+ * Called with the lock held.
+ * @return False if the file could not be written
+ */
+bool Spsa::SaveCheckpoint() const
+{
+    if (mOptions.mCheckpoint.empty())
+    {
+        return true;
+    }
+    std::string temporary = mOptions.mCheckpoint + ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::trunc);
+        output << "iterations " << mStats.mIterations << " wins " << mStats.mWins << " draws " << mStats.mDraws
+               << " losses " << mStats.mLosses << '\n';
+        output.precision(17);
+        for (auto const &parameter : mOptions.mParameters)
+        {
+            output << parameter.mName << ' ' << parameter.mValue << '\n';
+        }
+        if (!output.flush())
+        {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, mOptions.mCheckpoint, error);
+    return !error;
+}
+
+/**
+ * Perturbation of an option at an iteration, c_k
+ * @param parameter The option
+ * @param iteration Iteration number, from 1
+ * @return Distance each engine's value is moved from the current one
+ */
+double Spsa::Perturbation(const SpsaParameter &parameter, int iteration) const
+{
+    double iterations = std::max(1, mOptions.mIterations);
+    return parameter.mPerturbation * std::pow(iterations, mOptions.mGamma) / std::pow(iteration, mOptions.mGamma);
+}
+
+/**
+ * Learning rate of an option at an iteration, a_k
+ * @param parameter The option
+ * @param iteration Iteration number, from 1
+ * @return The gain, which reaches r_end * c_end^2 at the last iteration
+ */
+double Spsa::Rate(const SpsaParameter &parameter, int iteration) const
+{
+    double iterations = std::max(1, mOptions.mIterations);
+    double stability = mOptions.mStability * iterations;
+    double scale = parameter.mRate * parameter.mPerturbation * parameter.mPerturbation;
+    return scale * std::pow(stability + iterations, mOptions.mAlpha) / std::pow(stability + iteration, mOptions.mAlpha);
+}
+
+/**
+ * Run the iterations not done yet
+ * @param callback Called with the number of each iteration as it ends,
+ * on the worker threads but never by two at once, or nullptr
+ * @return False if the engine could not be started
+ */
+bool Spsa::Run(const std::function<void(int)> &callback)
+{
+    auto start = std::chrono::steady_clock::now();
+    mStopping = false;
+    mFailed = false;
+
+    int remaining = std::max(0, mOptions.mIterations - mNext + 1);
+    int threads = std::max(1, std::min(mOptions.mConcurrency, remaining));
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&Spsa::Worker, this, std::cref(callback));
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    mStats.mMilliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    return !mFailed;
+}
+
+/**
+ * Play iterations until there are none left
+ * @param callback Called with the number of each iteration, or nullptr
+ */
+void Spsa::Worker(const std::function<void(int)> &callback)
+{
+    size_t count = mOptions.mParameters.size();
+    int pairs = std::max(1, mOptions.mPairs);
+    while (true)
+    {
+        int iteration;
+        std::vector<double> values;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mStopping || mNext > mOptions.mIterations)
+            {
+                break;
+            }
+            iteration = mNext++;
+            for (auto const &parameter : mOptions.mParameters)
+            {
+                values.push_back(parameter.mValue);
+            }
+        }
+
+        // The first engine gets the values moved along the signs, the second against them
+        MatchOptions options;
+        options.mEngines[0] = mOptions.mEngine;
+        options.mEngines[1] = mOptions.mEngine;
+        options.mGames = 2 * pairs;
+        options.mTimeControl = mOptions.mTimeControl;
+        std::mt19937_64 random(mOptions.mSeed * 0x9e3779b97f4a7c15ull + uint64_t(iteration));
+        std::vector<int> signs(count);
+        std::vector<double> perturbations(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const SpsaParameter &parameter = mOptions.mParameters[i];
+            signs[i] = (random() & 1) != 0 ? 1 : -1;
+            perturbations[i] = Perturbation(parameter, iteration);
+            for (int engine = 0; engine < 2; engine++)
+            {
+                double value = values[i] + (engine == 0 ? 1 : -1) * signs[i] * perturbations[i];
+                value = std::clamp(value, parameter.mMin, parameter.mMax);
+                options.mEngines[engine].mOptions.emplace_back(parameter.mName, std::to_string(std::lround(value)));
+            }
+        }
+
+        std::vector<MatchOpening> openings;
+        for (int pair = 0; pair < pairs && !mOpenings.empty(); pair++)
+        {
+            openings.push_back(mOpenings[(size_t(iteration - 1) * pairs + pair) % mOpenings.size()]);
+        }
+        Match match(options);
+        match.SetOpenings(openings);
+        bool played = match.Run();
+        auto const &result = match.GetStats();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!played)
+        {
+            mFailed = true;
+            mStopping = true;
+            break;
+        }
+
+        // Each option moves towards the engine that scored more
+        double score = double(result.mWins) - double(result.mLosses);
+        for (size_t i = 0; i < count; i++)
+        {
+            SpsaParameter &parameter = mOptions.mParameters[i];
+            double step = Rate(parameter, iteration) / perturbations[i] * score * signs[i];
+            parameter.mValue = std::clamp(parameter.mValue + step, parameter.mMin, parameter.mMax);
+        }
+        mStats.mIterations++;
+        mStats.mWins += result.mWins;
+        mStats.mDraws += result.mDraws;
+        mStats.mLosses += result.mLosses;
+        SaveCheckpoint();
+        if (callback)
+        {
+            callback(iteration);
+        }
+    }
+}
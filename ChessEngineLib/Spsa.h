@@ -0,0 +1,181 @@
+/**
+ * @file Spsa.h
+ * @author John Korreck
+ *
+ * Tunes engine options by simultaneous perturbation stochastic approximation.
+ */
+
+#ifndef SPSA_H
+#define SPSA_H
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Match.h"
+
+/**
+ * An engine option being tuned
+ */
+struct SpsaParameter {
+    /// UCI option name
+    std::string mName;
+
+    /// Current value, rounded when sent to an engine
+    double mValue = 0;
+
+    /// Lowest value allowed
+    double mMin = 0;
+
+    /// Highest value allowed
+    double mMax = 0;
+
+    /// Size of the perturbation at the last iteration, c_end
+    double mPerturbation = 1;
+
+    /// Learning rate at the last iteration, r_end
+    double mRate = 0.002;
+};
+
+/**
+ * Settings for a tuning run
+ */
+struct SpsaOptions {
+    /// The engine, started twice for each game pair with opposite perturbations
+    MatchEngine mEngine;
+
+    /// The options being tuned
+    std::vector<SpsaParameter> mParameters;
+
+    /// Iterations to run, each a set of game pairs
+    int mIterations = 1000;
+
+    /// Game pairs played for each iteration
+    int mPairs = 1;
+
+    /// Iterations played at once
+    int mConcurrency = 1;
+
+    /// How long the engines may think
+    TimeControl mTimeControl;
+
+    /// EPD or PGN file of openings, empty to start every game from the start position
+    std::string mOpenings;
+
+    /// Half moves taken from each game of a PGN opening file
+    int mOpeningPlies = 8;
+
+    /// Exponent of the decay of the learning rate
+    double mAlpha = 0.602;
+
+    /// Exponent of the decay of the perturbation
+    double mGamma = 0.101;
+
+    /// Stability constant A as a fraction of the iterations
+    double mStability = 0.1;
+
+    /// File the state is saved to after every iteration, empty for none
+    std::string mCheckpoint;
+
+    /// Seed of the perturbation signs
+    uint64_t mSeed = 1;
+};
+
+/**
+ * Tunes integer engine options by SPSA.
+ *
+ * Every iteration draws a random sign for each option and starts two
+ * copies of the engine, one with every option moved by its current
+ * perturbation in the direction of its sign and one moved the other
+ * way. The copies play game pairs against each other, and each option
+ * then moves towards the copy that won, in proportion to the learning
+ * rate. The perturbation c_k and learning rate a_k decay over the run
+ * as in the usual SPSA gain sequences, scaled so that they reach
+ * mPerturbation and mRate at the last iteration.
+ *
+ * Several iterations are played at once, each against the values of
+ * the moment it started, and each moves the values when it ends. The
+ * values and the number of iterations done are saved to the
+ * checkpoint file after every iteration, so a run that is stopped
+ * carries on from there. The signs of an iteration come from the seed
+ * and the iteration number alone.
+ */
+class Spsa {
+public:
+    /**
+     * Progress of a run
+     */
+    struct Stats {
+        /// Iterations finished
+        int mIterations = 0;
+
+        /// Games won by the positively perturbed engine
+        uint64_t mWins = 0;
+
+        /// Games drawn
+        uint64_t mDraws = 0;
+
+        /// Games lost by the positively perturbed engine
+        uint64_t mLosses = 0;
+
+        /// Time taken in milliseconds
+        int64_t mMilliseconds = 0;
+    };
+
+private:
+    /// Settings for the run
+    SpsaOptions mOptions;
+
+    /// Openings, used in order across the iterations
+    std::vector<MatchOpening> mOpenings;
+
+    /// Progress so far
+    Stats mStats;
+
+    /// Number of the next iteration to start, from 1
+    int mNext = 1;
+
+    /// No further iterations are to be started
+    bool mStopping = false;
+
+    /// A match could not be played
+    bool mFailed = false;
+
+    /// Protects everything above
+    std::mutex mMutex;
+
+    void Worker(const std::function<void(int)> &callback);
+    double Perturbation(const SpsaParameter &parameter, int iteration) const;
+    double Rate(const SpsaParameter &parameter, int iteration) const;
+    bool SaveCheckpoint() const;
+
+public:
+    /**
+     * Constructor
+     * @param options Settings for the run
+     */
+    Spsa(const SpsaOptions &options) : mOptions(options) {}
+
+    /// Copy constructor (disabled)
+    Spsa(const Spsa &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const Spsa &) = delete;
+
+    bool LoadOpenings();
+    bool LoadCheckpoint();
+    bool Run(const std::function<void(int)> &callback = nullptr);
+
+    /// The options being tuned, to be read from the callback or after Run()
+    const std::vector<SpsaParameter> &GetParameters() const { return mOptions.mParameters; }
+
+    /// Progress so far, to be read from the callback or after Run()
+    const Stats &GetStats() const { return mStats; }
+
+    static bool ReadParameters(std::istream &input, std::vector<SpsaParameter> &parameters);
+};
+
+#endif //SPSA_H
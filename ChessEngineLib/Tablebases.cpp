@@ -0,0 +1,1221 @@
+/**
+ * @file Tablebases.cpp
+ * @author John Korreck
+ *
+ * The file format and the index encoding are those of the Syzygy
+ * tables as published with their generator by Ronald de Man.
+ */
+
+#include "pch.h"
+#include "Tablebases.h"
+#include "Bitboard.h"
+#include "Position.h"
+#include "Search.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+/// Largest distance to zeroing used for ranking root moves
+const int MAX_DTZ = 1 << 18;
+
+/// First four bytes of a WDL file
+const uint8_t WdlMagic[4] = {0x71, 0xE8, 0x23, 0x5D};
+
+/// First four bytes of a DTZ file
+const uint8_t DtzMagic[4] = {0xD7, 0x66, 0x0C, 0xA5};
+
+/**
+ * Flags of a sub-table
+ */
+enum TableFlag {
+    /// Side to move of a one sided DTZ table
+    FLAG_STM = 1,
+
+    /// DTZ values go through a value map
+    FLAG_MAPPED = 2,
+
+    /// DTZ of wins is stored in plies rather than moves
+    FLAG_WIN_PLIES = 4,
+
+    /// DTZ of losses is stored in plies rather than moves
+    FLAG_LOSS_PLIES = 8,
+
+    /// The value map holds 16 bit values
+    FLAG_WIDE = 16,
+
+    /// Every position has the same value
+    FLAG_SINGLE_VALUE = 128,
+};
+
+/// Syzygy piece code of each of our piece types, black adds 8
+const int TbPieceType[7] = {0, 6, 1, 2, 3, 4, 5};
+
+/// Squares a2 to h7 numbered so the leading pawn has the highest number
+static int MapPawns[SQUARE_NB];
+
+/// Squares below the a1-h8 diagonal numbered 0 to 27
+static int MapB1H1H7[SQUARE_NB];
+
+/// Squares of the a1-d1-d4 triangle numbered 0 to 9
+static int MapA1D1D4[SQUARE_NB];
+
+/// The 462 placements of two kings with the first in the a1-d1-d4 triangle
+static int MapKK[10][SQUARE_NB];
+
+/// Binomial[k][n], ways of choosing k of n squares
+static uint64_t Binomial[6][SQUARE_NB];
+
+/// Index of the leading pawns by their number and the leading square
+static int LeadPawnIdx[6][SQUARE_NB];
+
+/// Leading pawn indexes by their number and the leading file
+static int LeadPawnsSize[6][4];
+
+/**
+ * How far a square is above the a1-h8 diagonal
+ * @param square The square
+ * @return Positive above, 0 on and negative below the diagonal
+ */
+static int OffDiagonal(int square)
+{
+    return RankOf(square) - FileOf(square);
+}
+
+/**
+ * Fill the index encoding tables, once
+ */
+static void InitEncoding()
+{
+    int code = 0;
+    for (int square = 0; square < SQUARE_NB; square++)
+    {
+        if (OffDiagonal(square) < 0)
+        {
+            MapB1H1H7[square] = code++;
+        }
+    }
+
+    // Squares on the diagonal come last
+    code = 0;
+    std::vector<int> diagonal;
+    for (int square : {0, 1, 2, 3, 9, 10, 11, 18, 19, 27})
+    {
+        if (OffDiagonal(square) < 0)
+        {
+            MapA1D1D4[square] = code++;
+        }
+        else
+        {
+            diagonal.push_back(square);
+        }
+    }
+    for (int square : diagonal)
+    {
+        MapA1D1D4[square] = code++;
+    }
+
+    // With the first king on the diagonal the second is never above
+    // it, and placements with both on the diagonal come last
+    std::vector<std::pair<int, int>> bothOnDiagonal;
+    code = 0;
+    for (int index = 0; index < 10; index++)
+    {
+        for (int first = 0; first <= 27; first++)
+        {
+            if (MapA1D1D4[first] != index || (index == 0 && first != 1))
+            {
+                continue;
+            }
+            for (int second = 0; second < SQUARE_NB; second++)
+            {
+                if (Contains(KingAttacks[first] | SquareBB(first), second)
+                    || (OffDiagonal(first) == 0 && OffDiagonal(second) > 0))
+                {
+                    continue;
+                }
+                if (OffDiagonal(first) == 0 && OffDiagonal(second) == 0)
+                {
+                    bothOnDiagonal.emplace_back(index, second);
+                }
+                else
+                {
+                    MapKK[index][second] = code++;
+                }
+            }
+        }
+    }
+    for (auto [index, second] : bothOnDiagonal)
+    {
+        MapKK[index][second] = code++;
+    }
+
+    Binomial[0][0] = 1;
+    for (int n = 1; n < SQUARE_NB; n++)
+    {
+        for (int k = 0; k < 6 && k <= n; k++)
+        {
+            Binomial[k][n] = (k > 0 ? Binomial[k - 1][n - 1] : 0) + (k < n ? Binomial[k][n - 1] : 0);
+        }
+    }
+
+    // With the leading pawn on a square, the others can only stand
+    // on squares with a lower number, so the tables are split by file
+    int available = 47;
+    for (int leadPawns = 1; leadPawns <= 5; leadPawns++)
+    {
+        for (int file = 0; file < 4; file++)
+        {
+            int index = 0;
+            for (int rank = 1; rank <= 6; rank++)
+            {
+                int square = MakeSquare(file, rank);
+                if (leadPawns == 1)
+                {
+                    MapPawns[square] = available--;
+                    MapPawns[square ^ 7] = available--;
+                }
+                LeadPawnIdx[leadPawns][square] = index;
+                index += int(Binomial[leadPawns - 1][MapPawns[square]]);
+            }
+            LeadPawnsSize[leadPawns][file] = index;
+        }
+    }
+}
+
+/// Read a little endian 16 bit value
+static uint32_t Little16(const uint8_t *data)
+{
+    return uint32_t(data[0]) | uint32_t(data[1]) << 8;
+}
+
+/// Read a little endian 32 bit value
+static uint32_t Little32(const uint8_t *data)
+{
+    return Little16(data) | Little16(data + 2) << 16;
+}
+
+/// Read a big endian 32 bit value
+static uint32_t Big32(const uint8_t *data)
+{
+    return uint32_t(data[0]) << 24 | uint32_t(data[1]) << 16 | uint32_t(data[2]) << 8 | data[3];
+}
+
+/// Left symbol of a pair in the symbol tree
+static int LeftSymbol(const uint8_t *pair)
+{
+    return (pair[1] & 0xF) << 8 | pair[0];
+}
+
+/// Right symbol of a pair in the symbol tree
+static int RightSymbol(const uint8_t *pair)
+{
+    return pair[2] << 4 | pair[1] >> 4;
+}
+
+/**
+ * Distance to zeroing of a position where the best move zeroes
+ * @param wdl Result of the position
+ * @return Signed distance
+ */
+static int DtzBeforeZeroing(WdlScore wdl)
+{
+    return wdl == WDL_WIN ? 1 : wdl == WDL_CURSED_WIN ? 101 : wdl == WDL_BLESSED_LOSS ? -101 : wdl == WDL_LOSS ? -1 : 0;
+}
+
+/// Sign of a value
+static int Sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+/**
+ * Has any position since the last capture or pawn move occurred
+ * twice in the game?
+ * @param position The game
+ * @return True if so
+ */
+static bool HasRepeated(const Position &position)
+{
+    int end = position.GamePly();
+    int start = std::max(0, end - position.HalfmoveClock());
+    for (int ply = end; ply >= start + 4; ply--)
+    {
+        for (int back = ply - 4; back >= start; back -= 2)
+        {
+            if (position.KeyAtPly(back) == position.KeyAtPly(ply))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Is the position a root move leads to drawn by the rules? Unlike
+ * Position::IsDraw the position has to have occurred twice before,
+ * and mate on the hundredth half move is still mate.
+ * @param position Position after the root move
+ * @return True if so
+ */
+static bool IsRootMoveDraw(const Position &position)
+{
+    if (position.IsRepetition(2))
+    {
+        return true;
+    }
+    return position.HalfmoveClock() >= 100 && !(position.InCheck() && !position.HasLegalMove());
+}
+
+/**
+ * Find the tables in a list of directories. Any search using
+ * these tables must be stopped first.
+ * @param paths Directories separated by ':', or ';' on Windows,
+ * empty or "<empty>" for none
+ * @return Number of WDL tables found
+ */
+int Tablebases::Init(const std::string &paths)
+{
+    static std::once_flag encoding;
+    std::call_once(encoding, InitEncoding);
+
+    mPaths.clear();
+    mByKey.clear();
+    mMaterials.clear();
+    mMaxPieces = 0;
+    if (paths.empty() || paths == "<empty>")
+    {
+        return 0;
+    }
+
+#ifdef _WIN32
+    const char separator = ';';
+#else
+    const char separator = ':';
+#endif
+    size_t start = 0;
+    while (start <= paths.size())
+    {
+        size_t end = std::min(paths.find(separator, start), paths.size());
+        if (end > start)
+        {
+            mPaths.push_back(paths.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+
+    for (auto const &directory : mPaths)
+    {
+        std::error_code error;
+        for (auto const &file : std::filesystem::directory_iterator(directory, error))
+        {
+            if (file.path().extension() == ".rtbw")
+            {
+                Add(file.path().stem().string());
+            }
+        }
+    }
+    return int(mMaterials.size());
+}
+
+/**
+ * Add the tables of a material signature
+ * @param name Signature such as KRPvKR, ignored if it is not one
+ */
+void Tablebases::Add(const std::string &name)
+{
+    // Piece counts of the side named first, then the second
+    int counts[2][7] = {};
+    int side = 0;
+    for (size_t i = 0; i < name.size(); i++)
+    {
+        const char *letter = std::strchr(" KPNBRQ", name[i]);
+        if (name[i] == 'v' && side == 0)
+        {
+            side = 1;
+        }
+        else if (letter != nullptr && name[i] != ' ' && (name[i] == 'K') == (i == 0 || name[i - 1] == 'v'))
+        {
+            counts[side][letter - " KPNBRQ"]++;
+        }
+        else
+        {
+            return;
+        }
+    }
+    int pieces = 0;
+    for (auto const &count : counts)
+    {
+        for (int type = KING; type <= QUEEN; type++)
+        {
+            pieces += count[type];
+        }
+    }
+    if (side == 0 || counts[0][KING] != 1 || counts[1][KING] != 1 || pieces > TB_PIECES)
+    {
+        return;
+    }
+
+    uint64_t keys[2] = {0, 0};
+    for (int first = 0; first < 2; first++)
+    {
+        for (int s = 0; s < 2; s++)
+        {
+            int color = (s ^ first) == 0 ? WHITE : BLACK;
+            for (int type = KING; type <= QUEEN; type++)
+            {
+                for (int i = 0; i < counts[s][type]; i++)
+                {
+                    keys[first] ^= Zobrist.mPieceSquare[color + type][i];
+                }
+            }
+        }
+    }
+    if (mByKey.count(keys[0]) != 0)
+    {
+        return;
+    }
+
+    Material &material = mMaterials.emplace_back();
+    material.mName = name;
+    material.mKey = keys[0];
+    material.mKey2 = keys[1];
+    material.mPieceCount = pieces;
+    material.mHasPawns = counts[0][PAWN] + counts[1][PAWN] > 0;
+    for (auto const &count : counts)
+    {
+        for (int type = PAWN; type <= QUEEN; type++)
+        {
+            material.mHasUniquePieces |= count[type] == 1;
+        }
+    }
+
+    // The side with fewer pawns leads, as it compresses better
+    bool firstLeads = counts[1][PAWN] == 0 || (counts[0][PAWN] > 0 && counts[1][PAWN] >= counts[0][PAWN]);
+    material.mPawnCount[0] = counts[firstLeads ? 0 : 1][PAWN];
+    material.mPawnCount[1] = counts[firstLeads ? 1 : 0][PAWN];
+
+    mByKey[material.mKey] = &material;
+    mByKey[material.mKey2] = &material;
+    mMaxPieces = std::max(mMaxPieces, pieces);
+}
+
+/**
+ * Map the WDL or DTZ file of a signature if that was not done yet.
+ * Only the first call for a file takes the lock.
+ * @param material The signature
+ * @param dtz Map the DTZ rather than the WDL file
+ * @return False if the file is missing or unusable
+ */
+bool Tablebases::Map(Material &material, bool dtz)
+{
+    TableFile &table = dtz ? material.mDtz : material.mWdl;
+    if (table.mReady.load(std::memory_order_acquire))
+    {
+        return table.mFile.IsOpen();
+    }
+
+    std::lock_guard<std::mutex> lock(mMapMutex);
+    if (table.mReady.load(std::memory_order_relaxed))
+    {
+        return table.mFile.IsOpen();
+    }
+
+    for (auto const &directory : mPaths)
+    {
+        auto path = std::filesystem::path(directory) / (material.mName + (dtz ? ".rtbz" : ".rtbw"));
+        if (table.mFile.Open(path.string()))
+        {
+            break;
+        }
+    }
+
+    // Files are a magic number, a multiple of 64 bytes and 12 bytes of checksum
+    const uint8_t *magic = dtz ? DtzMagic : WdlMagic;
+    if (table.mFile.IsOpen()
+        && (table.mFile.Size() % 64 != 16 || std::memcmp(table.mFile.Data(), magic, 4) != 0
+            || !Setup(material, table, dtz)))
+    {
+        table.mFile.Close();
+    }
+
+    table.mReady.store(true, std::memory_order_release);
+    return table.mFile.IsOpen();
+}
+
+/**
+ * Read the headers of a mapped file
+ * @param material The signature the file is for
+ * @param table The file
+ * @param dtz Is it a DTZ file?
+ * @return False if the file does not match the signature
+ */
+bool Tablebases::Setup(Material &material, TableFile &table, bool dtz)
+{
+    const uint8_t *base = table.mFile.Data();
+    const uint8_t *data = base + 4;
+
+    // Flags for a table split by side to move, and one with pawns
+    bool split = (*data & 1) != 0;
+    if (((*data & 2) != 0) != material.mHasPawns || split != (material.mKey != material.mKey2))
+    {
+        return false;
+    }
+    data++;
+
+    int sides = !dtz && split ? 2 : 1;
+    int files = material.mHasPawns ? 4 : 1;
+    bool bothPawns = material.mHasPawns && material.mPawnCount[1] > 0;
+
+    for (int file = 0; file < files; file++)
+    {
+        int order[2][2] = {{*data & 0xF, bothPawns ? data[1] & 0xF : 0xF},
+                           {*data >> 4, bothPawns ? data[1] >> 4 : 0xF}};
+        data += 1 + bothPawns;
+
+        for (int i = 0; i < sides; i++)
+        {
+            table.mItems[i][file] = PairsData();
+        }
+        for (int k = 0; k < material.mPieceCount; k++, data++)
+        {
+            for (int i = 0; i < sides; i++)
+            {
+                table.mItems[i][file].mPieces[k] = uint8_t(i ? *data >> 4 : *data & 0xF);
+            }
+        }
+        for (int i = 0; i < sides; i++)
+        {
+            SetGroups(material, table.mItems[i][file], order[i], file);
+        }
+    }
+
+    // Parts are aligned relative to the start of the file, which the
+    // mapping puts at a page boundary
+    auto align = [base](const uint8_t *pointer, size_t alignment) {
+        return base + (size_t(pointer - base) + alignment - 1) / alignment * alignment;
+    };
+    data = align(data, 2);
+
+    for (int file = 0; file < files; file++)
+    {
+        for (int i = 0; i < sides; i++)
+        {
+            data = SetSizes(table.mItems[i][file], data);
+        }
+    }
+
+    if (dtz)
+    {
+        // Value maps for each result, of 8 or 16 bit values
+        table.mMap = data;
+        for (int file = 0; file < files; file++)
+        {
+            PairsData &d = table.mItems[0][file];
+            if ((d.mFlags & FLAG_MAPPED) == 0)
+            {
+                continue;
+            }
+            if (d.mFlags & FLAG_WIDE)
+            {
+                data = align(data, 2);
+                for (int i = 0; i < 4; i++)
+                {
+                    d.mMapIdx[i] = uint16_t((data - table.mMap) / 2 + 1);
+                    data += 2 * Little16(data) + 2;
+                }
+            }
+            else
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    d.mMapIdx[i] = uint16_t(data - table.mMap + 1);
+                    data += *data + 1;
+                }
+            }
+        }
+        data = align(data, 2);
+    }
+
+    for (int file = 0; file < files; file++)
+    {
+        for (int i = 0; i < sides; i++)
+        {
+            table.mItems[i][file].mSparseIndex = data;
+            data += table.mItems[i][file].mSparseIndexSize * 6;
+        }
+    }
+    for (int file = 0; file < files; file++)
+    {
+        for (int i = 0; i < sides; i++)
+        {
+            table.mItems[i][file].mBlockLength = data;
+            data += size_t(table.mItems[i][file].mBlockLengthSize) * 2;
+        }
+    }
+    for (int file = 0; file < files; file++)
+    {
+        for (int i = 0; i < sides; i++)
+        {
+            data = align(data, 64);
+            table.mItems[i][file].mData = data;
+            data += table.mItems[i][file].mNumBlocks * table.mItems[i][file].mBlockSize;
+        }
+    }
+    return data <= base + table.mFile.Size();
+}
+
+/**
+ * Split the pieces of a sub-table into the groups they are encoded
+ * in and work out what each group multiplies the index by
+ * @param material The signature
+ * @param d The sub-table, with its pieces set
+ * @param order Position of the leading group and of the other
+ * side's pawns in the encoding, 0xF if there are none
+ * @param file File of the leading pawn
+ */
+void Tablebases::SetGroups(const Material &material, PairsData &d, const int order[2], int file)
+{
+    // Kings and the first unique piece are encoded together
+    int n = 0;
+    int firstLength = material.mHasPawns ? 0 : material.mHasUniquePieces ? 3 : 2;
+    d.mGroupLen[n] = 1;
+    for (int i = 1; i < material.mPieceCount; i++)
+    {
+        if (--firstLength > 0 || d.mPieces[i] == d.mPieces[i - 1])
+        {
+            d.mGroupLen[n]++;
+        }
+        else
+        {
+            d.mGroupLen[++n] = 1;
+        }
+    }
+    d.mGroupLen[++n] = 0;
+
+    bool bothPawns = material.mHasPawns && material.mPawnCount[1] > 0;
+    int next = bothPawns ? 2 : 1;
+    int freeSquares = 64 - d.mGroupLen[0] - (bothPawns ? d.mGroupLen[1] : 0);
+    uint64_t index = 1;
+    for (int k = 0; next < n || k == order[0] || k == order[1]; k++)
+    {
+        if (k == order[0])
+        {
+            d.mGroupIdx[0] = index;
+            index *= material.mHasPawns ? LeadPawnsSize[d.mGroupLen[0]][file] : material.mHasUniquePieces ? 31332 : 462;
+        }
+        else if (k == order[1])
+        {
+            d.mGroupIdx[1] = index;
+            index *= Binomial[d.mGroupLen[1]][48 - d.mGroupLen[0]];
+        }
+        else
+        {
+            d.mGroupIdx[next] = index;
+            index *= Binomial[d.mGroupLen[next]][freeSquares];
+            freeSquares -= d.mGroupLen[next++];
+        }
+    }
+    d.mGroupIdx[n] = index;
+}
+
+/**
+ * Read the sizes and the Huffman code of a sub-table
+ * @param d The sub-table, with its groups set
+ * @param data Its header
+ * @return What follows the header
+ */
+const uint8_t *Tablebases::SetSizes(PairsData &d, const uint8_t *data)
+{
+    d.mFlags = *data++;
+    if (d.mFlags & FLAG_SINGLE_VALUE)
+    {
+        d.mMinSymLen = *data++;
+        return data;
+    }
+
+    // The last group index is the number of positions
+    int groups = 0;
+    while (d.mGroupLen[groups] != 0)
+    {
+        groups++;
+    }
+    uint64_t size = d.mGroupIdx[groups];
+
+    d.mBlockSize = size_t(1) << *data++;
+    d.mSpan = size_t(1) << *data++;
+    d.mSparseIndexSize = size_t((size + d.mSpan - 1) / d.mSpan);
+    int padding = *data++;
+    d.mNumBlocks = Little32(data);
+    data += 4;
+    d.mBlockLengthSize = d.mNumBlocks + padding;
+    d.mMaxSymLen = *data++;
+    d.mMinSymLen = *data++;
+    d.mLowestSym = data;
+
+    // Canonical Huffman code, longer codes have lower values
+    int lengths = d.mMaxSymLen - d.mMinSymLen + 1;
+    d.mBase64.assign(lengths, 0);
+    for (int i = lengths - 2; i >= 0; i--)
+    {
+        d.mBase64[i] = (d.mBase64[i + 1] + Little16(d.mLowestSym + 2 * i) - Little16(d.mLowestSym + 2 * i + 2)) / 2;
+    }
+    for (int i = 0; i < lengths; i++)
+    {
+        d.mBase64[i] <<= 64 - i - d.mMinSymLen;
+    }
+    data += lengths * 2;
+
+    d.mSymLen.assign(Little16(data), 0);
+    data += 2;
+    d.mTree = data;
+
+    std::vector<bool> visited(d.mSymLen.size());
+    for (size_t symbol = 0; symbol < d.mSymLen.size(); symbol++)
+    {
+        if (!visited[symbol])
+        {
+            d.mSymLen[symbol] = SetSymLen(d, int(symbol), visited);
+        }
+    }
+    return data + d.mSymLen.size() * 3 + (d.mSymLen.size() & 1);
+}
+
+/**
+ * Count the values a symbol of the pair tree expands to
+ * @param d The sub-table
+ * @param symbol The symbol
+ * @param visited Symbols already counted
+ * @return Number of values minus one
+ */
+uint8_t Tablebases::SetSymLen(PairsData &d, int symbol, std::vector<bool> &visited)
+{
+    visited[symbol] = true;
+    const uint8_t *pair = d.mTree + 3 * symbol;
+    int right = RightSymbol(pair);
+    if (right == 0xFFF)
+    {
+        return 0;
+    }
+    int left = LeftSymbol(pair);
+    if (!visited[left])
+    {
+        d.mSymLen[left] = SetSymLen(d, left, visited);
+    }
+    if (!visited[right])
+    {
+        d.mSymLen[right] = SetSymLen(d, right, visited);
+    }
+    return uint8_t(d.mSymLen[left] + d.mSymLen[right] + 1);
+}
+
+/**
+ * Get one value of a sub-table
+ * @param d The sub-table
+ * @param index Index of the position
+ * @return The stored value
+ */
+int Tablebases::Decompress(const PairsData &d, uint64_t index)
+{
+    if (d.mFlags & FLAG_SINGLE_VALUE)
+    {
+        return d.mMinSymLen;
+    }
+
+    // The sparse index gives the block holding the middle value of
+    // each span, walk the block lengths from there
+    size_t k = size_t(index / d.mSpan);
+    const uint8_t *sparse = d.mSparseIndex + 6 * k;
+    uint32_t block = Little32(sparse);
+    int offset = int(Little16(sparse + 4)) + int(index % d.mSpan) - int(d.mSpan / 2);
+    while (offset < 0)
+    {
+        offset += int(Little16(d.mBlockLength + 2 * --block)) + 1;
+    }
+    while (offset > int(Little16(d.mBlockLength + 2 * block)))
+    {
+        offset -= int(Little16(d.mBlockLength + 2 * block++)) + 1;
+    }
+
+    // Decode symbols until the one covering the offset
+    const uint8_t *pointer = d.mData + uint64_t(block) * d.mBlockSize;
+    uint64_t buffer = uint64_t(Big32(pointer)) << 32 | Big32(pointer + 4);
+    pointer += 8;
+    int bits = 64;
+    int symbol;
+    while (true)
+    {
+        int length = 0;
+        while (buffer < d.mBase64[length])
+        {
+            length++;
+        }
+        symbol = int((buffer - d.mBase64[length]) >> (64 - length - d.mMinSymLen));
+        symbol += Little16(d.mLowestSym + 2 * length);
+        if (offset < d.mSymLen[symbol] + 1)
+        {
+            break;
+        }
+        offset -= d.mSymLen[symbol] + 1;
+        length += d.mMinSymLen;
+        buffer <<= length;
+        bits -= length;
+        if (bits <= 32)
+        {
+            bits += 32;
+            buffer |= uint64_t(Big32(pointer)) << (64 - bits);
+            pointer += 4;
+        }
+    }
+
+    // Symbols stand for adjacent pairs, descend to the single value
+    while (d.mSymLen[symbol] != 0)
+    {
+        const uint8_t *pair = d.mTree + 3 * symbol;
+        int left = LeftSymbol(pair);
+        if (offset < d.mSymLen[left] + 1)
+        {
+            symbol = left;
+        }
+        else
+        {
+            offset -= d.mSymLen[left] + 1;
+            symbol = RightSymbol(pair);
+        }
+    }
+    return LeftSymbol(d.mTree + 3 * symbol);
+}
+
+/**
+ * Look a position up in its WDL or DTZ table
+ * @param position The position, with no castling rights
+ * @param dtz Probe the DTZ rather than the WDL table
+ * @param wdl Result of the position, for DTZ probes
+ * @param state Set to PROBE_FAIL or PROBE_CHANGE_STM on failure
+ * @return WDL score, or distance to zeroing in plies
+ */
+int Tablebases::ProbeTable(const Position &position, bool dtz, WdlScore wdl, ProbeState &state)
+{
+    if (PopCount(position.Occupied()) == 2)
+    {
+        return WDL_DRAW;
+    }
+
+    auto found = mByKey.find(position.MaterialKey());
+    if (found == mByKey.end() || !Map(*found->second, dtz))
+    {
+        state = PROBE_FAIL;
+        return 0;
+    }
+    const Material &material = *found->second;
+    const TableFile &table = dtz ? material.mDtz : material.mWdl;
+
+    // Tables have the side named first as white. For the other
+    // colors, and for black to move when both sides have the same
+    // pieces, swap the colors and mirror the board.
+    int sideToMove = ColorIndex(position.SideToMove());
+    bool flip = material.mKey == material.mKey2 ? sideToMove == 1 : position.MaterialKey() != material.mKey;
+    int flipColor = flip ? 8 : 0;
+    int flipSquares = flip ? 56 : 0;
+    int stm = (flip ? 1 : 0) ^ sideToMove;
+
+    int squares[TB_PIECES];
+    int pieces[TB_PIECES];
+    int size = 0;
+    int leadPawns = 0;
+    int file = 0;
+    Bitboard leadPawnSet = 0;
+    auto byMapPawns = [](int a, int b) { return MapPawns[a] < MapPawns[b]; };
+
+    // Pawn tables are split by the file of the leading pawn, the
+    // one nearest the edge and then the lowest
+    if (material.mHasPawns)
+    {
+        int leadColor = (table.mItems[0][0].mPieces[0] ^ flipColor) >> 3;
+        leadPawnSet = position.Pieces((leadColor == 0 ? WHITE : BLACK) + PAWN);
+        for (Bitboard pawns = leadPawnSet; pawns != 0;)
+        {
+            squares[size++] = PopLsb(pawns) ^ flipSquares;
+        }
+        leadPawns = size;
+        std::swap(squares[0], *std::max_element(squares, squares + leadPawns, byMapPawns));
+        file = std::min(FileOf(squares[0]), 7 - FileOf(squares[0]));
+    }
+
+    // DTZ tables have only one side to move
+    const PairsData &d = table.mItems[dtz ? 0 : stm][file];
+    if (dtz && (d.mFlags & FLAG_STM) != stm && (material.mKey != material.mKey2 || material.mHasPawns))
+    {
+        state = PROBE_CHANGE_STM;
+        return 0;
+    }
+
+    for (Bitboard rest = position.Occupied() ^ leadPawnSet; rest != 0;)
+    {
+        int square = PopLsb(rest);
+        int piece = position.PieceOn(square);
+        squares[size] = square ^ flipSquares;
+        pieces[size++] = (TbPieceType[TypeOf(piece)] + (ColorOf(piece) == BLACK ? 8 : 0)) ^ flipColor;
+    }
+
+    // Put the pieces in the order of the table
+    for (int i = leadPawns; i < size - 1; i++)
+    {
+        for (int j = i + 1; j < size; j++)
+        {
+            if (d.mPieces[i] == pieces[j])
+            {
+                std::swap(pieces[i], pieces[j]);
+                std::swap(squares[i], squares[j]);
+                break;
+            }
+        }
+    }
+
+    // Mirror the leading piece to files a to d
+    if (FileOf(squares[0]) > 3)
+    {
+        for (int i = 0; i < size; i++)
+        {
+            squares[i] ^= 7;
+        }
+    }
+
+    uint64_t index;
+    if (material.mHasPawns)
+    {
+        index = LeadPawnIdx[leadPawns][squares[0]];
+        std::stable_sort(squares + 1, squares + leadPawns, byMapPawns);
+        for (int i = 1; i < leadPawns; i++)
+        {
+            index += Binomial[i][MapPawns[squares[i]]];
+        }
+    }
+    else
+    {
+        // Without pawns the leading piece also goes to ranks 1 to 4,
+        // and the first piece off the diagonal below it
+        if (RankOf(squares[0]) > 3)
+        {
+            for (int i = 0; i < size; i++)
+            {
+                squares[i] ^= 56;
+            }
+        }
+        for (int i = 0; i < d.mGroupLen[0]; i++)
+        {
+            if (OffDiagonal(squares[i]) == 0)
+            {
+                continue;
+            }
+            if (OffDiagonal(squares[i]) > 0)
+            {
+                for (int j = i; j < size; j++)
+                {
+                    squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                }
+            }
+            break;
+        }
+
+        if (material.mHasUniquePieces)
+        {
+            int adjust1 = squares[1] > squares[0];
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+            if (OffDiagonal(squares[0]) != 0)
+            {
+                index = (MapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+            }
+            else if (OffDiagonal(squares[1]) != 0)
+            {
+                index = (6 * 63 + RankOf(squares[0]) * 28 + MapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+            }
+            else if (OffDiagonal(squares[2]) != 0)
+            {
+                index = 6 * 63 * 62 + 4 * 28 * 62 + RankOf(squares[0]) * 7 * 28
+                    + (RankOf(squares[1]) - adjust1) * 28 + MapB1H1H7[squares[2]];
+            }
+            else
+            {
+                index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + RankOf(squares[0]) * 7 * 6
+                    + (RankOf(squares[1]) - adjust1) * 6 + (RankOf(squares[2]) - adjust2);
+            }
+        }
+        else
+        {
+            index = MapKK[MapA1D1D4[squares[0]]][squares[1]];
+        }
+    }
+
+    // The other groups, each numbered among the squares left free
+    index *= d.mGroupIdx[0];
+    int *group = squares + d.mGroupLen[0];
+    bool remainingPawns = material.mHasPawns && material.mPawnCount[1] > 0;
+    for (int next = 1; d.mGroupLen[next] != 0; next++)
+    {
+        std::stable_sort(group, group + d.mGroupLen[next]);
+        uint64_t n = 0;
+        for (int i = 0; i < d.mGroupLen[next]; i++)
+        {
+            int adjust = int(std::count_if(squares, group, [&](int square) { return group[i] > square; }));
+            n += Binomial[i + 1][group[i] - adjust - (remainingPawns ? 8 : 0)];
+        }
+        remainingPawns = false;
+        index += n * d.mGroupIdx[next];
+        group += d.mGroupLen[next];
+    }
+
+    int value = Decompress(d, index);
+    if (!dtz)
+    {
+        return value - 2;
+    }
+
+    // DTZ values may go through a map, and may be in moves
+    const PairsData &first = table.mItems[0][file];
+    if (first.mFlags & FLAG_MAPPED)
+    {
+        const int wdlMap[] = {1, 3, 0, 2, 0};
+        int at = first.mMapIdx[wdlMap[wdl + 2]] + value;
+        value = first.mFlags & FLAG_WIDE ? int(Little16(table.mMap + 2 * at)) : table.mMap[at];
+    }
+    if ((wdl == WDL_WIN && !(first.mFlags & FLAG_WIN_PLIES)) || (wdl == WDL_LOSS && !(first.mFlags & FLAG_LOSS_PLIES))
+        || wdl == WDL_CURSED_WIN || wdl == WDL_BLESSED_LOSS)
+    {
+        value *= 2;
+    }
+    return value + 1;
+}
+
+/**
+ * Get the result of a position by looking at the captures, and
+ * pawn moves if asked, before the table. The tables do not hold
+ * positions with en passant rights, nor reliable values where
+ * the best move is a capture.
+ * @param position The position
+ * @param checkZeroingMoves Also try the pawn moves
+ * @param state Set to PROBE_FAIL if a table is missing, or to
+ * PROBE_ZEROING_BEST_MOVE if the best move found resets the counter
+ * @return The result
+ */
+WdlScore Tablebases::SearchZeroing(Position &position, bool checkZeroingMoves, ProbeState &state)
+{
+    MoveList moves;
+    position.GenerateLegalMoves(moves);
+    int tried = 0;
+    WdlScore best = WDL_LOSS;
+    for (Move move : moves)
+    {
+        if (!position.IsCapture(move) && (!checkZeroingMoves || TypeOf(position.PieceOn(move.From())) != PAWN))
+        {
+            continue;
+        }
+        tried++;
+
+        position.DoMove(move);
+        WdlScore value = WdlScore(-SearchZeroing(position, false, state));
+        position.UndoMove();
+        if (state == PROBE_FAIL)
+        {
+            return WDL_DRAW;
+        }
+        if (value > best)
+        {
+            best = value;
+            if (value >= WDL_WIN)
+            {
+                state = PROBE_ZEROING_BEST_MOVE;
+                return value;
+            }
+        }
+    }
+
+    // With every move tried the table is not needed
+    bool allTried = tried > 0 && tried == moves.Size();
+    WdlScore value = best;
+    if (!allTried)
+    {
+        value = WdlScore(ProbeTable(position, false, WDL_DRAW, state));
+        if (state == PROBE_FAIL)
+        {
+            return WDL_DRAW;
+        }
+    }
+
+    if (best >= value)
+    {
+        state = best > WDL_DRAW || allTried ? PROBE_ZEROING_BEST_MOVE : PROBE_OK;
+        return best;
+    }
+    state = PROBE_OK;
+    return value;
+}
+
+/**
+ * Probe the WDL tables, safe to call from several threads
+ * @param position Position with no castling rights, returned unchanged
+ * @param state Set to PROBE_FAIL if a table is missing
+ * @return Result for the side to move
+ */
+WdlScore Tablebases::ProbeWdl(Position &position, ProbeState &state)
+{
+    state = PROBE_OK;
+    return SearchZeroing(position, false, state);
+}
+
+/**
+ * Probe the DTZ tables, safe to call from several threads
+ * @param position Position with no castling rights, returned unchanged
+ * @param state Set to PROBE_FAIL if a table is missing
+ * @return Plies to a capture or pawn move that keeps the result,
+ * positive when winning, negative when losing and 0 for a draw.
+ * Results that the fifty move rule changes are 100 further away.
+ */
+int Tablebases::ProbeDtz(Position &position, ProbeState &state)
+{
+    state = PROBE_OK;
+    WdlScore wdl = SearchZeroing(position, true, state);
+    if (state == PROBE_FAIL || wdl == WDL_DRAW)
+    {
+        return 0;
+    }
+    if (state == PROBE_ZEROING_BEST_MOVE)
+    {
+        return DtzBeforeZeroing(wdl);
+    }
+
+    int dtz = ProbeTable(position, true, wdl, state);
+    if (state == PROBE_FAIL)
+    {
+        return 0;
+    }
+    if (state != PROBE_CHANGE_STM)
+    {
+        return (dtz + (wdl == WDL_BLESSED_LOSS || wdl == WDL_CURSED_WIN ? 100 : 0)) * Sign(wdl);
+    }
+
+    // The table is for the other side to move, take the best reply
+    int best = 0xFFFF;
+    MoveList moves;
+    position.GenerateLegalMoves(moves);
+    for (Move move : moves)
+    {
+        bool zeroing = position.IsCapture(move) || TypeOf(position.PieceOn(move.From())) == PAWN;
+        position.DoMove(move);
+        dtz = zeroing ? -DtzBeforeZeroing(SearchZeroing(position, false, state)) : -ProbeDtz(position, state);
+        if (dtz == 1 && position.InCheck() && !position.HasLegalMove())
+        {
+            best = 1;
+        }
+        if (!zeroing)
+        {
+            dtz += Sign(dtz);
+        }
+        if (dtz < best && Sign(dtz) == Sign(wdl))
+        {
+            best = dtz;
+        }
+        position.UndoMove();
+        if (state == PROBE_FAIL)
+        {
+            return 0;
+        }
+    }
+    return best == 0xFFFF ? -1 : best;
+}
+
+/**
+ * Rank the root moves with the DTZ tables. Winning moves are
+ * ranked by how soon they zero, losing ones by how late.
+ * @param position Root position with no castling rights
+ * @param rootMoves Receive mTbRank and mTbScore
+ * @param rule50 Does the fifty move rule apply?
+ * @return False if a table is missing
+ */
+bool Tablebases::RankRootMoves(Position &position, std::vector<RootMove> &rootMoves, bool rule50)
+{
+    ProbeState state = PROBE_OK;
+    int halfmoves = position.HalfmoveClock();
+    bool repeated = HasRepeated(position);
+    int bound = rule50 ? MAX_DTZ / 2 - 100 : 1;
+    for (RootMove &rootMove : rootMoves)
+    {
+        position.DoMove(rootMove.mMove);
+        int dtz;
+        if (position.HalfmoveClock() == 0)
+        {
+            dtz = DtzBeforeZeroing(WdlScore(-ProbeWdl(position, state)));
+        }
+        else if (IsRootMoveDraw(position))
+        {
+            dtz = 0;
+        }
+        else
+        {
+            dtz = -ProbeDtz(position, state);
+            dtz += Sign(dtz);
+        }
+        if (dtz == 2 && position.InCheck() && !position.HasLegalMove())
+        {
+            dtz = 1;
+        }
+        position.UndoMove();
+        if (state == PROBE_FAIL)
+        {
+            return false;
+        }
+
+        // Wins the fifty move rule does not spoil rank above the rest
+        int rank = dtz > 0 ? (dtz + halfmoves <= 99 && !repeated ? MAX_DTZ - dtz : MAX_DTZ / 2 - (dtz + halfmoves))
+            : dtz < 0 ? (-dtz * 2 + halfmoves < 100 ? -MAX_DTZ - dtz : -MAX_DTZ / 2 + (-dtz + halfmoves))
+            : 0;
+        rootMove.mTbRank = rank;
+
+        // Wins spoiled by the fifty move rule score a little above a
+        // draw, more the closer they come to a real win
+        int pawn = PieceValue[PAWN];
+        rootMove.mTbScore = rank >= bound ? VALUE_TB_WIN
+            : rank > 0 ? std::max(3, rank - (MAX_DTZ / 2 - 200)) * pawn / 200
+            : rank == 0 ? VALUE_DRAW
+            : rank > -bound ? std::min(-3, rank + (MAX_DTZ / 2 - 200)) * pawn / 200
+            : -VALUE_TB_WIN;
+    }
+    return true;
+}
+
+/**
+ * Rank the root moves with the WDL tables only, when DTZ tables
+ * are missing. Every win ranks the same, so the search has to
+ * make the progress.
+ * @param position Root position with no castling rights
+ * @param rootMoves Receive mTbRank and mTbScore
+ * @param rule50 Does the fifty move rule apply?
+ * @return False if a table is missing
+ */
+bool Tablebases::RankRootMovesWdl(Position &position, std::vector<RootMove> &rootMoves, bool rule50)
+{
+    const int wdlToRank[] = {-MAX_DTZ, -MAX_DTZ + 101, 0, MAX_DTZ - 101, MAX_DTZ};
+    const int wdlToScore[] = {-VALUE_TB_WIN, VALUE_DRAW - 2, VALUE_DRAW, VALUE_DRAW + 2, VALUE_TB_WIN};
+
+    ProbeState state = PROBE_OK;
+    for (RootMove &rootMove : rootMoves)
+    {
+        position.DoMove(rootMove.mMove);
+        WdlScore wdl = IsRootMoveDraw(position) ? WDL_DRAW : WdlScore(-ProbeWdl(position, state));
+        position.UndoMove();
+        if (state == PROBE_FAIL)
+        {
+            return false;
+        }
+
+        rootMove.mTbRank = wdlToRank[wdl + 2];
+        if (!rule50)
+        {
+            wdl = wdl > WDL_DRAW ? WDL_WIN : wdl < WDL_DRAW ? WDL_LOSS : WDL_DRAW;
+        }
+        rootMove.mTbScore = wdlToScore[wdl + 2];
+    }
+    return true;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file Tablebases.h
+ * @author John Korreck
+ *
+ * Probing Syzygy endgame tablebases.
+ */
+
+#ifndef TABLEBASES_H
+#define TABLEBASES_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+
+class Position;
+struct RootMove;
+
+/// Most pieces, kings included, in any Syzygy table
+const int TB_PIECES = 7;
+
+/**
+ * Win, draw or loss from the side to move's point of view. A cursed
+ * win would be won without the fifty move rule, a blessed loss lost.
+ */
+enum WdlScore { WDL_LOSS = -2, WDL_BLESSED_LOSS = -1, WDL_DRAW = 0, WDL_CURSED_WIN = 1, WDL_WIN = 2 };
+
+/**
+ * Outcome of a probe
+ */
+enum ProbeState {
+    /// No table for the position
+    PROBE_FAIL = 0,
+
+    /// The value is valid
+    PROBE_OK = 1,
+
+    /// The DTZ table only has the other side to move
+    PROBE_CHANGE_STM = -1,
+
+    /// The best move resets the fifty move counter
+    PROBE_ZEROING_BEST_MOVE = 2,
+};
+
+/**
+ * The Syzygy tables in a set of directories.
+ *
+ * Init() only looks at which .rtbw files exist. A table is mapped
+ * into memory the first time a position with its material is probed,
+ * under a mutex, after which an atomic flag makes every further probe
+ * lock free. Probing only reads the mapped files and the tables built
+ * by Init(), so any number of search threads can probe at once while
+ * nobody calls Init().
+ */
+class Tablebases {
+private:
+    /**
+     * Decoding information for one sub-table of a file
+     */
+    struct PairsData {
+        /// Table flags, see TableFlag in Tablebases.cpp
+        uint8_t mFlags = 0;
+
+        /// Longest Huffman code in bits
+        uint8_t mMaxSymLen = 0;
+
+        /// Shortest Huffman code in bits, or the value of a single valued table
+        uint8_t mMinSymLen = 0;
+
+        /// Number of compressed blocks
+        uint32_t mNumBlocks = 0;
+
+        /// Size of a block in bytes
+        size_t mBlockSize = 0;
+
+        /// Values between consecutive sparse index entries
+        size_t mSpan = 0;
+
+        /// Lowest symbol of each code length
+        const uint8_t *mLowestSym = nullptr;
+
+        /// Pairs of symbols each symbol expands to, 3 bytes each
+        const uint8_t *mTree = nullptr;
+
+        /// Number of values in each block minus one, 16 bits each
+        const uint8_t *mBlockLength = nullptr;
+
+        /// Size of mBlockLength, padded past mNumBlocks
+        uint32_t mBlockLengthSize = 0;
+
+        /// Block and offset of every mSpan'th value, 6 bytes each
+        const uint8_t *mSparseIndex = nullptr;
+
+        /// Number of sparse index entries
+        size_t mSparseIndexSize = 0;
+
+        /// Start of the compressed blocks
+        const uint8_t *mData = nullptr;
+
+        /// Lowest code of each length, left aligned in 64 bits
+        std::vector<uint64_t> mBase64;
+
+        /// Number of values each symbol expands to, minus one
+        std::vector<uint8_t> mSymLen;
+
+        /// Pieces in encoding order, in the file's piece codes
+        uint8_t mPieces[TB_PIECES] = {};
+
+        /// Index multiplier of each group of pieces
+        uint64_t mGroupIdx[TB_PIECES + 1] = {};
+
+        /// Pieces in each group, ending with 0
+        int mGroupLen[TB_PIECES + 1] = {};
+
+        /// Where the DTZ value map of each result starts
+        uint16_t mMapIdx[4] = {};
+    };
+
+    /**
+     * A WDL or DTZ file, mapped on first use
+     */
+    struct TableFile {
+        /// Set once the file has been mapped, or found to be unusable
+        std::atomic<bool> mReady{false};
+
+        /// The mapped file, closed if it could not be used
+        MappedFile mFile;
+
+        /// DTZ value maps
+        const uint8_t *mMap = nullptr;
+
+        /// Sub-tables by side to move, then leading pawn file
+        PairsData mItems[2][4];
+    };
+
+    /**
+     * The tables of one material signature, such as KRPvKR
+     */
+    struct Material {
+        /// File name without the extension
+        std::string mName;
+
+        /// Position::MaterialKey() with the first side of the name white
+        uint64_t mKey = 0;
+
+        /// Position::MaterialKey() with the first side of the name black
+        uint64_t mKey2 = 0;
+
+        /// Pieces, kings included
+        int mPieceCount = 0;
+
+        /// Are there any pawns?
+        bool mHasPawns = false;
+
+        /// Is some piece other than a king the only one of its kind?
+        bool mHasUniquePieces = false;
+
+        /// Pawns of the leading color, then of the other
+        int mPawnCount[2] = {};
+
+        /// Win, draw or loss table
+        TableFile mWdl;
+
+        /// Distance to zeroing table
+        TableFile mDtz;
+    };
+
+    /// Directories searched for table files
+    std::vector<std::string> mPaths;
+
+    /// Every signature found, in a deque so the addresses stay put
+    std::deque<Material> mMaterials;
+
+    /// Signatures by both of their material keys
+    std::unordered_map<uint64_t, Material *> mByKey;
+
+    /// Most pieces in any table found
+    int mMaxPieces = 0;
+
+    /// Serializes mapping the files
+    std::mutex mMapMutex;
+
+    void Add(const std::string &name);
+    bool Map(Material &material, bool dtz);
+    static bool Setup(Material &material, TableFile &table, bool dtz);
+    static void SetGroups(const Material &material, PairsData &d, const int order[2], int file);
+    static const uint8_t *SetSizes(PairsData &d, const uint8_t *data);
+    static uint8_t SetSymLen(PairsData &d, int symbol, std::vector<bool> &visited);
+    static int Decompress(const PairsData &d, uint64_t index);
+    int ProbeTable(const Position &position, bool dtz, WdlScore wdl, ProbeState &state);
+    WdlScore SearchZeroing(Position &position, bool checkZeroingMoves, ProbeState &state);
+
+public:
+    Tablebases() = default;
+
+    /// Copy constructor (disabled)
+    Tablebases(const Tablebases &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const Tablebases &) = delete;
+
+    int Init(const std::string &paths);
+
+    /// Most pieces in any table found, 0 if there are none
+    int MaxPieces() const { return mMaxPieces; }
+
+    WdlScore ProbeWdl(Position &position, ProbeState &state);
+    int ProbeDtz(Position &position, ProbeState &state);
+    bool RankRootMoves(Position &position, std::vector<RootMove> &rootMoves, bool rule50);
+    bool RankRootMovesWdl(Position &position, std::vector<RootMove> &rootMoves, bool rule50);
+};
+
+#endif //TABLEBASES_H
@@ -0,0 +1,133 @@
+/**
+ * @file TranspositionTable.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "TranspositionTable.h"
+
+/// Table size in megabytes until Resize is called
+const size_t DefaultHashMegabytes = 16;
+
+/**
+ * Constructor
+ */
+TranspositionTable::TranspositionTable()
+{
+    Resize(DefaultHashMegabytes);
+}
+
+/**
+ * Change the table size. This clears the table.
+ * @param megabytes New size in megabytes
+ */
+void TranspositionTable::Resize(size_t megabytes)
+{
+    size_t buckets = std::max<size_t>(1, megabytes * 1024 * 1024 / sizeof(Bucket));
+    mTable.assign(buckets, Bucket());
+}
+
+/**
+ * Erase every entry
+ */
+void TranspositionTable::Clear()
+{
+    std::fill(mTable.begin(), mTable.end(), Bucket());
+    mGeneration = 0;
+}
+
+/**
+ * Get the bucket a key maps to
+ * @param key Position key
+ * @return The bucket
+ */
+TranspositionTable::Bucket &TranspositionTable::BucketFor(uint64_t key)
+{
+    // Multiply-high maps the lower key bits onto any table size
+    uint64_t index = (uint64_t(uint32_t(key)) * mTable.size()) >> 32;
+    return mTable[index];
+}
+
+/**
+ * Look up a position
+ * @param key Position key
+ * @param entry Receives a copy of the entry if found
+ * @return True if the position is in the table
+ */
+bool TranspositionTable::Probe(uint64_t key, TTEntry &entry)
+{
+    uint32_t key32 = uint32_t(key >> 32);
+    for (TTEntry &candidate : BucketFor(key).mEntries)
+    {
+        if (candidate.mKey == key32 && candidate.GetBound() != BOUND_NONE)
+        {
+            // Refresh the generation so the entry survives this search
+            candidate.mGenerationBound = uint8_t(mGeneration | candidate.GetBound());
+            entry = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Store a search result. Replaces the same position, an empty
+ * entry or the least valuable entry in the bucket.
+ * @param key Position key
+ * @param move Best move, Move::None() keeps any move already stored
+ * @param score Search score, already adjusted for mate distance
+ * @param eval Static evaluation
+ * @param depth Search depth
+ * @param bound Kind of bound the score is
+ */
+void TranspositionTable::Store(uint64_t key, Move move, int score, int eval, int depth, Bound bound)
+{
+    uint32_t key32 = uint32_t(key >> 32);
+    Bucket &bucket = BucketFor(key);
+
+    TTEntry *replace = &bucket.mEntries[0];
+    for (TTEntry &candidate : bucket.mEntries)
+    {
+        if (candidate.mKey == key32 || candidate.GetBound() == BOUND_NONE)
+        {
+            replace = &candidate;
+            break;
+        }
+
+        // Prefer replacing old and shallow entries
+        int age = uint8_t(mGeneration - (candidate.mGenerationBound & 0xFC)) / 4;
+        int replaceAge = uint8_t(mGeneration - (replace->mGenerationBound & 0xFC)) / 4;
+        if (candidate.mDepth - 8 * age < replace->mDepth - 8 * replaceAge)
+        {
+            replace = &candidate;
+        }
+    }
+
+    if (move.IsValid() || replace->mKey != key32)
+    {
+        replace->mMove = move.Raw();
+    }
+    replace->mKey = key32;
+    replace->mScore = int16_t(score);
+    replace->mEval = int16_t(eval);
+    replace->mDepth = int8_t(depth);
+    replace->mGenerationBound = uint8_t(mGeneration | bound);
+}
+
+/**
+ * Estimate how full the table is
+ * @return Permill of the first thousand buckets used this search
+ */
+int TranspositionTable::Hashfull() const
+{
+    int used = 0;
+    int buckets = int(std::min<size_t>(1000, mTable.size()));
+    for (int i = 0; i < buckets; i++)
+    {
+        for (TTEntry const &entry : mTable[i].mEntries)
+        {
+            used += entry.GetBound() != BOUND_NONE && (entry.mGenerationBound & 0xFC) == mGeneration;
+        }
+    }
+    return used * 1000 / (buckets * BucketSize);
+}
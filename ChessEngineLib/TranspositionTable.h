@@ -0,0 +1,80 @@
+/**
+ * @file TranspositionTable.h
+ * @author John Korreck
+ *
+ * Hash table of search results shared between iterations and searches.
+ */
+
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Move.h"
+
+/// Kind of bound stored with a score
+enum Bound : uint8_t { BOUND_NONE = 0, BOUND_UPPER = 1, BOUND_LOWER = 2, BOUND_EXACT = 3 };
+
+/**
+ * A single table entry
+ */
+struct TTEntry {
+    /// Upper 32 bits of the position key
+    uint32_t mKey = 0;
+
+    /// Best move found, as Move::Raw()
+    uint16_t mMove = 0;
+
+    /// Search score
+    int16_t mScore = 0;
+
+    /// Static evaluation
+    int16_t mEval = 0;
+
+    /// Depth the score was searched to
+    int8_t mDepth = 0;
+
+    /// Search generation in the upper 6 bits, Bound in the lower 2
+    uint8_t mGenerationBound = 0;
+
+    Move GetMove() const { return Move::FromRaw(mMove); }
+    Bound GetBound() const { return Bound(mGenerationBound & 3); }
+};
+
+/**
+ * The transposition table, a vector of four entry buckets.
+ */
+class TranspositionTable {
+private:
+    /// Entries per bucket
+    static const int BucketSize = 4;
+
+    /// A bucket of entries sharing one index
+    struct Bucket {
+        TTEntry mEntries[BucketSize];
+    };
+
+    /// The table
+    std::vector<Bucket> mTable;
+
+    /// Current search generation, stored in the upper 6 bits
+    uint8_t mGeneration = 0;
+
+    Bucket &BucketFor(uint64_t key);
+
+public:
+    TranspositionTable();
+
+    void Resize(size_t megabytes);
+    void Clear();
+
+    /// Start a new search, older entries become replaceable
+    void NewSearch() { mGeneration += 4; }
+
+    bool Probe(uint64_t key, TTEntry &entry);
+    void Store(uint64_t key, Move move, int score, int eval, int depth, Bound bound);
+    int Hashfull() const;
+};
+
+#endif //TRANSPOSITIONTABLE_H
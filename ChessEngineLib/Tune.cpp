@@ -0,0 +1,79 @@
+/**
+ * @file Tune.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Tune.h"
+
+#include <algorithm>
+
+/**
+ * The registered parameters. A function static, so that it exists
+ * before the static initializers of other files register with it.
+ * @return The parameters in order of registration
+ */
+static std::vector<TuneParameter> &Parameters()
+{
+    static std::vector<TuneParameter> parameters;
+    return parameters;
+}
+
+/**
+ * Register parameters, meant to initialize a static in the file
+ * that owns them. Each default is taken from the current value.
+ * @param parameters Name, constant, minimum and maximum of each
+ * @return True, so the result can initialize a static
+ */
+bool TuneParameter::Add(std::initializer_list<TuneParameter> parameters)
+{
+    for (TuneParameter parameter : parameters)
+    {
+        parameter.mDefault = *parameter.mValue;
+        Parameters().push_back(parameter);
+    }
+    return true;
+}
+
+/**
+ * Get every registered parameter
+ * @return The parameters in order of registration
+ */
+const std::vector<TuneParameter> &TuneParameter::All()
+{
+    return Parameters();
+}
+
+/**
+ * Find a parameter by name
+ * @param name Option name
+ * @return The parameter, or nullptr if there is none of that name
+ */
+const TuneParameter *TuneParameter::Find(const std::string &name)
+{
+    for (auto const &parameter : Parameters())
+    {
+        if (parameter.mName == name)
+        {
+            return &parameter;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Set a parameter by name
+ * @param name Option name
+ * @param value New value, clamped to the parameter's range
+ * @return False if there is no parameter of that name
+ */
+bool TuneParameter::Set(const std::string &name, int value)
+{
+    const TuneParameter *parameter = Find(name);
+    if (parameter == nullptr)
+    {
+        return false;
+    }
+    *parameter->mValue = std::clamp(value, parameter->mMin, parameter->mMax);
+    return true;
+}
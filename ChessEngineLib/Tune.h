@@ -0,0 +1,52 @@
+/**
+ * @file Tune.h
+ * @author John Korreck
+ *
+ * Search and evaluation constants that can be set as UCI options.
+ */
+
+#ifndef TUNE_H
+#define TUNE_H
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/**
+ * A constant of the search or evaluation exposed as a UCI spin
+ * option, so a tuner can set it in each engine it starts.
+ *
+ * The constants stay globals of the file that uses them, only no
+ * longer const, and that file registers them with Add() when the
+ * program starts. Values are read while searching without any
+ * locking, so they must only be set between searches, which
+ * Engine::SetParameter() sees to. Evaluation terms that end up in
+ * the pawn and material tables are marked mCached, and setting one
+ * clears those tables so no entry keeps the old value.
+ */
+struct TuneParameter {
+    /// Option name
+    std::string mName;
+
+    /// The constant
+    int *mValue = nullptr;
+
+    /// Value the program was built with
+    int mDefault = 0;
+
+    /// Lowest value the option accepts
+    int mMin = 0;
+
+    /// Highest value the option accepts
+    int mMax = 0;
+
+    /// Is the constant held in the pawn or material tables?
+    bool mCached = false;
+
+    static bool Add(std::initializer_list<TuneParameter> parameters);
+    static const std::vector<TuneParameter> &All();
+    static const TuneParameter *Find(const std::string &name);
+    static bool Set(const std::string &name, int value);
+};
+
+#endif //TUNE_H
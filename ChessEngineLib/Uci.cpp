@@ -0,0 +1,393 @@
+/**
+ * @file Uci.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "Uci.h"
+#include "Engine.h"
+#include "Tune.h"
+
+#include <chrono>
+#include <iomanip>
+
+/// Name reported to the GUI
+const std::string EngineName = "Chess Engine";
+
+/// Author reported to the GUI
+const std::string EngineAuthor = "John Korreck";
+
+/// Positions searched by the bench command, from the opening to the endgame
+const char *BenchPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bqkb1r/pp3ppp/2n1pn2/2pp4/3P4/2PBPN2/PP3PPP/RNBQK2R w KQkq - 0 6",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "2r3k1/pp3ppp/2n5/3p4/3P4/2P2N2/P4PPP/2R3K1 w - - 0 24",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+};
+
+/**
+ * Constructor
+ * @param engine Engine the commands are sent to
+ */
+Uci::Uci(Engine &engine) : mEngine(engine)
+{
+    mEngine.GetSearch().SetInfoCallback([this](const SearchInfo &info) { SendInfo(info); });
+    mEngine.GetSearch().SetBestMoveCallback([this](Move best, Move ponder) {
+        std::string line = "bestmove ";
+        line += best.UciText().View();
+        if (ponder.IsValid())
+        {
+            line += " ponder ";
+            line += ponder.UciText().View();
+        }
+        Send(line);
+    });
+}
+
+/**
+ * Write a line of output
+ * @param line Line without the newline
+ */
+void Uci::Send(const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(mOutputMutex);
+    *mOutput << line << std::endl;
+}
+
+/**
+ * Format a score the way UCI expects it
+ * @param score Search score
+ * @return "cp 25" or "mate -3"
+ */
+std::string Uci::FormatScore(int score)
+{
+    if (std::abs(score) >= VALUE_MATE_IN_MAX_PLY)
+    {
+        int moves = score > 0 ? (VALUE_MATE - score + 1) / 2 : -(VALUE_MATE + score) / 2;
+        return "mate " + std::to_string(moves);
+    }
+    return "cp " + std::to_string(score);
+}
+
+/**
+ * Report the progress of the search
+ * @param info Result of an iteration
+ */
+void Uci::SendInfo(const SearchInfo &info)
+{
+    std::ostringstream line;
+    line << "info depth " << info.mDepth << " seldepth " << info.mSelDepth
+         << " multipv " << info.mMultiPV
+         << " score " << FormatScore(info.mScore)
+         << " nodes " << info.mNodes
+         << " nps " << info.mNodes * 1000 / std::max<int64_t>(1, info.mTime)
+         << " hashfull " << info.mHashfull
+         << " tbhits " << info.mTbHits
+         << " time " << info.mTime << " pv";
+    for (Move move : info.mPv)
+    {
+        line << ' ' << move.UciText().View();
+    }
+    Send(line.str());
+}
+
+/**
+ * Read commands until quit or the end of input
+ * @param input Command stream
+ * @param output Response stream
+ */
+void Uci::Loop(std::istream &input, std::ostream &output)
+{
+    mOutput = &output;
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream command(line);
+        std::string token;
+        command >> token;
+
+        if (token == "uci")
+        {
+            Send("id name " + EngineName);
+            Send("id author " + EngineAuthor);
+            Send("option name Hash type spin default 16 min 1 max 65536");
+            Send("option name Clear Hash type button");
+            Send("option name Ponder type check default false");
+            Send("option name MultiPV type spin default 1 min 1 max " + std::to_string(MAX_MOVES));
+            Send("option name EvalFile type string default "
+                 + (Network::HasEmbedded() ? EmbeddedNetworkName : std::string("<empty>")));
+            Send("option name Book type string default <empty>");
+            Send("option name SyzygyPath type string default <empty>");
+            Send("option name SyzygyProbeDepth type spin default 1 min 1 max 100");
+            Send("option name Syzygy50MoveRule type check default true");
+            Send("option name EndgameTablePath type string default <empty>");
+            for (auto const &parameter : TuneParameter::All())
+            {
+                Send("option name " + parameter.mName + " type spin default " + std::to_string(parameter.mDefault)
+                     + " min " + std::to_string(parameter.mMin) + " max " + std::to_string(parameter.mMax));
+            }
+            Send("uciok");
+        }
+        else if (token == "isready")
+        {
+            Send("readyok");
+        }
+        else if (token == "ucinewgame")
+        {
+            mEngine.NewGame();
+        }
+        else if (token == "setoption")
+        {
+            OnSetOption(command);
+        }
+        else if (token == "position")
+        {
+            OnPosition(command);
+        }
+        else if (token == "go")
+        {
+            OnGo(command);
+        }
+        else if (token == "stop")
+        {
+            mEngine.Stop();
+        }
+        else if (token == "ponderhit")
+        {
+            mEngine.PonderHit();
+        }
+        else if (token == "bench")
+        {
+            OnBench(command);
+        }
+        else if (token == "d")
+        {
+            Send(mEngine.GetPosition().GetFen());
+        }
+        else if (token == "quit")
+        {
+            break;
+        }
+    }
+
+    mEngine.Stop();
+    mEngine.Wait();
+}
+
+/**
+ * Handle "position [startpos | fen ...] [moves ...]"
+ * @param command Rest of the command line
+ */
+void Uci::OnPosition(std::istringstream &command)
+{
+    std::string token, fen;
+    command >> token;
+    if (token == "startpos")
+    {
+        fen = Position::StartFen;
+        command >> token;
+    }
+    else if (token == "fen")
+    {
+        while (command >> token && token != "moves")
+        {
+            fen += token + ' ';
+        }
+    }
+    else
+    {
+        return;
+    }
+
+    std::vector<std::string> moves;
+    while (command >> token)
+    {
+        moves.push_back(token);
+    }
+
+    if (!mEngine.SetPosition(fen, moves))
+    {
+        Send("info string invalid position");
+    }
+}
+
+/**
+ * Handle "go" and its search limits
+ * @param command Rest of the command line
+ */
+void Uci::OnGo(std::istringstream &command)
+{
+    SearchLimits limits;
+    std::string token;
+    while (command >> token)
+    {
+        if (token == "wtime") command >> limits.mTime[0];
+        else if (token == "btime") command >> limits.mTime[1];
+        else if (token == "winc") command >> limits.mIncrement[0];
+        else if (token == "binc") command >> limits.mIncrement[1];
+        else if (token == "movestogo") command >> limits.mMovesToGo;
+        else if (token == "depth") command >> limits.mDepth;
+        else if (token == "nodes") command >> limits.mNodes;
+        else if (token == "movetime") command >> limits.mMoveTime;
+        else if (token == "infinite") limits.mInfinite = true;
+        else if (token == "ponder") limits.mPonder = true;
+    }
+    mEngine.Go(limits);
+}
+
+/**
+ * Handle "setoption name <id> [value <x>]"
+ * @param command Rest of the command line
+ */
+void Uci::OnSetOption(std::istringstream &command)
+{
+    std::string token, name, value;
+    command >> token;
+    while (command >> token && token != "value")
+    {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    while (command >> token)
+    {
+        value += (value.empty() ? "" : " ") + token;
+    }
+
+    std::istringstream valueStream(value);
+    if (name == "Hash")
+    {
+        size_t megabytes = 0;
+        if (valueStream >> megabytes && megabytes > 0)
+        {
+            mEngine.SetHashSize(megabytes);
+        }
+    }
+    else if (name == "Clear Hash")
+    {
+        mEngine.ClearHash();
+    }
+    else if (name == "MultiPV")
+    {
+        int lines = 0;
+        if (valueStream >> lines && lines > 0)
+        {
+            mEngine.SetMultiPV(std::min(lines, MAX_MOVES));
+        }
+    }
+    else if (name == "EvalFile")
+    {
+        std::string path = value == "<empty>" ? "" : value;
+        if (!mEngine.LoadNetwork(path))
+        {
+            Send("info string could not load network " + path);
+        }
+        else if (!path.empty())
+        {
+            Send("info string loaded network " + path + " using " + mEngine.GetNetwork().KernelName());
+        }
+    }
+    else if (name == "Book")
+    {
+        std::string path = value == "<empty>" ? "" : value;
+        if (!mEngine.OpenBook(path))
+        {
+            Send("info string could not open book " + path);
+        }
+        else if (!path.empty())
+        {
+            Send("info string opened book " + path + " with " + std::to_string(mEngine.GetBook().Size())
+                 + " entries");
+        }
+    }
+    else if (name == "SyzygyPath")
+    {
+        std::string paths = value == "<empty>" ? "" : value;
+        int found = mEngine.SetSyzygyPath(paths);
+        if (!paths.empty())
+        {
+            Send("info string found " + std::to_string(found) + " tablebases with up to "
+                 + std::to_string(mEngine.GetTablebases().MaxPieces()) + " pieces");
+        }
+    }
+    else if (name == "SyzygyProbeDepth")
+    {
+        int depth = 0;
+        if (valueStream >> depth && depth > 0)
+        {
+            mEngine.SetSyzygyProbeDepth(std::min(depth, 100));
+        }
+    }
+    else if (name == "Syzygy50MoveRule")
+    {
+        mEngine.SetSyzygy50MoveRule(value == "true");
+    }
+    else if (name == "EndgameTablePath")
+    {
+        std::string paths = value == "<empty>" ? "" : value;
+        int found = mEngine.SetEndgameTablePath(paths);
+        if (!paths.empty())
+        {
+            Send("info string found " + std::to_string(found) + " endgame tables with up to "
+                 + std::to_string(mEngine.GetEndgameTables().MaxPieces()) + " pieces");
+        }
+    }
+    else if (name == "Ponder")
+    {
+        // Pondering is driven entirely by "go ponder", nothing to store
+    }
+    else if (mEngine.SetParameter(name, std::atoi(value.c_str())))
+    {
+        // A search or evaluation constant, set while no search is running
+    }
+    else
+    {
+        Send("info string unknown option " + name);
+    }
+}
+
+/**
+ * Handle "bench [depth]", search a fixed set of positions and
+ * report the speed and how the network accumulators were kept
+ * @param command Rest of the command line
+ */
+void Uci::OnBench(std::istringstream &command)
+{
+    SearchLimits limits;
+    limits.mDepth = 10;
+    command >> limits.mDepth;
+
+    const AccumulatorStack &accumulators = mEngine.GetSearch().GetEvaluation().GetAccumulators();
+    uint64_t updates = accumulators.Updates();
+    uint64_t refreshes = accumulators.Refreshes();
+    uint64_t nodes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    mEngine.NewGame();
+    for (auto fen : BenchPositions)
+    {
+        // Searched directly so that a book does not skip positions
+        mEngine.SetPosition(fen, {});
+        mEngine.GetSearch().Start(mEngine.GetPosition(), limits);
+        mEngine.Wait();
+        nodes += mEngine.GetSearch().Nodes();
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    int64_t time = std::max<int64_t>(1, elapsed.count());
+    Send("info string bench nodes " + std::to_string(nodes) + " time " + std::to_string(time)
+         + " nps " + std::to_string(nodes * 1000 / time));
+
+    updates = accumulators.Updates() - updates;
+    refreshes = accumulators.Refreshes() - refreshes;
+    if (updates + refreshes > 0)
+    {
+        std::ostringstream line;
+        line << "info string nnue updates " << updates << " refreshes " << refreshes << " incremental "
+             << std::fixed << std::setprecision(1) << 100.0 * updates / (updates + refreshes) << "%";
+        Send(line.str());
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * @file Uci.h
+ * @author John Korreck
+ *
+ * Universal Chess Interface front end for the engine.
+ */
+
+#ifndef UCI_H
+#define UCI_H
+
+#include <iosfwd>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+class Engine;
+struct SearchInfo;
+
+/**
+ * Reads UCI commands and drives an Engine.
+ */
+class Uci {
+private:
+    /// The engine being driven
+    Engine &mEngine;
+
+    /// Where responses are written
+    std::ostream *mOutput = nullptr;
+
+    /// The search thread and the command loop both write output
+    std::mutex mOutputMutex;
+
+    void Send(const std::string &line);
+    void SendInfo(const SearchInfo &info);
+    void OnPosition(std::istringstream &command);
+    void OnGo(std::istringstream &command);
+    void OnSetOption(std::istringstream &command);
+    void OnBench(std::istringstream &command);
+
+public:
+    Uci(Engine &engine);
+
+    /// Copy constructor (disabled)
+    Uci(const Uci &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const Uci &) = delete;
+
+    void Loop(std::istream &input, std::ostream &output);
+
+    static std::string FormatScore(int score);
+};
+
+#endif //UCI_H
@@ -0,0 +1,421 @@
+/**
+ * @file UciProcess.cpp
+ * @author John Korreck
+ */
+
+#include "pch.h"
+#include "UciProcess.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <mutex>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/// Time an engine gets to quit before it is killed, in milliseconds
+const int64_t QuitTimeout = 1000;
+
+#ifdef _WIN32
+/// Held while an engine is started, so no other thread's CreateProcess inherits this one's pipe ends
+static std::mutex StartMutex;
+#endif
+
+/**
+ * Milliseconds since some fixed point
+ * @return The time
+ */
+static int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Destructor, stops the engine
+ */
+UciProcess::~UciProcess()
+{
+    Close();
+}
+
+/**
+ * Start an engine, stopping any engine started before
+ * @param command Program to run followed by its arguments
+ * @return False if the program could not be started
+ */
+bool UciProcess::Start(const std::vector<std::string> &command)
+{
+    Close();
+    if (command.empty())
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    std::lock_guard<std::mutex> lock(StartMutex);
+    SECURITY_ATTRIBUTES attributes = {sizeof(attributes), nullptr, TRUE};
+    HANDLE childOutput = nullptr;
+    HANDLE childInput = nullptr;
+    HANDLE read = nullptr;
+    HANDLE write = nullptr;
+    if (!CreatePipe(&read, &childOutput, &attributes, 0))
+    {
+        return false;
+    }
+    if (!CreatePipe(&childInput, &write, &attributes, 0))
+    {
+        CloseHandle(read);
+        CloseHandle(childOutput);
+        return false;
+    }
+    SetHandleInformation(read, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(write, HANDLE_FLAG_INHERIT, 0);
+
+    std::string commandLine;
+    for (auto const &arg : command)
+    {
+        commandLine += (commandLine.empty() ? "\"" : " \"") + arg + "\"";
+    }
+    STARTUPINFOA startup = {};
+    startup.cb = sizeof(startup);
+    startup.dwFlags = STARTF_USESTDHANDLES;
+    startup.hStdInput = childInput;
+    startup.hStdOutput = childOutput;
+    startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    PROCESS_INFORMATION process = {};
+    BOOL started = CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, TRUE, CREATE_NO_WINDOW, nullptr,
+                                  nullptr, &startup, &process);
+    CloseHandle(childInput);
+    CloseHandle(childOutput);
+    if (!started)
+    {
+        CloseHandle(read);
+        CloseHandle(write);
+        return false;
+    }
+    CloseHandle(process.hThread);
+    mProcess = process.hProcess;
+    mRead = read;
+    mWrite = write;
+#else
+    // Both pipes are close-on-exec from the start, so an engine started by another thread never inherits them
+    int toChild[2];
+    int fromChild[2];
+    if (pipe2(toChild, O_CLOEXEC) != 0)
+    {
+        return false;
+    }
+    if (pipe2(fromChild, O_CLOEXEC) != 0)
+    {
+        close(toChild[0]);
+        close(toChild[1]);
+        return false;
+    }
+
+    std::vector<char *> argv;
+    for (auto const &arg : command)
+    {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // dup2 clears close-on-exec on its copy, but does nothing when the descriptor is already in place
+        for (auto [from, to] : {std::pair(toChild[0], STDIN_FILENO), std::pair(fromChild[1], STDOUT_FILENO)})
+        {
+            if (from == to)
+            {
+                fcntl(from, F_SETFD, 0);
+            }
+            else
+            {
+                dup2(from, to);
+            }
+        }
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    close(toChild[0]);
+    close(fromChild[1]);
+    if (pid < 0)
+    {
+        close(toChild[1]);
+        close(fromChild[0]);
+        return false;
+    }
+    mPid = pid;
+    mRead = fromChild[0];
+    mWrite = toChild[1];
+#endif
+    return true;
+}
+
+/**
+ * Ask the engine to quit, and kill it if it does not
+ */
+void UciProcess::Close()
+{
+    if (IsRunning())
+    {
+        Send("quit");
+    }
+    mBuffer.clear();
+
+#ifdef _WIN32
+    if (mProcess != nullptr)
+    {
+        if (WaitForSingleObject(mProcess, DWORD(QuitTimeout)) != WAIT_OBJECT_0)
+        {
+            TerminateProcess(mProcess, 1);
+            WaitForSingleObject(mProcess, INFINITE);
+        }
+        CloseHandle(mProcess);
+        mProcess = nullptr;
+    }
+    for (HANDLE *handle : {(HANDLE *)&mRead, (HANDLE *)&mWrite})
+    {
+        if (*handle != nullptr)
+        {
+            CloseHandle(*handle);
+            *handle = nullptr;
+        }
+    }
+#else
+    if (mWrite >= 0)
+    {
+        close(mWrite);
+        mWrite = -1;
+    }
+    if (mPid > 0)
+    {
+        int64_t deadline = Now() + QuitTimeout;
+        int status;
+        while (waitpid(mPid, &status, WNOHANG) == 0)
+        {
+            if (Now() >= deadline)
+            {
+                kill(mPid, SIGKILL);
+                waitpid(mPid, &status, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        mPid = -1;
+    }
+    if (mRead >= 0)
+    {
+        close(mRead);
+        mRead = -1;
+    }
+#endif
+}
+
+/**
+ * Is the engine still running?
+ * @return False if it was never started or has exited
+ */
+bool UciProcess::IsRunning() const
+{
+#ifdef _WIN32
+    return mProcess != nullptr && WaitForSingleObject(mProcess, 0) == WAIT_TIMEOUT;
+#else
+    return mPid > 0 && kill(mPid, 0) == 0 && waitpid(mPid, nullptr, WNOHANG) == 0;
+#endif
+}
+
+/**
+ * Write a line to the engine
+ * @param line The line, without the newline
+ * @return False if the engine is not there to read it
+ */
+bool UciProcess::Send(const std::string &line)
+{
+#ifndef _WIN32
+    // A write to an engine that died raises SIGPIPE. Block it in this thread only and swallow the one the write
+    // raised, so the write fails with EPIPE and the program's own handling of the signal is left alone.
+    sigset_t pipeSignal;
+    sigset_t previous;
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSignal, &previous);
+    sigset_t pending;
+    sigpending(&pending);
+    bool wasPending = sigismember(&pending, SIGPIPE) == 1;
+#endif
+
+    std::string text = line + "\n";
+    size_t written = 0;
+    bool sent = true;
+    while (written < text.size())
+    {
+#ifdef _WIN32
+        DWORD count = 0;
+        if (mWrite == nullptr || !WriteFile(mWrite, text.data() + written, DWORD(text.size() - written), &count,
+                                            nullptr))
+        {
+            sent = false;
+            break;
+        }
+#else
+        ssize_t count = mWrite < 0 ? -1 : write(mWrite, text.data() + written, text.size() - written);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count < 0)
+        {
+            if (errno == EPIPE && !wasPending)
+            {
+                timespec zero = {0, 0};
+                sigtimedwait(&pipeSignal, nullptr, &zero);
+            }
+            sent = false;
+            break;
+        }
+#endif
+        written += size_t(count);
+    }
+
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+#endif
+    return sent;
+}
+
+/**
+ * Read a line from the engine
+ * @param line Receives the line, without the newline
+ * @param timeout Milliseconds to wait for it
+ * @return False if no line came in time or the engine exited
+ */
+bool UciProcess::ReadLine(std::string &line, int64_t timeout)
+{
+    int64_t deadline = Now() + std::max<int64_t>(0, timeout);
+    while (true)
+    {
+        size_t end = mBuffer.find('\n');
+        if (end != std::string::npos)
+        {
+            line = mBuffer.substr(0, end > 0 && mBuffer[end - 1] == '\r' ? end - 1 : end);
+            mBuffer.erase(0, end + 1);
+            return true;
+        }
+
+        int64_t remaining = deadline - Now();
+        if (remaining < 0)
+        {
+            return false;
+        }
+
+        char data[4096];
+#ifdef _WIN32
+        // Anonymous pipes cannot wait with a timeout, so poll
+        DWORD available = 0;
+        if (mRead == nullptr || !PeekNamedPipe(mRead, nullptr, 0, nullptr, &available, nullptr))
+        {
+            return false;
+        }
+        if (available == 0)
+        {
+            Sleep(1);
+            continue;
+        }
+        DWORD count = 0;
+        if (!ReadFile(mRead, data, std::min<DWORD>(available, sizeof(data)), &count, nullptr) || count == 0)
+        {
+            return false;
+        }
+#else
+        if (mRead < 0)
+        {
+            return false;
+        }
+        pollfd descriptor = {mRead, POLLIN, 0};
+        int ready = poll(&descriptor, 1, int(std::min<int64_t>(remaining, 1000000)));
+        if (ready == 0)
+        {
+            continue;
+        }
+        ssize_t count = ready < 0 ? -1 : read(mRead, data, sizeof(data));
+        if (count <= 0)
+        {
+            return false;
+        }
+#endif
+        mBuffer.append(data, size_t(count));
+    }
+}
+
+/**
+ * Read lines until one starts with a token
+ * @param token First word of the line waited for, such as "readyok"
+ * @param timeout Milliseconds to wait for it
+ * @param line Receives the line, or nullptr
+ * @return False if it did not come in time or the engine exited
+ */
+bool UciProcess::WaitFor(const std::string &token, int64_t timeout, std::string *line)
+{
+    int64_t deadline = Now() + timeout;
+    std::string text;
+    while (ReadLine(text, deadline - Now()))
+    {
+        if (text.compare(0, token.size(), token) == 0 && (text.size() == token.size() || text[token.size()] == ' '))
+        {
+            if (line != nullptr)
+            {
+                *line = text;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Send "uci" and wait for the engine to identify itself
+ * @param name Receives the engine's "id name", or nullptr
+ * @param timeout Milliseconds to wait for "uciok"
+ * @return False if the engine did not answer
+ */
+bool UciProcess::Handshake(std::string *name, int64_t timeout)
+{
+    if (!Send("uci"))
+    {
+        return false;
+    }
+    int64_t deadline = Now() + timeout;
+    std::string line;
+    while (ReadLine(line, deadline - Now()))
+    {
+        if (line.compare(0, 8, "id name ") == 0 && name != nullptr)
+        {
+            *name = line.substr(8);
+        }
+        else if (line == "uciok")
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file UciProcess.h
+ * @author John Korreck
+ *
+ * An engine run as a child process and spoken to over UCI.
+ */
+
+#ifndef UCIPROCESS_H
+#define UCIPROCESS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A chess engine running as a child process, with its standard
+ * input and output connected to pipes.
+ *
+ * Lines are written to the engine with Send() and read back with
+ * ReadLine(), which gives up after a timeout so that a hung engine
+ * cannot stall the caller. Nothing here knows the protocol beyond
+ * Handshake() and WaitFor(), which wait for the replies UCI defines.
+ */
+class UciProcess {
+private:
+    /// Bytes read from the engine that do not make a full line yet
+    std::string mBuffer;
+
+#ifdef _WIN32
+    /// Process handle, nullptr if not running
+    void *mProcess = nullptr;
+
+    /// Read end of the engine's standard output
+    void *mRead = nullptr;
+
+    /// Write end of the engine's standard input
+    void *mWrite = nullptr;
+#else
+    /// Process id, -1 if not running
+    int mPid = -1;
+
+    /// Read end of the engine's standard output
+    int mRead = -1;
+
+    /// Write end of the engine's standard input
+    int mWrite = -1;
+#endif
+
+public:
+    UciProcess() = default;
+    ~UciProcess();
+
+    /// Copy constructor (disabled)
+    UciProcess(const UciProcess &) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const UciProcess &) = delete;
+
+    bool Start(const std::vector<std::string> &command);
+    void Close();
+    bool IsRunning() const;
+
+    bool Send(const std::string &line);
+    bool ReadLine(std::string &line, int64_t timeout);
+    bool WaitFor(const std::string &token, int64_t timeout, std::string *line = nullptr);
+    bool Handshake(std::string *name = nullptr, int64_t timeout = 10000);
+};
+
+#endif //UCIPROCESS_H
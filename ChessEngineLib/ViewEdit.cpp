@@ -14,11 +14,62 @@
 #include "Item.h"
 #include "Drawable.h"
 #include "Board.h"
+#include "BoardFactory.h"
 #include "Piece.h"
+#include "Engine.h"
 
 /// A scaling fItem, converts mouse motion to rotation in radians
 const double RotationScaling = 0.02;
 
+/// Milliseconds the engine thinks for each move
+const int64_t EngineMoveTime = 2000;
+
+/// Size of each square
+const int squareSize = 75;
+
+/// Number of candidate moves shown when analyzing
+const int AnalysisLines = 3;
+
+/// Left edge of the analysis text, to the right of the board
+const int AnalysisLeft = 880;
+
+/// Top of the analysis text, level with the board
+const int AnalysisTop = 100;
+
+/// Vertical distance between analysis lines
+const int AnalysisLineHeight = 28;
+
+/// Number of moves of each line that are listed
+const int AnalysisPvMoves = 6;
+
+/**
+ * Format a score for display
+ * @param score Score from the side to move's point of view
+ * @return Text like "+0.35" or "#3"
+ */
+static std::wstring ScoreText(int score)
+{
+    if (std::abs(score) >= VALUE_MATE_IN_MAX_PLY)
+    {
+        int moves = score > 0 ? (VALUE_MATE - score + 1) / 2 : -(VALUE_MATE + score) / 2;
+        return L"#" + std::to_wstring(moves);
+    }
+
+    wchar_t text[16];
+    swprintf(text, 16, L"%+.2f", score / 100.0);
+    return text;
+}
+
+/**
+ * Get the index of a board square from its name
+ * @param name Square name such as L"e4"
+ * @return Square index
+ */
+static int SquareIndex(std::wstring const &name)
+{
+    return MakeSquare(name[0] - L'a', name[1] - L'1');
+}
+
 /**
  * Constructor
  * @param parent Pointer to wxFrame object, the main frame for the application
@@ -33,6 +84,18 @@ ViewEdit::ViewEdit(wxFrame* parent, std::wstring resourcesDir) :wxScrolledCanvas
     Bind(wxEVT_LEFT_UP, &ViewEdit::OnLeftUp, this);
     Bind(wxEVT_LEFT_DCLICK, &ViewEdit::OnLeftDoubleClick, this);
     Bind(wxEVT_MOTION, &ViewEdit::OnMouseMove, this);
+
+    mEngine = std::make_unique<Engine>();
+}
+
+/**
+ * Destructor, stops the engine before the view goes away
+ */
+ViewEdit::~ViewEdit()
+{
+    mSearchId++;
+    mEngine->Stop();
+    mEngine->Wait();
 }
 
 /**
@@ -66,6 +129,7 @@ void ViewEdit::OnPaint(wxPaintEvent& event)
     auto graphics = std::shared_ptr<wxGraphicsContext>(wxGraphicsContext::Create( dc ));
 
     GetPicture()->Draw(graphics);
+    DrawAnalysis(graphics);
 }
 
 /**
@@ -117,7 +181,7 @@ void ViewEdit::OnLeftDown(wxMouseEvent &event)
     if (hitBoard != nullptr)
     {
         mBoard = hitBoard;
-        mBoard->GeneratePossibleMoves(false);
+        mBoard->GeneratePossibleMoves();
         mSelectedPiece = hitPiece;
         mSelectedDrawable = hitPiece;
         mBoard->MoveToBack(mSelectedPiece);
@@ -133,250 +197,37 @@ void ViewEdit::OnLeftUp(wxMouseEvent &event)
     if (mSelectedPiece && mSelectedPiece->IsMovable())
     {
         bool whiteTurn = mBoard->GetWhiteTurn();
-        /// Size of each square
-        const int squareSize = 75;
         std::shared_ptr<Square> newSquare = mBoard->GetClosestSquare(wxPoint(mSelectedPiece->GetPosition().x + 35, mSelectedPiece->GetPosition().y + 30));
-        std::wstring move = mSelectedPiece->GetSquare()->GetName() + newSquare->GetName();
-        std::vector<std::wstring> possibleMoves = mBoard->GetPossibleMoves();
-        if (possibleMoves.empty())
+        Move move = mBoard->FindMove(SquareIndex(mSelectedPiece->GetSquare()->GetName()), SquareIndex(newSquare->GetName()));
+        if (mEngineEnabled && !whiteTurn)
         {
+            // The engine is thinking, put the piece back
             wxPoint oldPos = mSelectedPiece->GetSquare()->GetPosition();
             mSelectedPiece->SetPosition(wxPoint(oldPos.x-(squareSize/2), oldPos.y-(squareSize/2)));
-            mBoard->displayWinner();
-            std::cout << "WIN" << std::endl;
             GetPicture()->UpdateObservers();
         }
-        else if (move == L"e1h1" || move == L"e1g1")
-        {
-            if (std::find(possibleMoves.begin(), possibleMoves.end(), L"OO") != possibleMoves.end())
-            {
-                std::shared_ptr<Square> newRookSquare;
-                std::shared_ptr<Square> newKingSquare;
-                std::shared_ptr<Square> oldRookSquare;
-                std::shared_ptr<Square> oldKingSquare;
-                Piece* rook = nullptr;
-
-                for (auto square : mBoard->GetSquares())
-                {
-
-                    if (square->GetName() == L"f1")
-                    {
-                        newRookSquare = square;
-                    }
-                    else if (square->GetName() == L"g1")
-                    {
-                        newKingSquare = square;
-                    }
-                    else if (square->GetName() == L"h1")
-                    {
-                        oldRookSquare = square;
-                        rook = square->GetPiece();
-                    }
-                    else if (square->GetName() == L"e1")
-                    {
-                        oldKingSquare = square;
-                    }
-                }
-                newKingSquare->SetPiece(&*mSelectedPiece);
-                if (rook)
-                {
-                    newRookSquare->SetPiece(rook);
-                    rook->SetPosition(wxPoint(newRookSquare->GetCenter().x-(squareSize/2), newRookSquare->GetCenter().y-(squareSize/2)));
-                }
-                mSelectedPiece->SetPosition(wxPoint(newKingSquare->GetCenter().x-(squareSize/2), newKingSquare->GetCenter().y-(squareSize/2)));
-                oldKingSquare->SetPiece(nullptr);
-                oldRookSquare->SetPiece(nullptr);
-                mBoard->UpdateBoard(L"OO");
-                std::cout << "Update Board Called" << std::endl;
-                mBoard->SetWhiteTurn(!whiteTurn);
-                mBoard->GeneratePossibleMoves(false);
-                GetPicture()->UpdateObservers();
-            }
-        }
-        else if (move == L"e8h8" || move == L"e8g8")
-        {
-            if (std::find(possibleMoves.begin(), possibleMoves.end(), L"OO") != possibleMoves.end())
-            {
-                std::shared_ptr<Square> newRookSquare;
-                std::shared_ptr<Square> newKingSquare;
-                std::shared_ptr<Square> oldRookSquare;
-                std::shared_ptr<Square> oldKingSquare;
-                Piece* rook = nullptr;
-
-                for (auto square : mBoard->GetSquares())
-                {
-
-                    if (square->GetName() == L"f8")
-                    {
-                        newRookSquare = square;
-                    }
-                    else if (square->GetName() == L"g8")
-                    {
-                        newKingSquare = square;
-                    }
-                    else if (square->GetName() == L"h8")
-                    {
-                        oldRookSquare = square;
-                        rook = square->GetPiece();
-                    }
-                    else if (square->GetName() == L"e8")
-                    {
-                        oldKingSquare = square;
-                    }
-                }
-                newKingSquare->SetPiece(&*mSelectedPiece);
-                if (rook)
-                {
-                    newRookSquare->SetPiece(rook);
-                    rook->SetPosition(wxPoint(newRookSquare->GetCenter().x-(squareSize/2), newRookSquare->GetCenter().y-(squareSize/2)));
-                }
-                mSelectedPiece->SetPosition(wxPoint(newKingSquare->GetCenter().x-(squareSize/2), newKingSquare->GetCenter().y-(squareSize/2)));
-                oldKingSquare->SetPiece(nullptr);
-                oldRookSquare->SetPiece(nullptr);
-                mBoard->UpdateBoard(L"OO");
-                std::cout << "Update Board Called" << std::endl;
-                mBoard->SetWhiteTurn(!whiteTurn);
-                mBoard->GeneratePossibleMoves(false);
-                GetPicture()->UpdateObservers();
-            }
-        }
-        else if (move == L"e8a8" || move == L"e8b8")
-        {
-            if (std::find(possibleMoves.begin(), possibleMoves.end(), L"OOO") != possibleMoves.end())
-            {
-                std::shared_ptr<Square> newRookSquare;
-                std::shared_ptr<Square> newKingSquare;
-                std::shared_ptr<Square> oldRookSquare;
-                std::shared_ptr<Square> oldKingSquare;
-                Piece* rook = nullptr;
-
-                for (auto square : mBoard->GetSquares())
-                {
-
-                    if (square->GetName() == L"d8")
-                    {
-                        newRookSquare = square;
-                    }
-                    else if (square->GetName() == L"c8")
-                    {
-                        newKingSquare = square;
-                    }
-                    else if (square->GetName() == L"a8")
-                    {
-                        oldRookSquare = square;
-                        rook = square->GetPiece();
-                    }
-                    else if (square->GetName() == L"e8")
-                    {
-                        oldKingSquare = square;
-                    }
-                }
-                newKingSquare->SetPiece(&*mSelectedPiece);
-                if (rook)
-                {
-                    newRookSquare->SetPiece(rook);
-                    rook->SetPosition(wxPoint(newRookSquare->GetCenter().x-(squareSize/2), newRookSquare->GetCenter().y-(squareSize/2)));
-                }
-                mSelectedPiece->SetPosition(wxPoint(newKingSquare->GetCenter().x-(squareSize/2), newKingSquare->GetCenter().y-(squareSize/2)));
-                oldKingSquare->SetPiece(nullptr);
-                oldRookSquare->SetPiece(nullptr);
-                mBoard->UpdateBoard(L"OOO");
-                std::cout << "Update Board Called" << std::endl;
-                mBoard->SetWhiteTurn(!whiteTurn);
-                mBoard->GeneratePossibleMoves(false);
-                GetPicture()->UpdateObservers();
-            }
-        }
-        else if (move == L"e1a1" || move == L"e1b1")
+        else if (mBoard->GetGameStatus() != GAME_ONGOING)
         {
-            if (std::find(possibleMoves.begin(), possibleMoves.end(), L"OOO") != possibleMoves.end())
-            {
-                std::shared_ptr<Square> newRookSquare;
-                std::shared_ptr<Square> newKingSquare;
-                std::shared_ptr<Square> oldRookSquare;
-                std::shared_ptr<Square> oldKingSquare;
-                Piece* rook = nullptr;
-
-                for (auto square : mBoard->GetSquares())
-                {
-
-                    if (square->GetName() == L"d1")
-                    {
-                        newRookSquare = square;
-                    }
-                    else if (square->GetName() == L"c1")
-                    {
-                        newKingSquare = square;
-                    }
-                    else if (square->GetName() == L"a1")
-                    {
-                        oldRookSquare = square;
-                        rook = square->GetPiece();
-                    }
-                    else if (square->GetName() == L"e1")
-                    {
-                        oldKingSquare = square;
-                    }
-                }
-                newKingSquare->SetPiece(&*mSelectedPiece);
-                if (rook)
-                {
-                    newRookSquare->SetPiece(rook);
-                    rook->SetPosition(wxPoint(newRookSquare->GetCenter().x-(squareSize/2), newRookSquare->GetCenter().y-(squareSize/2)));
-                }
-                mSelectedPiece->SetPosition(wxPoint(newKingSquare->GetCenter().x-(squareSize/2), newKingSquare->GetCenter().y-(squareSize/2)));
-                oldKingSquare->SetPiece(nullptr);
-                oldRookSquare->SetPiece(nullptr);
-                mBoard->UpdateBoard(L"OOO");
-                std::cout << "Update Board Called" << std::endl;
-                mBoard->SetWhiteTurn(!whiteTurn);
-                mBoard->GeneratePossibleMoves(false);
-                GetPicture()->UpdateObservers();
-            }
+            wxPoint oldPos = mSelectedPiece->GetSquare()->GetPosition();
+            mSelectedPiece->SetPosition(wxPoint(oldPos.x-(squareSize/2), oldPos.y-(squareSize/2)));
+            mBoard->displayWinner();
+            GetPicture()->UpdateObservers();
         }
-        else if (std::find(possibleMoves.begin(), possibleMoves.end(), move) != possibleMoves.end())
+        else if (move.IsValid())
         {
-            if (newSquare->GetPiece())
-            {
-                newSquare->GetPiece()->SetPosition(wxPoint(0,0));
-            }
-            if (mSelectedPiece->GetSquare())
-            {
-                mSelectedPiece->GetSquare()->SetPiece(nullptr);
-            }
-            newSquare->SetPiece(&*mSelectedPiece);
-            mSelectedPiece->SetPosition(wxPoint(newSquare->GetCenter().x-(squareSize/2), newSquare->GetCenter().y-(squareSize/2)));
-            int pieceNum = std::stoi(mSelectedPiece->GetName());
-            if (pieceNum == 17)
-            {
-                mBoard->SetBlackKingSquare({move[2], move[3]});
-            }
-            if (pieceNum == 9)
-            {
-                mBoard->SetWhiteKingSquare({move[2], move[3]});
-            }
+            MovePieceDrawables(move);
             mBoard->UpdateBoard(move);
-            std::cout << "Update Board Called" << std::endl;
             mBoard->SetWhiteTurn(!whiteTurn);
-            mBoard->GeneratePossibleMoves(false);
+            mBoard->GeneratePossibleMoves();
             GetPicture()->UpdateObservers();
+            OnUserMove(move);
         }
         else
         {
-            std::cout << "Move not viable" << std::endl;
             wxPoint oldPos = mSelectedPiece->GetSquare()->GetPosition();
             mSelectedPiece->SetPosition(wxPoint(oldPos.x-(squareSize/2), oldPos.y-(squareSize/2)));
             GetPicture()->UpdateObservers();
         }
-        for (auto file : mBoard->GetBoard())
-        {
-            for (auto rank : file)
-            {
-                std::cout << rank << " | ";
-            }
-            std::cout << std::endl;
-        }
-        std::cout << std::endl;
     }
     OnMouseMove(event);
 }
@@ -436,4 +287,410 @@ void ViewEdit::OnMouseMove(wxMouseEvent &event)
  */
 void ViewEdit::OnLeftDoubleClick(wxMouseEvent &event)
 {
-}
\ No newline at end of file
+}
+/**
+ * Turn the engine opponent on or off. The engine plays black.
+ * @param enabled True to let the engine play
+ */
+void ViewEdit::SetEngineEnabled(bool enabled)
+{
+    mEngineEnabled = enabled;
+    mPonderMove = Move::None();
+    if (enabled && !GetPicture()->GetBoard()->GetWhiteTurn())
+    {
+        StartEngineSearch(Move::None());
+    }
+    else if (mAnalysisEnabled)
+    {
+        StartAnalysis();
+    }
+    else if (!enabled)
+    {
+        mSearchId++;
+        mEngine->Stop();
+    }
+}
+
+/**
+ * Turn thinking on the user's time on or off
+ * @param enabled True to let the engine ponder
+ */
+void ViewEdit::SetPonderEnabled(bool enabled)
+{
+    mPonderEnabled = enabled;
+    if (!enabled && mPonderMove.IsValid())
+    {
+        mSearchId++;
+        mPonderMove = Move::None();
+        mEngine->Stop();
+    }
+}
+
+/**
+ * The user has made a move on the board. Either convert the
+ * ponder search into a real one or start searching from scratch.
+ * @param move The user's move
+ */
+void ViewEdit::OnUserMove(Move move)
+{
+    if (ShowGameOver())
+    {
+        return;
+    }
+    if (!mEngineEnabled)
+    {
+        if (mAnalysisEnabled)
+        {
+            StartAnalysis();
+        }
+        return;
+    }
+
+    if (mPonderMove.IsValid())
+    {
+        bool ponderHit = move == mPonderMove;
+        mPonderMove = Move::None();
+        if (ponderHit)
+        {
+            // The engine has already been searching this position
+            mEngine->PonderHit();
+            return;
+        }
+    }
+    StartEngineSearch(Move::None());
+}
+
+/**
+ * Show the game over screen if the side to move has been mated,
+ * stalemated or neither side can mate any more
+ * @return True if the game is over
+ */
+bool ViewEdit::ShowGameOver()
+{
+    auto board = GetPicture()->GetBoard();
+    if (board->GetGameStatus() == GAME_ONGOING)
+    {
+        return false;
+    }
+    board->displayWinner();
+    GetPicture()->UpdateObservers();
+    return true;
+}
+
+/**
+ * Start the engine on the current board position
+ * @param ponderMove Expected user move to ponder on, Move::None() to
+ * search for the engine's own move
+ */
+void ViewEdit::StartEngineSearch(Move ponderMove)
+{
+    mEngine->Stop();
+    mEngine->Wait();
+
+    int searchId = ++mSearchId;
+    mAnalyzing = false;
+    mAnalysis.clear();
+    mEngine->SetMultiPV(1);
+    mEngine->GetSearch().SetInfoCallback(nullptr);
+    mEngine->GetSearch().SetBestMoveCallback([this, searchId](Move best, Move ponder) {
+        // Called on the search thread, hand the move to the GUI thread
+        CallAfter([this, searchId, best, ponder]() { OnEngineMove(searchId, best, ponder); });
+    });
+
+    std::vector<std::string> moves;
+    if (ponderMove.IsValid())
+    {
+        moves.push_back(ponderMove.ToUci());
+    }
+    if (!mEngine->SetPosition(GetPicture()->GetBoard()->GetFen(), moves))
+    {
+        return;
+    }
+
+    SearchLimits limits;
+    limits.mMoveTime = EngineMoveTime;
+    limits.mPonder = ponderMove.IsValid();
+
+    mPonderMove = ponderMove;
+    mEngine->Go(limits);
+}
+
+/**
+ * The engine has finished searching
+ * @param searchId Search the result belongs to
+ * @param bestMove Move to play
+ * @param ponderMove Reply the engine expects from the user
+ */
+void ViewEdit::OnEngineMove(int searchId, Move bestMove, Move ponderMove)
+{
+    if (searchId != mSearchId || !mEngineEnabled)
+    {
+        return;
+    }
+
+    auto board = GetPicture()->GetBoard();
+    if (!bestMove.IsValid())
+    {
+        board->displayWinner();
+        GetPicture()->UpdateObservers();
+        return;
+    }
+
+    MovePieceDrawables(bestMove);
+    board->UpdateBoard(bestMove);
+    board->SetWhiteTurn(!board->GetWhiteTurn());
+    board->GeneratePossibleMoves();
+    GetPicture()->UpdateObservers();
+    if (ShowGameOver())
+    {
+        return;
+    }
+
+    // Showing the user their best moves takes priority over pondering
+    if (mAnalysisEnabled)
+    {
+        StartAnalysis();
+    }
+    else if (mPonderEnabled && ponderMove.IsValid())
+    {
+        StartEngineSearch(ponderMove);
+    }
+}
+
+/**
+ * Move the piece drawables of a move, capturing anything on the
+ * destination the same way a dropped piece does. A castling
+ * move also moves the rook and an en passant capture removes
+ * the pawn beside the destination.
+ * @param move The move
+ */
+void ViewEdit::MovePieceDrawables(Move move)
+{
+    std::shared_ptr<Square> squares[64];
+    for (auto square : GetPicture()->GetBoard()->GetSquares())
+    {
+        squares[SquareIndex(square->GetName())] = square;
+    }
+
+    int rank = RankOf(move.From());
+    if (move.GetType() == Move::EN_PASSANT)
+    {
+        // The captured pawn is beside the destination, not on it
+        auto capturedSquare = squares[MakeSquare(FileOf(move.To()), rank)];
+        if (capturedSquare->GetPiece())
+        {
+            capturedSquare->GetPiece()->SetPosition(wxPoint(0,0));
+            capturedSquare->SetPiece(nullptr);
+        }
+    }
+
+    bool kingSide = move.To() > move.From();
+    int moves[2][2] = {{move.From(), move.To()},
+                       {MakeSquare(kingSide ? 7 : 0, rank), MakeSquare(kingSide ? 5 : 3, rank)}};
+    for (int i = 0; i < (move.GetType() == Move::CASTLING ? 2 : 1); i++)
+    {
+        auto fromSquare = squares[moves[i][0]];
+        auto toSquare = squares[moves[i][1]];
+        Piece* piece = fromSquare->GetPiece();
+        if (piece == nullptr)
+        {
+            continue;
+        }
+        if (toSquare->GetPiece())
+        {
+            toSquare->GetPiece()->SetPosition(wxPoint(0,0));
+        }
+        fromSquare->SetPiece(nullptr);
+        toSquare->SetPiece(piece);
+        piece->SetPosition(wxPoint(toSquare->GetCenter().x-(squareSize/2), toSquare->GetCenter().y-(squareSize/2)));
+    }
+}
+
+/**
+ * Show a game on a new board by playing its moves from the
+ * standard starting position
+ * @param moves Moves of the game
+ */
+void ViewEdit::LoadGame(std::vector<Move> const &moves)
+{
+    // Whatever the engine was searching belongs to the old board
+    mSearchId++;
+    mPonderMove = Move::None();
+    mEngine->Stop();
+    mEngine->Wait();
+
+    BoardFactory factory;
+    auto board = factory.Create(mResourcesDir);
+    GetPicture()->SetBoard(board);
+    mBoard = nullptr;
+    mSelectedPiece = nullptr;
+    mSelectedDrawable = nullptr;
+
+    for (Move move : moves)
+    {
+        MovePieceDrawables(move);
+        board->UpdateBoard(move);
+        board->SetWhiteTurn(!board->GetWhiteTurn());
+    }
+    board->GeneratePossibleMoves();
+    GetPicture()->UpdateObservers();
+    if (ShowGameOver())
+    {
+        return;
+    }
+
+    if (mEngineEnabled && !board->GetWhiteTurn())
+    {
+        StartEngineSearch(Move::None());
+    }
+    else if (mAnalysisEnabled)
+    {
+        StartAnalysis();
+    }
+}
+
+/**
+ * Turn the candidate move overlay on or off
+ * @param enabled True to analyze the position whenever it is the user's move
+ */
+void ViewEdit::SetAnalysisEnabled(bool enabled)
+{
+    mAnalysisEnabled = enabled;
+    mAnalysis.clear();
+    if (enabled)
+    {
+        // Never interrupt the engine thinking about its own move
+        if (!mEngineEnabled || GetPicture()->GetBoard()->GetWhiteTurn())
+        {
+            StartAnalysis();
+        }
+    }
+    else if (mAnalyzing)
+    {
+        mSearchId++;
+        mAnalyzing = false;
+        mEngine->Stop();
+    }
+    Refresh();
+}
+
+/**
+ * Search the current board for its best few moves until stopped
+ */
+void ViewEdit::StartAnalysis()
+{
+    mEngine->Stop();
+    mEngine->Wait();
+
+    int searchId = ++mSearchId;
+    mAnalyzing = true;
+    mPonderMove = Move::None();
+    mAnalysis.clear();
+    Refresh();
+
+    mEngine->SetMultiPV(AnalysisLines);
+    mEngine->GetSearch().SetInfoCallback([this, searchId](SearchInfo const &info) {
+        // Called on the search thread, hand the line to the GUI thread
+        CallAfter([this, searchId, info]() { OnAnalysisInfo(searchId, info); });
+    });
+    mEngine->GetSearch().SetBestMoveCallback(nullptr);
+
+    if (!mEngine->SetPosition(GetPicture()->GetBoard()->GetFen(), {}))
+    {
+        return;
+    }
+
+    SearchLimits limits;
+    limits.mInfinite = true;
+    mEngine->Go(limits);
+}
+
+/**
+ * The analysis has finished a line
+ * @param searchId Search the line belongs to
+ * @param info The line
+ */
+void ViewEdit::OnAnalysisInfo(int searchId, SearchInfo const &info)
+{
+    if (searchId != mSearchId || !mAnalyzing)
+    {
+        return;
+    }
+
+    if ((int)mAnalysis.size() < info.mMultiPV)
+    {
+        mAnalysis.resize(info.mMultiPV);
+    }
+    mAnalysis[info.mMultiPV - 1] = info;
+    Refresh();
+}
+
+/**
+ * Draw the candidate moves as arrows on the board and list
+ * their lines beside it
+ * @param graphics Graphics context to draw on
+ */
+void ViewEdit::DrawAnalysis(std::shared_ptr<wxGraphicsContext> graphics)
+{
+    if (!mAnalysisEnabled || mAnalysis.empty())
+    {
+        return;
+    }
+
+    wxPoint centers[64];
+    for (auto square : GetPicture()->GetBoard()->GetSquares())
+    {
+        centers[SquareIndex(square->GetName())] = square->GetCenter();
+    }
+
+    // The lines are listed in SAN, played out from the board
+    Position position;
+    if (!position.SetFen(GetPicture()->GetBoard()->GetFen()))
+    {
+        return;
+    }
+
+    // Arrow colours, best line first
+    const wxColour colours[AnalysisLines] = {
+        wxColour(0, 160, 0, 160), wxColour(0, 90, 200, 130), wxColour(200, 120, 0, 110)};
+
+    wxFont font(wxSize(0, 18), wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
+    graphics->SetFont(font, *wxBLACK);
+
+    // Worst line first so the best arrow ends up on top
+    for (int line = std::min<int>(mAnalysis.size(), AnalysisLines) - 1; line >= 0; line--)
+    {
+        auto const &info = mAnalysis[line];
+        if (info.mPv.empty())
+        {
+            continue;
+        }
+
+        wxPoint from = centers[info.mPv[0].From()];
+        wxPoint to = centers[info.mPv[0].To()];
+        graphics->SetPen(wxPen(colours[line], 12 - line * 3));
+        graphics->StrokeLine(from.x, from.y, to.x, to.y);
+
+        std::wstring text = std::to_wstring(line + 1) + L". " + ScoreText(info.mScore) + L" ";
+        int played = 0;
+        for (; played < (int)info.mPv.size() && played < AnalysisPvMoves; played++)
+        {
+            Move move = info.mPv[played];
+            if (!position.IsPseudoLegal(move) || !position.IsLegal(move))
+            {
+                break;
+            }
+            auto san = position.SanText(move).View();
+            text += L" " + std::wstring(san.begin(), san.end());
+            position.DoMove(move);
+        }
+        for (; played > 0; played--)
+        {
+            position.UndoMove();
+        }
+        graphics->DrawText(text, AnalysisLeft, AnalysisTop + line * AnalysisLineHeight);
+    }
+
+    std::wstring depth = L"Depth " + std::to_wstring(mAnalysis[0].mDepth);
+    graphics->DrawText(depth, AnalysisLeft, AnalysisTop + AnalysisLines * AnalysisLineHeight);
+}
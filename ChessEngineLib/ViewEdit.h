@@ -12,11 +12,14 @@
 #define CANADIANEXPERIENCE_VIEWEDIT_H
 
 #include "PictureObserver.h"
+#include "Move.h"
+#include "Search.h"
 
 class Item;
 class Drawable;
 class Board;
 class Piece;
+class Engine;
 
 /**
  * View class for our aquarium
@@ -28,6 +31,14 @@ private:
     void OnLeftUp(wxMouseEvent& event);
     void OnMouseMove(wxMouseEvent& event);
     void OnPaint(wxPaintEvent& event);
+    bool ShowGameOver();
+    void OnUserMove(Move move);
+    void OnEngineMove(int searchId, Move bestMove, Move ponderMove);
+    void StartEngineSearch(Move ponderMove);
+    void StartAnalysis();
+    void OnAnalysisInfo(int searchId, SearchInfo const &info);
+    void DrawAnalysis(std::shared_ptr<wxGraphicsContext> graphics);
+    void MovePieceDrawables(Move move);
 
     /// The last mouse position
     wxPoint mLastMouse = wxPoint(0, 0);
@@ -47,6 +58,30 @@ private:
     /// The resource directory
     std::wstring mResourcesDir;
 
+    /// The engine that plays black
+    std::unique_ptr<Engine> mEngine;
+
+    /// Does the engine play black?
+    bool mEngineEnabled = false;
+
+    /// Should the engine think while the user is thinking?
+    bool mPonderEnabled = true;
+
+    /// The user move the engine is pondering on, Move::None() when not pondering
+    Move mPonderMove;
+
+    /// Identifies the current search so results of stopped searches are ignored
+    int mSearchId = 0;
+
+    /// Should the best moves for the side to move be shown?
+    bool mAnalysisEnabled = false;
+
+    /// True while the engine is analyzing rather than playing or pondering
+    bool mAnalyzing = false;
+
+    /// Candidate lines from the last completed analysis depth, best first
+    std::vector<SearchInfo> mAnalysis;
+
 public:
     /// The current mouse mode
     enum class Mode {Move, Rotate};
@@ -56,8 +91,13 @@ public:
 
 public:
     ViewEdit(wxFrame* parent, std::wstring resourcesdir);
+    ~ViewEdit();
 
     void UpdateObserver() override;
+    void SetEngineEnabled(bool enabled);
+    void SetPonderEnabled(bool enabled);
+    void SetAnalysisEnabled(bool enabled);
+    void LoadGame(std::vector<Move> const &moves);
 
 
 };
@@ -0,0 +1,82 @@
+/**
+ * @file Zobrist.h
+ * @author John Korreck
+ *
+ * Random keys used to hash positions for the transposition table
+ * and repetition detection. The keys are generated at compile time
+ * so every build hashes positions identically.
+ */
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+#include "ChessTypes.h"
+
+/**
+ * The Zobrist key tables
+ */
+struct ZobristKeys {
+    /// Key for each piece code on each square
+    uint64_t mPieceSquare[PIECE_CODE_NB][SQUARE_NB] = {};
+
+    /// Key for each combination of castling rights
+    uint64_t mCastling[ALL_CASTLING + 1] = {};
+
+    /// Key for the file of the en passant square
+    uint64_t mEnPassant[8] = {};
+
+    /// Key toggled when black is to move
+    uint64_t mSideToMove = 0;
+};
+
+/**
+ * Fill the key tables with a xorshift64* sequence
+ * @return The generated keys
+ */
+constexpr ZobristKeys GenerateZobristKeys()
+{
+    ZobristKeys keys;
+    uint64_t seed = 1070372;
+    auto next = [&seed]() {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 2685821657736338717ULL;
+    };
+
+    for (auto &piece : keys.mPieceSquare)
+    {
+        for (auto &key : piece)
+        {
+            key = next();
+        }
+    }
+
+    // Castling keys are built from the four single rights so that
+    // toggling one right is a single xor
+    uint64_t rights[4] = {next(), next(), next(), next()};
+    for (int cr = 0; cr <= ALL_CASTLING; cr++)
+    {
+        for (int bit = 0; bit < 4; bit++)
+        {
+            if (cr & (1 << bit))
+            {
+                keys.mCastling[cr] ^= rights[bit];
+            }
+        }
+    }
+
+    for (auto &key : keys.mEnPassant)
+    {
+        key = next();
+    }
+    keys.mSideToMove = next();
+    return keys;
+}
+
+/// The keys used by every Position
+inline constexpr ZobristKeys Zobrist = GenerateZobristKeys();
+
+#endif //ZOBRIST_H
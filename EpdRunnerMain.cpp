@@ -0,0 +1,120 @@
+/**
+ * @file EpdRunnerMain.cpp
+ * @author John Korreck
+ *
+ * Entry point for the tool that runs EPD test suites
+ */
+
+#include "pch.h"
+#include <EpdRunner.h>
+#include <Position.h>
+
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+/**
+ * Search the positions of the EPD suites given as arguments and
+ * report which were solved, and how fast.
+ *
+ * Usage: Chess_Engine_EpdRunner [-threads N] [-time ms] [-nodes N]
+ * [-depth N] [-hash MB] [-syzygy path] suite.epd...
+ * @param argc Number of arguments
+ * @param argv The arguments
+ * @return Exit code
+ */
+int main(int argc, char *argv[])
+{
+    EpdRunnerOptions options;
+    options.mThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::string> files;
+    int64_t moveTime = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-threads" && hasValue) options.mThreads = std::atoi(argv[++i]);
+        else if (arg == "-time" && hasValue) moveTime = std::atoll(argv[++i]);
+        else if (arg == "-nodes" && hasValue) options.mNodes = uint64_t(std::atoll(argv[++i]));
+        else if (arg == "-depth" && hasValue) options.mDepth = std::atoi(argv[++i]);
+        else if (arg == "-hash" && hasValue) options.mHash = size_t(std::atoll(argv[++i]));
+        else if (arg == "-syzygy" && hasValue) options.mSyzygyPath = argv[++i];
+        else files.push_back(arg);
+    }
+    if (files.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " [-threads N] [-time ms] [-nodes N] [-depth N] [-hash MB]"
+                  << " [-syzygy path] suite.epd..." << std::endl;
+        return 1;
+    }
+    if (moveTime >= 0 || options.mNodes > 0 || options.mDepth > 0)
+    {
+        // A node or depth limit replaces the default time
+        options.mMoveTime = std::max<int64_t>(0, moveTime);
+    }
+
+    // Only positions with a bm or am operation can be scored
+    std::vector<EpdPosition> positions;
+    for (auto const &path : files)
+    {
+        std::ifstream input(path);
+        if (!input)
+        {
+            std::cerr << "could not read " << path << std::endl;
+            return 1;
+        }
+        std::vector<EpdPosition> suite;
+        int bad = EpdPosition::Load(input, suite);
+        if (bad > 0)
+        {
+            std::cerr << path << ": " << bad << " lines could not be read" << std::endl;
+        }
+        for (auto &position : suite)
+        {
+            if (!position.mBestMoves.empty() || !position.mAvoidMoves.empty())
+            {
+                positions.push_back(std::move(position));
+            }
+        }
+    }
+
+    EpdRunner runner(options);
+    runner.Run(positions, [&positions](const EpdRunner::Result &result) {
+        auto const &epd = positions[result.mIndex];
+        std::string id = epd.mId.empty() ? std::to_string(result.mIndex + 1) : epd.mId;
+        if (!result.mError.empty())
+        {
+            std::cout << "failed " << id << " " << result.mError << std::endl;
+            return;
+        }
+        Position position;
+        position.SetFen(epd.mFen);
+        std::string move = result.mMove.IsValid() ? position.SanText(result.mMove).ToString() : "none";
+        std::cout << (result.mSolved ? "solved " : "failed ") << id << " move " << move
+                  << " depth " << result.mDepth << " nodes " << result.mNodes;
+        if (result.mSolved)
+        {
+            std::cout << " solution time " << result.mSolveTime << " ms nodes " << result.mSolveNodes;
+        }
+        std::cout << std::endl;
+    });
+
+    auto const &stats = runner.GetStats();
+    std::cout << "solved " << stats.mSolved << " of " << stats.mPositions;
+    if (stats.mPositions > 0)
+    {
+        std::cout << " (" << stats.mSolved * 100 / stats.mPositions << "%)";
+    }
+    if (stats.mErrors > 0)
+    {
+        std::cout << " with " << stats.mErrors << " not searched";
+    }
+    if (stats.mSolved > 0)
+    {
+        std::cout << " mean solution time " << stats.mSolveTime / int64_t(stats.mSolved) << " ms nodes "
+                  << stats.mSolveNodes / stats.mSolved;
+    }
+    std::cout << " nodes " << stats.mNodes << " time " << stats.mMilliseconds << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file MatchMain.cpp
+ * @author John Korreck
+ *
+ * Entry point for the tool that plays matches between UCI engines
+ */
+
+#include "pch.h"
+#include <Match.h>
+#include <Sprt.h>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+/**
+ * Split a command line into its words
+ * @param text The command, words separated by spaces
+ * @return The words
+ */
+static std::vector<std::string> Words(const std::string &text)
+{
+    std::vector<std::string> words;
+    std::istringstream input(text);
+    std::string word;
+    while (input >> word)
+    {
+        words.push_back(word);
+    }
+    return words;
+}
+
+/**
+ * Read a time in seconds such as "10" or "0.5"
+ * @param text The time
+ * @return The time in milliseconds
+ */
+static int64_t Milliseconds(const std::string &text)
+{
+    return int64_t(std::atof(text.c_str()) * 1000 + 0.5);
+}
+
+/**
+ * Play a match between two UCI engines and write the games as PGN.
+ * Option names and values are given as name=value. With -sprt the
+ * match stops as soon as the test accepts either hypothesis, and
+ * -games only caps its length.
+ *
+ * Usage: Chess_Engine_Match -engine1 command -engine2 command
+ * [-name1 name] [-name2 name] [-option1 name=value] [-option2 name=value]
+ * [-games N] [-concurrency N] [-tc base+inc] [-movetime ms] [-nodes N]
+ * [-openings file.epd|file.pgn] [-plies N] [-syzygy path]
+ * [-draw movenumber moves cp] [-resign moves cp] [-pgn out.pgn]
+ * [-sprt elo0 elo1 alpha beta]
+ * @param argc Number of arguments
+ * @param argv The arguments
+ * @return Exit code
+ */
+int main(int argc, char *argv[])
+{
+    MatchOptions options;
+    int concurrency = 0;
+    bool bad = false;
+    bool sprt = false;
+    SprtOptions sprtOptions;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        int engine = arg.back() == '2' ? 1 : 0;
+        if ((arg == "-engine1" || arg == "-engine2") && hasValue) options.mEngines[engine].mCommand = Words(argv[++i]);
+        else if ((arg == "-name1" || arg == "-name2") && hasValue) options.mEngines[engine].mName = argv[++i];
+        else if ((arg == "-option1" || arg == "-option2") && hasValue)
+        {
+            std::string option = argv[++i];
+            size_t equals = option.find('=');
+            options.mEngines[engine].mOptions.emplace_back(option.substr(0, equals),
+                                                           equals == std::string::npos ? "" : option.substr(equals + 1));
+        }
+        else if (arg == "-games" && hasValue) options.mGames = std::atoi(argv[++i]);
+        else if (arg == "-concurrency" && hasValue) concurrency = std::atoi(argv[++i]);
+        else if (arg == "-tc" && hasValue)
+        {
+            std::string tc = argv[++i];
+            size_t plus = tc.find('+');
+            options.mTimeControl.mBase = Milliseconds(tc.substr(0, plus));
+            options.mTimeControl.mIncrement = plus == std::string::npos ? 0 : Milliseconds(tc.substr(plus + 1));
+        }
+        else if (arg == "-movetime" && hasValue) options.mTimeControl.mMoveTime = std::atoll(argv[++i]);
+        else if (arg == "-nodes" && hasValue) options.mTimeControl.mNodes = uint64_t(std::atoll(argv[++i]));
+        else if (arg == "-openings" && hasValue) options.mOpenings = argv[++i];
+        else if (arg == "-plies" && hasValue) options.mOpeningPlies = std::atoi(argv[++i]);
+        else if (arg == "-syzygy" && hasValue) options.mSyzygyPath = argv[++i];
+        else if (arg == "-draw" && i + 3 < argc)
+        {
+            options.mDrawMoveNumber = std::atoi(argv[++i]);
+            options.mDrawMoves = std::atoi(argv[++i]);
+            options.mDrawScore = std::atoi(argv[++i]);
+        }
+        else if (arg == "-resign" && i + 2 < argc)
+        {
+            options.mResignMoves = std::atoi(argv[++i]);
+            options.mResignScore = std::atoi(argv[++i]);
+        }
+        else if (arg == "-pgn" && hasValue) options.mPgnPath = argv[++i];
+        else if (arg == "-sprt" && i + 4 < argc)
+        {
+            sprt = true;
+            sprtOptions.mElo0 = std::atof(argv[++i]);
+            sprtOptions.mElo1 = std::atof(argv[++i]);
+            sprtOptions.mAlpha = std::atof(argv[++i]);
+            sprtOptions.mBeta = std::atof(argv[++i]);
+        }
+        else bad = true;
+    }
+    if (bad || options.mEngines[0].mCommand.empty() || options.mEngines[1].mCommand.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " -engine1 command -engine2 command [-name1 name] [-name2 name]"
+                  << " [-option1 name=value] [-option2 name=value] [-games N] [-concurrency N] [-tc base+inc]"
+                  << " [-movetime ms] [-nodes N] [-openings file.epd|file.pgn] [-plies N] [-syzygy path]"
+                  << " [-draw movenumber moves cp] [-resign moves cp] [-pgn out.pgn] [-sprt elo0 elo1 alpha beta]"
+                  << std::endl;
+        return 1;
+    }
+
+    // Every game needs a core for each search thread of the engine to move
+    int cores = Match::DefaultConcurrency(options);
+    options.mConcurrency = concurrency > 0 ? concurrency : cores;
+    if (options.mConcurrency > cores)
+    {
+        std::cerr << "warning: " << options.mConcurrency << " games at once is more than the " << cores
+                  << " the cores allow, timing will suffer" << std::endl;
+    }
+
+    Match match(options);
+    if (!match.LoadOpenings())
+    {
+        std::cerr << "could not read openings from " << options.mOpenings << std::endl;
+        return 1;
+    }
+
+    // The test is decided on whole pairs, as each one finishes
+    Sprt test(sprtOptions);
+    SprtDecision decision = SPRT_CONTINUE;
+    bool played = match.Run([&](const Match::GameResult &result) {
+        auto const &stats = match.GetStats();
+        std::cout << "game " << result.mRound << " opening " << result.mOpening + 1 << ": " << result.mResult
+                  << " (" << result.mReason << "), score " << stats.mWins << " - " << stats.mLosses << " - "
+                  << stats.mDraws;
+        if (sprt && result.mRound % 2 == 0)
+        {
+            std::cout << " llr " << std::fixed << std::setprecision(2) << test.Llr(stats.mPairs)
+                      << std::defaultfloat;
+            if (decision == SPRT_CONTINUE)
+            {
+                decision = test.Decide(stats.mPairs);
+                if (decision != SPRT_CONTINUE)
+                {
+                    match.Stop();
+                }
+            }
+        }
+        std::cout << std::endl;
+    });
+    if (!played)
+    {
+        std::cerr << "an engine could not be started" << std::endl;
+    }
+
+    auto const &stats = match.GetStats();
+    uint64_t games = stats.Games();
+    std::cout << "games " << games << " wins " << stats.mWins << " losses " << stats.mLosses << " draws "
+              << stats.mDraws;
+    if (games > 0)
+    {
+        std::cout << " score " << (stats.mWins * 2 + stats.mDraws) * 50.0 / double(games) << "%";
+    }
+    std::cout << std::endl << "pairs";
+    for (auto count : stats.mPairs)
+    {
+        std::cout << ' ' << count;
+    }
+    std::cout << " time forfeits " << stats.mTimeLosses << " crashes " << stats.mCrashes << " adjudicated "
+              << stats.mAdjudicated << " time " << stats.mMilliseconds << " ms" << std::endl;
+
+    EloEstimate elo = Sprt::Estimate(stats.mPairs);
+    std::cout << std::fixed << std::setprecision(2) << "elo " << elo.mElo << " +/- " << elo.mError << " los "
+              << elo.mLos * 100 << "%" << std::endl;
+    if (sprt)
+    {
+        std::cout << "sprt elo0 " << sprtOptions.mElo0 << " elo1 " << sprtOptions.mElo1 << " llr "
+                  << test.Llr(stats.mPairs) << " (" << test.LowerBound() << ", " << test.UpperBound() << ") "
+                  << (decision == SPRT_H1 ? "H1 accepted" : decision == SPRT_H0 ? "H0 accepted" : "undecided")
+                  << std::endl;
+    }
+    return played ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file SpsaMain.cpp
+ * @author John Korreck
+ *
+ * Entry point for the tool that tunes engine options by SPSA
+ */
+
+#include "pch.h"
+#include <Spsa.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+/**
+ * Split a command line into its words
+ * @param text The command, words separated by spaces
+ * @return The words
+ */
+static std::vector<std::string> Words(const std::string &text)
+{
+    std::vector<std::string> words;
+    std::istringstream input(text);
+    std::string word;
+    while (input >> word)
+    {
+        words.push_back(word);
+    }
+    return words;
+}
+
+/**
+ * Read a time in seconds such as "10" or "0.5"
+ * @param text The time
+ * @return The time in milliseconds
+ */
+static int64_t Milliseconds(const std::string &text)
+{
+    return int64_t(std::atof(text.c_str()) * 1000 + 0.5);
+}
+
+/**
+ * Tune options of a UCI engine by playing it against itself. The
+ * options to tune are read from a file with one option per line as
+ * "name, value, min, max, c_end, r_end". With -checkpoint, a run that
+ * is stopped carries on from where it was when started again.
+ *
+ * Usage: Chess_Engine_Spsa -engine command -params file
+ * [-option name=value] [-iterations N] [-pairs N] [-concurrency N]
+ * [-tc base+inc] [-movetime ms] [-nodes N] [-openings file.epd|file.pgn]
+ * [-plies N] [-alpha a] [-gamma g] [-stability A] [-checkpoint file]
+ * [-seed N]
+ * @param argc Number of arguments
+ * @param argv The arguments
+ * @return Exit code
+ */
+int main(int argc, char *argv[])
+{
+    SpsaOptions options;
+    options.mConcurrency = int(std::max(1u, std::thread::hardware_concurrency()));
+    std::string paramsPath;
+    bool bad = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-engine" && hasValue) options.mEngine.mCommand = Words(argv[++i]);
+        else if (arg == "-params" && hasValue) paramsPath = argv[++i];
+        else if (arg == "-option" && hasValue)
+        {
+            std::string option = argv[++i];
+            size_t equals = option.find('=');
+            options.mEngine.mOptions.emplace_back(option.substr(0, equals),
+                                                  equals == std::string::npos ? "" : option.substr(equals + 1));
+        }
+        else if (arg == "-iterations" && hasValue) options.mIterations = std::atoi(argv[++i]);
+        else if (arg == "-pairs" && hasValue) options.mPairs = std::atoi(argv[++i]);
+        else if (arg == "-concurrency" && hasValue) options.mConcurrency = std::atoi(argv[++i]);
+        else if (arg == "-tc" && hasValue)
+        {
+            std::string tc = argv[++i];
+            size_t plus = tc.find('+');
+            options.mTimeControl.mBase = Milliseconds(tc.substr(0, plus));
+            options.mTimeControl.mIncrement = plus == std::string::npos ? 0 : Milliseconds(tc.substr(plus + 1));
+        }
+        else if (arg == "-movetime" && hasValue) options.mTimeControl.mMoveTime = std::atoll(argv[++i]);
+        else if (arg == "-nodes" && hasValue) options.mTimeControl.mNodes = uint64_t(std::atoll(argv[++i]));
+        else if (arg == "-openings" && hasValue) options.mOpenings = argv[++i];
+        else if (arg == "-plies" && hasValue) options.mOpeningPlies = std::atoi(argv[++i]);
+        else if (arg == "-alpha" && hasValue) options.mAlpha = std::atof(argv[++i]);
+        else if (arg == "-gamma" && hasValue) options.mGamma = std::atof(argv[++i]);
+        else if (arg == "-stability" && hasValue) options.mStability = std::atof(argv[++i]);
+        else if (arg == "-checkpoint" && hasValue) options.mCheckpoint = argv[++i];
+        else if (arg == "-seed" && hasValue) options.mSeed = uint64_t(std::atoll(argv[++i]));
+        else bad = true;
+    }
+    if (bad || options.mEngine.mCommand.empty() || paramsPath.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " -engine command -params file [-option name=value] [-iterations N]"
+                  << " [-pairs N] [-concurrency N] [-tc base+inc] [-movetime ms] [-nodes N]"
+                  << " [-openings file.epd|file.pgn] [-plies N] [-alpha a] [-gamma g] [-stability A]"
+                  << " [-checkpoint file] [-seed N]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream params(paramsPath);
+    if (!params || !Spsa::ReadParameters(params, options.mParameters) || options.mParameters.empty())
+    {
+        std::cerr << "could not read options to tune from " << paramsPath << std::endl;
+        return 1;
+    }
+
+    Spsa spsa(options);
+    if (!spsa.LoadOpenings())
+    {
+        std::cerr << "could not read openings from " << options.mOpenings << std::endl;
+        return 1;
+    }
+    if (!spsa.LoadCheckpoint())
+    {
+        std::cerr << "could not read checkpoint " << options.mCheckpoint << std::endl;
+        return 1;
+    }
+    if (spsa.GetStats().mIterations > 0)
+    {
+        std::cout << "resuming after iteration " << spsa.GetStats().mIterations << std::endl;
+    }
+
+    bool tuned = spsa.Run([&spsa](int iteration) {
+        auto const &stats = spsa.GetStats();
+        std::cout << "iteration " << iteration << " (" << stats.mIterations << " done) games +" << stats.mWins
+                  << " =" << stats.mDraws << " -" << stats.mLosses;
+        for (auto const &parameter : spsa.GetParameters())
+        {
+            std::cout << ' ' << parameter.mName << ' ' << parameter.mValue;
+        }
+        std::cout << std::endl;
+    });
+    if (!tuned)
+    {
+        std::cerr << "the engine could not be started" << std::endl;
+    }
+
+    // Ready to paste back in as the next run's parameter file
+    for (auto const &parameter : spsa.GetParameters())
+    {
+        std::cout << parameter.mName << ", " << parameter.mValue << ", " << parameter.mMin << ", " << parameter.mMax
+                  << ", " << parameter.mPerturbation << ", " << parameter.mRate << std::endl;
+    }
+    return tuned ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file TablebaseGeneratorMain.cpp
+ * @author John Korreck
+ *
+ * Entry point for the tool that generates endgame tables
+ */
+
+#include "pch.h"
+#include <RetrogradeGenerator.h>
+
+#include <iostream>
+#include <thread>
+
+/**
+ * Generate the endgame tables named as arguments, and the smaller
+ * tables they need that are not in the output directory yet.
+ *
+ * Usage: Chess_Engine_TablebaseGenerator [-threads N] [-o directory]
+ * KQvK KRPvKR...
+ * @param argc Number of arguments
+ * @param argv The arguments
+ * @return Exit code
+ */
+int main(int argc, char *argv[])
+{
+    RetrogradeOptions options;
+    options.mThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue) options.mDirectory = argv[++i];
+        else if (arg == "-threads" && hasValue) options.mThreads = std::atoi(argv[++i]);
+        else names.push_back(arg);
+    }
+    if (names.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " [-threads N] [-o directory] KQvK KRPvKR..." << std::endl;
+        return 1;
+    }
+
+    RetrogradeGenerator generator(options);
+    bool generated = true;
+    for (const std::string &name : names)
+    {
+        generated = generated && generator.Generate(name);
+    }
+
+    for (auto const &stats : generator.GetStats())
+    {
+        std::cout << stats.mName << " positions " << stats.mPositions << " wins " << stats.mWins << " draws "
+                  << stats.mDraws << " losses " << stats.mLosses << " longest mate " << stats.mLongestMate
+                  << " time " << stats.mMilliseconds << " ms memory " << (stats.mPeakMemory + 1023) / 1024 << " KB"
+                  << std::endl;
+    }
+    if (!generated)
+    {
+        std::cerr << generator.Error() << std::endl;
+        return 1;
+    }
+    return 0;
+}
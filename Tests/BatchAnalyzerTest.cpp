@@ -0,0 +1,165 @@
+/**
+ * @file BatchAnalyzerTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <BatchAnalyzer.h>
+
+using namespace std;
+
+/// Positions to analyze, with a comment, a blank line and a bad line
+const string TestPositions = "# mates and quiet positions\n"
+                             "6k1/5ppp/8/8/8/8/8/R5K1 w - - id \"back rank\";\n"
+                             "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1\n"
+                             "\n"
+                             "not a position\n"
+                             "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1\n"
+                             "k7/8/1K6/8/8/8/8/7R w - - id \"ladder\";\n"
+                             "7k/6Q1/6K1/8/8/8/8/8 b - - 0 1\n";
+
+/**
+ * Split output into its lines
+ * @param text The output
+ * @return The lines
+ */
+static vector<string> Lines(const string &text)
+{
+    vector<string> lines;
+    istringstream input(text);
+    string line;
+    while (getline(input, line))
+    {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/**
+ * Options for a fast run
+ * @param threads Worker threads
+ * @param ordered Write results in input order?
+ * @return The options
+ */
+static BatchAnalyzerOptions TestOptions(int threads, bool ordered)
+{
+    BatchAnalyzerOptions options;
+    options.mThreads = threads;
+    options.mDepth = 4;
+    options.mHash = 1;
+    options.mOrdered = ordered;
+    return options;
+}
+
+TEST(BatchAnalyzerTest, Ordered)
+{
+    BatchAnalyzer analyzer(TestOptions(3, true));
+    istringstream input(TestPositions);
+    ostringstream output;
+    analyzer.Run(input, output);
+
+    auto lines = Lines(output.str());
+    ASSERT_EQ(6u, lines.size());
+    ASSERT_EQ(0u, lines[0].find("{\"line\":2,\"fen\":\"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1\",\"id\":\"back rank\","
+                                "\"bestmove\":\"a1a8\",\"mate\":1,"));
+    ASSERT_EQ(0u, lines[1].find("{\"line\":3,"));
+    ASSERT_EQ("{\"line\":5,\"error\":\"not a position\"}", lines[2]);
+    ASSERT_EQ(0u, lines[3].find("{\"line\":6,"));
+    ASSERT_NE(string::npos, lines[3].find("\"pv\":[\"e1"));
+    ASSERT_EQ(0u, lines[4].find("{\"line\":7,\"fen\":\"k7/8/1K6/8/8/8/8/7R w - - 0 1\",\"id\":\"ladder\","
+                                "\"bestmove\":\"h1h8\",\"mate\":1,"));
+
+    // Checkmated, so there is nothing to play
+    ASSERT_EQ(0u, lines[5].find("{\"line\":8,\"fen\":\"7k/6Q1/6K1/8/8/8/8/8 b - - 0 1\",\"bestmove\":null,\"mate\":0,"));
+
+    auto const &stats = analyzer.GetStats();
+    ASSERT_EQ(5u, stats.mPositions);
+    ASSERT_EQ(1u, stats.mBadLines);
+    ASSERT_EQ(0u, stats.mSkipped);
+    ASSERT_GT(stats.mNodes, 0u);
+}
+
+TEST(BatchAnalyzerTest, Unordered)
+{
+    BatchAnalyzer ordered(TestOptions(1, true));
+    istringstream input(TestPositions);
+    ostringstream output;
+    ordered.Run(input, output);
+
+    BatchAnalyzer unordered(TestOptions(4, false));
+    istringstream unorderedInput(TestPositions);
+    ostringstream unorderedOutput;
+    unordered.Run(unorderedInput, unorderedOutput);
+
+    // The same results, whatever order they finished in, apart from
+    // the time each search took
+    auto strip = [](vector<string> lines) {
+        for (auto &line : lines)
+        {
+            size_t time = line.find(",\"time\":");
+            if (time != string::npos)
+            {
+                line.erase(time, line.find(',', time + 1) - time);
+            }
+        }
+        sort(lines.begin(), lines.end());
+        return lines;
+    };
+    ASSERT_EQ(strip(Lines(output.str())), strip(Lines(unorderedOutput.str())));
+}
+
+TEST(BatchAnalyzerTest, Resume)
+{
+    string path = "BatchAnalyzerTest.jsonl";
+    remove(path.c_str());
+
+    unordered_set<uint64_t> done;
+    ASSERT_TRUE(BatchAnalyzer::Resume(path, done));
+    ASSERT_TRUE(done.empty());
+
+    // Interrupted after two results, part way through the third
+    {
+        ofstream file(path, ios::binary);
+        file << "{\"line\":2,\"fen\":\"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1\"}\n"
+             << "{\"line\":5,\"error\":\"not a position\"}\n"
+             << "{\"line\":3,\"fen\":\"rnbqkb";
+    }
+    ASSERT_TRUE(BatchAnalyzer::Resume(path, done));
+    ASSERT_EQ(2u, done.size());
+    ASSERT_EQ(1u, done.count(2));
+    ASSERT_EQ(1u, done.count(5));
+
+    {
+        ofstream file(path, ios::app);
+        BatchAnalyzer analyzer(TestOptions(2, true));
+        istringstream input(TestPositions);
+        analyzer.Run(input, file, done);
+        ASSERT_EQ(4u, analyzer.GetStats().mPositions);
+        ASSERT_EQ(0u, analyzer.GetStats().mBadLines);
+        ASSERT_EQ(2u, analyzer.GetStats().mSkipped);
+    }
+
+    ifstream file(path);
+    stringstream text;
+    text << file.rdbuf();
+    auto lines = Lines(text.str());
+    ASSERT_EQ(6u, lines.size());
+    ASSERT_EQ(0u, lines[1].find("{\"line\":5,"));
+    ASSERT_EQ(0u, lines[2].find("{\"line\":3,\"fen\":\"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1\","));
+    ASSERT_EQ(0u, lines[5].find("{\"line\":8,"));
+    file.close();
+    remove(path.c_str());
+}
+
+TEST(BatchAnalyzerTest, Escape)
+{
+    ASSERT_EQ("plain", BatchAnalyzer::Escape("plain"));
+    ASSERT_EQ("a \\\"quote\\\" and \\\\", BatchAnalyzer::Escape("a \"quote\" and \\"));
+    ASSERT_EQ("tab\\u0009", BatchAnalyzer::Escape("tab\t"));
+}
@@ -0,0 +1,254 @@
+/**
+ * @file BookTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include <Book.h>
+#include <BookBuilder.h>
+#include <Position.h>
+
+using namespace std;
+
+/**
+ * Write a Polyglot book file
+ * @param path File to write
+ * @param entries Entries, already sorted by key
+ */
+static void WriteBook(const string &path, const vector<BookEntry> &entries)
+{
+    ofstream output(path, ios::binary);
+    auto put = [&output](uint64_t value, int bytes) {
+        for (int b = bytes - 1; b >= 0; b--)
+        {
+            output.put(char(value >> (8 * b)));
+        }
+    };
+    for (const BookEntry &entry : entries)
+    {
+        put(entry.mKey, 8);
+        put(entry.mMove, 2);
+        put(entry.mWeight, 2);
+        put(entry.mLearn, 4);
+    }
+}
+
+/**
+ * Encode a move the way Polyglot does
+ * @param from From square
+ * @param to To square
+ * @param promotion 0, or 1 for a knight to 4 for a queen
+ * @return The Polyglot move
+ */
+static uint16_t PolyglotMove(int from, int to, int promotion = 0)
+{
+    return uint16_t(to | from << 6 | promotion << 12);
+}
+
+TEST(BookTest, Find)
+{
+    string path = (filesystem::temp_directory_path() / "BookTest.bin").string();
+    WriteBook(path, {{5, 1, 10, 0}, {5, 2, 20, 0}, {9, 3, 30, 0},
+                     {20, 4, 1, 0}, {20, 5, 2, 0}, {20, 6, 3, 7}});
+
+    Book book;
+    ASSERT_FALSE(book.IsOpen());
+    ASSERT_TRUE(book.Open(path));
+    ASSERT_EQ(6u, book.Size());
+
+    ASSERT_TRUE(book.Find(1).empty());
+    ASSERT_TRUE(book.Find(7).empty());
+    ASSERT_TRUE(book.Find(100).empty());
+    ASSERT_EQ(1u, book.Find(9).size());
+    ASSERT_EQ(30, book.Find(9)[0].mWeight);
+
+    auto entries = book.Find(20);
+    ASSERT_EQ(3u, entries.size());
+    ASSERT_EQ(4, entries[0].mMove);
+    ASSERT_EQ(6, entries[2].mMove);
+    ASSERT_EQ(7u, entries[2].mLearn);
+
+    // Files that are not whole entries are refused
+    {
+        ofstream output(path, ios::binary | ios::app);
+        output.put(0);
+    }
+    ASSERT_FALSE(book.Open(path));
+    ASSERT_FALSE(book.IsOpen());
+    filesystem::remove(path);
+    ASSERT_FALSE(book.Open(path));
+}
+
+TEST(BookTest, DecodeMove)
+{
+    Position position;
+    position.SetFen("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+
+    // Castling is written as the king taking its own rook
+    Move shortCastle = Book::DecodeMove(position, PolyglotMove(4, 7));
+    ASSERT_EQ(Move::CASTLING, shortCastle.GetType());
+    ASSERT_EQ("e1g1", shortCastle.ToUci());
+    ASSERT_EQ(PolyglotMove(4, 7), Book::EncodeMove(shortCastle));
+    ASSERT_EQ("e1c1", Book::DecodeMove(position, PolyglotMove(4, 0)).ToUci());
+    ASSERT_EQ("a1a8", Book::DecodeMove(position, PolyglotMove(0, 56)).ToUci());
+    ASSERT_FALSE(Book::DecodeMove(position, PolyglotMove(4, 20)).IsValid());
+
+    position.SetFen("8/P7/8/8/8/8/8/k6K w - - 0 1");
+    ASSERT_EQ("a7a8q", Book::DecodeMove(position, PolyglotMove(48, 56, 4)).ToUci());
+    ASSERT_EQ("a7a8n", Book::DecodeMove(position, PolyglotMove(48, 56, 1)).ToUci());
+    ASSERT_EQ(PolyglotMove(48, 56, 1), Book::EncodeMove(Book::DecodeMove(position, PolyglotMove(48, 56, 1))));
+    ASSERT_FALSE(Book::DecodeMove(position, PolyglotMove(48, 56)).IsValid());
+}
+
+TEST(BookTest, Key)
+{
+    // Keys from the Polyglot format documentation
+    Position position;
+    ASSERT_EQ(0x463b96181691fc9cULL, Book::Key(position));
+    const pair<const char *, uint64_t> lines[] = {
+        {"e2e4", 0x823c9b50fd114196ULL},
+        {"d7d5", 0x0756b94461c50fb0ULL},
+        {"e4e5", 0x662fafb965db29d4ULL},
+        {"f7f5", 0x22a48b5a8e47ff78ULL},
+        {"e1e2", 0x652a607ca3f242c1ULL},
+        {"e8f7", 0x00fdd303c946bdd9ULL},
+    };
+    for (auto line : lines)
+    {
+        position.DoMove(position.ParseMove(line.first));
+        ASSERT_EQ(line.second, Book::Key(position)) << line.first;
+    }
+
+    // The en passant file only counts when a pawn can take
+    Position enPassant;
+    for (const char *move : {"a2a4", "b7b5", "h2h4", "b5b4", "c2c4"})
+    {
+        enPassant.DoMove(enPassant.ParseMove(move));
+    }
+    ASSERT_EQ(0x3c8123ea7b067637ULL, Book::Key(enPassant));
+    enPassant.DoMove(enPassant.ParseMove("b4c3"));
+    enPassant.DoMove(enPassant.ParseMove("a1a3"));
+    ASSERT_EQ(0x5c3f9b829b279560ULL, Book::Key(enPassant));
+
+    // Weight zero moves are never played
+    Position start;
+    string path = (filesystem::temp_directory_path() / "BookTest.bin").string();
+    WriteBook(path, {{Book::Key(start), PolyglotMove(11, 27), 0, 0}, {Book::Key(start), PolyglotMove(12, 28), 5, 0}});
+    Book book;
+    ASSERT_TRUE(book.Open(path));
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_EQ("e2e4", book.Probe(start).ToUci());
+    }
+    ASSERT_FALSE(book.Probe(position).IsValid());
+    book.Close();
+    filesystem::remove(path);
+}
+
+TEST(BookTest, Builder)
+{
+    auto directory = filesystem::temp_directory_path();
+    string pgnPath = (directory / "BookTest.pgn").string();
+    string bookPath = (directory / "BookTest.bin").string();
+    {
+        // White wins twice after 1. e4 and loses once after 1. d4
+        ofstream pgn(pgnPath);
+        pgn << "1. e4 e5 2. Nf3 1-0\n\n1. e4 c5 1-0\n\n1. d4 d5 0-1\n\n1. e4 e5 1/2-1/2\n\n1. e4 Zz9 1-0\n";
+    }
+
+    BookBuilderOptions options;
+    options.mMinGames = 2;
+    options.mThreads = 2;
+    BookBuilder builder(options);
+    ASSERT_TRUE(builder.Build({pgnPath}, bookPath));
+    ASSERT_EQ(5u, builder.GetStats().mGames);
+    ASSERT_EQ(1u, builder.GetStats().mBadGames);
+
+    Book book;
+    ASSERT_TRUE(book.Open(bookPath));
+    Position position;
+    auto entries = book.Find(Book::Key(position));
+    ASSERT_EQ(1u, entries.size());
+    ASSERT_EQ(PolyglotMove(12, 28), entries[0].mMove);
+    ASSERT_EQ(7, entries[0].mWeight);
+
+    // 1... e5 was played twice but only drew
+    position.DoMove(position.ParseMove("e2e4"));
+    entries = book.Find(Book::Key(position));
+    ASSERT_EQ(1u, entries.size());
+    ASSERT_EQ(1, entries[0].mWeight);
+
+    book.Close();
+    filesystem::remove(pgnPath);
+    filesystem::remove(bookPath);
+}
+
+TEST(BookTest, BuilderRuns)
+{
+    // Random games, with every move written fully disambiguated
+    auto directory = filesystem::temp_directory_path();
+    string pgnPath = (directory / "BookTestRuns.pgn").string();
+    {
+        ofstream pgn(pgnPath);
+        mt19937 random(7);
+        for (int game = 0; game < 500; game++)
+        {
+            Position position;
+            for (int ply = 0; ply < 16; ply++)
+            {
+                MoveList moves;
+                position.GenerateLegalMoves(moves);
+                if (moves.Empty())
+                {
+                    break;
+                }
+                Move move = moves[int(random() % moves.Size())];
+                string san = move.GetType() == Move::CASTLING ? (move.To() > move.From() ? "O-O" : "O-O-O")
+                    : string(1, " K NBRQ"[TypeOf(position.PieceOn(move.From()))]) + move.ToUci().substr(0, 4);
+                if (move.GetType() == Move::PROMOTION)
+                {
+                    san += string("=") + " K NBRQ"[move.PromotionType()];
+                }
+                pgn << (san[0] == ' ' ? san.substr(1) : san) << ' ';
+                position.DoMove(move);
+            }
+            pgn << (game % 3 == 0 ? "1-0" : game % 3 == 1 ? "0-1" : "1/2-1/2") << "\n\n";
+        }
+    }
+
+    // The smallest budget spills sorted runs to disk, which must
+    // give exactly the book built in memory
+    BookBuilderOptions options;
+    options.mMinGames = 1;
+    options.mThreads = 3;
+    string books[2];
+    for (int i = 0; i < 2; i++)
+    {
+        options.mMemory = i == 0 ? 0 : 64;
+        string bookPath = (directory / "BookTestRuns.bin").string();
+        BookBuilder builder(options);
+        ASSERT_TRUE(builder.Build({pgnPath}, bookPath));
+        ASSERT_EQ(0u, builder.GetStats().mBadGames);
+        ASSERT_EQ(i == 0, builder.GetStats().mRuns > 0);
+        ifstream book(bookPath, ios::binary);
+        books[i] = string(istreambuf_iterator<char>(book), {});
+        book.close();
+        filesystem::remove(bookPath);
+    }
+    ASSERT_FALSE(books[0].empty());
+    ASSERT_EQ(books[0], books[1]);
+
+    // A run that cannot be written fails the build
+    options.mMemory = 0;
+    options.mTempDirectory = (directory / "BookTestMissing" / "runs").string();
+    BookBuilder builder(options);
+    ASSERT_FALSE(builder.Build({pgnPath}, (directory / "BookTestRuns.bin").string()));
+    filesystem::remove(directory / "BookTestRuns.bin");
+    filesystem::remove(pgnPath);
+}
@@ -0,0 +1,171 @@
+/**
+ * @file EndgameTableTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <map>
+
+#include <EndgameTable.h>
+#include <RetrogradeGenerator.h>
+#include <Position.h>
+#include <Search.h>
+
+using namespace std;
+
+/**
+ * Probe a position
+ * @param tables The tables
+ * @param fen The position
+ * @return Result for the side to move, EGT_BROKEN if there is none
+ */
+static uint8_t Probe(const EndgameTables &tables, const string &fen)
+{
+    Position position;
+    position.SetFen(fen);
+    uint8_t result;
+    return tables.Probe(position, result) ? result : EGT_BROKEN;
+}
+
+TEST(EndgameTableTest, Names)
+{
+    ASSERT_EQ("KQvK", EndgameTable::Normalize("KvKQ"));
+    ASSERT_EQ("KRvKB", EndgameTable::Normalize("KBvKR"));
+    ASSERT_EQ("KRPvKR", EndgameTable::Normalize("KPRvKR"));
+    ASSERT_EQ("KBNvK", EndgameTable::Normalize("KNBvK"));
+    ASSERT_EQ("", EndgameTable::Normalize("KQK"));
+    ASSERT_EQ("", EndgameTable::Normalize("KQvKQvK"));
+    ASSERT_EQ("", EndgameTable::Normalize("KQRBNvK"));
+
+    // Every index decodes to a position that encodes back to it,
+    // or to one the table does not need
+    EndgameTable table;
+    ASSERT_TRUE(table.SetName("KPvK"));
+    ASSERT_EQ(2u * 1806 * 48, table.Size());
+    uint64_t canonical = 0;
+    for (uint64_t index = 0; index < table.Size(); index++)
+    {
+        int squares[EGT_PIECES];
+        int stm;
+        table.Decode(index, squares, stm);
+        canonical += table.Encode(squares, stm) == index;
+    }
+    ASSERT_EQ(table.Size(), canonical);
+}
+
+TEST(EndgameTableTest, Generate)
+{
+    auto directory = filesystem::temp_directory_path() / "EndgameTableTest";
+    filesystem::remove_all(directory);
+
+    RetrogradeOptions options;
+    options.mThreads = 2;
+    options.mDirectory = directory.string();
+    RetrogradeGenerator generator(options);
+    ASSERT_FALSE(generator.Generate("KQRBNPvK"));
+    ASSERT_TRUE(generator.Generate("KQvK"));
+    ASSERT_TRUE(generator.Generate("KRvK"));
+    ASSERT_TRUE(generator.Generate("KPvK"));
+
+    // The smaller tables KPvK promotes into are generated first
+    map<string, RetrogradeGenerator::Stats> stats;
+    for (auto const &table : generator.GetStats())
+    {
+        stats[table.mName] = table;
+    }
+    ASSERT_EQ(5u, stats.size());
+    ASSERT_EQ(10, stats["KQvK"].mLongestMate);
+    ASSERT_EQ(16, stats["KRvK"].mLongestMate);
+    ASSERT_EQ(0, stats["KNvK"].mLongestMate);
+    ASSERT_EQ(0u, stats["KBvK"].mWins + stats["KBvK"].mLosses);
+    ASSERT_GT(stats["KPvK"].mDraws, 0u);
+    ASSERT_GT(stats["KPvK"].mPeakMemory, stats["KPvK"].mPositions);
+
+    EndgameTables tables;
+    ASSERT_EQ(5, tables.Init(directory.string()));
+    ASSERT_EQ(3, tables.MaxPieces());
+
+    // Mate in one, mated and stalemate, either color
+    ASSERT_EQ(EGT_WIN, Probe(tables, "k7/8/1K6/8/8/8/8/6Q1 w - - 0 1"));
+    ASSERT_EQ(EGT_LOSS, Probe(tables, "k7/1Q6/1K6/8/8/8/8/8 b - - 0 1"));
+    ASSERT_EQ(EGT_DRAW, Probe(tables, "k7/8/1Q6/8/8/8/8/K7 b - - 0 1"));
+    ASSERT_EQ(EGT_WIN, Probe(tables, "6q1/8/8/8/8/1k6/8/K7 b - - 0 1"));
+    ASSERT_EQ(EGT_DRAW, Probe(tables, "K7/8/1q6/8/8/8/8/k7 w - - 0 1"));
+
+    // King and pawn against king
+    ASSERT_EQ(EGT_DRAW, Probe(tables, "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1"));
+    ASSERT_EQ(EGT_DRAW, Probe(tables, "k7/8/8/8/8/8/P7/K7 w - - 0 1"));
+    uint8_t win = Probe(tables, "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1");
+    ASSERT_TRUE(win >= EGT_WIN && win < EGT_LOSS);
+    ASSERT_EQ(win, Probe(tables, "8/8/8/8/4p3/4k3/8/4K3 b - - 0 1"));
+    ASSERT_EQ(EGT_BROKEN, Probe(tables, "4k3/8/4K3/4P3/4N3/8/8/8 w - - 0 1"));
+
+    // Root moves ranked by distance to mate
+    Position position;
+    position.SetFen("k7/8/1K6/8/8/8/8/6Q1 w - - 0 1");
+    MoveList moves;
+    position.GenerateLegalMoves(moves);
+    vector<RootMove> rootMoves;
+    for (Move move : moves)
+    {
+        RootMove rootMove;
+        rootMove.mMove = move;
+        rootMove.mPv.push_back(move);
+        rootMoves.push_back(rootMove);
+    }
+    ASSERT_TRUE(tables.RankRootMoves(position, rootMoves));
+    auto best = max_element(rootMoves.begin(), rootMoves.end(),
+                            [](const RootMove &a, const RootMove &b) { return a.mTbRank < b.mTbRank; });
+    ASSERT_EQ(position.ParseMove("g1g8"), best->mMove);
+    ASSERT_EQ(MateIn(1), best->mTbScore);
+
+    // Tables already written are read rather than generated again
+    RetrogradeGenerator again(options);
+    ASSERT_TRUE(again.Generate("KPvK"));
+    ASSERT_EQ(1u, again.GetStats().size());
+
+    ASSERT_EQ(0, tables.Init(""));
+    filesystem::remove_all(directory);
+}
+
+TEST(EndgameTableTest, FourPieces)
+{
+    auto directory = filesystem::temp_directory_path() / "EndgameTableTestFour";
+    filesystem::remove_all(directory);
+
+    RetrogradeOptions options;
+    options.mThreads = 2;
+    options.mDirectory = directory.string();
+    RetrogradeGenerator generator(options);
+    ASSERT_TRUE(generator.Generate("KQvKR"));
+
+    // The longest queen against rook mate is 35 moves
+    map<string, RetrogradeGenerator::Stats> stats;
+    for (auto const &table : generator.GetStats())
+    {
+        stats[table.mName] = table;
+    }
+    ASSERT_EQ(3u, stats.size());
+    ASSERT_EQ(35, stats["KQvKR"].mLongestMate);
+    ASSERT_GT(stats["KQvKR"].mDraws, 0u);
+
+    EndgameTables tables;
+    ASSERT_EQ(3, tables.Init(directory.string()));
+    ASSERT_EQ(4, tables.MaxPieces());
+
+    // Mate in one, for either color
+    ASSERT_EQ(EGT_WIN, Probe(tables, "k7/8/1K6/8/8/8/7r/6Q1 w - - 0 1"));
+    ASSERT_EQ(EGT_WIN, Probe(tables, "6q1/7R/8/8/8/1k6/8/K7 b - - 0 1"));
+
+    // The rook takes the queen and mates with the KRvK table
+    ASSERT_EQ(EGT_WIN + 5, Probe(tables, "8/8/8/3k4/8/8/1r2Q3/K7 b - - 0 1"));
+    ASSERT_EQ(EGT_WIN + 14, Probe(tables, "k7/8/1K6/8/8/8/6r1/6Q1 b - - 0 1"));
+
+    // The side not to move is in check
+    ASSERT_EQ(EGT_BROKEN, Probe(tables, "3k4/8/3K4/8/8/8/3r4/4Q3 b - - 0 1"));
+
+    filesystem::remove_all(directory);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file EpdTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include <Epd.h>
+#include <EpdRunner.h>
+#include <Position.h>
+
+using namespace std;
+
+TEST(EpdTest, Parse)
+{
+    EpdPosition epd;
+    ASSERT_TRUE(epd.Parse("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - "
+                          "bm Bb5 Bc4; id \"test; 1\"; c0 \"a comment\";"));
+    ASSERT_EQ("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 0 1", epd.mFen);
+    ASSERT_EQ("test; 1", epd.mId);
+    ASSERT_EQ("a comment", epd.Operation("c0"));
+    ASSERT_EQ("", epd.Operation("pv"));
+    ASSERT_EQ(2u, epd.mBestMoves.size());
+
+    Position position;
+    position.SetFen(epd.mFen);
+    ASSERT_TRUE(epd.IsSolution(position.ParseMove("f1b5")));
+    ASSERT_TRUE(epd.IsSolution(position.ParseMove("f1c4")));
+    ASSERT_FALSE(epd.IsSolution(position.ParseMove("d2d4")));
+
+    // Move counters as operations or as a full FEN, moves to avoid in UCI
+    ASSERT_TRUE(epd.Parse("4k3/8/8/8/8/8/4P3/4K3 w - - am e2e3; hmvc 7; fmvn 40;"));
+    ASSERT_EQ("4k3/8/8/8/8/8/4P3/4K3 w - - 7 40", epd.mFen);
+    position.SetFen(epd.mFen);
+    ASSERT_FALSE(epd.IsSolution(position.ParseMove("e2e3")));
+    ASSERT_TRUE(epd.IsSolution(position.ParseMove("e2e4")));
+    ASSERT_FALSE(epd.IsSolution(Move::None()));
+
+    ASSERT_TRUE(epd.Parse("4k3/8/8/8/8/8/4P3/4K3 b - - 3 12"));
+    ASSERT_EQ("4k3/8/8/8/8/8/4P3/4K3 b - - 3 12", epd.mFen);
+    ASSERT_TRUE(epd.mOperations.empty());
+    ASSERT_FALSE(epd.IsSolution(position.ParseMove("e2e4")));
+
+    // Bad positions and moves
+    ASSERT_FALSE(epd.Parse("4k3/8/8/8/8/8/4P3/4K3 w -"));
+    ASSERT_FALSE(epd.Parse("4k3/8/8/8/8/8/4P3/4K3 w - - bm Qd1;"));
+
+    istringstream input("# comment\n"
+                        "4k3/8/8/8/8/8/4P3/4K3 w - - bm e4; id \"one\";\n"
+                        "\n"
+                        "not a position\n"
+                        "4k3/8/8/8/8/8/4P3/4K3 b - - id \"two\";\r\n");
+    vector<EpdPosition> positions;
+    ASSERT_EQ(1, EpdPosition::Load(input, positions));
+    ASSERT_EQ(2u, positions.size());
+    ASSERT_EQ("one", positions[0].mId);
+    ASSERT_EQ("two", positions[1].mId);
+    ASSERT_EQ(2, positions[0].mLine);
+    ASSERT_EQ(5, positions[1].mLine);
+}
+
+TEST(EpdTest, Runner)
+{
+    // Mates in one, and a queen that should not take a guarded rook
+    istringstream input("6k1/5ppp/8/8/8/8/8/R5K1 w - - bm Ra8#; id \"back rank\";\n"
+                        "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - bm Qxf7#; id \"scholar\";\n"
+                        "k7/8/1K6/8/8/8/8/7R w - - bm Rh8#; id \"ladder\";\n"
+                        "4k3/8/8/8/8/8/3q4/3RK3 b - - am Qxd1+; id \"avoid\";\n"
+                        "2k5/8/2K5/8/8/8/8/7R w - - bm Rh8#; id \"box\";\n");
+    vector<EpdPosition> positions;
+    ASSERT_EQ(0, EpdPosition::Load(input, positions));
+    ASSERT_EQ(5u, positions.size());
+
+    // A position that cannot be set up is reported rather than skipped
+    EpdPosition bad;
+    bad.mFen = "4k3/8/8/8/8/8/8/8 w - - 0 1";
+    bad.mLine = 9;
+    positions.push_back(bad);
+
+    EpdRunnerOptions options;
+    options.mThreads = 3;
+    options.mMoveTime = 0;
+    options.mDepth = 4;
+    options.mHash = 1;
+    EpdRunner runner(options);
+    size_t reported = 0;
+    runner.Run(positions, [&reported](const EpdRunner::Result &) { reported++; });
+
+    ASSERT_EQ(6u, reported);
+    auto const &stats = runner.GetStats();
+    ASSERT_EQ(6u, stats.mPositions);
+    ASSERT_EQ(5u, stats.mSolved);
+    ASSERT_EQ(1u, stats.mErrors);
+    ASSERT_GT(stats.mNodes, 0u);
+
+    auto const &results = runner.GetResults();
+    ASSERT_EQ(6u, results.size());
+    ASSERT_EQ(5u, results[5].mIndex);
+    ASSERT_FALSE(results[5].mSolved);
+    ASSERT_EQ("line 9: invalid FEN \"4k3/8/8/8/8/8/8/8 w - - 0 1\"", results[5].mError);
+    for (size_t i = 0; i < 5; i++)
+    {
+        ASSERT_EQ(i, results[i].mIndex);
+        ASSERT_EQ("", results[i].mError);
+        ASSERT_TRUE(results[i].mSolved) << positions[i].mId;
+        ASSERT_GE(results[i].mSolveTime, 0);
+        ASSERT_GT(results[i].mSolveNodes, 0u);
+        ASSERT_LE(results[i].mSolveNodes, results[i].mNodes);
+    }
+    ASSERT_GT(results[0].mScore, VALUE_MATE_IN_MAX_PLY);
+}
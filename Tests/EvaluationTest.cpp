@@ -0,0 +1,175 @@
+/**
+ * @file EvaluationTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <Bitbase.h>
+#include <Evaluation.h>
+#include <Position.h>
+#include <Tune.h>
+
+using namespace std;
+
+TEST(EvaluationTest, Symmetric)
+{
+    // A position and its color flipped mirror score the same for the side to move
+    Evaluation evaluation;
+    Position position;
+    Position mirror;
+    position.SetFen("r1bqk2r/pp3ppp/2n1pn2/3p4/1bPP4/2N1PN2/PP3PPP/R1BQKB1R w KQkq - 0 1");
+    mirror.SetFen("r1bqkb1r/pp3ppp/2n1pn2/1Bpp4/3P4/2N1PN2/PP3PPP/R1BQK2R b KQkq - 0 1");
+    ASSERT_EQ(evaluation.Evaluate(position), evaluation.Evaluate(mirror));
+}
+
+TEST(EvaluationTest, PawnStructure)
+{
+    Evaluation evaluation;
+    Position position;
+
+    // A passed pawn is worth more than a blocked one
+    position.SetFen("r3k3/8/8/3P4/8/8/8/R3K3 w - - 0 1");
+    int passed = evaluation.Evaluate(position);
+    position.SetFen("r3k3/3p4/8/3P4/8/8/8/R3K3 w - - 0 1");
+    int blocked = evaluation.Evaluate(position) + 100;
+    ASSERT_GT(passed, blocked);
+
+    // Doubled isolated pawns are worse than two connected ones
+    position.SetFen("r3k3/8/8/8/3P4/3P4/8/R3K3 w - - 0 1");
+    int doubled = evaluation.Evaluate(position);
+    position.SetFen("r3k3/8/8/8/3PP3/8/8/R3K3 w - - 0 1");
+    ASSERT_GT(evaluation.Evaluate(position), doubled);
+}
+
+TEST(EvaluationTest, PawnHash)
+{
+    Evaluation evaluation;
+    Position position;
+    position.SetFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    uint64_t pawnKey = position.PawnKey();
+    int score = evaluation.Evaluate(position);
+
+    // Piece moves keep the pawn key, so the structure is found again
+    for (auto uci : {"e5d3", "a6b7", "d3e5", "b7a6"})
+    {
+        position.DoMove(position.ParseMove(uci));
+        evaluation.Evaluate(position);
+    }
+    ASSERT_EQ(pawnKey, position.PawnKey());
+    ASSERT_EQ(score, evaluation.Evaluate(position));
+    // Six probes, only the first one missed
+    ASSERT_EQ(833, evaluation.GetPawnTable().HitRate());
+
+    // A pawn move changes it, undoing the move restores it
+    position.DoMove(position.ParseMove("d5e6"));
+    ASSERT_NE(pawnKey, position.PawnKey());
+    position.UndoMove();
+    ASSERT_EQ(pawnKey, position.PawnKey());
+}
+
+TEST(EvaluationTest, Clear)
+{
+    Evaluation evaluation;
+    Position position;
+    position.SetFen("r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKBNR w KQkq - 0 1");
+    int score = evaluation.Evaluate(position);
+
+    // The bishop pair bonus is part of the cached material balance
+    const TuneParameter *bishopPair = TuneParameter::Find("BishopPair");
+    ASSERT_NE(nullptr, bishopPair);
+    position.SetFen("r1bqk2r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 0 1");
+    int pair = evaluation.Evaluate(position);
+    TuneParameter::Set("BishopPair", bishopPair->mDefault + 100);
+    ASSERT_EQ(pair, evaluation.Evaluate(position));
+    evaluation.Clear();
+    ASSERT_EQ(pair + 100, evaluation.Evaluate(position));
+    TuneParameter::Set("BishopPair", bishopPair->mDefault);
+    evaluation.Clear();
+    ASSERT_EQ(pair, evaluation.Evaluate(position));
+
+    position.SetFen("r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKBNR w KQkq - 0 1");
+    ASSERT_EQ(score, evaluation.Evaluate(position));
+}
+
+TEST(EvaluationTest, Endgames)
+{
+    Evaluation evaluation;
+    Position position;
+
+    // Mating material is a known win for either side to move
+    position.SetFen("8/8/8/4k3/8/8/8/R3K3 w - - 0 1");
+    ASSERT_GT(evaluation.Evaluate(position), VALUE_KNOWN_WIN);
+    position.SetFen("8/8/8/4k3/8/8/8/R3K3 b - - 0 1");
+    ASSERT_LT(evaluation.Evaluate(position), -VALUE_KNOWN_WIN);
+
+    // The lone king is better off in the centre
+    position.SetFen("8/8/8/4k3/8/8/8/R3K3 w - - 0 1");
+    int centre = evaluation.Evaluate(position);
+    position.SetFen("7k/8/8/8/8/8/8/R3K3 w - - 0 1");
+    ASSERT_GT(evaluation.Evaluate(position), centre);
+
+    // Bishop and knight mate in the corner of the bishop's color
+    position.SetFen("7k/8/8/8/8/8/8/2B1KN2 w - - 0 1");
+    int rightCorner = evaluation.Evaluate(position);
+    position.SetFen("k7/8/8/8/8/8/8/2B1KN2 w - - 0 1");
+    ASSERT_GT(rightCorner, evaluation.Evaluate(position));
+
+    // King and pawn, won outside the square and drawn in front of the pawn
+    position.SetFen("k7/8/8/8/7P/8/8/K7 w - - 0 1");
+    ASSERT_GT(evaluation.Evaluate(position), VALUE_KNOWN_WIN);
+    position.SetFen("4k3/8/8/8/4P3/8/8/4K3 w - - 0 1");
+    ASSERT_LT(evaluation.Evaluate(position), PieceValue[PAWN]);
+
+    // The bitbase knows the opposition and the rook pawn, for either color and wing
+    position.SetFen("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1");
+    ASSERT_LT(evaluation.Evaluate(position), -VALUE_KNOWN_WIN);
+    position.SetFen("8/8/8/8/3p4/3k4/8/3K4 w - - 0 1");
+    ASSERT_LT(evaluation.Evaluate(position), -VALUE_KNOWN_WIN);
+    position.SetFen("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1");
+    ASSERT_GT(evaluation.Evaluate(position), VALUE_KNOWN_WIN);
+    position.SetFen("4k3/4P3/4K3/8/8/8/8/8 b - - 0 1");
+    ASSERT_EQ(0, evaluation.Evaluate(position));
+    position.SetFen("7k/8/8/8/8/8/7P/7K w - - 0 1");
+    ASSERT_EQ(0, evaluation.Evaluate(position));
+    position.SetFen("8/p7/8/8/8/8/8/k1K5 b - - 0 1");
+    ASSERT_EQ(0, evaluation.Evaluate(position));
+
+    // A pawn on the first or last rank is outside the bitbase
+    ASSERT_FALSE(position.SetFen("4k3/8/8/8/8/8/8/K3P3 w - - 0 1"));
+    InitKpkBitbase();
+    ASSERT_FALSE(ProbeKpk(MakeSquare(0, 0), MakeSquare(3, 0), MakeSquare(4, 7), true));
+    ASSERT_FALSE(ProbeKpk(MakeSquare(0, 0), MakeSquare(3, 7), MakeSquare(4, 5), true));
+
+    // A minor piece up without pawns is a draw
+    position.SetFen("8/8/4k3/8/8/3BK3/8/8 w - - 0 1");
+    ASSERT_EQ(0, evaluation.Evaluate(position));
+    position.SetFen("8/8/4k3/8/8/3BKn2/8/8 w - - 0 1");
+    ASSERT_EQ(0, evaluation.Evaluate(position));
+
+    // Opposite colored bishops halve a pawn advantage or more
+    position.SetFen("4k1b1/8/8/8/8/8/PP6/2B1K3 w - - 0 1");
+    int opposite = evaluation.Evaluate(position);
+    position.SetFen("4kb2/8/8/8/8/8/PP6/2B1K3 w - - 0 1");
+    ASSERT_LE(opposite * 2, evaluation.Evaluate(position));
+}
+
+TEST(EvaluationTest, MaterialKey)
+{
+    // The material key ignores where the pieces stand
+    Position position;
+    Position moved;
+    moved.SetFen("rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 1 1");
+    ASSERT_EQ(position.MaterialKey(), moved.MaterialKey());
+
+    position.SetFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    uint64_t key = position.MaterialKey();
+    position.DoMove(position.ParseMove("e5f7"));
+    ASSERT_NE(key, position.MaterialKey());
+    Position direct;
+    direct.SetFen(position.GetFen());
+    ASSERT_EQ(direct.MaterialKey(), position.MaterialKey());
+    position.UndoMove();
+    ASSERT_EQ(key, position.MaterialKey());
+}
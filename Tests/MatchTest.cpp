@@ -0,0 +1,176 @@
+/**
+ * @file MatchTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <Match.h>
+#include <UciProcess.h>
+
+using namespace std;
+
+/// An engine that plays fool's mate, whichever side it has
+const string FoolScript = "while read -r command rest; do\n"
+                          "  case \"$command\" in\n"
+                          "    uci) echo 'id name Fool'; echo uciok ;;\n"
+                          "    isready) echo readyok ;;\n"
+                          "    position) set -- $rest; if [ $# -gt 7 ]; then moves=$(($# - 8)); else moves=0; fi ;;\n"
+                          "    go) echo 'info depth 1 score cp 0'\n"
+                          "        case $moves in 0) echo 'bestmove f2f3' ;; 1) echo 'bestmove e7e5' ;;\n"
+                          "        2) echo 'bestmove g2g4' ;; *) echo 'bestmove d8h4' ;; esac ;;\n"
+                          "    quit) exit 0 ;;\n"
+                          "  esac\n"
+                          "done\n";
+
+/// An engine that never answers "go"
+const string SleeperScript = "while read -r command rest; do\n"
+                             "  case \"$command\" in\n"
+                             "    uci) echo 'id name Sleeper'; echo uciok ;;\n"
+                             "    isready) echo readyok ;;\n"
+                             "    quit) exit 0 ;;\n"
+                             "  esac\n"
+                             "done\n";
+
+/**
+ * Write a script engine to a file
+ * @param path The file
+ * @param script The script
+ * @return Command that runs it
+ */
+static vector<string> ScriptEngine(const string &path, const string &script)
+{
+    ofstream file(path);
+    file << script;
+    return {"sh", path};
+}
+
+TEST(MatchTest, Process)
+{
+#ifdef _WIN32
+    GTEST_SKIP() << "the script engines need a POSIX shell";
+#endif
+    UciProcess process;
+    ASSERT_FALSE(process.IsRunning());
+    ASSERT_TRUE(process.Start(ScriptEngine("MatchTestFool.sh", FoolScript)));
+    ASSERT_TRUE(process.IsRunning());
+
+    string name;
+    ASSERT_TRUE(process.Handshake(&name));
+    ASSERT_EQ("Fool", name);
+    ASSERT_TRUE(process.Send("isready"));
+    ASSERT_TRUE(process.WaitFor("readyok", 1000));
+
+    ASSERT_TRUE(process.Send("position fen rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 moves e2e4"));
+    ASSERT_TRUE(process.Send("go"));
+    string line;
+    ASSERT_TRUE(process.WaitFor("bestmove", 1000, &line));
+    ASSERT_EQ("bestmove e7e5", line);
+
+    // Nothing more to read
+    ASSERT_FALSE(process.ReadLine(line, 50));
+
+    process.Close();
+    ASSERT_FALSE(process.IsRunning());
+    ASSERT_FALSE(process.Send("isready"));
+    remove("MatchTestFool.sh");
+
+    // Writing to an engine that has exited fails instead of ending the test with SIGPIPE
+    ASSERT_TRUE(process.Start({"sh", "-c", "exit 0"}));
+    for (int i = 0; i < 1000 && process.IsRunning(); i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    ASSERT_FALSE(process.IsRunning());
+    ASSERT_FALSE(process.Send("isready"));
+}
+
+TEST(MatchTest, Pairs)
+{
+#ifdef _WIN32
+    GTEST_SKIP() << "the script engines need a POSIX shell";
+#endif
+    string pgnPath = "MatchTest.pgn";
+    remove(pgnPath.c_str());
+
+    MatchOptions options;
+    options.mEngines[0].mCommand = ScriptEngine("MatchTestFool.sh", FoolScript);
+    options.mEngines[0].mName = "First";
+    options.mEngines[1].mCommand = options.mEngines[0].mCommand;
+    options.mGames = 4;
+    options.mConcurrency = 2;
+    options.mPgnPath = pgnPath;
+    Match match(options);
+    ASSERT_TRUE(match.LoadOpenings());
+
+    int games = 0;
+    ASSERT_TRUE(match.Run([&games](const Match::GameResult &result) {
+        games++;
+        ASSERT_EQ("checkmate", result.mReason);
+        ASSERT_EQ("0-1", result.mResult);
+        ASSERT_EQ(result.mFirstIsWhite ? 0 : 2, result.mScore);
+        ASSERT_EQ(4, result.mPlies);
+    }));
+    ASSERT_EQ(4, games);
+
+    // White always loses, so each pair is split
+    auto const &stats = match.GetStats();
+    ASSERT_EQ(2u, stats.mWins);
+    ASSERT_EQ(2u, stats.mLosses);
+    ASSERT_EQ(0u, stats.mDraws);
+    ASSERT_EQ(2u, stats.mPairs[2]);
+    ASSERT_EQ(0u, stats.mCrashes);
+
+    ifstream file(pgnPath);
+    PgnReader reader(file);
+    PgnGame game;
+    int read = 0;
+    while (reader.Next(game))
+    {
+        read++;
+        ASSERT_EQ("0-1", game.mResult);
+        ASSERT_EQ((vector<string>{"f3", "e5", "g4", "Qh4#"}), game.mMoves);
+        ASSERT_TRUE(game.Tag("White") == "First" || game.Tag("Black") == "First");
+        ASSERT_TRUE(game.Tag("White") == "Fool" || game.Tag("Black") == "Fool");
+        ASSERT_EQ("10+0.1", game.Tag("TimeControl"));
+    }
+    ASSERT_EQ(4, read);
+    file.close();
+    remove(pgnPath.c_str());
+    remove("MatchTestFool.sh");
+}
+
+TEST(MatchTest, Forfeit)
+{
+#ifdef _WIN32
+    GTEST_SKIP() << "the script engines need a POSIX shell";
+#endif
+    MatchOptions options;
+    options.mEngines[0].mCommand = ScriptEngine("MatchTestFool.sh", FoolScript);
+    options.mEngines[1].mCommand = ScriptEngine("MatchTestSleeper.sh", SleeperScript);
+    options.mGames = 2;
+    options.mTimeControl.mMoveTime = 50;
+    options.mTimeControl.mMargin = 50;
+    Match match(options);
+    ASSERT_TRUE(match.Run());
+
+    auto const &stats = match.GetStats();
+    ASSERT_EQ(2u, stats.mWins);
+    ASSERT_EQ(2u, stats.mTimeLosses);
+    ASSERT_EQ(1u, stats.mPairs[4]);
+
+    // An engine that cannot be started fails the match
+    options.mEngines[1].mCommand = {"no-such-engine-anywhere"};
+    Match failed(options);
+    ASSERT_FALSE(failed.Run());
+    ASSERT_EQ(0u, failed.GetStats().Games());
+    remove("MatchTestFool.sh");
+    remove("MatchTestSleeper.sh");
+}
@@ -0,0 +1,211 @@
+/**
+ * @file NnueTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include <AccumulatorStack.h>
+#include <Nnue.h>
+#include <Position.h>
+
+using namespace std;
+
+/**
+ * Write random little endian values to a stream
+ * @param stream Stream to write
+ * @param count Number of values
+ * @param bytes Size of each value
+ * @param low Smallest value
+ * @param high Largest value
+ * @param random Random number generator
+ */
+static void WriteRandom(ostream &stream, size_t count, int bytes, int low, int high, mt19937 &random)
+{
+    uniform_int_distribution<int> distribution(low, high);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t value = uint32_t(distribution(random));
+        for (int b = 0; b < bytes; b++)
+        {
+            stream.put(char(value >> (8 * b)));
+        }
+    }
+}
+
+/**
+ * Make a network file with random weights
+ * @param seed Random seed
+ * @return The file contents
+ */
+static string RandomNetwork(unsigned seed)
+{
+    mt19937 random(seed);
+    ostringstream stream;
+    for (uint32_t value : {NnueMagic, NnueVersion, uint32_t(NnueFeatures), uint32_t(NnueHalfDims),
+                           uint32_t(NnueHidden1), uint32_t(NnueHidden2)})
+    {
+        WriteRandom(stream, 1, 4, int(value), int(value), random);
+    }
+    WriteRandom(stream, NnueHalfDims, 2, -60, 60, random);
+    WriteRandom(stream, size_t(NnueFeatures) * NnueHalfDims, 2, -40, 40, random);
+    WriteRandom(stream, NnueHidden1, 4, -3000, 3000, random);
+    WriteRandom(stream, NnueHidden1 * 2 * NnueHalfDims, 1, -128, 127, random);
+    WriteRandom(stream, NnueHidden2, 4, -3000, 3000, random);
+    WriteRandom(stream, NnueHidden2 * NnueHidden1, 1, -128, 127, random);
+    WriteRandom(stream, 1, 4, -3000, 3000, random);
+    WriteRandom(stream, NnueHidden2, 1, -128, 127, random);
+    return stream.str();
+}
+
+/**
+ * Evaluate every node of the move tree with the accumulator stack
+ * and check it against computing the network from scratch
+ * @param network The network
+ * @param stack Accumulator stack for the network
+ * @param position Position to start from
+ * @param depth Depth in half moves
+ */
+static void CheckTree(const Network &network, AccumulatorStack &stack, Position &position, int depth)
+{
+    ASSERT_EQ(network.Evaluate(position), stack.Evaluate(position)) << position.GetFen();
+    if (depth == 0)
+    {
+        return;
+    }
+
+    MoveList moves;
+    position.GenerateLegalMoves(moves);
+    for (Move move : moves)
+    {
+        position.DoMove(move);
+        CheckTree(network, stack, position, depth - 1);
+        position.UndoMove();
+    }
+
+    if (!position.InCheck())
+    {
+        position.DoNullMove();
+        ASSERT_EQ(network.Evaluate(position), stack.Evaluate(position)) << position.GetFen();
+        position.UndoNullMove();
+    }
+}
+
+TEST(NnueTest, Load)
+{
+    Network network;
+    ASSERT_FALSE(network.IsLoaded());
+
+    string file = RandomNetwork(1);
+    istringstream stream(file);
+    ASSERT_TRUE(network.Load(stream));
+    ASSERT_TRUE(network.IsLoaded());
+
+    // Truncated and foreign files are refused
+    Network other;
+    istringstream truncated(file.substr(0, file.size() - 1));
+    ASSERT_FALSE(other.Load(truncated));
+    istringstream foreign("not a network at all");
+    ASSERT_FALSE(other.Load(foreign));
+    ASSERT_FALSE(other.IsLoaded());
+    ASSERT_FALSE(other.Load("no such file.nnue"));
+}
+
+TEST(NnueTest, MappedFile)
+{
+    // A mapped file evaluates exactly like one read from a stream
+    string file = RandomNetwork(5);
+    string path = (filesystem::temp_directory_path() / "NnueTest.nnue").string();
+    {
+        ofstream output(path, ios::binary);
+        output.write(file.data(), streamsize(file.size()));
+    }
+
+    Network mapped;
+    ASSERT_TRUE(mapped.Load(path));
+    istringstream stream(file);
+    Network read;
+    ASSERT_TRUE(read.Load(stream));
+
+    Position position;
+    position.SetFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    ASSERT_EQ(read.Evaluate(position), mapped.Evaluate(position));
+
+    // Loading another network releases the mapping
+    istringstream other(RandomNetwork(6));
+    ASSERT_TRUE(mapped.Load(other));
+    filesystem::remove(path);
+    ASSERT_FALSE(Network().Load(path));
+}
+
+TEST(NnueTest, Kernels)
+{
+    // Every instruction set computes exactly what the scalar code does
+    istringstream stream(RandomNetwork(2));
+    Network network;
+    ASSERT_TRUE(network.Load(stream));
+
+    const char *fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    };
+    for (auto fen : fens)
+    {
+        Position position;
+        position.SetFen(fen);
+        network.SetSimdLevel(SIMD_SCALAR);
+        int expected = network.Evaluate(position);
+        for (SimdLevel level : {SIMD_SSE41, SIMD_AVX2, SIMD_AVX512})
+        {
+            network.SetSimdLevel(level);
+            ASSERT_EQ(expected, network.Evaluate(position)) << fen << " " << network.KernelName();
+        }
+    }
+}
+
+TEST(NnueTest, Symmetric)
+{
+    // Black sees the board flipped, so a color flipped mirror scores the same
+    istringstream stream(RandomNetwork(3));
+    Network network;
+    ASSERT_TRUE(network.Load(stream));
+
+    Position position;
+    Position mirror;
+    position.SetFen("r1bqk2r/pp3ppp/2n1pn2/3p4/1bPP4/2N1PN2/PP3PPP/R1BQKB1R w KQkq - 0 1");
+    mirror.SetFen("r1bqkb1r/pp3ppp/2n1pn2/1Bpp4/3P4/2N1PN2/PP3PPP/R1BQK2R b KQkq - 0 1");
+    ASSERT_EQ(network.Evaluate(position), network.Evaluate(mirror));
+}
+
+TEST(NnueTest, Incremental)
+{
+    // Castling, en passant, promotions and king moves all update correctly
+    istringstream stream(RandomNetwork(4));
+    Network network;
+    ASSERT_TRUE(network.Load(stream));
+    AccumulatorStack stack;
+    stack.SetNetwork(&network);
+
+    const char *fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/8/8/2k5/3Pp3/8/8/4K2Q b - d3 0 1",
+    };
+    for (auto fen : fens)
+    {
+        Position position;
+        position.SetFen(fen);
+        CheckTree(network, stack, position, 2);
+    }
+
+    // Most halves come from the ply before rather than a refresh
+    ASSERT_GT(stack.Updates(), stack.Refreshes() * 4);
+}
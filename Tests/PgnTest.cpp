@@ -0,0 +1,194 @@
+/**
+ * @file PgnTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <Pgn.h>
+#include <Position.h>
+
+using namespace std;
+
+/// Two games, the second with no tags and no result before the third
+const char *TestPgn =
+    "[Event \"Test \\\"match\\\"\"]\r\n"
+    "[White \"A\"]\r\n"
+    "[Result \"1-0\"]\r\n"
+    "\r\n"
+    "1. e4 e5 2.Nf3 {a comment\r\n"
+    "over two lines} Nc6 (2... d6 3. d4 (3. Bc4)) 3. Bb5 $1 a6 ; rest of line\r\n"
+    "4... Nf6 1-0\r\n"
+    "\r\n"
+    "1. d4 d5 2. c4\r\n"
+    "[Event \"Third\"]\r\n"
+    "[FEN \"4k3/8/8/8/8/8/4P3/4K3 w - - 0 1\"]\r\n"
+    "1. e4 1/2-1/2\r\n";
+
+TEST(PgnTest, Reader)
+{
+    istringstream input(TestPgn);
+    PgnReader reader(input);
+    PgnGame game;
+
+    ASSERT_TRUE(reader.Next(game));
+    ASSERT_EQ("Test \"match\"", game.Tag("Event"));
+    ASSERT_EQ("A", game.Tag("White"));
+    ASSERT_EQ("", game.Tag("Black"));
+    ASSERT_EQ("1-0", game.mResult);
+    ASSERT_EQ((vector<string>{"e4", "e5", "Nf3", "Nc6", "Bb5", "a6", "Nf6"}), game.mMoves);
+
+    ASSERT_TRUE(reader.Next(game));
+    ASSERT_TRUE(game.mTags.empty());
+    ASSERT_EQ("*", game.mResult);
+    ASSERT_EQ((vector<string>{"d4", "d5", "c4"}), game.mMoves);
+
+    ASSERT_TRUE(reader.Next(game));
+    ASSERT_EQ("Third", game.Tag("Event"));
+    ASSERT_EQ("1/2-1/2", game.mResult);
+    ASSERT_EQ(1u, game.mMoves.size());
+
+    ASSERT_FALSE(reader.Next(game));
+}
+
+TEST(PgnTest, Replay)
+{
+    // The moves of a game replay with the SAN parser
+    istringstream input("1. e4 e5 2. Nf3 Nc6 3. Bb5 a6 4. Ba4 Nf6 5. O-O Be7 6. Re1 b5 7. Bb3 d6\n"
+                        "8. c3 O-O 9. h3 Nb8 10. d4 Nbd7 11. c4 c6 12. cxb5 axb5 13. Nc3 Bb7\n"
+                        "14. Bg5 b4 15. Nb1 h6 16. Bh4 c5 17. dxe5 Nxe4 18. Bxe7 Qxe7 19. exd6 Qf6 1-0\n");
+    PgnReader reader(input);
+    PgnGame game;
+    ASSERT_TRUE(reader.Next(game));
+
+    Position position;
+    for (auto const &san : game.mMoves)
+    {
+        Move move = position.ParseSan(san);
+        ASSERT_TRUE(move.IsValid()) << san;
+        position.DoMove(move);
+    }
+    ASSERT_EQ("r4rk1/1b1n1pp1/3P1q1p/2p5/1p2n3/1B3N1P/PP3PP1/RN1QR1K1 w - - 1 20", position.GetFen());
+}
+
+TEST(PgnTest, TextReader)
+{
+    // Reading text gives the same games, and where each starts
+    string text = TestPgn;
+    PgnReader reader(text);
+    PgnGame game;
+
+    ASSERT_TRUE(reader.Next(game));
+    ASSERT_EQ(0u, reader.GameOffset());
+    ASSERT_EQ(7u, game.mMoves.size());
+
+    ASSERT_TRUE(reader.Next(game));
+    ASSERT_EQ(text.find("\r\n\r\n1. d4") + 2, reader.GameOffset());
+    ASSERT_EQ((vector<string>{"d4", "d5", "c4"}), game.mMoves);
+
+    ASSERT_TRUE(reader.Next(game));
+    ASSERT_EQ(text.find("[Event \"Third"), reader.GameOffset());
+    ASSERT_EQ("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1", game.Tag("FEN"));
+
+    ASSERT_FALSE(reader.Next(game));
+}
+
+TEST(PgnTest, Write)
+{
+    istringstream input(TestPgn);
+    PgnReader reader(input);
+    PgnGame game;
+    ASSERT_TRUE(reader.Next(game));
+
+    ostringstream output;
+    game.Write(output);
+    ASSERT_EQ("[Event \"Test \\\"match\\\"\"]\n[White \"A\"]\n[Result \"1-0\"]\n\n"
+              "1. e4 e5 2. Nf3 Nc6 3. Bb5 a6 4. Nf6 1-0\n\n", output.str());
+
+    // A game from a FEN with black to move starts with "n..."
+    game.Clear();
+    game.mTags.emplace_back("FEN", "4k3/8/8/8/8/8/4P3/4K3 b - - 0 12");
+    game.mMoves = {"Kd7", "e4", "Kc6"};
+    output.str("");
+    game.Write(output);
+    ASSERT_NE(string::npos, output.str().find("12... Kd7 13. e4 Kc6 *\n"));
+
+    // Long games are wrapped, and read back the same
+    game.Clear();
+    for (int i = 0; i < 50; i++)
+    {
+        game.mMoves.insert(game.mMoves.end(), {"Nf3", "Nf6", "Ng1", "Ng8"});
+    }
+    output.str("");
+    game.Write(output);
+    istringstream line(output.str());
+    string text;
+    while (getline(line, text))
+    {
+        ASSERT_LE(text.size(), 79u);
+    }
+    istringstream again(output.str());
+    PgnReader reread(again);
+    PgnGame copy;
+    ASSERT_TRUE(reread.Next(copy));
+    ASSERT_EQ(game.mMoves, copy.mMoves);
+}
+
+TEST(PgnTest, Parser)
+{
+    string path = (filesystem::temp_directory_path() / "PgnTest.pgn").string();
+    {
+        ofstream output(path, ios::binary);
+        for (int i = 0; i < 200; i++)
+        {
+            output << TestPgn;
+        }
+        // Ke7 is blocked by the pawn
+        output << "[Event \"Bad\"]\n\n1. e4 Ke7 2. Nf3 *\n";
+    }
+
+    for (int threads : {1, 4})
+    {
+        PgnParser parser(threads);
+        vector<ParsedGame> games;
+        ASSERT_TRUE(parser.Load(path, games));
+        ASSERT_EQ(601u, games.size());
+        ASSERT_EQ(601u, parser.GetStats().mGames);
+        // The first game of each copy has white play "4... Nf6"
+        ASSERT_EQ(201u, parser.GetStats().mBadGames);
+        ASSERT_EQ(200u * 10 + 1, parser.GetStats().mPositions);
+
+        for (size_t i = 1; i < games.size(); i++)
+        {
+            ASSERT_LT(games[i - 1].mOffset, games[i].mOffset);
+        }
+        ASSERT_EQ("Test \"match\"", games[0].mGame.Tag("Event"));
+        ASSERT_EQ(Position::StartFen, games[0].mStartFen);
+        ASSERT_FALSE(games[0].mComplete);
+        ASSERT_EQ(6u, games[0].mMoves.size());
+        ASSERT_TRUE(games[4].mComplete);
+        ASSERT_EQ(3u, games[4].mMoves.size());
+        ASSERT_EQ("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1", games[5].mStartFen);
+
+        Position position;
+        ASSERT_TRUE(position.SetFen(games[5].mStartFen));
+        ASSERT_EQ(position.ParseSan("e4"), games[5].mMoves[0]);
+
+        ASSERT_FALSE(games[600].mComplete);
+        ASSERT_EQ(1u, games[600].mMoves.size());
+    }
+
+    // An empty file has no games, a missing one cannot be read
+    ofstream(path, ios::binary | ios::trunc).close();
+    PgnParser parser(2);
+    vector<ParsedGame> games;
+    ASSERT_TRUE(parser.Load(path, games));
+    ASSERT_TRUE(games.empty());
+    filesystem::remove(path);
+    ASSERT_FALSE(parser.Load(path, games));
+}
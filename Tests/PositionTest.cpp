@@ -0,0 +1,442 @@
+/**
+ * @file PositionTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <Position.h>
+
+using namespace std;
+
+/**
+ * Count the leaf nodes of the legal move tree
+ * @param position Position to count from
+ * @param depth Depth in half moves
+ * @return Number of leaves
+ */
+static uint64_t Perft(Position &position, int depth)
+{
+    MoveList moves;
+    position.GenerateLegalMoves(moves);
+    if (depth == 1)
+    {
+        return moves.Size();
+    }
+
+    uint64_t nodes = 0;
+    for (Move move : moves)
+    {
+        position.DoMove(move);
+        nodes += Perft(position, depth - 1);
+        position.UndoMove();
+    }
+    return nodes;
+}
+
+TEST(PositionTest, Fen)
+{
+    Position position;
+    ASSERT_EQ(Position::StartFen, position.GetFen());
+
+    const string fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b Kq - 3 17";
+    ASSERT_TRUE(position.SetFen(fen));
+    ASSERT_EQ(fen, position.GetFen());
+    ASSERT_EQ(BLACK, position.SideToMove());
+    ASSERT_EQ(WHITE_OO | BLACK_OOO, position.CastlingRights());
+
+    ASSERT_FALSE(position.SetFen("not a fen"));
+
+    // The en passant square must be behind a pawn that just moved two squares
+    ASSERT_TRUE(position.SetFen("rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3"));
+    ASSERT_EQ(MakeSquare(3, 5), position.EnPassantSquare());
+    ASSERT_FALSE(position.SetFen("rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d3 0 3"));
+    ASSERT_FALSE(position.SetFen("rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq d6 0 3"));
+    ASSERT_FALSE(position.SetFen("rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 3"));
+    ASSERT_FALSE(position.SetFen("rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d9 0 3"));
+    ASSERT_TRUE(position.SetFen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"));
+
+    // Castling rights need the king and the rook on their squares
+    ASSERT_FALSE(position.SetFen("r3k2r/8/8/8/8/8/8/R3K1R1 w K - 0 1"));
+    ASSERT_FALSE(position.SetFen("r3k2r/8/8/8/8/8/8/R4K1R w Q - 0 1"));
+    ASSERT_FALSE(position.SetFen("1r2k2r/8/8/8/8/8/8/R3K2R w q - 0 1"));
+    ASSERT_FALSE(position.SetFen("r3k2r/8/8/8/8/8/8/R3K2r w K - 0 1"));
+    ASSERT_TRUE(position.SetFen("1r2k2r/8/8/8/8/8/8/R3K2R w KQk - 0 1"));
+    ASSERT_EQ(WHITE_OO | WHITE_OOO | BLACK_OO, position.CastlingRights());
+
+    // Pawns never stand on the first or last rank
+    ASSERT_FALSE(position.SetFen("4k3/8/8/8/8/8/8/K3P3 w - - 0 1"));
+    ASSERT_FALSE(position.SetFen("K3P3/8/8/8/8/8/8/4k3 w - - 0 1"));
+    ASSERT_FALSE(position.SetFen("4k3/8/8/8/8/8/8/K3p3 b - - 0 1"));
+
+    // A rejected FEN leaves the position as it was
+    ASSERT_FALSE(position.SetFen("1r2k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1"));
+    ASSERT_EQ("1r2k2r/8/8/8/8/8/8/R3K2R w KQk - 0 1", position.GetFen());
+}
+
+TEST(PositionTest, DoUndo)
+{
+    Position position;
+    uint64_t key = position.Key();
+
+    position.DoMove(position.ParseMove("e2e4"));
+    position.DoMove(position.ParseMove("d7d5"));
+    position.DoMove(position.ParseMove("e4d5"));
+    ASSERT_EQ("rnbqkbnr/ppp1pppp/8/3P4/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", position.GetFen());
+
+    ASSERT_EQ(7, position.PieceCount(BLACK_PAWN));
+    ASSERT_EQ(8, position.PieceCount(WHITE_PAWN));
+
+    // The key is the same no matter how a position was reached
+    Position direct;
+    direct.SetFen(position.GetFen());
+    ASSERT_EQ(direct.Key(), position.Key());
+
+    position.UndoMove();
+    position.UndoMove();
+    position.UndoMove();
+    ASSERT_EQ(Position::StartFen, position.GetFen());
+    ASSERT_EQ(key, position.Key());
+    ASSERT_EQ(8, position.PieceCount(BLACK_PAWN));
+    ASSERT_EQ(MakeSquare(4, 7), position.KingSquare(BLACK));
+}
+
+TEST(PositionTest, Perft)
+{
+    Position position;
+    ASSERT_EQ(20u, Perft(position, 1));
+    ASSERT_EQ(8902u, Perft(position, 3));
+    ASSERT_EQ(197281u, Perft(position, 4));
+
+    // Castling, en passant and promotions
+    position.SetFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    ASSERT_EQ(97862u, Perft(position, 3));
+
+    position.SetFen("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    ASSERT_EQ(43238u, Perft(position, 4));
+
+    position.SetFen("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    ASSERT_EQ(9467u, Perft(position, 3));
+}
+
+TEST(PositionTest, GenTypes)
+{
+    // Captures and quiets split the pseudo-legal moves between them
+    Position position;
+    position.SetFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    MoveList captures, quiets, all;
+    position.GenerateMoves<CAPTURES>(captures);
+    position.GenerateMoves<QUIETS>(quiets);
+    position.GenerateMoves<NON_EVASIONS>(all);
+    ASSERT_EQ(all.Size(), captures.Size() + quiets.Size());
+    for (Move move : captures)
+    {
+        ASSERT_TRUE(all.Contains(move));
+        ASSERT_FALSE(quiets.Contains(move));
+    }
+    for (Move move : quiets)
+    {
+        ASSERT_TRUE(all.Contains(move));
+    }
+
+    // Only the rooks can check, by reaching the eighth rank
+    position.SetFen("4k3/8/8/8/8/8/4P3/RN2K1NR w - - 0 1");
+    MoveList checks;
+    position.GenerateMoves<QUIET_CHECKS>(checks);
+    ASSERT_EQ(2, checks.Size());
+    ASSERT_TRUE(checks.Contains(position.ParseMove("a1a8")));
+    ASSERT_TRUE(checks.Contains(position.ParseMove("h1h8")));
+
+    // Double check, only king moves are generated
+    position.SetFen("4k3/8/5N2/8/8/8/8/4R1K1 b - - 0 1");
+    MoveList evasions;
+    position.GenerateMoves<EVASIONS>(evasions);
+    ASSERT_FALSE(evasions.Empty());
+    for (Move move : evasions)
+    {
+        ASSERT_EQ(position.KingSquare(BLACK), move.From());
+    }
+}
+
+TEST(PositionTest, Draws)
+{
+    Position position;
+    for (auto uci : {"g1f3", "g8f6", "f3g1"})
+    {
+        position.DoMove(position.ParseMove(uci));
+        ASSERT_FALSE(position.IsRepetition());
+    }
+
+    // Back to the start position, which the search scores as a draw but the game goes on
+    position.DoMove(position.ParseMove("f6g8"));
+    ASSERT_TRUE(position.IsRepetition());
+    ASSERT_FALSE(position.IsRepetition(2));
+    ASSERT_EQ(GAME_ONGOING, position.GetGameStatus());
+
+    // The third time it is over
+    for (auto uci : {"g1f3", "g8f6", "f3g1", "f6g8"})
+    {
+        ASSERT_NE(GAME_REPETITION, position.GetGameStatus());
+        position.DoMove(position.ParseMove(uci));
+    }
+    ASSERT_TRUE(position.IsRepetition(2));
+    ASSERT_EQ(GAME_REPETITION, position.GetGameStatus());
+
+    // A null move is not a move of the game, the positions before it do not repeat
+    position.SetFen(Position::StartFen);
+    position.DoMove(position.ParseMove("g1f3"));
+    position.DoNullMove();
+    position.DoMove(position.ParseMove("f3g1"));
+    position.DoNullMove();
+    ASSERT_FALSE(position.IsRepetition());
+
+    // Those after it still do
+    for (auto uci : {"g1f3", "g8f6", "f3g1", "f6g8"})
+    {
+        position.DoMove(position.ParseMove(uci));
+    }
+    ASSERT_TRUE(position.IsRepetition());
+    ASSERT_FALSE(position.IsRepetition(2));
+
+    position.SetFen("8/8/4k3/8/8/3NK3/8/8 w - - 0 1");
+    ASSERT_TRUE(position.IsInsufficientMaterial());
+    position.SetFen("8/8/4k3/8/8/3RK3/8/8 w - - 0 1");
+    ASSERT_FALSE(position.IsInsufficientMaterial());
+}
+
+TEST(PositionTest, GameStatus)
+{
+    Position position;
+    ASSERT_TRUE(position.HasLegalMove());
+    ASSERT_EQ(GAME_ONGOING, position.GetGameStatus());
+
+    // Back rank mate
+    position.SetFen("R5k1/5ppp/8/8/8/8/5PPP/6K1 b - - 0 1");
+    ASSERT_FALSE(position.HasLegalMove());
+    ASSERT_EQ(GAME_CHECKMATE, position.GetGameStatus());
+
+    position.SetFen("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    ASSERT_EQ(GAME_STALEMATE, position.GetGameStatus());
+
+    // Mate on the hundredth half move is still mate
+    position.SetFen("R5k1/5ppp/8/8/8/8/5PPP/6K1 b - - 100 80");
+    ASSERT_EQ(GAME_CHECKMATE, position.GetGameStatus());
+    position.SetFen("6k1/5ppp/8/8/8/8/5PPP/R5K1 b - - 100 80");
+    ASSERT_EQ(GAME_FIFTY_MOVES, position.GetGameStatus());
+
+    position.SetFen("8/8/4k3/8/8/3NK3/8/8 w - - 0 1");
+    ASSERT_EQ(GAME_INSUFFICIENT, position.GetGameStatus());
+
+    // Only a pawn, a pinned piece or a check evasion can move, or nothing can
+    for (auto fen : {"7k/8/6Q1/8/8/8/P7/K7 b - - 0 1", "k7/P7/1K6/8/8/8/8/8 b - - 0 1",
+                     "7k/8/8/8/3b4/8/8/R3K1r1 w - - 0 1", "4k3/8/8/8/4r3/8/4R3/4K3 w - - 0 1",
+                     "8/8/8/8/8/5k2/5p2/5K2 w - - 0 1", "K7/2k5/8/8/8/8/8/1r6 w - - 0 1",
+                     "1k6/8/1K6/8/8/8/8/2Q5 w - - 0 1", "3k4/3P4/3K4/8/8/8/8/8 b - - 0 1",
+                     "8/8/8/8/8/8/p7/k1K5 b - - 0 1", "r3k3/8/8/8/8/8/8/BN2K3 w - - 0 1"})
+    {
+        position.SetFen(fen);
+        MoveList moves;
+        position.GenerateLegalMoves(moves);
+        ASSERT_EQ(!moves.Empty(), position.HasLegalMove()) << fen;
+    }
+}
+
+TEST(PositionTest, GivesCheck)
+{
+    // Direct, discovered, promotion, en passant and castling checks
+    // must all agree with making the move
+    const char *fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/8/8/K2pP2q/8/8/8/7k w - d6 0 1",
+        "5k2/8/8/8/8/8/8/4K2R w K - 0 1",
+        "3k4/1P6/8/8/8/8/3B4/R3K3 w Q - 0 1",
+    };
+    for (auto fen : fens)
+    {
+        Position position;
+        ASSERT_TRUE(position.SetFen(fen));
+        MoveList moves;
+        position.GenerateLegalMoves(moves);
+        for (Move move : moves)
+        {
+            bool givesCheck = position.GivesCheck(move);
+            position.DoMove(move);
+            ASSERT_EQ(position.InCheck(), givesCheck) << fen << " " << move.ToUci();
+            position.UndoMove();
+        }
+    }
+
+    // Quiet discovered checks by a knight blocking the rook
+    Position position;
+    position.SetFen("4k3/8/8/8/4N3/8/8/4R1K1 w - - 0 1");
+    MoveList checks;
+    position.GenerateMoves<QUIET_CHECKS>(checks);
+    ASSERT_EQ(8, checks.Size());
+    ASSERT_TRUE(checks.Contains(position.ParseMove("e4c3")));
+}
+
+TEST(PositionTest, PseudoLegal)
+{
+    // Every encodable move is accepted exactly when the generator
+    // would produce it, and IsLegal agrees with making the move
+    const char *fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/8/8/2k5/3Pp3/8/8/4K2Q b - d3 0 1",
+        "4k3/8/5N2/8/8/8/8/4R1K1 b - - 0 1",
+        "r3k2r/8/8/8/8/8/8/R3K1r1 w Qkq - 0 1",
+    };
+    for (auto fen : fens)
+    {
+        Position position;
+        ASSERT_TRUE(position.SetFen(fen));
+        MoveList generated;
+        if (position.InCheck())
+        {
+            position.GenerateMoves<EVASIONS>(generated);
+        }
+        else
+        {
+            position.GenerateMoves<NON_EVASIONS>(generated);
+        }
+
+        for (int from = 0; from < SQUARE_NB; from++)
+        {
+            for (int to = 0; to < SQUARE_NB; to++)
+            {
+                Move moves[] = {Move(from, to), Move::Make(from, to, Move::EN_PASSANT),
+                    Move::Make(from, to, Move::CASTLING), Move::Make(from, to, Move::PROMOTION, QUEEN),
+                    Move::Make(from, to, Move::PROMOTION, KNIGHT)};
+                for (Move move : moves)
+                {
+                    ASSERT_EQ(generated.Contains(move), position.IsPseudoLegal(move)) << fen << " " << move.ToUci();
+                    if (generated.Contains(move))
+                    {
+                        bool legal = position.IsLegal(move);
+                        position.DoMove(move);
+                        ASSERT_EQ(position.LastMoveWasLegal(), legal) << fen << " " << move.ToUci();
+                        position.UndoMove();
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(PositionTest, ParseSan)
+{
+    Position position;
+    position.SetFen("r3k2r/1P6/8/3pP3/8/2N3N1/8/R3K2R w KQkq d6 0 1");
+    ASSERT_EQ("e5d6", position.ParseSan("exd6").ToUci());
+    ASSERT_EQ("e1g1", position.ParseSan("O-O").ToUci());
+    ASSERT_EQ("e1c1", position.ParseSan("0-0-0+").ToUci());
+    ASSERT_EQ("b7a8q", position.ParseSan("bxa8=Q+").ToUci());
+    ASSERT_EQ("b7b8n", position.ParseSan("b8N").ToUci());
+    ASSERT_EQ("c3e4", position.ParseSan("Nce4!?").ToUci());
+    ASSERT_EQ("g3e4", position.ParseSan("Ngxe4").ToUci());
+
+    // Ambiguous, illegal and malformed moves
+    ASSERT_FALSE(position.ParseSan("Ne4").IsValid());
+    ASSERT_FALSE(position.ParseSan("b8").IsValid());
+    ASSERT_FALSE(position.ParseSan("Qd1").IsValid());
+    ASSERT_FALSE(position.ParseSan("Zz9").IsValid());
+    ASSERT_FALSE(position.ParseSan("").IsValid());
+}
+
+/**
+ * Check that every legal move writes as SAN that parses back to it
+ * @param position Position to check from
+ * @param depth Depth in half moves
+ */
+static void CheckSan(Position &position, int depth)
+{
+    MoveList moves;
+    position.GenerateLegalMoves(moves);
+    for (Move move : moves)
+    {
+        MoveText san = position.SanText(move);
+        ASSERT_EQ(move, position.ParseSan(san.View())) << position.GetFen() << " " << san.View();
+        ASSERT_EQ(move, position.ParseMove(move.UciText().View()));
+        if (depth > 1)
+        {
+            position.DoMove(move);
+            CheckSan(position, depth - 1);
+            position.UndoMove();
+        }
+    }
+}
+
+TEST(PositionTest, SanText)
+{
+    Position position;
+    position.SetFen("r3k2r/1P6/8/3pP3/8/2N3N1/8/R3K2R w KQkq d6 0 1");
+    ASSERT_EQ("exd6", position.SanText(position.ParseMove("e5d6")).View());
+    ASSERT_EQ("O-O", position.SanText(position.ParseMove("e1g1")).View());
+    ASSERT_EQ("O-O-O", position.SanText(position.ParseMove("e1c1")).View());
+    ASSERT_EQ("bxa8=Q+", position.SanText(position.ParseMove("b7a8q")).View());
+    ASSERT_EQ("b8=N", position.SanText(position.ParseMove("b7b8n")).View());
+    ASSERT_EQ("Nce4", position.SanText(position.ParseMove("c3e4")).View());
+    ASSERT_EQ("Nge4", position.SanText(position.ParseMove("g3e4")).View());
+    ASSERT_EQ("Rb1", position.SanText(position.ParseMove("a1b1")).View());
+
+    // By rank, and by both file and rank
+    position.SetFen("4k3/8/8/8/R7/8/8/R3K3 w - - 0 1");
+    ASSERT_EQ("R1a2", position.SanText(position.ParseMove("a1a2")).View());
+    ASSERT_EQ("R4a3", position.SanText(position.ParseMove("a4a3")).View());
+    position.SetFen("4k3/8/8/8/8/Q7/8/Q1Q1K3 w - - 0 1");
+    ASSERT_EQ("Qa1b2", position.SanText(position.ParseMove("a1b2")).View());
+    ASSERT_EQ("Qcb2", position.SanText(position.ParseMove("c1b2")).View());
+
+    // A pinned piece needs no telling apart, unless it moves along the pin
+    position.SetFen("4k3/8/8/8/4r3/8/2N1N3/4K3 w - - 0 1");
+    ASSERT_EQ("Nd4", position.SanText(position.ParseMove("c2d4")).View());
+    position.SetFen("4k3/4r3/8/8/R7/8/4R3/4K3 w - - 0 1");
+    ASSERT_EQ("Rae4", position.SanText(position.ParseMove("a4e4")).View());
+    ASSERT_EQ("Ree4", position.SanText(position.ParseMove("e2e4")).View());
+
+    // Check and mate
+    position.SetFen(Position::StartFen);
+    for (auto uci : {"e2e4", "e7e5", "f1c4", "b8c6", "d1h5", "g8f6"})
+    {
+        position.DoMove(position.ParseMove(uci));
+    }
+    ASSERT_EQ("Bxf7+", position.SanText(position.ParseMove("c4f7")).View());
+    ASSERT_EQ("Qxf7#", position.SanText(position.ParseMove("h5f7")).View());
+
+    // Writing leaves the position as it was
+    ASSERT_EQ("r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", position.GetFen());
+
+    for (auto fen : {Position::StartFen.c_str(),
+                     "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                     "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                     "r3k2r/1P6/8/3pP3/8/2N3N1/8/R3K2R w KQkq d6 0 1"})
+    {
+        position.SetFen(fen);
+        CheckSan(position, 2);
+    }
+}
+
+TEST(PositionTest, ParseMove)
+{
+    Position position;
+    position.SetFen("r3k2r/1P6/8/3pP3/8/2N3N1/8/R3K2R w KQkq d6 0 1");
+    ASSERT_EQ(Move::EN_PASSANT, position.ParseMove("e5d6").GetType());
+    ASSERT_EQ(Move::CASTLING, position.ParseMove("e1g1").GetType());
+    ASSERT_EQ(ROOK, position.ParseMove("b7b8r").PromotionType());
+
+    // Illegal and malformed moves
+    ASSERT_FALSE(position.ParseMove("b7b8").IsValid());
+    ASSERT_FALSE(position.ParseMove("b7b8k").IsValid());
+    ASSERT_FALSE(position.ParseMove("e5e6q").IsValid());
+    ASSERT_FALSE(position.ParseMove("e2e4").IsValid());
+    ASSERT_FALSE(position.ParseMove("i1a1").IsValid());
+    ASSERT_FALSE(position.ParseMove("e5").IsValid());
+    ASSERT_FALSE(position.ParseMove("").IsValid());
+
+    ASSERT_EQ("(none)", Move::None().UciText().View());
+    ASSERT_EQ("0000", Move::Null().ToUci());
+}
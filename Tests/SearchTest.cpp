@@ -0,0 +1,108 @@
+/**
+ * @file SearchTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <Engine.h>
+
+#include <chrono>
+
+using namespace std;
+
+TEST(SearchTest, MateInOne)
+{
+    Engine engine;
+    Move best;
+    engine.GetSearch().SetBestMoveCallback([&best](Move move, Move) { best = move; });
+
+    ASSERT_TRUE(engine.SetPosition("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1", {}));
+    SearchLimits limits;
+    limits.mDepth = 4;
+    engine.Go(limits);
+    engine.Wait();
+    ASSERT_EQ("a1a8", best.ToUci());
+}
+
+TEST(SearchTest, PonderWaitsForPonderHit)
+{
+    Engine engine;
+    atomic<bool> reported{false};
+    Move best;
+    Move ponder;
+    engine.GetSearch().SetBestMoveCallback([&](Move move, Move reply) {
+        best = move;
+        ponder = reply;
+        reported = true;
+    });
+
+    // A shallow ponder search finishes quickly but must not report
+    // its move until the opponent actually plays the expected move
+    ASSERT_TRUE(engine.SetPosition(Position::StartFen, {"e2e4"}));
+    SearchLimits limits;
+    limits.mDepth = 3;
+    limits.mPonder = true;
+    engine.Go(limits);
+
+    this_thread::sleep_for(chrono::milliseconds(200));
+    ASSERT_FALSE(reported);
+    ASSERT_TRUE(engine.GetSearch().IsPondering());
+
+    engine.PonderHit();
+    engine.Wait();
+    ASSERT_TRUE(reported);
+    ASSERT_TRUE(best.IsValid());
+    ASSERT_TRUE(ponder.IsValid());
+}
+
+TEST(SearchTest, PonderMissStops)
+{
+    Engine engine;
+    atomic<bool> reported{false};
+    engine.GetSearch().SetBestMoveCallback([&](Move, Move) { reported = true; });
+
+    SearchLimits limits;
+    limits.mPonder = true;
+    engine.Go(limits);
+    this_thread::sleep_for(chrono::milliseconds(100));
+    ASSERT_FALSE(reported);
+
+    engine.Stop();
+    engine.Wait();
+    ASSERT_TRUE(reported);
+}
+
+TEST(SearchTest, MultiPV)
+{
+    Engine engine;
+    vector<SearchInfo> lines;
+    Move best;
+    engine.GetSearch().SetInfoCallback([&lines](const SearchInfo &info) {
+        if (info.mMultiPV == 1)
+        {
+            lines.clear();
+        }
+        lines.push_back(info);
+    });
+    engine.GetSearch().SetBestMoveCallback([&best](Move move, Move) { best = move; });
+
+    ASSERT_TRUE(engine.SetPosition("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1", {}));
+    engine.SetMultiPV(3);
+    SearchLimits limits;
+    limits.mDepth = 5;
+    engine.Go(limits);
+    engine.Wait();
+
+    // Three different moves, best first, and the mate is still played
+    ASSERT_EQ(3u, lines.size());
+    ASSERT_EQ("a1a8", lines[0].mPv[0].ToUci());
+    ASSERT_EQ(VALUE_MATE - 1, lines[0].mScore);
+    ASSERT_NE(lines[0].mPv[0], lines[1].mPv[0]);
+    ASSERT_NE(lines[1].mPv[0], lines[2].mPv[0]);
+    ASSERT_NE(lines[0].mPv[0], lines[2].mPv[0]);
+    ASSERT_GE(lines[0].mScore, lines[1].mScore);
+    ASSERT_GE(lines[1].mScore, lines[2].mScore);
+    ASSERT_EQ("a1a8", best.ToUci());
+}
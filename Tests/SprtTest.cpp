@@ -0,0 +1,82 @@
+/**
+ * @file SprtTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+#include <Sprt.h>
+
+using namespace std;
+
+TEST(SprtTest, Bounds)
+{
+    Sprt test(SprtOptions{0, 5, 0.05, 0.05});
+    ASSERT_NEAR(-2.944, test.LowerBound(), 0.001);
+    ASSERT_NEAR(2.944, test.UpperBound(), 0.001);
+
+    Sprt lopsided(SprtOptions{0, 5, 0.05, 0.1});
+    ASSERT_NEAR(log(0.1 / 0.95), lopsided.LowerBound(), 1e-9);
+    ASSERT_NEAR(log(0.9 / 0.05), lopsided.UpperBound(), 1e-9);
+}
+
+TEST(SprtTest, Llr)
+{
+    Sprt test(SprtOptions{0, 5, 0.05, 0.05});
+
+    // Nothing to go on
+    uint64_t none[5] = {};
+    ASSERT_EQ(0, test.Llr(none));
+    ASSERT_EQ(SPRT_CONTINUE, test.Decide(none));
+
+    // Draw after draw is evidence against a gain
+    uint64_t draws[5] = {0, 0, 200, 0, 0};
+    ASSERT_LT(test.Llr(draws), 0);
+
+    // Win after win has no variance, but must still pass
+    uint64_t sweep[5] = {0, 0, 0, 0, 10};
+    ASSERT_EQ(SPRT_H1, test.Decide(sweep));
+
+    uint64_t better[5] = {10, 200, 500, 250, 40};
+    ASSERT_NEAR(4.3137, test.Llr(better), 0.001);
+    ASSERT_EQ(SPRT_H1, test.Decide(better));
+
+    // The mirror image fails
+    uint64_t worse[5] = {40, 250, 500, 200, 10};
+    ASSERT_LT(test.Llr(worse), test.LowerBound());
+    ASSERT_EQ(SPRT_H0, test.Decide(worse));
+
+    uint64_t even[5] = {10, 200, 500, 200, 10};
+    ASSERT_EQ(SPRT_CONTINUE, test.Decide(even));
+    ASSERT_LT(test.Llr(even), 0);
+}
+
+TEST(SprtTest, Estimate)
+{
+    uint64_t better[5] = {10, 200, 500, 250, 40};
+    EloEstimate elo = Sprt::Estimate(better);
+    ASSERT_NEAR(19.128, elo.mElo, 0.001);
+    ASSERT_NEAR(8.627, elo.mError, 0.01);
+    ASSERT_GT(elo.mLos, 0.9999);
+
+    uint64_t even[5] = {10, 200, 500, 200, 10};
+    elo = Sprt::Estimate(even);
+    ASSERT_NEAR(0, elo.mElo, 1e-9);
+    ASSERT_NEAR(0.5, elo.mLos, 1e-9);
+    ASSERT_GT(elo.mError, 0);
+
+    // Every pair won stays finite
+    uint64_t sweep[5] = {0, 0, 0, 0, 8};
+    elo = Sprt::Estimate(sweep);
+    ASSERT_TRUE(isfinite(elo.mElo));
+    ASSERT_GT(elo.mElo, 1000);
+    ASSERT_EQ(1, elo.mLos);
+
+    uint64_t none[5] = {};
+    elo = Sprt::Estimate(none);
+    ASSERT_EQ(0, elo.mElo);
+    ASSERT_EQ(0.5, elo.mLos);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file SpsaTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <Spsa.h>
+#include <Tune.h>
+
+using namespace std;
+
+/// An engine that plays fool's mate when its Skill is 50 or more and
+/// an illegal move when it is less
+const string SkillScript = "skill=0\n"
+                           "while read -r command rest; do\n"
+                           "  case \"$command\" in\n"
+                           "    uci) echo 'id name Skill'; echo uciok ;;\n"
+                           "    setoption) set -- $rest; skill=$4 ;;\n"
+                           "    isready) echo readyok ;;\n"
+                           "    position) set -- $rest; if [ $# -gt 7 ]; then moves=$(($# - 8)); else moves=0; fi ;;\n"
+                           "    go) if [ \"$skill\" -lt 50 ]; then echo 'bestmove 0000'; else\n"
+                           "        case $moves in 0) echo 'bestmove f2f3' ;; 1) echo 'bestmove e7e5' ;;\n"
+                           "        2) echo 'bestmove g2g4' ;; *) echo 'bestmove d8h4' ;; esac; fi ;;\n"
+                           "    quit) exit 0 ;;\n"
+                           "  esac\n"
+                           "done\n";
+
+TEST(SpsaTest, Parameters)
+{
+    istringstream input("# name, value, min, max, c_end, r_end\n"
+                        "AspirationDelta, 25, 5, 200, 4, 0.002\n"
+                        "\n"
+                        "BishopPair 300 0 150 10 0.002\n");
+    vector<SpsaParameter> parameters;
+    ASSERT_TRUE(Spsa::ReadParameters(input, parameters));
+    ASSERT_EQ(2u, parameters.size());
+    ASSERT_EQ("AspirationDelta", parameters[0].mName);
+    ASSERT_EQ(25, parameters[0].mValue);
+    ASSERT_EQ(200, parameters[0].mMax);
+    ASSERT_EQ(4, parameters[0].mPerturbation);
+    ASSERT_EQ(0.002, parameters[0].mRate);
+
+    // Clamped into range
+    ASSERT_EQ(150, parameters[1].mValue);
+
+    istringstream bad("BishopPair, 30, 0\n");
+    ASSERT_FALSE(Spsa::ReadParameters(bad, parameters));
+}
+
+TEST(SpsaTest, TuneParameter)
+{
+    auto const &all = TuneParameter::All();
+    auto found = find_if(all.begin(), all.end(), [](const TuneParameter &p) { return p.mName == "AspirationDelta"; });
+    ASSERT_NE(all.end(), found);
+    ASSERT_EQ(*found->mValue, found->mDefault);
+
+    ASSERT_TRUE(TuneParameter::Set("AspirationDelta", 40));
+    ASSERT_EQ(40, *found->mValue);
+    ASSERT_TRUE(TuneParameter::Set("AspirationDelta", 100000));
+    ASSERT_EQ(found->mMax, *found->mValue);
+    ASSERT_FALSE(TuneParameter::Set("NoSuchParameter", 1));
+    TuneParameter::Set("AspirationDelta", found->mDefault);
+
+    // Only evaluation terms are held in the pawn and material tables
+    ASSERT_FALSE(found->mCached);
+    ASSERT_TRUE(TuneParameter::Find("BishopPair")->mCached);
+    ASSERT_EQ(nullptr, TuneParameter::Find("NoSuchParameter"));
+}
+
+TEST(SpsaTest, Run)
+{
+#ifdef _WIN32
+    GTEST_SKIP() << "the script engine needs a POSIX shell";
+#endif
+    string script = "SpsaTestSkill.sh";
+    string checkpoint = "SpsaTest.checkpoint";
+    {
+        ofstream file(script);
+        file << SkillScript;
+    }
+    remove(checkpoint.c_str());
+
+    SpsaOptions options;
+    options.mEngine.mCommand = {"sh", script};
+    options.mParameters.push_back({"Skill", 50, 0, 100, 5, 0.01});
+    options.mIterations = 3;
+    options.mConcurrency = 2;
+    options.mCheckpoint = checkpoint;
+
+    // Whichever way Skill is moved, the higher one wins both games
+    Spsa spsa(options);
+    ASSERT_TRUE(spsa.LoadOpenings());
+    ASSERT_TRUE(spsa.LoadCheckpoint());
+    int iterations = 0;
+    ASSERT_TRUE(spsa.Run([&iterations](int) { iterations++; }));
+    ASSERT_EQ(3, iterations);
+    ASSERT_EQ(3, spsa.GetStats().mIterations);
+    ASSERT_EQ(6u, spsa.GetStats().mWins + spsa.GetStats().mLosses);
+    double tuned = spsa.GetParameters()[0].mValue;
+    ASSERT_GT(tuned, 50.2);
+    ASSERT_LT(tuned, 52);
+
+    // Resuming from the checkpoint has nothing left to do
+    Spsa resumed(options);
+    ASSERT_TRUE(resumed.LoadCheckpoint());
+    ASSERT_EQ(3, resumed.GetStats().mIterations);
+    ASSERT_DOUBLE_EQ(tuned, resumed.GetParameters()[0].mValue);
+    iterations = 0;
+    ASSERT_TRUE(resumed.Run([&iterations](int) { iterations++; }));
+    ASSERT_EQ(0, iterations);
+
+    // Two more iterations carry on from there
+    options.mIterations = 5;
+    Spsa longer(options);
+    ASSERT_TRUE(longer.LoadCheckpoint());
+    ASSERT_TRUE(longer.Run());
+    ASSERT_EQ(5, longer.GetStats().mIterations);
+    ASSERT_GT(longer.GetParameters()[0].mValue, tuned);
+
+    remove(checkpoint.c_str());
+    remove(script.c_str());
+}
@@ -0,0 +1,791 @@
+/**
+ * @file TablebasesTest.cpp
+ * @author John Korreck
+ */
+
+#include <pch.h>
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <numeric>
+
+#include <EndgameTable.h>
+#include <RetrogradeGenerator.h>
+#include <Tablebases.h>
+#include <Position.h>
+#include <Search.h>
+
+using namespace std;
+
+/// Syzygy piece codes of a king, pawn, rook and queen, black adds 8
+const int TbKing = 6;
+const int TbPawn = 1;
+const int TbRook = 4;
+const int TbQueen = 5;
+
+/// Bytes in a block of the test tables, as a power of two, small to give many blocks
+const int TestBlockBits = 5;
+
+/// Values per sparse index entry, as a power of two
+const int TestSpanBits = 6;
+
+/**
+ * A sub-table compressed for a Syzygy file
+ */
+struct SyzygyPart {
+    /// Flags, sizes, Huffman code and symbol tree
+    vector<uint8_t> mHeader;
+
+    /// Block and offset of the middle value of each span
+    vector<uint8_t> mSparse;
+
+    /// Number of values in each block, minus one
+    vector<uint8_t> mLengths;
+
+    /// The blocks
+    vector<uint8_t> mData;
+};
+
+/**
+ * Append a little endian value
+ * @param bytes Bytes to append to
+ * @param value The value
+ * @param count Number of bytes
+ */
+static void PutLittle(vector<uint8_t> &bytes, uint64_t value, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        bytes.push_back(uint8_t(value >> (8 * i)));
+    }
+}
+
+/**
+ * Compress the values of a sub-table as the Syzygy files do: a
+ * canonical Huffman code of symbols, longer codes having lower
+ * values, packed into blocks. Each value has a symbol, and one more
+ * stands for a pair of the most common value.
+ * @param values The values, in index order
+ * @param flags Flags of the sub-table
+ * @return The compressed sub-table
+ */
+static SyzygyPart Compress(const vector<int> &values, int flags)
+{
+    SyzygyPart part;
+    map<int, uint64_t> counts;
+    for (int value : values)
+    {
+        counts[value]++;
+    }
+    if (counts.size() == 1)
+    {
+        part.mHeader = {uint8_t(flags | 128), uint8_t(values[0])};
+        return part;
+    }
+
+    // Symbols before numbering: the values in order, then the pair
+    vector<int> leaves;
+    for (auto [value, count] : counts)
+    {
+        leaves.push_back(value);
+    }
+    int common = int(distance(counts.begin(), max_element(counts.begin(), counts.end(), [](auto &a, auto &b) {
+        return a.second < b.second;
+    })));
+    int symbols = int(leaves.size()) + 1;
+    int twice = symbols - 1;
+    vector<int> tokens;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        int leaf = int(lower_bound(leaves.begin(), leaves.end(), values[i]) - leaves.begin());
+        if (leaf == common && i + 1 < values.size() && values[i + 1] == values[i])
+        {
+            tokens.push_back(twice);
+            i++;
+        }
+        else
+        {
+            tokens.push_back(leaf);
+        }
+    }
+
+    // Huffman code lengths, every symbol getting a code
+    vector<uint64_t> frequency(symbols, 1);
+    for (int token : tokens)
+    {
+        frequency[token]++;
+    }
+    vector<int> length(symbols, 0);
+    vector<pair<uint64_t, vector<int>>> nodes;
+    for (int symbol = 0; symbol < symbols; symbol++)
+    {
+        nodes.push_back({frequency[symbol], {symbol}});
+    }
+    while (nodes.size() > 1)
+    {
+        sort(nodes.begin(), nodes.end(), [](auto &a, auto &b) { return a.first > b.first; });
+        auto last = nodes.back();
+        nodes.pop_back();
+        for (int symbol : last.second)
+        {
+            length[symbol]++;
+        }
+        for (int symbol : nodes.back().second)
+        {
+            length[symbol]++;
+        }
+        nodes.back().first += last.first;
+        nodes.back().second.insert(nodes.back().second.end(), last.second.begin(), last.second.end());
+    }
+
+    // Number the symbols longest code first, and give each length
+    // the codes just above those of the next longer length
+    vector<int> order(symbols);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&length](int a, int b) { return length[a] > length[b]; });
+    vector<int> number(symbols);
+    for (int i = 0; i < symbols; i++)
+    {
+        number[order[i]] = i;
+    }
+    int minLength = *min_element(length.begin(), length.end());
+    int maxLength = *max_element(length.begin(), length.end());
+    vector<int> lowest(maxLength + 2, 0);
+    vector<uint64_t> base(maxLength + 2, 0);
+    for (int l = maxLength - 1; l >= minLength; l--)
+    {
+        int longer = int(count(length.begin(), length.end(), l + 1));
+        lowest[l] = lowest[l + 1] + longer;
+        base[l] = (base[l + 1] + longer) / 2;
+    }
+
+    // Pack the codes into blocks, a symbol never crossing into the next
+    size_t blockBits = size_t(8) << TestBlockBits;
+    vector<size_t> blockStart;
+    size_t used = blockBits;
+    size_t value = 0;
+    for (int token : tokens)
+    {
+        if (used + length[token] > blockBits)
+        {
+            blockStart.push_back(value);
+            part.mData.resize(part.mData.size() + blockBits / 8);
+            used = 0;
+        }
+        uint64_t code = base[length[token]] + uint64_t(number[token] - lowest[length[token]]);
+        for (int bit = length[token] - 1; bit >= 0; bit--, used++)
+        {
+            if ((code >> bit) & 1)
+            {
+                part.mData[part.mData.size() - blockBits / 8 + used / 8] |= uint8_t(0x80 >> (used % 8));
+            }
+        }
+        value += token == twice ? 2 : 1;
+    }
+    blockStart.push_back(values.size());
+    size_t blocks = blockStart.size() - 1;
+
+    part.mHeader = {uint8_t(flags), uint8_t(TestBlockBits), uint8_t(TestSpanBits), 0};
+    PutLittle(part.mHeader, blocks, 4);
+    part.mHeader.push_back(uint8_t(maxLength));
+    part.mHeader.push_back(uint8_t(minLength));
+    for (int l = minLength; l <= maxLength; l++)
+    {
+        PutLittle(part.mHeader, lowest[l], 2);
+    }
+    PutLittle(part.mHeader, symbols, 2);
+    for (int symbol : order)
+    {
+        int left = symbol == twice ? number[common] : leaves[symbol];
+        int right = symbol == twice ? number[common] : 0xFFF;
+        part.mHeader.push_back(uint8_t(left));
+        part.mHeader.push_back(uint8_t(left >> 8 | (right & 0xF) << 4));
+        part.mHeader.push_back(uint8_t(right >> 4));
+    }
+    if (symbols & 1)
+    {
+        part.mHeader.push_back(0);
+    }
+
+    for (size_t block = 0; block < blocks; block++)
+    {
+        PutLittle(part.mLengths, blockStart[block + 1] - blockStart[block] - 1, 2);
+    }
+    size_t span = size_t(1) << TestSpanBits;
+    for (size_t middle = span / 2; middle - span / 2 < values.size(); middle += span)
+    {
+        size_t block = size_t(upper_bound(blockStart.begin(), blockStart.end() - 1, middle) - blockStart.begin()) - 1;
+        PutLittle(part.mSparse, block, 4);
+        PutLittle(part.mSparse, middle - blockStart[block], 2);
+    }
+    return part;
+}
+
+/**
+ * Write a table in the Syzygy format, with the same piece order
+ * for every sub-table and no DTZ value maps
+ * @param path File to write
+ * @param dtz Is it a DTZ table?
+ * @param pieces Piece codes in the order of the index
+ * @param parts Sub-tables by file of the leading pawn, then by side to move
+ */
+static void WriteSyzygy(const filesystem::path &path, bool dtz, const vector<int> &pieces,
+                        const vector<vector<SyzygyPart>> &parts)
+{
+    vector<uint8_t> bytes = dtz ? vector<uint8_t>{0xD7, 0x66, 0x0C, 0xA5} : vector<uint8_t>{0x71, 0xE8, 0x23, 0x5D};
+    bytes.push_back(uint8_t(1 | (parts.size() == 4 ? 2 : 0)));
+    for (size_t file = 0; file < parts.size(); file++)
+    {
+        bytes.push_back(0);
+        for (int piece : pieces)
+        {
+            bytes.push_back(uint8_t(piece | piece << 4));
+        }
+    }
+    auto align = [&bytes](size_t alignment) { bytes.resize((bytes.size() + alignment - 1) / alignment * alignment); };
+    align(2);
+    for (auto &file : parts)
+    {
+        for (auto &part : file)
+        {
+            bytes.insert(bytes.end(), part.mHeader.begin(), part.mHeader.end());
+        }
+    }
+    if (dtz)
+    {
+        align(2);
+    }
+    for (auto &file : parts)
+    {
+        for (auto &part : file)
+        {
+            bytes.insert(bytes.end(), part.mSparse.begin(), part.mSparse.end());
+        }
+    }
+    for (auto &file : parts)
+    {
+        for (auto &part : file)
+        {
+            bytes.insert(bytes.end(), part.mLengths.begin(), part.mLengths.end());
+        }
+    }
+    for (auto &file : parts)
+    {
+        for (auto &part : file)
+        {
+            align(64);
+            bytes.insert(bytes.end(), part.mData.begin(), part.mData.end());
+        }
+    }
+
+    // Room for the decoder to read ahead, then the checksum
+    bytes.resize(bytes.size() + 64);
+    align(64);
+    bytes.resize(bytes.size() + 16);
+    ofstream file(path, ios::binary);
+    file.write(reinterpret_cast<const char *>(bytes.data()), streamsize(bytes.size()));
+}
+
+/**
+ * Write a position with a few pieces as FEN
+ * @param pieces Syzygy piece codes
+ * @param squares Their squares
+ * @param stm Side to move, 0 for white
+ * @return The FEN
+ */
+static string Fen(const vector<int> &pieces, const vector<int> &squares, int stm)
+{
+    string board(64, ' ');
+    for (size_t i = 0; i < pieces.size(); i++)
+    {
+        char letter = " PNBRQK"[pieces[i] & 7];
+        board[squares[i]] = pieces[i] & 8 ? char(tolower(letter)) : letter;
+    }
+    string fen;
+    for (int rank = 7; rank >= 0; rank--)
+    {
+        int empty = 0;
+        for (int file = 0; file < 8; file++)
+        {
+            char c = board[MakeSquare(file, rank)];
+            if (c == ' ')
+            {
+                empty++;
+                continue;
+            }
+            if (empty > 0)
+            {
+                fen += char('0' + empty);
+            }
+            empty = 0;
+            fen += c;
+        }
+        if (empty > 0)
+        {
+            fen += char('0' + empty);
+        }
+        fen += rank > 0 ? "/" : "";
+    }
+    return fen + (stm == 0 ? " w" : " b") + " - - 0 1";
+}
+
+/**
+ * Look a position up in tables from RetrogradeGenerator
+ * @param tables The tables
+ * @param pieces Syzygy piece codes
+ * @param squares Their squares
+ * @param stm Side to move
+ * @return Stored result, EGT_BROKEN for an illegal position
+ */
+static uint8_t Solve(const EndgameTables &tables, const vector<int> &pieces, const vector<int> &squares, int stm)
+{
+    Position position;
+    uint8_t result;
+    return position.SetFen(Fen(pieces, squares, stm)) && tables.Probe(position, result) ? result : EGT_BROKEN;
+}
+
+/**
+ * Value of a WDL table for a result, -2 to 2 plus 2
+ * @param result Stored result of RetrogradeGenerator
+ * @return The value
+ */
+static int WdlValue(uint8_t result)
+{
+    return result == EGT_BROKEN || result == EGT_DRAW ? 2 : result < EGT_LOSS ? 4 : 0;
+}
+
+/**
+ * Index of a position of three different pieces and no pawns. The
+ * first piece goes in the a1-d1-d4 triangle and the first one off
+ * the a1-h8 diagonal below it.
+ * @param squares Squares of the pieces
+ * @return The index, or -1 if the squares are not placed that way
+ */
+static int64_t PawnlessIndex(const int squares[3])
+{
+    const int triangle[] = {1, 2, 3, 10, 11, 19};
+    auto off = [](int square) { return RankOf(square) - FileOf(square); };
+    auto below = [](int square) { return square - (RankOf(square) + 1) * (RankOf(square) + 2) / 2; };
+    int first = int(find(begin(triangle), end(triangle), squares[0]) - begin(triangle));
+    if (FileOf(squares[0]) > 3 || RankOf(squares[0]) > 3 || off(squares[0]) > 0 || squares[1] == squares[0]
+        || squares[2] == squares[0] || squares[2] == squares[1])
+    {
+        return -1;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        if (off(squares[i]) > 0)
+        {
+            return -1;
+        }
+        if (off(squares[i]) < 0)
+        {
+            break;
+        }
+    }
+
+    // Squares below the diagonal are numbered b1 to h1, then c2 to h2 and so on
+    int adjust1 = squares[1] > squares[0];
+    int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+    if (off(squares[0]) != 0)
+    {
+        return (first * 63 + squares[1] - adjust1) * 62 + squares[2] - adjust2;
+    }
+    if (off(squares[1]) != 0)
+    {
+        return (6 * 63 + RankOf(squares[0]) * 28 + below(squares[1])) * 62 + squares[2] - adjust2;
+    }
+    if (off(squares[2]) != 0)
+    {
+        return 6 * 63 * 62 + 4 * 28 * 62 + RankOf(squares[0]) * 7 * 28 + (RankOf(squares[1]) - adjust1) * 28
+            + below(squares[2]);
+    }
+    return 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + RankOf(squares[0]) * 7 * 6 + (RankOf(squares[1]) - adjust1) * 6
+        + RankOf(squares[2]) - adjust2;
+}
+
+/**
+ * Write the WDL and DTZ tables of a king and piece against a king
+ * @param directory Directory to write them to
+ * @param tables Tables from RetrogradeGenerator with the results
+ * @param piece Syzygy code of the piece
+ * @param dtzSide Side to move the DTZ table is for
+ */
+static void WritePawnless(const filesystem::path &directory, const EndgameTables &tables, int piece, int dtzSide)
+{
+    const vector<int> pieces = {TbKing, piece, TbKing + 8};
+    vector<int> wdl[2] = {vector<int>(31332, 2), vector<int>(31332, 2)};
+    vector<int> dtz(31332, 0);
+    for (int a = 0; a < 64; a++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            for (int c = 0; c < 64; c++)
+            {
+                int squares[3] = {a, b, c};
+                int64_t index = PawnlessIndex(squares);
+                if (index < 0)
+                {
+                    continue;
+                }
+                for (int stm = 0; stm < 2; stm++)
+                {
+                    uint8_t result = Solve(tables, pieces, {a, b, c}, stm);
+                    wdl[stm][index] = WdlValue(result);
+
+                    // Distances are kept in moves, so odd distances in
+                    // plies read back exactly and even ones one short
+                    if (stm == dtzSide && result != EGT_BROKEN && result != EGT_DRAW)
+                    {
+                        int plies = result < EGT_LOSS ? 2 * (result - EGT_WIN) + 1 : 2 * (result - EGT_LOSS);
+                        dtz[index] = max(0, (plies - 1) / 2);
+                    }
+                }
+            }
+        }
+    }
+
+    string name = piece == TbQueen ? "KQvK" : "KRvK";
+    WriteSyzygy(directory / (name + ".rtbw"), false, pieces, {{Compress(wdl[0], 0), Compress(wdl[1], 0)}});
+    WriteSyzygy(directory / (name + ".rtbz"), true, pieces, {{Compress(dtz, dtzSide)}});
+}
+
+/**
+ * Write the WDL and DTZ tables of king and pawn against king. The
+ * DTZ table is for white to move, worked out by levels from the
+ * pawn moves that keep the win.
+ * @param directory Directory to write them to
+ * @param tables Tables from RetrogradeGenerator with the results
+ */
+static void WriteKpk(const filesystem::path &directory, const EndgameTables &tables)
+{
+    const vector<int> pieces = {TbPawn, TbKing, TbKing + 8};
+    auto id = [](int pawn, int king, int other, int stm) { return ((pawn * 64 + king) * 64 + other) * 2 + stm; };
+    vector<uint8_t> results(64 * 64 * 64 * 2, EGT_BROKEN);
+    vector<vector<int>> next(results.size());
+    vector<int> distance(results.size(), 0);
+    for (int pawn = 8; pawn < 56; pawn++)
+    {
+        for (int king = 0; king < 64; king++)
+        {
+            for (int other = 0; other < 64; other++)
+            {
+                for (int stm = 0; stm < 2; stm++)
+                {
+                    int i = id(pawn, king, other, stm);
+                    Position position;
+                    if (pawn == king || pawn == other || king == other
+                        || !position.SetFen(Fen(pieces, {pawn, king, other}, stm))
+                        || !tables.Probe(position, results[i]))
+                    {
+                        results[i] = EGT_BROKEN;
+                        continue;
+                    }
+
+                    MoveList moves;
+                    position.GenerateLegalMoves(moves);
+                    for (Move move : moves)
+                    {
+                        if (TypeOf(position.PieceOn(move.From())) == KING && !position.IsCapture(move))
+                        {
+                            int to = move.To();
+                            next[i].push_back(id(pawn, stm == 0 ? to : king, stm == 1 ? to : other, 1 - stm));
+                            continue;
+                        }
+                        uint8_t after;
+                        position.DoMove(move);
+                        if (stm == 0 && tables.Probe(position, after) && after >= EGT_LOSS && after != EGT_BROKEN)
+                        {
+                            distance[i] = 1;
+                        }
+                        position.UndoMove();
+                    }
+                }
+            }
+        }
+    }
+
+    auto won = [&results](int i) { return results[i] != EGT_DRAW && results[i] < EGT_LOSS; };
+    auto lost = [&results](int i) { return results[i] != EGT_BROKEN && results[i] >= EGT_LOSS; };
+    for (int ply = 2, changed = 1; changed; ply++)
+    {
+        changed = 0;
+        for (size_t i = ply % 2 == 0 ? 1 : 0; i < results.size(); i += 2)
+        {
+            if (distance[i] != 0 || !(ply % 2 == 0 ? lost(int(i)) : won(int(i))))
+            {
+                continue;
+            }
+            bool all = all_of(next[i].begin(), next[i].end(), [&distance](int j) { return distance[j] != 0; });
+            bool any = any_of(next[i].begin(), next[i].end(), [&](int j) { return distance[j] == ply - 1; });
+            if (ply % 2 == 0 ? all : any)
+            {
+                distance[i] = ply;
+                changed = 1;
+            }
+        }
+    }
+
+    vector<vector<SyzygyPart>> wdlParts;
+    vector<vector<SyzygyPart>> dtzParts;
+    for (int file = 0; file < 4; file++)
+    {
+        vector<int> wdl[2] = {vector<int>(6 * 63 * 62, 2), vector<int>(6 * 63 * 62, 2)};
+        vector<int> dtz(6 * 63 * 62, 0);
+        for (int rank = 1; rank <= 6; rank++)
+        {
+            int pawn = MakeSquare(file, rank);
+            for (int king = 0; king < 64; king++)
+            {
+                for (int other = 0; other < 64; other++)
+                {
+                    if (pawn == king || pawn == other || king == other)
+                    {
+                        continue;
+                    }
+                    int index = (rank - 1) + 6 * (king - (pawn < king))
+                        + 6 * 63 * (other - (pawn < other) - (king < other));
+                    for (int stm = 0; stm < 2; stm++)
+                    {
+                        wdl[stm][index] = WdlValue(results[id(pawn, king, other, stm)]);
+                    }
+                    if (won(id(pawn, king, other, 0)))
+                    {
+                        dtz[index] = (distance[id(pawn, king, other, 0)] - 1) / 2;
+                    }
+                }
+            }
+        }
+        wdlParts.push_back({Compress(wdl[0], 0), Compress(wdl[1], 0)});
+        dtzParts.push_back({Compress(dtz, 0)});
+    }
+    WriteSyzygy(directory / "KPvK.rtbw", false, pieces, wdlParts);
+    WriteSyzygy(directory / "KPvK.rtbz", true, pieces, dtzParts);
+}
+
+TEST(TablebasesTest, NoTables)
+{
+    Tablebases tablebases;
+    ASSERT_EQ(0, tablebases.Init(""));
+    ASSERT_EQ(0, tablebases.Init("<empty>"));
+    ASSERT_EQ(0, tablebases.MaxPieces());
+
+    Position position;
+    position.SetFen("8/8/8/3k4/8/8/3KR3/8 w - - 0 1");
+    ProbeState state;
+    tablebases.ProbeWdl(position, state);
+    ASSERT_EQ(PROBE_FAIL, state);
+    tablebases.ProbeDtz(position, state);
+    ASSERT_EQ(PROBE_FAIL, state);
+    ASSERT_EQ("8/8/8/3k4/8/8/3KR3/8 w - - 0 1", position.GetFen());
+
+    // Bare kings need no table
+    position.SetFen("8/8/8/3k4/8/8/3K4/8 w - - 0 1");
+    ASSERT_EQ(WDL_DRAW, tablebases.ProbeWdl(position, state));
+    ASSERT_EQ(PROBE_OK, state);
+
+    // Nor does a position whose only move captures into one
+    position.SetFen("k7/1R6/8/8/8/8/8/7K b - - 0 1");
+    ASSERT_EQ(WDL_DRAW, tablebases.ProbeWdl(position, state));
+    ASSERT_EQ(PROBE_ZEROING_BEST_MOVE, state);
+}
+
+TEST(TablebasesTest, Files)
+{
+    auto directory = filesystem::temp_directory_path() / "TablebasesTest";
+    filesystem::create_directories(directory);
+    for (const char *name : {"KRvK.rtbw", "KQPvKR.rtbw", "KRvK.rtbz", "KvRK.rtbw", "KRKv.rtbw", "KRvKK.rtbw", "README.txt"})
+    {
+        ofstream file(directory / name, ios::binary);
+        file << "not a table";
+    }
+
+    Tablebases tablebases;
+    string paths = directory.string() + (filesystem::path::preferred_separator == '\\' ? ";" : ":")
+        + (directory / "missing").string();
+    ASSERT_EQ(2, tablebases.Init(paths));
+    ASSERT_EQ(5, tablebases.MaxPieces());
+
+    // Tables found by name, but unusable files fail the probe
+    Position position;
+    position.SetFen("8/8/8/3k4/8/8/3KR3/8 w - - 0 1");
+    ProbeState state;
+    tablebases.ProbeWdl(position, state);
+    ASSERT_EQ(PROBE_FAIL, state);
+    position.SetFen("8/8/8/3k4/8/8/3Kr3/8 w - - 0 1");
+    tablebases.ProbeWdl(position, state);
+    ASSERT_EQ(PROBE_FAIL, state);
+
+    ASSERT_EQ(0, tablebases.Init(""));
+    filesystem::remove_all(directory);
+}
+
+TEST(TablebasesTest, Probe)
+{
+    // Tables in the Syzygy format, written from the results of the
+    // retrograde generator
+    auto directory = filesystem::temp_directory_path() / "TablebasesTestProbe";
+    filesystem::remove_all(directory);
+    RetrogradeOptions options;
+    options.mThreads = 2;
+    options.mDirectory = (directory / "egt").string();
+    RetrogradeGenerator generator(options);
+    ASSERT_TRUE(generator.Generate("KPvK"));
+    EndgameTables solved;
+    ASSERT_EQ(5, solved.Init(options.mDirectory));
+    WritePawnless(directory, solved, TbQueen, 1);
+    WritePawnless(directory, solved, TbRook, 0);
+    WriteKpk(directory, solved);
+
+    Tablebases tablebases;
+    ASSERT_EQ(3, tablebases.Init(directory.string()));
+    ASSERT_EQ(3, tablebases.MaxPieces());
+    auto wdl = [&tablebases](const string &fen) {
+        Position position;
+        position.SetFen(fen);
+        ProbeState state;
+        WdlScore score = tablebases.ProbeWdl(position, state);
+        return state == PROBE_FAIL ? -3 : int(score);
+    };
+    auto dtz = [&tablebases](const string &fen) {
+        Position position;
+        position.SetFen(fen);
+        ProbeState state;
+        int distance = tablebases.ProbeDtz(position, state);
+        return state == PROBE_FAIL ? -1000 : distance;
+    };
+
+    // Mate in one and mated next move, the rook table is for white to move
+    ASSERT_EQ(WDL_WIN, wdl("k7/8/1K6/8/8/8/8/7R w - - 0 1"));
+    ASSERT_EQ(1, dtz("k7/8/1K6/8/8/8/8/7R w - - 0 1"));
+    ASSERT_EQ(WDL_LOSS, wdl("k7/8/1K6/8/8/8/8/7R b - - 0 1"));
+    ASSERT_EQ(-2, dtz("k7/8/1K6/8/8/8/8/7R b - - 0 1"));
+    ASSERT_EQ(WDL_DRAW, wdl("k7/1R6/8/8/8/8/8/K7 b - - 0 1"));
+    ASSERT_EQ(0, dtz("k7/1R6/8/8/8/8/8/K7 b - - 0 1"));
+
+    // The longest rook mate takes 16 moves
+    ASSERT_EQ(31, dtz("8/8/8/8/8/2k5/1R6/K7 w - - 0 1"));
+
+    // The queen table is for black to move and in moves, so a loss
+    // in two plies reads as one, and the mate in two above it too
+    ASSERT_EQ(WDL_WIN, wdl("k7/8/1K6/8/8/8/8/6Q1 w - - 0 1"));
+    ASSERT_EQ(1, dtz("k7/8/1K6/8/8/8/8/6Q1 w - - 0 1"));
+    ASSERT_EQ(WDL_LOSS, wdl("k7/8/1K6/8/8/8/8/6Q1 b - - 0 1"));
+    ASSERT_EQ(-1, dtz("k7/8/1K6/8/8/8/8/6Q1 b - - 0 1"));
+    ASSERT_EQ(2, dtz("k7/8/2K5/8/8/8/8/6Q1 w - - 0 1"));
+
+    // Black holding the queen, looked up with the colors swapped
+    ASSERT_EQ(WDL_WIN, wdl("6q1/8/8/8/8/1k6/8/K7 b - - 0 1"));
+    ASSERT_EQ(1, dtz("6q1/8/8/8/8/1k6/8/K7 b - - 0 1"));
+    ASSERT_EQ(WDL_LOSS, wdl("6q1/8/8/8/8/1k6/8/K7 w - - 0 1"));
+    ASSERT_EQ(-1, dtz("6q1/8/8/8/8/1k6/8/K7 w - - 0 1"));
+    ASSERT_EQ(WDL_DRAW, wdl("K7/8/1q6/8/8/8/8/k7 w - - 0 1"));
+
+    // King and pawn, either color and on either wing
+    ASSERT_EQ(WDL_DRAW, wdl("k7/8/8/8/8/8/P7/K7 w - - 0 1"));
+    ASSERT_EQ(WDL_DRAW, wdl("4k3/4P3/4K3/8/8/8/8/8 b - - 0 1"));
+    ASSERT_EQ(WDL_WIN, wdl("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1"));
+    ASSERT_EQ(WDL_LOSS, wdl("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1"));
+    ASSERT_EQ(WDL_LOSS, wdl("8/8/8/8/4p3/4k3/8/4K3 w - - 0 1"));
+    ASSERT_EQ(WDL_WIN, wdl("8/8/8/8/4p3/4k3/8/4K3 b - - 0 1"));
+    ASSERT_EQ(1, dtz("8/1P6/8/8/8/8/8/K6k w - - 0 1"));
+    ASSERT_EQ(1, dtz("8/6P1/8/8/8/8/8/k6K w - - 0 1"));
+    int win = dtz("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1");
+    ASSERT_EQ(3, win);
+    ASSERT_EQ(win, dtz("8/8/8/8/4p3/4k3/8/4K3 b - - 0 1"));
+    ASSERT_EQ(-4, dtz("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1"));
+    ASSERT_EQ(-4, dtz("8/8/8/8/4p3/4k3/8/4K3 w - - 0 1"));
+
+    // Every legal position agrees with the generator, which also
+    // takes in the colors swapped and the pawn on the other wing
+    const vector<int> kpk = {TbPawn, TbKing, TbKing + 8};
+    const vector<int> kpkSwapped = {TbPawn + 8, TbKing + 8, TbKing};
+    int compared = 0;
+    for (int pawn = 8; pawn < 56; pawn++)
+    {
+        for (int king = 0; king < 64; king++)
+        {
+            for (int other = 0; other < 64; other++)
+            {
+                for (int stm = 0; stm < 2; stm++)
+                {
+                    if (pawn == king || pawn == other || king == other)
+                    {
+                        continue;
+                    }
+                    uint8_t result = Solve(solved, kpk, {pawn, king, other}, stm);
+                    if (result == EGT_BROKEN)
+                    {
+                        continue;
+                    }
+                    ASSERT_EQ(WdlValue(result) - 2, wdl(Fen(kpk, {pawn, king, other}, stm)));
+                    ASSERT_EQ(WdlValue(result) - 2, wdl(Fen(kpkSwapped, {pawn ^ 56, king ^ 56, other ^ 56}, 1 - stm)));
+                    compared++;
+                }
+            }
+        }
+    }
+    ASSERT_GT(compared, 300000);
+
+    ASSERT_EQ(0, tablebases.Init(""));
+    filesystem::remove_all(directory);
+}
+
+TEST(TablebasesTest, RankRootRepetition)
+{
+    auto directory = filesystem::temp_directory_path() / "TablebasesTestRankRootRepetition";
+    filesystem::remove_all(directory);
+    RetrogradeOptions options;
+    options.mThreads = 2;
+    options.mDirectory = (directory / "egt").string();
+    RetrogradeGenerator generator(options);
+    ASSERT_TRUE(generator.Generate("KRvK"));
+    EndgameTables solved;
+    ASSERT_EQ(1, solved.Init(options.mDirectory));
+    WritePawnless(directory, solved, TbRook, 0);
+
+    Tablebases tablebases;
+    ASSERT_EQ(1, tablebases.Init(directory.string()));
+    Position position;
+    ASSERT_TRUE(position.SetFen("4k3/8/8/8/8/8/R7/4K3 w - - 0 1"));
+    auto kingRank = [&tablebases, &position]() {
+        MoveList moves;
+        position.GenerateLegalMoves(moves);
+        vector<RootMove> rootMoves;
+        for (Move move : moves)
+        {
+            RootMove rootMove;
+            rootMove.mMove = move;
+            rootMoves.push_back(rootMove);
+        }
+        EXPECT_TRUE(tablebases.RankRootMoves(position, rootMoves, true));
+        for (auto const &rootMove : rootMoves)
+        {
+            if (rootMove.mMove.ToUci() == "e1f1")
+            {
+                return rootMove.mTbRank;
+            }
+        }
+        return -1;
+    };
+    auto shuffle = [&position]() {
+        for (auto uci : {"e1f1", "e8f8", "f1e1", "f8e8"})
+        {
+            position.DoMove(position.ParseMove(uci));
+        }
+    };
+
+    // A position seen once before is not yet a draw, the win only
+    // ranks below those the fifty move rule could never spoil
+    shuffle();
+    ASSERT_GT(kingRank(), 0);
+
+    // Seen twice before, going there again draws
+    shuffle();
+    ASSERT_EQ(0, kingRank());
+
+    ASSERT_EQ(0, tablebases.Init(""));
+    filesystem::remove_all(directory);
+}
@@ -0,0 +1,36 @@
+/**
+ * @file UciMain.cpp
+ * @author John Korreck
+ *
+ * Entry point for the console engine that speaks UCI
+ */
+
+#include "pch.h"
+#include <Engine.h>
+#include <Uci.h>
+
+/**
+ * Run the UCI command loop on standard input and output. Any
+ * arguments are run as a single command instead, as in "bench 12".
+ * @param argc Number of arguments
+ * @param argv The arguments
+ * @return Exit code
+ */
+int main(int argc, char *argv[])
+{
+    Engine engine;
+    Uci uci(engine);
+    if (argc > 1)
+    {
+        std::string command;
+        for (int i = 1; i < argc; i++)
+        {
+            command += std::string(i > 1 ? " " : "") + argv[i];
+        }
+        std::istringstream input(command);
+        uci.Loop(input, std::cout);
+        return 0;
+    }
+    uci.Loop(std::cin, std::cout);
+    return 0;
+}